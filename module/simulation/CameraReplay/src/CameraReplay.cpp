@@ -0,0 +1,126 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "CameraReplay.h"
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <yaml-cpp/yaml.h>
+#include "message/input/Image.h"
+
+// frames ahead of the one being emitted that the kernel is asked to read in
+const size_t READ_AHEAD = 8;
+
+namespace module {
+namespace simulation {
+
+    CameraReplay::CameraReplay(std::unique_ptr<NUClear::Environment> environment)
+    : Reactor(std::move(environment)) {
+
+        load_config();
+
+        log = utility::simulation::FrameLogReader::open(log_path);
+        std::cout << "Replaying " << log->size() << " frames from " << log_path << "\n";
+
+        next = 0;
+        emitted = 0;
+        start_pass();
+
+        on<Always>().then([this] {
+
+            if (next == log->size())
+            {
+                if (!loop || log->size() == 0)
+                {
+                    std::cout << "Replayed " << emitted << " frames\n";
+                    powerplant.shutdown();
+                    return;
+                }
+
+                // the next pass carries on one average frame interval after this one ended
+                const auto& first = log->record(0);
+                const auto& last = log->record(log->size() - 1);
+                const int64_t span = last.timestamp - first.timestamp;
+                const int64_t interval = log->size() > 1 ? span / int64_t(log->size() - 1) : 0;
+
+                next = 0;
+                timestamp_offset += std::chrono::nanoseconds(span + interval);
+                start_pass();
+            }
+
+            const utility::simulation::FrameLogRecord& record = log->record(next);
+            const std::chrono::nanoseconds recorded(record.timestamp);
+
+            // sleep until the frame is due, measured from the first frame of the pass
+            if (speed > 0.0)
+            {
+                const std::chrono::nanoseconds since_first(record.timestamp - log->record(0).timestamp);
+                std::this_thread::sleep_until(pass_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                  std::chrono::duration<double, std::nano>(since_first.count() / speed)));
+            }
+
+            log->will_need(next + READ_AHEAD, 1);
+
+            // the image shares ownership of the mapping, which stays alive until its last subscriber drops it
+            message::input::ImageBuffer buffer(log->data(next), record.bytes, log);
+
+            NUClear::clock::time_point timestamp = restamp
+                ? NUClear::clock::now()
+                : NUClear::clock::time_point(std::chrono::duration_cast<NUClear::clock::duration>(recorded + timestamp_offset));
+
+            auto image = std::make_unique<message::input::Image>(record.width, record.height, timestamp, std::move(buffer)
+                                                               , message::input::ImageFormat(record.format));
+            image->camera_id = record.camera_id;
+            image->world_id = record.world_id;
+            image->sequence = emitted;
+            emit(std::move(image));
+
+            ++next;
+            ++emitted;
+        });
+    }
+
+    void CameraReplay::load_config()
+    {
+        YAML::Node config = YAML::LoadFile("config/CameraReplay.yaml");
+
+        log_path = config["log"] ? config["log"].as<std::string>() : "recording.nufl";
+
+        std::string rate = config["rate"] ? config["rate"].as<std::string>() : "original";
+        if (rate != "original" && rate != "max")
+            throw std::runtime_error("Unknown replay rate " + rate + ", expected original or max");
+        speed = rate == "max" ? 0.0 : config["speed"] ? config["speed"].as<double>() : 1.0;
+
+        loop = config["loop"] ? config["loop"].as<bool>() : false;
+
+        std::string timestamps = config["timestamps"] ? config["timestamps"].as<std::string>() : "original";
+        if (timestamps != "original" && timestamps != "replay")
+            throw std::runtime_error("Unknown replay timestamps " + timestamps + ", expected original or replay");
+        restamp = timestamps == "replay";
+
+        timestamp_offset = std::chrono::nanoseconds(0);
+    }
+
+    void CameraReplay::start_pass()
+    {
+        pass_start = std::chrono::steady_clock::now();
+        log->will_need(0, READ_AHEAD);
+    }
+}
+}
@@ -0,0 +1,67 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATION_CAMERAREPLAY_H
+#define MODULE_SIMULATION_CAMERAREPLAY_H
+
+#include <nuclear>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "utility/simulation/FrameLog.h"
+
+namespace module {
+namespace simulation {
+
+    /**
+     * Plays back a frame log recorded by the CameraSimulator, emitting its images at the rate they were
+     * recorded, scaled, or as fast as possible. Images borrow their pixels straight from the memory mapped
+     * log, so nothing is copied or converted and no renderer is needed.
+     */
+    class CameraReplay : public NUClear::Reactor {
+
+		std::shared_ptr<utility::simulation::FrameLogReader> log;
+		std::string log_path;
+
+		// 0 emits as fast as possible
+		double speed;
+		bool loop;
+		bool restamp;
+
+		size_t next;
+		uint64_t emitted;
+		// the wall time the first frame of this pass was due and how far the recorded timestamps are moved on
+		std::chrono::steady_clock::time_point pass_start;
+		std::chrono::nanoseconds timestamp_offset;
+
+   	private:
+
+   		void load_config();
+   		void start_pass();
+
+    public:
+        /// @brief Called by the powerplant to build and setup the CameraReplay reactor.
+        explicit CameraReplay(std::unique_ptr<NUClear::Environment> environment);
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATION_CAMERAREPLAY_H
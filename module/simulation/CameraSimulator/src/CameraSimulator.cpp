@@ -18,646 +18,1737 @@
  */
 
 #include "CameraSimulator.h"
+#include <OgreStringConverter.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <yaml-cpp/yaml.h>
 #include "message/input/Image.h"
+#include "message/input/ImagePyramid.h"
+#include "message/simulation/FrameAck.h"
+#include "message/simulation/FrameProfile.h"
+#include "message/simulation/GroundTruth.h"
+#include "message/simulation/LabelImage.h"
 
-const int TEX_WIDTH = 640;
-const int TEX_HEIGHT = 480;
-const double SCALE = 0.024;
-const int NUM_NOISE_FRAMES = 1;
+// rows of a tile converted per task, small enough that a few cameras still keep every core busy
+const unsigned int STRIP_ROWS = 48;
 
 namespace module {
 namespace simulation {
 
-    uint8_t double_to_color(double d)
+    // Maps the Ogre (native endian) pixel formats we can read back to their byte order in memory
+    bool layout_for_format(Ogre::PixelFormat format, PixelLayout& layout)
     {
-        if (d < 0.0)
-            d = 0.0;
-        if (d > 1.0)
-            d = 1.0;
-        return (uint8_t)(d * 255.0);
+        switch (format)
+        {
+            case Ogre::PF_BYTE_BGR:  layout = PixelLayout::BGR;  return true;
+            case Ogre::PF_BYTE_RGB:  layout = PixelLayout::RGB;  return true;
+            case Ogre::PF_BYTE_BGRA: layout = PixelLayout::BGRX; return true;
+            case Ogre::PF_BYTE_RGBA: layout = PixelLayout::RGBX; return true;
+#if OGRE_ENDIAN == OGRE_ENDIAN_LITTLE
+            case Ogre::PF_X8R8G8B8:  layout = PixelLayout::BGRX; return true;
+            case Ogre::PF_X8B8G8R8:  layout = PixelLayout::RGBX; return true;
+#endif
+            default: return false;
+        }
+    }
+
+    Ogre::TextureFilterOptions texture_filter_options(TextureFiltering filtering)
+    {
+        switch (filtering)
+        {
+            case TextureFiltering::BILINEAR:    return Ogre::TFO_BILINEAR;
+            case TextureFiltering::TRILINEAR:   return Ogre::TFO_TRILINEAR;
+            case TextureFiltering::ANISOTROPIC: return Ogre::TFO_ANISOTROPIC;
+            default:                            return Ogre::TFO_NONE;
+        }
     }
 
     CameraSimulator::CameraSimulator(std::unique_ptr<NUClear::Environment> environment)
     : Reactor(std::move(environment)) {
     
         is_initialised = false;
+        is_running = false;
+        ogre_root = nullptr;
+        parent_gone = false;
+
+        startup_mark = std::chrono::steady_clock::now();
+        load_config();
+        mark_startup_phase("config");
+
+        image_sequence = 0;
+        label_frame = 0;
+
+        if (!dataset_options.directory.empty())
+        {
+            dataset = std::make_unique<DatasetWriter>(dataset_options);
+            std::cout << "Writing images to " << dataset_options.directory << " on " << dataset_options.threads << " threads\n";
+
+            // images are numbered on from any the directory already holds, so a second run adds to the dataset
+            image_sequence = dataset->next_sequence();
+            if (image_sequence > 0)
+                std::cout << "Continuing the dataset from image " << image_sequence << "\n";
+
+            on<Trigger<message::input::Image>>().then([this] (std::shared_ptr<const message::input::Image> image) {
+                dataset->push(image, image->sequence);
+            });
+        }
+
+        // generated frames are listed beside the images they were rendered into, joined on world_id and timestamp_ns.
+        // A world process takes every episode_stride'th episode from its own id, so ids match one process running them all
 
-        // fill std::vector here??
+        next_episode = first_world_id;
+        generated_episodes = 0;
+        generated_frames = 0;
+        if (generator.enabled() && dataset)
+        {
+            const std::string manifest_path = dataset_options.directory + "/manifest.csv";
+            manifest.open(manifest_path, std::ios::out | std::ios::app | std::ios::ate);
+            if (!manifest)
+                throw std::runtime_error("Can't open " + manifest_path);
+            if (manifest.tellp() == 0)
+                ScenarioGenerator::write_manifest_header(manifest, robot_placements.size());
+        }
+
+        if (!record_path.empty())
+        {
+            recorder = std::make_unique<utility::simulation::FrameLogWriter>(record_path);
+            std::cout << "Recording images to " << record_path << " after " << recorder->frames() << " recorded frames\n";
+
+            on<Trigger<message::input::Image>>().then([this] (const message::input::Image& image) {
+                record_image(image);
+            });
+        }
+
+        // a world process takes kicks and velocities from the simulator that started it, and stops when it goes
+
+        if (world_channel)
+            world_channel_reader = std::thread([this] { read_parent(); });
+
+        if (world_processes_enabled)
+            start_world_processes();
 
         on<Always>().then([this] {
 
+            // with a process per world this one only merges what they send
+
+            if (world_processes)
+            {
+                if (is_running)
+                    supervise_world_processes();
+                return;
+            }
+
             // initialise on first call only
 
             if (!is_initialised)
             {
                 is_initialised = true;
-                initialise_ogre();
+                is_running = initialise_ogre();
+
+                if (!is_running)
+                    powerplant.shutdown();
+            }
+
+            if (!is_running)
+                return;
+
+            if (parent_gone)
+            {
+                std::cout << "The simulator that started this world has gone\n";
+                is_running = false;
+                powerplant.shutdown();
+                return;
+            }
+
+            // sleep until this frame is due, then report how well we are keeping up
+
+            scheduler.wait();
+
+            // with the block policy a dataset that can't keep up holds the next frame back until this one fits
+            if (dataset)
+                dataset->wait_for_space(worlds.size() * camera_configs.size());
+
+            FrameScheduler::Report report;
+            if (scheduler.report(scheduler_report_interval, report))
+            {
+                std::cout << "Camera " << report.achieved_rate << " fps, "
+                          << report.missed << " late, " << report.dropped << " dropped, worst "
+                          << report.worst_lateness.count() * 1000.0 << " ms late\n";
+
+                // where the render thread's time went, rendering is serial across worlds so once it
+                // dominates more worlds stop adding throughput
+
+                double render_seconds = std::chrono::duration<double>(render_time).count();
+                double readback_seconds = std::chrono::duration<double>(readback_time).count();
+                double busy = render_seconds + readback_seconds;
+
+                uint64_t total_frames = 0;
+                for (uint64_t frames : world_frames)
+                    total_frames += frames;
+
+                std::cout << "Worlds " << worlds.size() << ", " << total_frames / scheduler_report_interval.count()
+                          << " world frames per second, rendering " << (busy > 0 ? 100.0 * render_seconds / busy : 0.0)
+                          << "% and readback " << (busy > 0 ? 100.0 * readback_seconds / busy : 0.0) << "% of render thread time\n";
+                for (size_t i = 0; i < worlds.size(); ++i)
+                {
+                    std::cout << "  World " << worlds[i]->id << " " << world_frames[i] / scheduler_report_interval.count() << " fps\n";
+                    world_frames[i] = 0;
+                }
+
+                render_time = std::chrono::steady_clock::duration::zero();
+                readback_time = std::chrono::steady_clock::duration::zero();
+
+                // buffers still held by subscribers, and how often since startup the pools ran dry and allocated
+                auto pool_report = [] (const char* name, const std::shared_ptr<message::input::ImageBufferPool>& pool) {
+                    if (pool)
+                        std::cout << " " << name << " " << pool->in_use() << "/" << pool->capacity()
+                                  << " in use, " << pool->exhausted() << " exhausted;";
+                };
+                std::cout << "Buffers:";
+                pool_report("image", image_pool);
+                pool_report("pyramid", pyramid_pool);
+                pool_report("native", native_pool);
+                std::cout << "\n";
+
+                report_dataset(scheduler_report_interval.count());
+
+                if (profiler.enabled)
+                {
+                    auto profile = std::make_unique<message::simulation::FrameProfile>(
+                        profiler.report(NUClear::clock::now(), scheduler_report_interval));
+
+                    std::cout << "Stages (p50/p99 ms):";
+                    for (const auto& stage : profile->stages)
+                        std::cout << " " << stage.name << " " << stage.p50 * 1000.0 << "/" << stage.p99 * 1000.0;
+                    std::cout << "\n";
+
+                    emit(std::move(profile));
+                }
+            }
+
+            // update time info, in lockstep mode wait (a little at a time so we can still shut down)
+            // until the last frame has been acknowledged
+
+            if (!clock.wait(std::chrono::milliseconds(100)))
+                return;
+
+            PROFILE_STAGE(profiler, ProfileStage::FRAME);
+
+            std::chrono::duration<double> time_span = clock.advance();
+            auto frame_start = std::chrono::steady_clock::now();
+
+            // give idle worlds the next scenario, then calculate flag positions, ball rotations etc.
+
+            {
+                PROFILE_STAGE(profiler, ProfileStage::CALCULATE_WORLD);
+
+                for (size_t i = 0; i < worlds.size(); ++i)
+                {
+                    // episodes are only drawn once a world is free for one, so any number of them costs nothing up front
+                    if (!worlds[i]->is_active() && scenarios.empty() && generator.enabled() && next_episode < generator.episodes())
+                    {
+                        if (generated_episodes == 0)
+                            generation_start = std::chrono::steady_clock::now();
+
+                        ScenarioJob job;
+                        job.id = next_episode;
+                        job.frames = generator.frames();
+                        job.initial_state = state_from_scene(generator.sample(next_episode, 0));
+                        job.generated = true;
+                        scenarios.push_back(job);
+                        next_episode += episode_stride;
+                        ++generated_episodes;
+                    }
+
+                    if (!worlds[i]->is_active() && !scenarios.empty())
+                    {
+                        worlds[i]->start_job(scenarios.front());
+                        scenarios.pop_front();
+
+                        if (dynamics)
+                            reset_dynamics(i);
+                    }
+                    else if (worlds[i]->is_active() && worlds[i]->job.generated && generator.per_frame())
+                    {
+                        // every frame after the first is a fresh draw, posed as the robots already are
+                        const ScenarioJob& job = worlds[i]->job;
+                        WorldState next = state_from_scene(generator.sample(job.id, job.frames - worlds[i]->frames_remaining));
+                        next.joint_angles = worlds[i]->state.joint_angles;
+                        worlds[i]->set_state(next);
+
+                        if (dynamics)
+                            reset_dynamics(i);
+                    }
+
+                    if (worlds[i]->is_active())
+                        worlds[i]->calculate_world(time_span);
+                }
+
+                if (dynamics)
+                    step_dynamics(time_span);
+            }
+
+            // render to window and texture, a headless window is never updated so only the frame listeners run
+
+            auto render_start = std::chrono::steady_clock::now();
+
+            {
+                PROFILE_STAGE(profiler, ProfileStage::RENDER_ONE_FRAME);
+                ogre_root->renderOneFrame();
             }
 
-            // update time info
+            if (!headless)
+            {
+                PROFILE_STAGE(profiler, ProfileStage::SWAP_BUFFERS);
+                window->swapBuffers();
+            }
+
+            // render each world into its next texture. A world's oldest frame is read back once its ring
+            // is full, by which point the GPU has finished with it. Lockstep can't have frames in flight
+            // as the next frame waits for this one to be acknowledged, and a finished scenario has nothing
+            // left to push its last frames out.
+
+            {
+                PROFILE_STAGE(profiler, ProfileStage::RENDER_WORLDS);
+
+                const bool with_labels = labels_enabled && label_frame++ % label_every == 0;
+
+                for (size_t i = 0; i < worlds.size(); ++i)
+                {
+                    if (worlds[i]->is_active())
+                    {
+                        NUClear::clock::time_point timestamp = clock.now();
+                        worlds[i]->render(timestamp, with_labels);
+                        ++world_frames[i];
+
+                        if (ground_truth)
+                            emit_ground_truth(*worlds[i], timestamp);
+
+                        if (worlds[i]->state.noise_level != 1.0f)
+                            noise_levels[std::make_pair(worlds[i]->id, timestamp)] = worlds[i]->state.noise_level;
+
+                        if (worlds[i]->job.generated)
+                        {
+                            ++generated_frames;
+                            if (manifest.is_open() || world_channel)
+                            {
+                                const ScenarioJob& job = worlds[i]->job;
+                                SampledScene rendered = scene_from_state(worlds[i]->state);
+                                if (dynamics)
+                                    dynamics->ball_velocity(i, rendered.ball_velocity);
+
+                                // a world process's rows are written by the simulator that started it
+                                std::ostringstream row;
+                                std::ostream& out = world_channel ? static_cast<std::ostream&>(row) : manifest;
+                                generator.write_manifest_row(out, job.id, job.frames - worlds[i]->frames_remaining - 1, worlds[i]->id
+                                                           , std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count()
+                                                           , rendered);
+                                if (world_channel && !world_channel->send_manifest_row(row.str()))
+                                    parent_gone = true;
+                            }
+                        }
+
+                        if (recorder)
+                        {
+                            std::lock_guard<std::mutex> lock(recorder_mutex);
+                            rendered_states[std::make_pair(worlds[i]->id, timestamp)] = { worlds[i]->state, worlds[i]->camera_configs, worlds[i]->cameras.size() };
+                        }
+                    }
+                }
+            }
+
+            auto readback_start = std::chrono::steady_clock::now();
+            render_time += readback_start - render_start;
+
+            std::vector<std::pair<World*, RenderTextureRing::Frame>> ready;
+            std::vector<std::pair<World*, RenderTextureRing::Frame>> labels_ready;
+            for (auto& world : worlds)
+            {
+                bool drain = clock.mode() == ClockMode::LOCKSTEP || !world->is_active();
+                while (world->readback->full() || (drain && !world->readback->empty()))
+                {
+                    ready.emplace_back(world.get(), world->readback->oldest());
+
+                    // labels rendered with this frame are read back with it
+                    if (world->labels && !world->labels->empty()
+                        && world->labels->oldest().timestamp == world->readback->oldest().timestamp)
+                    {
+                        labels_ready.emplace_back(world.get(), world->labels->oldest());
+                        world->labels->pop();
+                    }
+
+                    world->readback->pop();
+                }
+            }
+
+            size_t emitted = 0;
+            if (!ready.empty())
+                emitted = emit_images(ready);
+
+            // lockstep waits for every image of this frame, from every world and camera, to be acknowledged
+            clock.expect(emitted);
+
+            if (!labels_ready.empty())
+                emit_labels(labels_ready);
+
+            readback_time += std::chrono::steady_clock::now() - readback_start;
+
+            // only now has this frame made it out, a lockstep wait that timed out above never gets here
+            scheduler.rendered();
+
+            if (startup_phases.back().first == "scene")
+            {
+                mark_startup_phase("first frame");
+                report_startup();
+            }
+
+            // trade quality for frame time, or back again, to hold the target rate
+
+            if (quality.record(std::chrono::steady_clock::now() - frame_start))
+            {
+                const QualityTier& tier = quality_tiers[quality.tier()];
+                std::cout << "Quality tier " << tier.name << " after " << quality.mean_frame_time() * 1000.0 << " ms frames\n";
+                apply_quality(tier);
+            }
+
+            if (scenarios_finished())
+            {
+                std::cout << "All scenarios rendered\n";
+
+                if (generator.enabled())
+                {
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - generation_start).count();
+                    std::cout << "Generated " << generated_episodes << " episodes, " << generated_frames << " frames in "
+                              << seconds << " s, " << generated_frames / seconds << " frames/s\n";
+                }
+                is_running = false;
+                powerplant.shutdown();
+                return;
+            }
+
+            if (!headless)
+            {
+                Ogre::WindowEventUtilities::messagePump();
+                if (window->isClosed())
+                {
+                    is_running = false;
+                    powerplant.shutdown();
+                }
+            }
+        });
 
-            auto this_time = std::chrono::steady_clock::now();
-            std::chrono::duration<double> time_span = 
-                    std::chrono::duration_cast<std::chrono::duration<double>>(this_time - last_time);
-            last_time = this_time;
+        on<Trigger<message::simulation::FrameAck>>().then([this] (const message::simulation::FrameAck& ack) {
+            clock.acknowledge(ack.timestamp);
+        });
 
-            // calculate flag positions, ball rotations etc.
+        // a world in a process of its own is sent what is meant for it
 
-            calculate_world(time_span);
+        on<Trigger<message::simulation::KickBall>>().then([this] (const message::simulation::KickBall& kick) {
+            if (world_processes)
+            {
+                if (kick.world_id < world_processes->size())
+                    world_processes->channel(kick.world_id).send(kick);
+                return;
+            }
 
-            // render to window and texture
+            std::lock_guard<std::mutex> lock(dynamics_mutex);
+            pending_kicks.push_back(kick);
+        });
 
-            ogre_root->renderOneFrame();
-            window->swapBuffers();
-            
-            //render_target->update();
-            //tex_to_yuyv();
-            Ogre::WindowEventUtilities::messagePump();
-            if (window->isClosed()) 
-                abort();
+        on<Trigger<message::simulation::RobotVelocity>>().then([this] (const message::simulation::RobotVelocity& velocity) {
+            if (world_processes)
+            {
+                if (velocity.world_id < world_processes->size())
+                    world_processes->channel(velocity.world_id).send(velocity);
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(dynamics_mutex);
+            pending_velocities.push_back(velocity);
         });
     }
 
-    IGus CameraSimulator::new_igus()
+    CameraSimulator::~CameraSimulator()
     {
-        IGus result;
-
-        result.root_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        result.root_node->setScale(8.0, 8.0, 8.0);
-        result.root_node->pitch(Ogre::Degree(90));
-        result.root_node->roll(Ogre::Degree(180));
-
-        Ogre::SceneNode* body_node = result.root_node->createChildSceneNode();
-        Ogre::SceneNode* neck_node = body_node->createChildSceneNode();
-        Ogre::SceneNode* shoulder_right_node = body_node->createChildSceneNode();
-        Ogre::SceneNode* shoulder_left_node = body_node->createChildSceneNode();
-        Ogre::SceneNode* bicep_right_node = shoulder_right_node->createChildSceneNode();
-        Ogre::SceneNode* bicep_left_node = shoulder_left_node->createChildSceneNode();
-        Ogre::SceneNode* forearm_right_node = bicep_right_node->createChildSceneNode();
-        Ogre::SceneNode* forearm_left_node = bicep_left_node->createChildSceneNode();
-        Ogre::SceneNode* hip_right_node = body_node->createChildSceneNode();
-        Ogre::SceneNode* hip_left_node = body_node->createChildSceneNode();
-        Ogre::SceneNode* thigh_right_node = hip_right_node->createChildSceneNode();
-        Ogre::SceneNode* thigh_left_node = hip_left_node->createChildSceneNode();
-        Ogre::SceneNode* lower_leg_right_node = thigh_right_node->createChildSceneNode();
-        Ogre::SceneNode* lower_leg_left_node = thigh_left_node->createChildSceneNode();
-        Ogre::SceneNode* foot_right_node = lower_leg_right_node->createChildSceneNode();
-        Ogre::SceneNode* foot_left_node = lower_leg_left_node->createChildSceneNode();
-
-        body_node->pitch(-Ogre::Degree(90));
-        body_node->translate(-50.0 * SCALE,  19.1 * SCALE, -25.0 * SCALE);
-        
-        neck_node->translate(0.0, 10.0 * SCALE, 0.0);
-        shoulder_right_node->translate(-3.2 * SCALE, 7.3 * SCALE, 0.0);
-        shoulder_left_node->translate(3.2 * SCALE, 7.3 * SCALE, 0.0);
-        bicep_right_node->translate(-1.8 * SCALE, -0.4 * SCALE, 0.0);
-        bicep_left_node->translate(1.8 * SCALE, -0.4 * SCALE, 0.0);
-        forearm_right_node->translate(-0.1 * SCALE, -6.5 * SCALE, 0.9 * SCALE);
-        forearm_left_node->translate(-0.1 * SCALE, -6.5 * SCALE, 0.9 * SCALE);
-        hip_right_node->translate(-2.3 * SCALE, 0.0 * SCALE, 0.0 * SCALE);
-        hip_left_node->translate(2.3 * SCALE, 0.0 * SCALE, 0.0 * SCALE);
-        thigh_right_node->translate(0.0 * SCALE, 2.4 * SCALE, 0.9 * SCALE);
-        thigh_left_node->translate(0.0 * SCALE, 2.4 * SCALE, 0.9 * SCALE);
-        lower_leg_right_node->translate(-0.2 * SCALE, -7.9 * SCALE, 0.1 * SCALE);
-        lower_leg_left_node->translate(0.2 * SCALE, -7.9 * SCALE, 0.1 * SCALE);
-        foot_right_node->translate(0.2 * SCALE, -9.7 * SCALE, -0.2 * SCALE);
-        foot_left_node->translate(-0.2 * SCALE, -9.7 * SCALE, -0.2 * SCALE);
-        
-        Ogre::Entity* body = scene_mgr->createEntity("igus_body.mesh");
-        body->setMaterialName("iguswhite");
-        body->setCastShadows(false);
-        body_node->attachObject(body);
-
-        Ogre::Entity* head = scene_mgr->createEntity("igus_head.mesh");
-        head->setMaterialName("iguswhite");
-        head->setCastShadows(false);
-        neck_node->attachObject(head);
-
-        Ogre::Entity* eyemask = scene_mgr->createEntity("igus_eyemask.mesh");
-        eyemask->setMaterialName("igusorange");
-        eyemask->setCastShadows(false);
-        neck_node->attachObject(eyemask);
-
-        Ogre::Entity* shoulder_right = scene_mgr->createEntity("igus_shoulder_right.mesh");
-        shoulder_right->setMaterialName("iguswhite");
-        shoulder_right->setCastShadows(false);
-        shoulder_right_node->attachObject(shoulder_right);
-
-        Ogre::Entity* shoulder_left = scene_mgr->createEntity("igus_shoulder_left.mesh");
-        shoulder_left->setMaterialName("iguswhite");
-        shoulder_left->setCastShadows(false);
-        shoulder_left_node->attachObject(shoulder_left);
-
-        Ogre::Entity* bicep_right = scene_mgr->createEntity("igus_bicep_right.mesh");
-        bicep_right->setMaterialName("iguswhite");
-        bicep_right->setCastShadows(false);
-        bicep_right_node->attachObject(bicep_right);
-
-        Ogre::Entity* bicep_left = scene_mgr->createEntity("igus_bicep_left.mesh");
-        bicep_left->setMaterialName("iguswhite");
-        bicep_left->setCastShadows(false);
-        bicep_left_node->attachObject(bicep_left);
-
-        Ogre::Entity* forearm_right = scene_mgr->createEntity("igus_forearm_right.mesh");
-        forearm_right->setMaterialName("iguswhite");
-        forearm_right->setCastShadows(false);
-        forearm_right_node->attachObject(forearm_right);
-
-        Ogre::Entity* hand_right = scene_mgr->createEntity("igus_hand_right.mesh");
-        hand_right->setMaterialName("igusorange");
-        hand_right->setCastShadows(false);
-        forearm_right_node->attachObject(hand_right);
-
-        Ogre::Entity* forearm_left = scene_mgr->createEntity("igus_forearm_left.mesh");
-        forearm_left->setMaterialName("iguswhite");
-        forearm_left->setCastShadows(false);
-        forearm_left_node->attachObject(forearm_left);
-
-        Ogre::Entity* hand_left = scene_mgr->createEntity("igus_hand_left.mesh");
-        hand_left->setMaterialName("igusorange");
-        hand_left->setCastShadows(false);
-        forearm_left_node->attachObject(hand_left);
-
-        Ogre::Entity* hip_right = scene_mgr->createEntity("igus_hip_right.mesh");
-        hip_right->setMaterialName("iguswhite");
-        hip_right->setCastShadows(false);
-        hip_right_node->attachObject(hip_right);
-
-        Ogre::Entity* hip_left = scene_mgr->createEntity("Igushipleft", "igus_hip_left.mesh");
-        hip_left->setMaterialName("iguswhite");
-        hip_left->setCastShadows(false);
-        hip_left_node->attachObject(hip_left);
-
-        Ogre::Entity* thigh_right = scene_mgr->createEntity("Igusthighright", "igus_thigh_right.mesh");
-        thigh_right->setMaterialName("iguswhite");
-        thigh_right->setCastShadows(false);
-        thigh_right_node->attachObject(thigh_right);
-
-        Ogre::Entity* thigh_left = scene_mgr->createEntity("Igusthighleft", "igus_thigh_left.mesh");
-        thigh_left->setMaterialName("iguswhite");
-        thigh_left->setCastShadows(false);
-        thigh_left_node->attachObject(thigh_left);
-
-        Ogre::Entity* lower_leg_right = scene_mgr->createEntity("Iguslower_legright", "igus_lower_leg_right.mesh");
-        lower_leg_right->setMaterialName("iguswhite");
-        lower_leg_right->setCastShadows(false);
-        lower_leg_right_node->attachObject(lower_leg_right);
-
-        Ogre::Entity* lower_leg_left = scene_mgr->createEntity("Iguslower_legleft", "igus_lower_leg_left.mesh");
-        lower_leg_left->setMaterialName("iguswhite");
-        lower_leg_left->setCastShadows(false);
-        lower_leg_left_node->attachObject(lower_leg_left);
-
-        Ogre::Entity* foot_right = scene_mgr->createEntity("Igusfootright", "igus_foot_right.mesh");
-        foot_right->setMaterialName("igusblack");
-        foot_right->setCastShadows(false);
-        foot_right_node->attachObject(foot_right);
-
-        Ogre::Entity* arches_right = scene_mgr->createEntity("Igusarchesright", "igus_arches_right.mesh");
-        arches_right->setMaterialName("iguswhite");
-        arches_right->setCastShadows(false);
-        foot_right_node->attachObject(arches_right);
-
-        Ogre::Entity* foot_left = scene_mgr->createEntity("Igusfootleft", "igus_foot_left.mesh");
-        foot_left->setMaterialName("igusblack");
-        foot_left->setCastShadows(false);
-        foot_left_node->attachObject(foot_left);
-
-        Ogre::Entity* arches_left = scene_mgr->createEntity("Igusarchesleft", "igus_arches_left.mesh");
-        arches_left->setMaterialName("iguswhite");
-        arches_left->setCastShadows(false);
-        foot_left_node->attachObject(arches_left);
-
-        body_node->yaw(Ogre::Degree(90));
-
-        return result;
+        // the worlds take their closed channels as the signal to stop, which also ends our readers
+        if (world_processes)
+        {
+            world_processes->stop();
+            for (auto& reader : world_readers)
+                reader.join();
+            world_processes.reset();
+        }
+
+        if (world_channel)
+        {
+            world_channel->shutdown();
+            world_channel_reader.join();
+        }
+
+        if (ogre_root)
+        {
+            worlds.clear();
+            if (label_scheme)
+                Ogre::MaterialManager::getSingleton().removeListener(label_scheme.get());
+            delete ogre_root;
+        }
     }
 
-    void CameraSimulator::RenderNoise(Ogre::TexturePtr tex)
+    void CameraSimulator::load_config()
     {
-        
-        scene_mgr->getRootSceneNode()->attachObject(noise);
-        
-        params = noise->getMaterial()->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
-        params->setNamedConstant("seed", (Ogre::Real)((double) 10000000.0 * rand()/(double)RAND_MAX));      
-        noise->setVisible(true);
-
-        Ogre::RenderTexture* rt = tex->getBuffer()->getRenderTarget();
-        
-        rt->addViewport(camera);
-        rt->getViewport(0)->setClearEveryFrame(true);
-        rt->getViewport(0)->setBackgroundColour(Ogre::ColourValue::Blue);
-        rt->getViewport(0)->setOverlaysEnabled(false);
-        rt->update();
-        rt->removeViewport(0);
-  
-        noise->setVisible(false);
-        scene_mgr->getRootSceneNode()->detachObject(noise);
-        
+        // benchmarks and world processes point the simulator at a configuration of their own
+        const char* override_path = std::getenv(WorldProcesses::CONFIG_VARIABLE);
+        config_path = override_path ? override_path : "config/CameraSimulator.yaml";
+        YAML::Node config = YAML::LoadFile(config_path);
+
+        readback_buffers = config["readback_buffers"] ? config["readback_buffers"].as<size_t>() : 3;
+        image_pool_size = config["image_pool_size"] ? config["image_pool_size"].as<size_t>() : 8;
+        headless = config["headless"] ? config["headless"].as<bool>() : false;
+        software_gl = config["software_gl"] ? config["software_gl"].as<bool>() : false;
+        image_format = config["image_format"] ? message::input::image_format_from_string(config["image_format"].as<std::string>())
+                                              : message::input::ImageFormat::YUYV;
+        scene_description = config["scene"] ? config["scene"].as<std::string>() : "config/scenes/Stadium.yaml";
+        scene_cache_path = config["scene_cache"] ? config["scene_cache"].as<std::string>() : scene_description + ".cache";
+        robot_description = config["robot_model"] ? config["robot_model"].as<std::string>() : "config/robots/Igus.yaml";
+        robot_instancing = config["robot_instancing"] ? config["robot_instancing"].as<bool>() : true;
+        world_count = config["worlds"] ? std::max(config["worlds"].as<size_t>(), size_t(1)) : 1;
+        resource_threads = config["resource_threads"] ? config["resource_threads"].as<unsigned int>() : 2;
+        // the stadium's own meshes and materials are in General and its sky in the sample media's Popular group
+        resource_groups = config["resource_groups"] ? config["resource_groups"].as<std::vector<std::string>>() : std::vector<std::string>({ "General", "Popular" });
+        record_path = config["record"] ? config["record"].as<std::string>() : "";
+
+        // run each world in a process of its own, by default this program run again with the same arguments
+
+        world_processes_enabled = false;
+        world_process_command.clear();
+        if (YAML::Node process_config = config["world_processes"])
+        {
+            if (process_config["enabled"])
+                world_processes_enabled = process_config["enabled"].as<bool>();
+            if (process_config["command"])
+                world_process_command = process_config["command"].as<std::vector<std::string>>();
+        }
+        if (world_processes_enabled && world_process_command.empty())
+            world_process_command = WorldProcesses::own_command();
+
+        // or be one of those processes
+
+        first_world_id = 0;
+        episode_stride = 1;
+        world_channel.reset();
+        if (YAML::Node process_config = config["world_process"])
+        {
+            first_world_id = process_config["index"].as<unsigned int>();
+            episode_stride = std::max(process_config["count"].as<uint64_t>(), uint64_t(1));
+            world_channel = std::make_unique<WorldChannel>(process_config["channel"].as<int>());
+        }
+
+        // materials are labelled with the id of the class that lists them, the rest are 0
+
+        labels_enabled = false;
+        label_every = 1;
+        label_scale = 1;
+        label_classes.clear();
+        if (YAML::Node label_config = config["labels"])
+        {
+            labels_enabled = label_config["enabled"] ? label_config["enabled"].as<bool>() : false;
+            label_every = label_config["every"] ? std::max(label_config["every"].as<unsigned int>(), 1u) : 1;
+            label_scale = label_config["scale"] ? std::max(label_config["scale"].as<unsigned int>(), 1u) : 1;
+
+            YAML::Node class_list = label_config["classes"];
+            for (size_t i = 0; class_list && i < class_list.size(); ++i)
+            {
+                unsigned int label = class_list[i]["id"].as<unsigned int>();
+                if (label == 0 || label > 255)
+                    throw std::runtime_error("Label class " + class_list[i]["name"].as<std::string>() + " needs an id from 1 to 255");
+
+                for (const auto& material : class_list[i]["materials"].as<std::vector<std::string>>())
+                    label_classes[material] = label;
+            }
+        }
+
+        field_description = config["field"] ? config["field"].as<std::string>() : "config/scenes/StadiumFeatures.yaml";
+
+        ground_truth_enabled = false;
+        if (YAML::Node ground_truth_config = config["ground_truth"])
+        {
+            if (ground_truth_config["enabled"])
+                ground_truth_enabled = ground_truth_config["enabled"].as<bool>();
+        }
+
+        // the ball's size and the goal posts come from the field, the rest of the physics from here
+
+        dynamics_enabled = false;
+        dynamics_params = DynamicsParameters();
+        if (YAML::Node dynamics_config = config["dynamics"])
+        {
+            if (dynamics_config["enabled"])
+                dynamics_enabled = dynamics_config["enabled"].as<bool>();
+            if (dynamics_config["rate"])
+                dynamics_params.step = std::chrono::duration<double>(1.0 / dynamics_config["rate"].as<double>());
+            if (dynamics_config["gravity"])
+                dynamics_params.gravity = dynamics_config["gravity"].as<float>();
+            if (dynamics_config["ground"])
+                dynamics_params.ground = dynamics_config["ground"].as<float>();
+            if (dynamics_config["rolling_friction"])
+                dynamics_params.rolling_friction = dynamics_config["rolling_friction"].as<float>();
+            if (dynamics_config["ground_restitution"])
+                dynamics_params.ground_restitution = dynamics_config["ground_restitution"].as<float>();
+            if (dynamics_config["wall_restitution"])
+                dynamics_params.wall_restitution = dynamics_config["wall_restitution"].as<float>();
+            if (dynamics_config["robot_radius"])
+                dynamics_params.robot_radius = dynamics_config["robot_radius"].as<float>();
+            if (dynamics_config["boundary"])
+            {
+                std::vector<float> boundary = dynamics_config["boundary"].as<std::vector<float>>();
+                if (boundary.size() != 4)
+                    throw std::runtime_error("The dynamics boundary is [min x, max x, min z, max z]");
+                std::copy(boundary.begin(), boundary.end(), dynamics_params.boundary);
+            }
+        }
+
+        dataset_options = DatasetOptions();
+        if (YAML::Node dataset_config = config["dataset"])
+        {
+            if (dataset_config["directory"])
+                dataset_options.directory = dataset_config["directory"].as<std::string>();
+            if (dataset_config["format"])
+                dataset_options.format = encoded_format_from_string(dataset_config["format"].as<std::string>());
+            if (dataset_config["quality"])
+                dataset_options.quality = dataset_config["quality"].as<int>();
+            if (dataset_config["level"])
+                dataset_options.level = dataset_config["level"].as<int>();
+            if (dataset_config["threads"])
+                dataset_options.threads = dataset_config["threads"].as<unsigned int>();
+            if (dataset_config["queue_size"])
+                dataset_options.queue_size = std::max(dataset_config["queue_size"].as<size_t>(), size_t(1));
+            if (dataset_config["batch_size"])
+                dataset_options.batch_size = std::max(dataset_config["batch_size"].as<size_t>(), size_t(1));
+            if (dataset_config["overflow"])
+                dataset_options.overflow = overflow_policy_from_string(dataset_config["overflow"].as<std::string>());
+        }
+        if (dataset_options.threads == 0)
+            dataset_options.threads = std::max(std::thread::hardware_concurrency(), 1u);
+        conversion_threads = config["conversion_threads"] ? config["conversion_threads"].as<unsigned int>() : 0;
+        if (conversion_threads == 0)
+            conversion_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+        ClockMode mode = ClockMode::REALTIME;
+        double step = 1.0 / 30.0;
+        if (config["clock"])
+        {
+            if (config["clock"]["mode"])
+                mode = clock_mode_from_string(config["clock"]["mode"].as<std::string>());
+            if (config["clock"]["step"])
+                step = config["clock"]["step"].as<double>();
+        }
+        clock_mode = mode;
+        clock_step = std::chrono::duration<double>(step);
+
+        // one camera in the stands looking down the field unless told otherwise
+
+        camera_configs.clear();
+        YAML::Node camera_list = config["cameras"];
+        for (size_t i = 0; camera_list && i < camera_list.size(); ++i)
+        {
+            CameraConfig camera_config;
+            camera_config.id = camera_list[i]["id"] ? camera_list[i]["id"].as<unsigned int>() : i;
+            std::vector<double> position = camera_list[i]["position"].as<std::vector<double>>();
+            camera_config.position = Ogre::Vector3(position[0], position[1], position[2]);
+            camera_config.pitch = camera_list[i]["pitch"].as<double>();
+            camera_config.yaw = camera_list[i]["yaw"].as<double>();
+            camera_config.fov_y = Ogre::Degree(camera_list[i]["fov_y"] ? camera_list[i]["fov_y"].as<double>() : 45.0);
+            camera_configs.push_back(camera_config);
+        }
+
+        if (camera_configs.empty())
+        {
+            camera_configs.push_back({ 0, Ogre::Vector3(-20.0f, 8.0f, -5.0f), -0.18f, 1.8f, Ogre::Degree(45.0) });
+        }
+
+        // one robot in the centre circle unless told otherwise
+
+        robot_placements.clear();
+        YAML::Node robot_list = config["robots"];
+        for (size_t i = 0; robot_list && i < robot_list.size(); ++i)
+        {
+            std::vector<double> position = robot_list[i]["position"].as<std::vector<double>>();
+            Ogre::Degree yaw(robot_list[i]["yaw"] ? robot_list[i]["yaw"].as<double>() : 0.0);
+            robot_placements.push_back({ Ogre::Vector3(position[0], position[1], position[2]), yaw });
+        }
+
+        if (!robot_list)
+        {
+            robot_placements.push_back({ Ogre::Vector3(9.6f, 0.0f, -3.6672f), Ogre::Degree(-90.0) });
+        }
+
+        // without a lens every camera is a centred pinhole of the configured resolution with its own field of
+        // view. With one every camera renders the pinhole frustum the lens needs and the images are remapped through it
+
+        LensParameters lens_params;
+        if (config["resolution"])
+        {
+            std::vector<unsigned int> resolution = config["resolution"].as<std::vector<unsigned int>>();
+            if (resolution.size() != 2 || resolution[0] == 0 || resolution[1] == 0 || resolution[0] % 2 != 0)
+                throw std::runtime_error("The resolution is [width, height] with an even width");
+            lens_params.width = resolution[0];
+            lens_params.height = resolution[1];
+        }
+        YAML::Node lens_config = config["lens"];
+        if (lens_config)
+        {
+            lens_params.projection = lens_projection_from_string(lens_config["projection"].as<std::string>());
+            if (lens_config["width"])
+                lens_params.width = lens_config["width"].as<unsigned int>();
+            if (lens_config["height"])
+                lens_params.height = lens_config["height"].as<unsigned int>();
+            lens_params.fx = lens_config["fx"].as<double>();
+            lens_params.fy = lens_config["fy"] ? lens_config["fy"].as<double>() : lens_params.fx;
+            lens_params.cx = lens_config["cx"] ? lens_config["cx"].as<double>() : lens_params.width * 0.5;
+            lens_params.cy = lens_config["cy"] ? lens_config["cy"].as<double>() : lens_params.height * 0.5;
+            if (lens_config["k"])
+            {
+                std::vector<double> k = lens_config["k"].as<std::vector<double>>();
+                std::copy_n(k.begin(), std::min(k.size(), size_t(4)), lens_params.k);
+            }
+            if (lens_config["p"])
+            {
+                std::vector<double> p = lens_config["p"].as<std::vector<double>>();
+                lens_params.p1 = p.at(0);
+                lens_params.p2 = p.at(1);
+            }
+            if (lens_config["render_scale"])
+                lens_params.render_scale = lens_config["render_scale"].as<double>();
+        }
+        else
+        {
+            lens_params.fy = lens_params.height * 0.5 / std::tan(camera_configs.front().fov_y.valueRadians() * 0.5);
+            lens_params.fx = lens_params.fy;
+            lens_params.cx = lens_params.width * 0.5;
+            lens_params.cy = lens_params.height * 0.5;
+        }
+
+        lens.reset(lens_params);
+
+        // each level of the pyramid halves the one above, so the image has to halve that many times
+        YAML::Node pyramid_config = config["pyramid"];
+        pyramid.reset(lens.width(), lens.height(), pyramid_config && pyramid_config["levels"] ? pyramid_config["levels"].as<unsigned int>() : 0);
+
+        if (lens_config)
+        {
+            for (auto& camera_config : camera_configs)
+                camera_config.fov_y = Ogre::Radian(lens.render_fov_y());
+        }
+
+        uint64_t noise_seed = 0;
+        double read_sigma = 2.0;
+        double shot_gain = 0.05;
+        if (config["noise"])
+        {
+            YAML::Node noise_config = config["noise"];
+            if (noise_config["seed"])
+                noise_seed = noise_config["seed"].as<uint64_t>();
+            if (noise_config["read_sigma"])
+                read_sigma = noise_config["read_sigma"].as<double>();
+            if (noise_config["shot_gain"])
+                shot_gain = noise_config["shot_gain"].as<double>();
+        }
+        sensor_noise.reset(noise_seed, read_sigma, shot_gain);
+
+        bool profiling = false;
+        std::string profile_csv;
+        if (config["profiling"])
+        {
+            YAML::Node profiling_config = config["profiling"];
+            if (profiling_config["enabled"])
+                profiling = profiling_config["enabled"].as<bool>();
+            if (profiling_config["csv"])
+                profile_csv = profiling_config["csv"].as<std::string>();
+        }
+        profiler.reset(profiling, profile_csv);
+
+        // each scenario starts from the first camera's pose and the ball's kick off spot unless it says otherwise
+
+        scenarios.clear();
+        YAML::Node scenario_list = config["scenarios"];
+        for (size_t i = 0; scenario_list && i < scenario_list.size(); ++i)
+        {
+            YAML::Node scenario = scenario_list[i];
+
+            ScenarioJob job;
+            job.id = scenario["id"] ? scenario["id"].as<unsigned int>() : i;
+            job.frames = scenario["frames"] ? scenario["frames"].as<unsigned int>() : 1;
+            job.initial_state.camera_pos = camera_configs.front().position;
+            job.initial_state.camera_pitch = camera_configs.front().pitch;
+            job.initial_state.camera_yaw = camera_configs.front().yaw;
+            job.initial_state.ball_pos = Ogre::Vector3(22.0f, 0.8f, 0.0f);
+
+            if (scenario["camera"])
+            {
+                YAML::Node camera_config = scenario["camera"];
+                if (camera_config["position"])
+                {
+                    std::vector<double> position = camera_config["position"].as<std::vector<double>>();
+                    job.initial_state.camera_pos = Ogre::Vector3(position[0], position[1], position[2]);
+                }
+                if (camera_config["pitch"])
+                    job.initial_state.camera_pitch = camera_config["pitch"].as<double>();
+                if (camera_config["yaw"])
+                    job.initial_state.camera_yaw = camera_config["yaw"].as<double>();
+            }
+
+            if (scenario["ball"])
+            {
+                std::vector<double> ball = scenario["ball"].as<std::vector<double>>();
+                job.initial_state.ball_pos = Ogre::Vector3(ball[0], ball[1], ball[2]);
+            }
+            job.initial_state.last_ball_pos = job.initial_state.ball_pos;
+
+            job.initial_state.ball_velocity = Ogre::Vector3::ZERO;
+            if (scenario["ball_velocity"])
+            {
+                std::vector<double> velocity = scenario["ball_velocity"].as<std::vector<double>>();
+                job.initial_state.ball_velocity = Ogre::Vector3(velocity[0], velocity[1], velocity[2]);
+            }
+
+            if (scenario["joint_angles"])
+                job.initial_state.joint_angles = scenario["joint_angles"].as<std::vector<float>>();
+
+            scenarios.push_back(job);
+        }
+
+        // randomised episodes start from the same state as a scenario for whatever they don't randomise
+
+        SampledScene defaults = {};
+        for (int i = 0; i < 3; ++i)
+        {
+            defaults.camera_position[i] = camera_configs.front().position[i];
+            defaults.light_colour[i] = 1.0f;
+        }
+        defaults.camera_pitch = camera_configs.front().pitch;
+        defaults.camera_yaw = camera_configs.front().yaw;
+        defaults.ambient = 0.5f;
+        defaults.ball_position[0] = 22.0f;
+        defaults.ball_position[1] = 0.8f;
+        for (const auto& placement : robot_placements)
+        {
+            defaults.robots.insert(defaults.robots.end(), { placement.position.x, placement.position.y, placement.position.z
+                                                          , placement.yaw.valueDegrees() });
+        }
+        defaults.noise_level = 1.0f;
+
+        generator = config["randomization"] ? ScenarioGenerator::parse(config["randomization"], defaults) : ScenarioGenerator();
+
+        run_scenarios = !scenarios.empty() || generator.enabled();
+
+        scheduler_rate = 30.0;
+        scheduler_policy = LatePolicy::DROP;
+        scheduler_max_catch_up = 3;
+        scheduler_report_interval = std::chrono::duration<double>(5.0);
+        if (config["scheduler"])
+        {
+            YAML::Node scheduler_config = config["scheduler"];
+            if (scheduler_config["rate"])
+                scheduler_rate = scheduler_config["rate"].as<double>();
+            if (scheduler_config["late_policy"])
+                scheduler_policy = late_policy_from_string(scheduler_config["late_policy"].as<std::string>());
+            if (scheduler_config["max_catch_up"])
+                scheduler_max_catch_up = scheduler_config["max_catch_up"].as<unsigned int>();
+            if (scheduler_config["report_interval"])
+                scheduler_report_interval = std::chrono::duration<double>(scheduler_config["report_interval"].as<double>());
+        }
+
+        // tiers are listed cheapest first and the most expensive is rendered unless another is named
+
+        quality_tiers = default_quality_tiers();
+        size_t quality_tier = quality_tiers.size() - 1;
+        bool quality_auto = false;
+        double quality_rate = 30.0;
+        unsigned int quality_window = 30;
+        double quality_headroom = 0.2;
+        unsigned int quality_cooldown = 4;
+        if (YAML::Node quality_config = config["quality"])
+        {
+            if (quality_config["tiers"])
+            {
+                quality_tiers.clear();
+                YAML::Node tier_list = quality_config["tiers"];
+                for (size_t i = 0; i < tier_list.size(); ++i)
+                    quality_tiers.push_back(QualityTier::parse(tier_list[i]));
+                if (quality_tiers.empty())
+                    throw std::runtime_error("The quality section needs at least one tier");
+                quality_tier = quality_tiers.size() - 1;
+            }
+            if (quality_config["tier"])
+            {
+                const std::string name = quality_config["tier"].as<std::string>();
+                auto tier = std::find_if(quality_tiers.begin(), quality_tiers.end(), [&] (const QualityTier& t) { return t.name == name; });
+                if (tier == quality_tiers.end())
+                    throw std::runtime_error("There is no quality tier called " + name);
+                quality_tier = tier - quality_tiers.begin();
+            }
+            if (YAML::Node auto_config = quality_config["auto"])
+            {
+                if (auto_config["enabled"])
+                    quality_auto = auto_config["enabled"].as<bool>();
+                if (auto_config["target_rate"])
+                    quality_rate = auto_config["target_rate"].as<double>();
+                if (auto_config["window"])
+                    quality_window = auto_config["window"].as<unsigned int>();
+                if (auto_config["headroom"])
+                    quality_headroom = auto_config["headroom"].as<double>();
+                if (auto_config["cooldown"])
+                    quality_cooldown = auto_config["cooldown"].as<unsigned int>();
+            }
+        }
+        quality.reset(quality_tiers.size(), quality_tier, quality_auto ? quality_rate : 0.0, quality_window, quality_headroom, quality_cooldown);
+
+        // only realtime frames are paced, the fixed step modes run as fast as they are allowed to
+        if (clock_mode != ClockMode::REALTIME)
+            scheduler_rate = 0.0;
+
+        // what only works with every world in this process
+        if (world_processes_enabled)
+        {
+            if (clock_mode == ClockMode::LOCKSTEP)
+                throw std::runtime_error("World processes can't run in lockstep, frame acknowledgements aren't forwarded to them");
+            if (!record_path.empty())
+                throw std::runtime_error("World processes can't be recorded, the recorder needs the state each world rendered");
+            if (!pyramid.levels().empty())
+                throw std::runtime_error("World processes don't forward image pyramids");
+        }
     }
 
-    void CameraSimulator::calculate_world(std::chrono::duration<double> time_span)
+    void CameraSimulator::report_dataset(double seconds)
     {
-        time_tally += time_span.count();
-        //camera->yaw(Ogre::Radian(cos(time_tally * 2.0) / 30.0));
+        if (!dataset)
+            return;
+
+        DatasetWriter::Report written = dataset->report();
+        double encode_ms = std::chrono::duration<double, std::milli>(written.encode_time).count();
+
+        std::cout << "Dataset " << written.written / seconds << " images/s, "
+                  << written.encoded_bytes / seconds / 1e6 << " MB/s at "
+                  << (written.encoded_bytes > 0 ? double(written.raw_bytes) / written.encoded_bytes : 0.0) << ":1, "
+                  << (written.written > 0 ? encode_ms / written.written : 0.0) << " ms to encode, "
+                  << written.queued << " queued, " << written.dropped << " dropped, "
+                  << std::chrono::duration<double, std::milli>(written.blocked_time).count() << " ms blocked\n";
+    }
+
+    void CameraSimulator::start_world_processes()
+    {
+        // with nothing but scenarios to run a world without one would have nothing to do
+        size_t count = world_count;
+        if (!generator.enabled() && !scenarios.empty())
+            count = std::min(count, scenarios.size());
+
+        world_processes = std::make_unique<WorldProcesses>(world_process_command, YAML::LoadFile(config_path), count);
+        world_images.assign(count, 0);
+        worlds_running = count;
+        merge_report_time = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < count; ++i)
+            world_readers.emplace_back([this, i] { read_world(i); });
+
+        std::cout << "Running " << count << " worlds in processes of their own\n";
+        is_initialised = true;
+        is_running = true;
+    }
+
+    void CameraSimulator::read_world(size_t index)
+    {
+        WorldChannel& channel = world_processes->channel(index);
+        WorldChannel::Message message;
+
+        while (channel.receive(message))
+        {
+            switch (message.kind)
+            {
+                case WorldChannel::Kind::IMAGE:
+                {
+                    // a dataset that can't keep up stops us reading, which fills the channel and holds the world back
+                    if (dataset)
+                        dataset->wait_for_space(1);
+
+                    {
+                        std::lock_guard<std::mutex> lock(merge_mutex);
+                        message.image->sequence = image_sequence++;
+                        ++world_images[index];
+                    }
+                    emit(std::move(message.image));
+                    break;
+                }
+
+                case WorldChannel::Kind::LABELS:
+                    emit(std::move(message.labels));
+                    break;
+
+                case WorldChannel::Kind::GROUND_TRUTH:
+                    emit(std::move(message.ground_truth));
+                    break;
+
+                case WorldChannel::Kind::MANIFEST_ROW:
+                {
+                    std::lock_guard<std::mutex> lock(merge_mutex);
+                    if (manifest.is_open())
+                        manifest << message.manifest_row;
+                    break;
+                }
+
+                default: break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(merge_mutex);
+        std::cout << "World " << index << " has stopped\n";
+        --worlds_running;
+    }
+
+    void CameraSimulator::supervise_world_processes()
+    {
+        // the worlds do the work, this only wakes to report on them and to notice when they have all stopped
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        std::lock_guard<std::mutex> lock(merge_mutex);
+
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - merge_report_time).count();
+        if (seconds >= scheduler_report_interval.count())
+        {
+            uint64_t total = std::accumulate(world_images.begin(), world_images.end(), uint64_t(0));
+            std::cout << "World processes " << world_images.size() << ", " << total / seconds << " images/s\n";
+            for (size_t i = 0; i < world_images.size(); ++i)
+            {
+                std::cout << "  World " << i << " " << world_images[i] / seconds << " images/s\n";
+                world_images[i] = 0;
+            }
+
+            report_dataset(seconds);
+            merge_report_time = now;
+        }
+
+        if (worlds_running == 0)
+        {
+            std::cout << "All worlds have stopped\n";
+            is_running = false;
+            powerplant.shutdown();
+        }
+    }
+
+    void CameraSimulator::read_parent()
+    {
+        // this process has the one world, whatever its id
+        WorldChannel::Message message;
+        while (world_channel->receive(message))
+        {
+            std::lock_guard<std::mutex> lock(dynamics_mutex);
+            if (message.kind == WorldChannel::Kind::KICK)
+            {
+                message.kick.world_id -= first_world_id;
+                pending_kicks.push_back(message.kick);
+            }
+            else if (message.kind == WorldChannel::Kind::VELOCITY)
+            {
+                message.velocity.world_id -= first_world_id;
+                pending_velocities.push_back(message.velocity);
+            }
+        }
+
+        parent_gone = true;
     }
 
     bool CameraSimulator::frameEnded(const Ogre::FrameEvent& evt)
     {
-        flag0_anim->addTime(evt.timeSinceLastFrame);
-        flag1_anim->addTime(evt.timeSinceLastFrame);
-        flag2_anim->addTime(evt.timeSinceLastFrame);
-        flag3_anim->addTime(evt.timeSinceLastFrame);
+        // animate by simulated time, not Ogre's wall clock, so frames are reproducible
 
-     //   params = noise->getMaterial()->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
-       // params->setNamedConstant("seed", (Ogre::Real)(rand()/(double)RAND_MAX + 1.0));      
-        //cur_noise_index = (cur_noise_index + 1) % NUM_NOISE_FRAMES;
+        PROFILE_STAGE(profiler, ProfileStage::ANIMATE);
 
+        Ogre::Real step = clock.last_step().count();
+        for (auto& world : worlds)
+            world->animate(step);
+
+        return true;
     }
 
-    void CameraSimulator::initialise_scene()
+    bool CameraSimulator::scenarios_finished() const
     {
-       // Setup the basic scene (WARNING - wallpaper code)
-
-        Ogre::SceneNode* base_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* base = scene_mgr->createEntity("stadiumstadionbase.mesh");
-        base->setMaterialName("stadiumstadion_concrete");
-        base->setCastShadows(true);
-        base_node->attachObject(base);
-        base_node->setScale(Ogre::Vector3(10.0f, 10.0f, 10.0f));
-        base_node->yaw(Ogre::Degree(90));
-        base_node->translate(0, 25.4f, -1.27f);
-
-        Ogre::SceneNode* grass_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* grass = scene_mgr->createEntity("stadiumgrass.mesh");
-        grass->setMaterialName("SoccerField");
-        grass->setCastShadows(false);
-        grass_node->attachObject(grass);
-        grass_node->setScale(Ogre::Vector3(10.0f, 10.0f, 10.0f));
-        grass_node->yaw(Ogre::Degree(90));
-        grass_node->translate(0, 0.0333151f, -1.27f);
-
-        Ogre::SceneNode* flag_node0 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::SceneNode* flag_pole_node0 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* flag0 = scene_mgr->createEntity("stadiumFlag_Cloth.mesh");
-        flag0->setMaterialName("soccerballMaterial__26");
-        Ogre::Entity* flag_pole0 = scene_mgr->createEntity("stadiumFlag_Pole.mesh");
-        flag_pole0->setMaterialName("soccerballMaterial__25");
-        Ogre::Entity* flag_ring0 = scene_mgr->createEntity("stadiumPole_Cloth.mesh");
-        flag_ring0->setMaterialName("stadiumMaterial__28");
-        flag_node0->attachObject(flag0);
-        flag_pole_node0->attachObject(flag_pole0);
-        flag_pole_node0->setScale(Ogre::Vector3(1.5f, 1.5f, 1.5f));
-        flag_pole_node0->translate(30.28, 0.0, -22.76);
-        flag_pole_node0->attachObject(flag_ring0);
-        flag_node0->setScale(Ogre::Vector3(1.5f, 1.5f, 1.5f));
-        flag_node0->pitch(Ogre::Degree(90));
-        flag_node0->translate(30.28, 3.2, -22.76);
-        flag_node0->roll(Ogre::Degree(69 - 90));
-        flag0_anim = flag0->getAnimationState("default_morph");
-        flag0_anim->setEnabled(true);
-        flag0_anim->setLoop(true);
-
-
-        Ogre::SceneNode* flag_node1 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::SceneNode* flag_pole_node1 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* flag1 = scene_mgr->createEntity("stadiumFlag_Cloth.mesh");
-        flag1->setMaterialName("soccerballMaterial__26");
-        Ogre::Entity* flag_pole1 = scene_mgr->createEntity("stadiumFlag_Pole.mesh");
-        flag_pole1->setMaterialName("soccerballMaterial__25");
-        Ogre::Entity* flag_ring1 = scene_mgr->createEntity("stadiumPole_Cloth.mesh");
-        flag_ring1->setMaterialName("stadiumMaterial__28");
-        flag_node1->attachObject(flag1);
-        flag_pole_node1->attachObject(flag_pole1);
-        flag_pole_node1->setScale(Ogre::Vector3(1.5f, 1.5f, 1.5f));
-        flag_pole_node1->translate(-30.28, 0.0, -22.76);
-        flag_pole_node1->attachObject(flag_ring1);
-        flag_node1->setScale(Ogre::Vector3(1.5f, 1.5f, 1.5f));
-        flag_node1->pitch(Ogre::Degree(90));
-        flag_node1->translate(-30.28, 3.2, -22.76);
-        flag_node1->roll(Ogre::Degree(69 - 90));
-        flag1_anim = flag1->getAnimationState("default_morph");
-        flag1_anim->setEnabled(true);
-        flag1_anim->setLoop(true);
-
-
-        Ogre::SceneNode* flag_node2 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::SceneNode* flag_pole_node2 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* flag2 = scene_mgr->createEntity("stadiumFlag_Cloth.mesh");
-        flag2->setMaterialName("soccerballMaterial__26");
-        Ogre::Entity* flag_pole2 = scene_mgr->createEntity("stadiumFlag_Pole.mesh");
-        flag_pole2->setMaterialName("soccerballMaterial__25");
-        Ogre::Entity* flag_ring2 = scene_mgr->createEntity("stadiumPole_Cloth.mesh");
-        flag_ring2->setMaterialName("stadiumMaterial__28");
-        flag_node2->attachObject(flag2);
-        flag_pole_node2->attachObject(flag_pole2);
-        flag_pole_node2->setScale(Ogre::Vector3(1.5f, 1.5f, 1.5f));
-        flag_pole_node2->translate(-30.28, 0.0, 20.26);
-        flag_pole_node2->attachObject(flag_ring2);
-        flag_node2->setScale(Ogre::Vector3(1.5f, 1.5f, 1.5f));
-        flag_node2->pitch(Ogre::Degree(90));
-        flag_node2->translate(-30.28, 3.2, 20.26);
-        flag_node2->roll(Ogre::Degree(69 - 90));
-        flag2_anim = flag2->getAnimationState("default_morph");
-        flag2_anim->setEnabled(true);
-        flag2_anim->setLoop(true);
-
-        Ogre::SceneNode* flag_node3 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::SceneNode* flag_pole_node3 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* flag3 = scene_mgr->createEntity("stadiumFlag_Cloth.mesh");
-        flag3->setMaterialName("soccerballMaterial__26");
-        Ogre::Entity* flag_pole3 = scene_mgr->createEntity("stadiumFlag_Pole.mesh");
-        flag_pole3->setMaterialName("soccerballMaterial__25");
-        Ogre::Entity* flag_ring3 = scene_mgr->createEntity("stadiumPole_Cloth.mesh");
-        flag_ring3->setMaterialName("stadiumMaterial__28");
-        flag_node3->attachObject(flag3);
-        flag_pole_node3->attachObject(flag_pole3);
-        flag_pole_node3->setScale(Ogre::Vector3(1.5f, 1.5f, 1.5f));
-        flag_pole_node3->translate(30.28, 0.0, 20.26);
-        flag_pole_node3->attachObject(flag_ring3);
-        flag_node3->setScale(Ogre::Vector3(1.5f, 1.5f, 1.5f));
-        flag_node3->pitch(Ogre::Degree(90));
-        flag_node3->translate(30.28, 3.2, 20.26);
-        flag_node3->roll(Ogre::Degree(69 - 90));
-        flag3_anim = flag3->getAnimationState("default_morph");
-        flag3_anim->setEnabled(true);
-        flag3_anim->setLoop(true);
- 
-        Ogre::SceneNode* chairs_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* chairs = scene_mgr->createEntity("stadiumchairs.mesh");
-        chairs->setMaterialName("stadiumchairs");
-        chairs->setCastShadows(false);
-        chairs_node->attachObject(chairs);
-        chairs_node->setScale(Ogre::Vector3(10.1f, 10.0f, 10.0f));
-        chairs_node->yaw(Ogre::Degree(76.5));
-        chairs_node->translate(-48.8449, 12.6779, 47.0319);
-
-        Ogre::SceneNode* lines_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* lines = scene_mgr->createEntity("stadiumsoccerlines.mesh");
-        lines->setMaterialName("stadiumwhite");
-        lines->setCastShadows(false);
-        lines_node->attachObject(lines);
-        lines_node->setScale(Ogre::Vector3(10.0f, 10.0f, 10.0f));
-        lines_node->yaw(Ogre::Degree(90));
-        lines_node->translate(0, 0.0357773, -1.27);
-
-        ball_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* ball = scene_mgr->createEntity("soccerballFootball.mesh");
-        ball->setMaterialName("SoccerBall");
-        ball_node->attachObject(ball);
-        ball_node->setScale(Ogre::Vector3(0.4, 0.4, 0.4));
-        ball_node->translate(22.0, 0.8, 0.0);
-        
-        Ogre::SceneNode* goal_a_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* goal_a = scene_mgr->createEntity("stadiumgoalnet01.mesh");
-        goal_a->setMaterialName("stadiumnet");
-        goal_a->setCastShadows(true);
-        goal_a_node->attachObject(goal_a);
-        Ogre::Entity* goal_posts = scene_mgr->createEntity("stadiumgoalframe01.mesh");
-        Ogre::SceneNode* posts_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        goal_posts->setMaterialName("stadiumwhite");
-        goal_posts->setCastShadows(true);
-        posts_node->attachObject(goal_posts);
-        posts_node->setScale(Ogre::Vector3(10.0, 10.0, 10.0));
-        posts_node->translate(30.5, 0.12, -7.9);
-        posts_node->roll(Ogre::Degree(90));
-        goal_a_node->setScale(Ogre::Vector3(10.0, 10.0, 10.0));
-        goal_a_node->yaw(Ogre::Degree(90));
-        goal_a_node->translate(32.75, 0.12, -1.18);
-        
-        Ogre::SceneNode* goal_b_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        Ogre::Entity* goal_b = scene_mgr->createEntity("GoalB", "stadiumgoalnet01.mesh");
-        goal_b->setMaterialName("stadiumnet");
-        goal_b->setCastShadows(true);
-        goal_b_node->attachObject(goal_b);
-        Ogre::Entity* goal_postsb = scene_mgr->createEntity("stadiumgoalframe01.mesh");
-        Ogre::SceneNode* posts_nodeb = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        goal_postsb->setMaterialName("stadiumwhite");
-        goal_postsb->setCastShadows(true);
-        posts_nodeb->attachObject(goal_postsb);
-        posts_nodeb->setScale(Ogre::Vector3(10.0, 10.0, 10.0));
-        posts_nodeb->translate(-30.5, 0.12, -7.9);
-        posts_nodeb->roll(Ogre::Degree(90));
-        goal_b_node->setScale(Ogre::Vector3(10.0, 10.0, 10.0));
-        goal_b_node->yaw(-Ogre::Degree(90));
-        goal_b_node->translate(-32.75, 0.12, -1.18);
-        
-        Ogre::Entity* logo = scene_mgr->createEntity(Ogre::SceneManager::PT_PLANE);
-        logo->setMaterialName("Logo");
-        logo->setCastShadows(false);
-        Ogre::SceneNode* logo_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        logo_node->setScale(Ogre::Vector3(0.0300, 0.008, 1.0f));
-        logo_node->yaw(Ogre::Degree(180));
-        logo_node->translate(16.0f, 1.0f, 21.9f);
-        logo_node->attachObject(logo);
-
-        Ogre::Entity* logo2 = scene_mgr->createEntity(Ogre::SceneManager::PT_PLANE);
-        logo2->setMaterialName("Logo");
-        logo2->setCastShadows(false);
-        Ogre::SceneNode* logo_node2 = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        logo_node2->setScale(Ogre::Vector3(0.0300, 0.0080, 1.0f));
-        logo_node2->yaw(Ogre::Degree(180));
-        logo_node2->translate(-16.0f, 1.0f, 21.9f);
-        logo_node2->attachObject(logo2);
-
-        igus = new_igus();
-
-        noise_tex0 = Ogre::TextureManager::getSingleton().createManual
-        (
-                "NoiseTex0", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, Ogre::TEX_TYPE_2D,
-                640, 480, 0, Ogre::PF_R8G8B8A8, Ogre::TU_RENDERTARGET
-        );
-
-         noise = new Ogre::Rectangle2D(true);
-         noise->setCorners(-1.0, 1.0, 1.0, -1.0);
-         noise->setBoundingBox(Ogre::AxisAlignedBox::BOX_INFINITE);
-         noise->setMaterial("NoiseGenerator");
-         noise->setCastShadows(false);
-         RenderNoise(noise_tex0);
-
-        // for (int i=0; i<NUM_NOISE_FRAMES; i++)
-        // {
-        //     Ogre::String name = Ogre::String("NoiseTex") + (char)(48+i);
-        //     noise_tex.push_back(Ogre::TextureManager::getSingleton().createManual
-        //     (
-        //         name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, Ogre::TEX_TYPE_2D,
-        //         640, 480, 0, Ogre::PF_R8G8B8A8, Ogre::TU_RENDERTARGET
-
-        //     ));
-        //     //RenderNoise(noise_tex[i]);
-        // }*/
-            
+        if (!run_scenarios || !scenarios.empty())
+            return false;
+
+        for (auto& world : worlds)
+        {
+            if (world->is_active() || !world->readback->empty())
+                return false;
+        }
+
+        return true;
     }
 
-    void CameraSimulator::initialise_ogre()
+    bool CameraSimulator::initialise_ogre()
     {
+        // Mesa reads these when the GL context is created, so they must be set before the render system starts
+
+        if (software_gl)
+        {
+            setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+            setenv("GALLIUM_DRIVER", "llvmpipe", 1);
+        }
+
         // Set up OGRE root!!
 
         ogre_root = new Ogre::Root("plugins.cfg");
- 
-        // Go through all sections & settings in the file
+        ogre_root->getWorkQueue()->setWorkerThreadCount(resource_threads);
+
+        // Declare everything in resources.cfg, nothing is parsed or loaded yet
+
+        resources.declare("resources.cfg");
+
+        if (ogre_root->restoreConfig() == 0)
+        {
+            std::cout << "Failure to load ogre.cfg\n";
+            return false;
+        }
+
+        if (headless)
+        {
+            // GL still needs a drawable to own its context, so make a tiny hidden one that is never
+            // rendered, swapped or pumped. Everything we keep goes through the offscreen textures.
+
+            ogre_root->initialise(false);
 
-        Ogre::ConfigFile cf;
-        cf.load("resources.cfg");
+            Ogre::NameValuePairList params;
+            params["hidden"] = "true";
+            params["vsync"] = "false";
 
-        Ogre::ConfigFile::SectionIterator seci = cf.getSectionIterator();
+            window = ogre_root->createRenderWindow("NUSimulator", 1, 1, false, &params);
+            window->setAutoUpdated(false);
+        }
+        else
+        {
+            window = ogre_root->initialise(true, "NUSimulator");
+        }
+
+        mark_startup_phase("root");
+
+        // the defaults apply when textures load, so set them before anything does. Textures are only loaded
+        // once, so the starting tier decides their mipmaps
+
+        const QualityTier& start_tier = quality_tiers[quality.tier()];
+        Ogre::TextureManager::getSingleton().setDefaultNumMipmaps(start_tier.mipmaps);
+        Ogre::MaterialManager::getSingleton().setDefaultTextureFiltering(texture_filter_options(start_tier.filtering));
+        Ogre::MaterialManager::getSingleton().setDefaultAnisotropy(start_tier.anisotropy);
+
+        resources.initialise(resource_groups);
+
+        // every world builds the same scene, which only needs parsing when the description has changed
+
+        try
+        {
+            scene = SceneCache::load(scene_description, scene_cache_path);
+            robot_model = std::make_unique<RobotModel>(RobotModel::load(robot_description));
+
+            if (ground_truth_enabled || dynamics_enabled)
+                field_features = std::make_unique<FieldFeatures>(FieldFeatures::load(field_description));
+
+            if (ground_truth_enabled)
+                ground_truth = std::make_unique<GroundTruthProjector>(*field_features, lens);
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << e.what() << "\n";
+            return false;
+        }
+        std::cout << "Scene " << (scene->from_cache() ? "loaded from " + scene_cache_path : "compiled from " + scene_description) << "\n";
+
+        // read the scene's meshes and textures in the background while we set up everything else
+
+        std::vector<std::string> skies = { World::SKY_MATERIAL };
+        skies.insert(skies.end(), generator.skies().begin(), generator.skies().end());
+        resources.prefetch(*scene, skies);
+        resources.prefetch(*robot_model);
+
+        ogre_root->addFrameListener(this);
+
+        workers = std::make_unique<WorkerPool>(conversion_threads);
+
+        image_pool = message::input::ImageBufferPool::create(image_pool_size * camera_configs.size() * world_count
+                                                           , lens.width() * lens.height() * 2);
+
+        if (!pyramid.levels().empty())
+        {
+            pyramid_pool = message::input::ImageBufferPool::create(image_pool_size * camera_configs.size() * world_count
+                                                                 , pyramid.size());
+        }
+
+        if (image_format != message::input::ImageFormat::YUYV)
+        {
+            native_pool = message::input::ImageBufferPool::create(image_pool_size * camera_configs.size() * world_count
+                                                                , message::input::image_size(image_format, lens.width(), lens.height()));
+        }
+
+        // the label scheme makes each material's label technique the first time it is drawn. Hardware instanced
+        // meshes need their instancing vertex program, which a flat fixed function pass doesn't have
 
-        Ogre::String sec_name, type_name, arch_name;
-        while (seci.hasMoreElements())
+        if (labels_enabled)
         {
-            sec_name = seci.peekNextKey();
-            Ogre::ConfigFile::SettingsMultiMap* settings = seci.getNext();
-            Ogre::ConfigFile::SettingsMultiMap::iterator i;
-            for (i = settings->begin(); i != settings->end(); ++i)
+            label_scheme = std::make_unique<LabelScheme>(label_classes);
+            Ogre::MaterialManager::getSingleton().addListener(label_scheme.get());
+
+            if (robot_instancing)
             {
-                type_name = i->first;
-                arch_name = i->second;
-                Ogre::ResourceGroupManager::getSingleton().addResourceLocation(arch_name, type_name, sec_name);
+                std::cout << "Robot instancing is off while rendering labels\n";
+                robot_instancing = false;
+            }
+        }
+
+        resources.wait();
+
+        mark_startup_phase("resources");
+
+        // every world is its own scene under the one root, the window shows the first
+
+        for (size_t i = 0; i < world_count; ++i)
+        {
+            worlds.push_back(std::make_unique<World>(first_world_id + i, ogre_root, *scene, *robot_model, robot_placements, robot_instancing, camera_configs, lens.render_width(), lens.render_height(), readback_buffers, labels_enabled ? label_scale : 0));
+
+            // with scenarios to run worlds only render while they have one
+            worlds.back()->free_running = !run_scenarios;
+        }
+        world_frames.assign(worlds.size(), 0);
+
+        apply_quality(start_tier);
+        std::cout << "Quality tier " << start_tier.name << "\n";
 
+        // each goal post is a cylinder from its base up to its top
+
+        if (dynamics_enabled)
+        {
+            dynamics_params.ball_radius = field_features->ball_radius;
+            dynamics_params.post_radius = field_features->post_radius;
+            dynamics_params.posts.clear();
+            for (const auto& point : field_features->points)
+            {
+                if (point.type == message::simulation::GroundTruth::FeatureType::GOAL_POST_TOP)
+                    dynamics_params.posts.push_back({ point.position[0], point.position[2], point.position[1] });
             }
+
+            dynamics = std::make_unique<DynamicsEngine>(dynamics_params, worlds.size(), robot_placements.size());
+            for (size_t i = 0; i < worlds.size(); ++i)
+                reset_dynamics(i);
         }
 
-        if (ogre_root->restoreConfig() == 0)
+        if (!headless)
         {
-            std::cout << "Failure to load ogre.cfg\n";
-            return;
+            Ogre::Viewport* vp = window->addViewport(worlds.front()->camera);
+            vp->setBackgroundColour(Ogre::ColourValue(0,0,0));
         }
-       
-        // Setup the hidden window
 
-        window = ogre_root->initialise(true, "NUSimulator");
-       // window->setHidden(true);
-        //Ogre::WindowEventUtilities::messagePump(); // force hiding the window
+        mark_startup_phase("scene");
 
-        Ogre::ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
+        // start the clock last so setup time isn't counted as the first step
 
-        Ogre::TextureManager::getSingleton().setDefaultNumMipmaps(5);
-        Ogre::MaterialManager::getSingleton().setDefaultTextureFiltering(Ogre::TFO_ANISOTROPIC);
-        Ogre::MaterialManager::getSingleton().setDefaultAnisotropy(8);
- 
-        // Setup lights/cameras
- 
-        scene_mgr = ogre_root->createSceneManager(Ogre::ST_GENERIC);
+        clock.reset(clock_mode, clock_step);
+        scheduler.reset(scheduler_rate, scheduler_policy, scheduler_max_catch_up);
+        render_time = std::chrono::steady_clock::duration::zero();
+        readback_time = std::chrono::steady_clock::duration::zero();
 
-        scene_mgr->setShadowTechnique(Ogre::SHADOWTYPE_STENCIL_ADDITIVE);
-        scene_mgr->setAmbientLight(Ogre::ColourValue(0.5f, 0.5f, 0.5f));
+        return true;
+    }
 
-        camera = scene_mgr->createCamera("PlayerCam");
+    void CameraSimulator::mark_startup_phase(const std::string& phase)
+    {
+        auto now = std::chrono::steady_clock::now();
+        startup_phases.emplace_back(phase, now - startup_mark);
+        startup_mark = now;
+    }
 
-        camera->setNearClipDistance(5);
-        camera->setAspectRatio((double)TEX_WIDTH/(double)TEX_HEIGHT);
+    void CameraSimulator::report_startup()
+    {
+        std::chrono::duration<double, std::milli> total(0);
 
-        scene_mgr->setAmbientLight(Ogre::ColourValue(0.5, 0.5, 0.5));
+        std::cout << "Startup:";
+        for (const auto& phase : startup_phases)
+        {
+            std::chrono::duration<double, std::milli> ms = phase.second;
+            std::cout << " " << phase.first << " " << ms.count() << " ms,";
+            total += ms;
+        }
+        std::cout << " total " << total.count() << " ms (" << resources.queued() << " resources prefetched)\n";
+    }
+
+    size_t CameraSimulator::emit_images(const std::vector<std::pair<World*, RenderTextureRing::Frame>>& frames)
+    {
+        // lock every ready atlas up front, the tiles are then converted in parallel and the buffers unlocked
 
-        scene_mgr->setSkyDome(true, "Examples/CloudySky", 5, 8);
+        struct Task {
+            PixelSource source;
+            World* world;
+            size_t camera;
+            NUClear::clock::time_point timestamp;
+            float noise_level;
+        };
 
-        Ogre::Light* light0 = scene_mgr->createLight();
-        light0->setPosition(20, 80, 50);
-        light0->setDiffuseColour(1.0, 1.0, 1.0);
- 
-        float pitch = -0.18f;
-        float yaw = 1.8f;
+        std::vector<Ogre::HardwarePixelBufferSharedPtr> locked;
+        std::vector<Task> tasks;
 
-        float x = -20.0f;
-        float y = 8.0f;
-        float z = -5.0f;
-        
-        camera->setPosition(x, y, z);
-        camera->setDirection(sin(yaw) * cos(pitch), sin(pitch), -cos(yaw) * cos(pitch));   
- 
-        Ogre::Viewport* vp = window->addViewport(camera);
-        vp->setBackgroundColour(Ogre::ColourValue(0,0,0));
- 
-        ogre_root->addFrameListener(this);
+        {
+            PROFILE_STAGE(profiler, ProfileStage::READBACK);
+
+            for (const auto& frame : frames)
+            {
+                // frames rendered without a noise level of their own get the configured noise
+                float noise_level = 1.0f;
+                auto level = noise_levels.find(std::make_pair(frame.first->id, frame.second.timestamp));
+                if (level != noise_levels.end())
+                {
+                    noise_level = level->second;
+                    noise_levels.erase(level);
+                }
+
+                Ogre::HardwarePixelBufferSharedPtr ptr = frame.second.texture->getBuffer(0,0);
+
+                PixelLayout layout;
+                if (!layout_for_format(ptr->getFormat(), layout))
+                {
+                    std::cout << "BAD IMAGE FORMAT " << Ogre::PixelUtil::getFormatName(ptr->getFormat()) << "\n";
+
+                    // none of this frame's images will reach the recorder, so it won't clean up after them
+                    if (recorder)
+                    {
+                        std::lock_guard<std::mutex> lock(recorder_mutex);
+                        rendered_states.erase(std::make_pair(frame.first->id, frame.second.timestamp));
+                    }
+                    continue;
+                }
+
+                ptr->lock(Ogre::HardwareBuffer::HBL_READ_ONLY);
+                locked.push_back(ptr);
+                const Ogre::PixelBox& pixel_box = ptr->getCurrentLock();
+
+                // rowPitch is in pixels, the converter wants bytes
+                const size_t pixel_bytes = Ogre::PixelUtil::getNumElemBytes(pixel_box.format);
+                const size_t stride = pixel_box.rowPitch * pixel_bytes;
+
+                World* world = frame.first;
+                for (size_t i = 0; i < world->cameras.size(); ++i)
+                {
+                    const RenderTextureRing::Tile& tile = world->readback->tiles()[i];
+
+                    Task task;
+                    task.source.data = static_cast<const uint8_t*>(pixel_box.data) + tile.y * stride + tile.x * pixel_bytes;
+                    task.source.width = lens.render_width();
+                    task.source.height = lens.render_height();
+                    task.source.stride = stride;
+                    task.source.layout = layout;
+                    task.world = world;
+                    task.camera = i;
+                    task.timestamp = frame.second.timestamp;
+                    task.noise_level = noise_level;
+                    tasks.push_back(task);
+                }
+            }
+        }
+
+        // every tile gets its buffer up front so the strips of a tile can be converted and noised in parallel.
+        // The noise is keyed on the frame's timestamp and source rather than on whichever thread gets the strip.
+        // Strips start on rows the pyramid can be built from without reading the strip above
+
+        const unsigned int width = lens.width();
+        const unsigned int height = lens.height();
+        const unsigned int strip_rows = (STRIP_ROWS + pyramid.row_alignment() - 1) / pyramid.row_alignment() * pyramid.row_alignment();
+        const size_t strips = (height + strip_rows - 1) / strip_rows;
+
+        std::vector<message::input::ImageBuffer> buffers;
+        buffers.reserve(tasks.size());
+        for (size_t i = 0; i < tasks.size(); ++i)
+            buffers.push_back(image_pool->acquire());
+
+        std::vector<message::input::ImageBuffer> pyramids;
+        if (pyramid_pool)
+        {
+            pyramids.reserve(tasks.size());
+            for (size_t i = 0; i < tasks.size(); ++i)
+                pyramids.push_back(pyramid_pool->acquire());
+        }
 
+        {
+            PROFILE_STAGE(profiler, ProfileStage::CONVERT);
+
+            workers->run(tasks.size() * strips, [&] (size_t i) {
+                const Task& task = tasks[i / strips];
+                uint8_t* data = buffers[i / strips].bytes().data();
+
+                unsigned int first_row = (i % strips) * strip_rows;
+                unsigned int last_row = std::min(first_row + strip_rows, height);
+
+                if (lens.remaps())
+                {
+                    // gather each distorted row from the render then convert it while it is still in cache
+                    thread_local std::vector<uint8_t> remapped;
+                    remapped.resize(width * 4);
+
+                    PixelSource row_source;
+                    row_source.data = remapped.data();
+                    row_source.width = width;
+                    row_source.height = 1;
+                    row_source.stride = width * 4;
+                    row_source.layout = LensModel::remapped_layout(task.source.layout);
+
+                    for (unsigned int row = first_row; row < last_row; ++row)
+                    {
+                        lens.remap_row(task.source, row, remapped.data());
+                        yuyv_converter.convert_rows(row_source, data + size_t(row) * width * 2, 0, 1);
+                    }
+                }
+                else
+                {
+                    yuyv_converter.convert_rows(task.source, data, first_row, last_row);
+                }
+
+                sensor_noise.apply_rows(data, width, task.timestamp.time_since_epoch().count(),
+                                        (uint64_t(task.world->id) << 32) | task.world->camera_configs[task.camera].id,
+                                        first_row, last_row, task.noise_level);
+
+                // the strip is still in cache, so its pyramid rows cost little more than the reads
+                if (pyramid_pool)
+                    pyramid.build_rows(data, pyramids[i / strips].bytes().data(), first_row, last_row);
+            });
+        }
 
-        initialise_scene();
+        for (auto& ptr : locked)
+            ptr->unlock();
+
+        // emit in the camera's own format so subscribers don't each convert, the YUYV buffers then go straight back
+
+        if (image_format != message::input::ImageFormat::YUYV)
+        {
+            PROFILE_STAGE(profiler, ProfileStage::FORMAT_CONVERT);
 
-        // setup render to texture
+            std::vector<message::input::ImageBuffer> native;
+            native.reserve(tasks.size());
+            for (size_t i = 0; i < tasks.size(); ++i)
+                native.push_back(native_pool->acquire());
 
-        rtt_tex = Ogre::TextureManager::getSingleton().createManual("RttTex", 
-                Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,  Ogre::TEX_TYPE_2D, 
-                TEX_WIDTH, TEX_HEIGHT, 1,  Ogre::PF_R8G8B8, Ogre::TU_RENDERTARGET);
+            workers->run(tasks.size(), [&] (size_t i) {
+                message::input::convert_image(message::input::ImageFormat::YUYV, buffers[i].bytes().data()
+                                            , image_format, native[i].bytes().data(), width, height);
+            });
 
-//        render_target = rtt_tex->getBuffer()->getRenderTarget();
- 
- //       render_target->addViewport(camera);
- //       render_target->getViewport(0)->setClearEveryFrame(true);
- //       render_target->getViewport(0)->setBackgroundColour(Ogre::ColourValue::Black);
- //       render_target->getViewport(0)->setOverlaysEnabled(false);
-        window->addListener(this);
+            buffers = std::move(native);
+        }
+
+        // the buffers go back to the pool when the last subscriber drops the image
+
+        PROFILE_STAGE(profiler, ProfileStage::EMIT);
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            auto image = std::make_unique<message::input::Image>(width, height, tasks[i].timestamp, std::move(buffers[i]), image_format);
+            image->camera_id = tasks[i].world->camera_configs[tasks[i].camera].id;
+            image->world_id = tasks[i].world->id;
+            image->sequence = image_sequence++;
+
+            // the pyramid follows its image, matched by sequence
+            std::unique_ptr<message::input::ImagePyramid> levels;
+            if (pyramid_pool)
+            {
+                levels = std::make_unique<message::input::ImagePyramid>();
+                levels->timestamp = image->timestamp;
+                levels->camera_id = image->camera_id;
+                levels->world_id = image->world_id;
+                levels->sequence = image->sequence;
+                levels->levels = pyramid.levels();
+                levels->data = std::move(pyramids[i]);
+            }
 
-        image_yuyv.resize(TEX_WIDTH * TEX_HEIGHT * 2);
-        last_time = std::chrono::steady_clock::now();
-        time_tally = 0;
+            // a world process's images are sent on from here, so a channel that fills holds the next frame back
+            if (world_channel && !world_channel->send(*image))
+                parent_gone = true;
 
-        cur_noise_index = 0;
+            emit(std::move(image));
+            if (levels)
+                emit(std::move(levels));
+        }
 
-        noise_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
-        screen_noise = new Ogre::Rectangle2D(true);
-        screen_noise->setCorners(-0.0, 0.0, 1.0, -1.0);
-        screen_noise->setBoundingBox(Ogre::AxisAlignedBox::BOX_INFINITE);
-        screen_noise->setCastShadows(false);
-        screen_noise->setMaterial("NoiseMaterial");
-        screen_noise->setRenderQueueGroup(Ogre::RENDER_QUEUE_OVERLAY);
-        screen_noise->setVisible(true);
-        noise_node->attachObject(screen_noise);
+        return tasks.size();
     }
 
+    void CameraSimulator::emit_labels(const std::vector<std::pair<World*, RenderTextureRing::Frame>>& frames)
+    {
+        PROFILE_STAGE(profiler, ProfileStage::LABELS);
+
+        const unsigned int width = lens.width() / label_scale;
+        const unsigned int height = lens.height() / label_scale;
+
+        for (const auto& frame : frames)
+        {
+            Ogre::HardwarePixelBufferSharedPtr ptr = frame.second.texture->getBuffer(0,0);
+
+            PixelLayout layout;
+            if (!layout_for_format(ptr->getFormat(), layout))
+            {
+                std::cout << "BAD LABEL FORMAT " << Ogre::PixelUtil::getFormatName(ptr->getFormat()) << "\n";
+                continue;
+            }
+
+            ptr->lock(Ogre::HardwareBuffer::HBL_READ_ONLY);
+            const Ogre::PixelBox& pixel_box = ptr->getCurrentLock();
+            const size_t pixel_bytes = Ogre::PixelUtil::getNumElemBytes(pixel_box.format);
+            const size_t stride = pixel_box.rowPitch * pixel_bytes;
+
+            // every channel holds the class id, so each pixel's first byte is enough
+            World* world = frame.first;
+            std::vector<std::unique_ptr<message::simulation::LabelImage>> images(world->cameras.size());
+
+            workers->run(images.size(), [&] (size_t i) {
+                const RenderTextureRing::Tile& tile = world->labels->tiles()[i];
+
+                PixelSource source;
+                source.data = static_cast<const uint8_t*>(pixel_box.data) + tile.y * stride + tile.x * pixel_bytes;
+                source.width = lens.render_width() / label_scale;
+                source.height = lens.render_height() / label_scale;
+                source.stride = stride;
+                source.layout = layout;
+
+                auto labels = std::make_unique<message::simulation::LabelImage>();
+                labels->width = width;
+                labels->height = height;
+                labels->scale = label_scale;
+                labels->timestamp = frame.second.timestamp;
+                labels->camera_id = world->camera_configs[i].id;
+                labels->world_id = world->id;
+                labels->labels.resize(size_t(width) * height);
 
-    void CameraSimulator::preRenderTargetUpdate(const Ogre::RenderTargetEvent& rte)
+                for (unsigned int row = 0; row < height; ++row)
+                    lens.sample_row_nearest(source, row, label_scale, labels->labels.data() + size_t(row) * width);
+
+                images[i] = std::move(labels);
+            });
+
+            ptr->unlock();
+
+            for (auto& labels : images)
+            {
+                if (world_channel && !world_channel->send(*labels))
+                    parent_gone = true;
+                emit(std::move(labels));
+            }
+        }
+    }
+
+    void CameraSimulator::emit_ground_truth(const World& world, NUClear::clock::time_point timestamp)
     {
-        RenderNoise(noise_tex0);
-        screen_noise->setVisible(true);
+        PROFILE_STAGE(profiler, ProfileStage::GROUND_TRUTH);
+
+        // rendering has just updated the scene graph, so the cameras and robot bounds are those of this frame
 
-      //  screen_mb->setVisible(true);
+        std::vector<ProxyBox> robot_boxes(world.robots->size());
+        for (size_t i = 0; i < robot_boxes.size(); ++i)
+        {
+            Ogre::AxisAlignedBox box = world.robots->bounds(i);
+            for (int j = 0; j < 3; ++j)
+            {
+                robot_boxes[i].min[j] = box.getMinimum()[j];
+                robot_boxes[i].max[j] = box.getMaximum()[j];
+            }
+        }
+
+        const float ball[3] = { world.state.ball_pos.x, world.state.ball_pos.y, world.state.ball_pos.z };
+
+        for (size_t i = 0; i < world.cameras.size(); ++i)
+        {
+            const Ogre::Matrix4& view_matrix = world.cameras[i]->getViewMatrix();
+            const Ogre::Matrix4& projection_matrix = world.cameras[i]->getProjectionMatrix();
+
+            float view[16];
+            float projection[16];
+            for (int row = 0; row < 4; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    view[row * 4 + column] = view_matrix[row][column];
+                    projection[row * 4 + column] = projection_matrix[row][column];
+                }
+            }
+
+            auto truth = std::make_unique<message::simulation::GroundTruth>();
+            truth->timestamp = timestamp;
+            truth->camera_id = world.camera_configs[i].id;
+            truth->world_id = world.id;
+            ground_truth->project(view, projection, ball, robot_boxes, *truth);
+            if (world_channel && !world_channel->send(*truth))
+                parent_gone = true;
+            emit(std::move(truth));
+        }
     }
 
-    void CameraSimulator::postRenderTargetUpdate(const Ogre::RenderTargetEvent& rte)
+    void CameraSimulator::apply_quality(const QualityTier& tier)
     {
-    //    screen_mb->setVisible(false);
-        screen_noise->setVisible(false);
+        resources.set_texture_filtering(texture_filter_options(tier.filtering), tier.anisotropy);
+
+        for (auto& world : worlds)
+            world->set_quality(tier);
     }
 
-    void CameraSimulator::tex_to_yuyv()
+    void CameraSimulator::reset_dynamics(size_t world)
     {
-        Ogre::HardwarePixelBufferSharedPtr ptr = rtt_tex->getBuffer(0,0);
-        if (ptr->getFormat() != Ogre::PixelFormat::PF_X8R8G8B8)
+        // a new scenario starts with the robots where it puts them, or back where they were placed
+
+        const WorldState& state = worlds[world]->state;
+        const float position[3] = { state.ball_pos.x, state.ball_pos.y, state.ball_pos.z };
+        const float velocity[3] = { state.ball_velocity.x, state.ball_velocity.y, state.ball_velocity.z };
+
+        std::vector<float> robots;
+        for (const auto& placement : state.robot_placements.empty() ? robot_placements : state.robot_placements)
         {
-            std::cout << "BAD IMAGE FORMAT\n";
-            abort();
+            robots.push_back(placement.position.x);
+            robots.push_back(placement.position.z);
         }
-        ptr->lock(Ogre::HardwareBuffer::HBL_READ_ONLY);
-        const Ogre::PixelBox& pixel_box = ptr->getCurrentLock();
-        unsigned char* bitmap = static_cast<unsigned char*>(pixel_box.data);
 
-        for (int i=0; i<TEX_WIDTH * TEX_HEIGHT * 4; i += 8)
+        dynamics->reset(world, position, velocity, robots.data());
+    }
+
+    void CameraSimulator::step_dynamics(std::chrono::duration<double> time_span)
+    {
         {
-            double blue1 = (double) bitmap[i];
-            double green1 = (double) bitmap[i + 1];
-            double red1 = (double) bitmap[i + 2];
+            std::lock_guard<std::mutex> lock(dynamics_mutex);
 
-            double blue2 = (double) bitmap[i + 4];
-            double green2 = (double)bitmap[i + 5];
-            double red2 =  (double)bitmap[i + 6];
+            for (const auto& kick : pending_kicks)
+            {
+                if (kick.world_id < worlds.size())
+                    dynamics->kick(kick.world_id, kick.velocity);
+            }
+            for (const auto& velocity : pending_velocities)
+            {
+                if (velocity.world_id < worlds.size() && velocity.robot < dynamics->robots_per_instance())
+                    dynamics->set_robot_velocity(velocity.world_id, velocity.robot, velocity.velocity[0], velocity.velocity[1]);
+            }
+
+            pending_kicks.clear();
+            pending_velocities.clear();
+        }
 
-            double y1 = 0.299 * red1 + 0.587 * green1 + 0.114 * blue1;
-            double y2 = 0.299 * red2 + 0.587 * green2 + 0.114 * blue2;
+        dynamics->step(*workers, dynamics->accumulate(time_span));
 
-            double u1 = (0.492 * (blue1 - y1) + 0.436) / 2.0;
-            double u2 = (0.492 * (blue2 - y2) + 0.436) / 2.0;
-            double v1 = (0.877 * (red1 - y1) + 0.615) / 2.0;
-            double v2 = (0.877 * (red2 - y2) + 0.615) / 2.0;
-            
-            int j = i / 2;
-            image_yuyv[j] = double_to_color(y1); 
-            image_yuyv[j + 1] = double_to_color((u1 + u2) / 2.0);
-            image_yuyv[j + 2] = double_to_color(y2);
-            image_yuyv[j + 3] = double_to_color((v1 + v2) / 2.0);
+        for (size_t i = 0; i < worlds.size(); ++i)
+        {
+            if (!worlds[i]->is_active())
+                continue;
+
+            float ball[3];
+            dynamics->ball_position(i, ball);
+            worlds[i]->move_ball(Ogre::Vector3(ball[0], ball[1], ball[2]), dynamics_params.ball_radius);
+
+            for (size_t j = 0; j < dynamics->robots_per_instance(); ++j)
+            {
+                float x;
+                float z;
+                dynamics->robot_position(i, j, x, z);
+                worlds[i]->move_robot(j, x, z);
+            }
         }
-        ptr->unlock();
+    }
+
+    WorldState CameraSimulator::state_from_scene(const SampledScene& scene) const
+    {
+        WorldState state;
+        state.camera_pos = Ogre::Vector3(scene.camera_position[0], scene.camera_position[1], scene.camera_position[2]);
+        state.camera_pitch = scene.camera_pitch;
+        state.camera_yaw = scene.camera_yaw;
+        state.ball_pos = Ogre::Vector3(scene.ball_position[0], scene.ball_position[1], scene.ball_position[2]);
+        state.last_ball_pos = state.ball_pos;
+        state.ball_velocity = Ogre::Vector3(scene.ball_velocity[0], scene.ball_velocity[1], scene.ball_velocity[2]);
+        state.light_colour = Ogre::ColourValue(scene.light_colour[0], scene.light_colour[1], scene.light_colour[2]);
+        state.ambient_light = Ogre::ColourValue(scene.ambient, scene.ambient, scene.ambient);
+        if (scene.sky < generator.skies().size())
+            state.sky = generator.skies()[scene.sky];
+        for (size_t i = 0; i + 3 < scene.robots.size(); i += 4)
+        {
+            state.robot_placements.push_back({ Ogre::Vector3(scene.robots[i], scene.robots[i + 1], scene.robots[i + 2])
+                                             , Ogre::Degree(scene.robots[i + 3]) });
+        }
+        state.noise_level = scene.noise_level;
+        return state;
+    }
+
+    SampledScene CameraSimulator::scene_from_state(const WorldState& state) const
+    {
+        // the manifest lists where things are when the frame is rendered, after the dynamics have moved them
+
+        SampledScene scene;
+        for (int i = 0; i < 3; ++i)
+        {
+            scene.camera_position[i] = state.camera_pos[i];
+            scene.light_colour[i] = state.light_colour[i];
+            scene.ball_position[i] = state.ball_pos[i];
+            scene.ball_velocity[i] = state.ball_velocity[i];
+        }
+        scene.camera_pitch = state.camera_pitch;
+        scene.camera_yaw = state.camera_yaw;
+        scene.ambient = state.ambient_light.r;
+        auto sky = std::find(generator.skies().begin(), generator.skies().end(), state.sky);
+        scene.sky = sky - generator.skies().begin();
+        for (const auto& placement : state.robot_placements)
+        {
+            scene.robots.insert(scene.robots.end(), { placement.position.x, placement.position.y, placement.position.z
+                                                    , placement.yaw.valueDegrees() });
+        }
+        scene.noise_level = state.noise_level;
+        return scene;
+    }
+
+    void CameraSimulator::record_image(const message::input::Image& image)
+    {
+        // the image is written straight from its shared buffer, the lock keeps frames whole and in one index
+        std::lock_guard<std::mutex> lock(recorder_mutex);
+
+        utility::simulation::FrameLogRecord record = {};
+        record.format = uint32_t(image.format);
+        record.width = image.width;
+        record.height = image.height;
+        record.world_id = image.world_id;
+        record.camera_id = image.camera_id;
+        record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(image.timestamp.time_since_epoch()).count();
+
+        auto rendered = rendered_states.find(std::make_pair(image.world_id, image.timestamp));
+        if (rendered != rendered_states.end())
+        {
+            // only the first camera follows the world's state, the others stay where they were configured.
+            // This runs on a subscriber thread, so everything comes from the copy taken at render time
+            const WorldState& state = rendered->second.state;
+            const std::vector<CameraConfig>& configs = rendered->second.camera_configs;
+
+            Ogre::Vector3 position = state.camera_pos;
+            Ogre::Real pitch = state.camera_pitch;
+            Ogre::Real yaw = state.camera_yaw;
+            for (size_t i = 1; i < configs.size(); ++i)
+            {
+                if (configs[i].id == image.camera_id)
+                {
+                    position = configs[i].position;
+                    pitch = configs[i].pitch;
+                    yaw = configs[i].yaw;
+                }
+            }
+
+            for (int i = 0; i < 3; ++i)
+            {
+                record.pose.camera_position[i] = position[i];
+                record.pose.ball_position[i] = state.ball_pos[i];
+            }
+            record.pose.camera_pitch = pitch;
+            record.pose.camera_yaw = yaw;
+
+            if (--rendered->second.images_left == 0)
+                rendered_states.erase(rendered);
+        }
+
+        recorder->append(record, image.pixels(), message::input::image_size(image.format, image.width, image.height));
     }
 }
 }
-
@@ -22,7 +22,13 @@
 
 #include <nuclear>
 #include <vector>
+#include <atomic>
 #include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include <Overlay/OgreOverlay.h>
 #include <OgreEntity.h>
@@ -42,77 +48,215 @@
 #include <OgreHardwarePixelBuffer.h>
 #include <OgreRenderTargetListener.h>
 
+#include "message/input/Image.h"
+#include "message/input/ImageBufferPool.h"
+#include "message/input/ImageFormat.h"
+#include "message/input/ImagePyramid.h"
+#include "message/simulation/KickBall.h"
+#include "message/simulation/RobotVelocity.h"
+#include "utility/simulation/FrameLog.h"
+
+#include "DatasetWriter.h"
+#include "DynamicsEngine.h"
+#include "FrameScheduler.h"
+#include "GroundTruthProjector.h"
+#include "LabelScheme.h"
+#include "LensModel.h"
+#include "Profiler.h"
+#include "PyramidBuilder.h"
+#include "RenderQuality.h"
+#include "RenderTextureRing.h"
+#include "ResourceLoader.h"
+#include "RobotModel.h"
+#include "ScenarioGenerator.h"
+#include "SensorNoise.h"
+#include "SimulationClock.h"
+#include "WorkerPool.h"
+#include "World.h"
+#include "WorldChannel.h"
+#include "WorldProcesses.h"
+#include "YUYVConverter.h"
+
 namespace module {
 namespace simulation {
 
-	class WorldState {
-
-	public:
+    class CameraSimulator : public NUClear::Reactor, Ogre::FrameListener {
 
-		Ogre::Vector3 camera_pos;
-		Ogre::Real camera_pitch;
-		Ogre::Real camera_yaw;
+    	Ogre::Root* ogre_root;
+    	std::vector<CameraConfig> camera_configs;
+    	Ogre::RenderWindow* window;
+		size_t readback_buffers;
 
-		Ogre::Vector3 ball_pos;
-		Ogre::Vector3 last_ball_pos;
-	};
+		ResourceLoader resources;
+		std::vector<std::string> resource_groups;
+		unsigned int resource_threads;
 
-	class IGus
-	{
+		// each startup phase is timed from the end of the previous one and reported after the first frame
+		std::chrono::steady_clock::time_point startup_mark;
+		std::vector<std::pair<std::string, std::chrono::steady_clock::duration>> startup_phases;
 
-	public:
+		std::string scene_description;
+		std::string scene_cache_path;
+		std::unique_ptr<SceneCache> scene;
 
-		Ogre::SceneNode* root_node;
-	};
+		std::string robot_description;
+		std::unique_ptr<RobotModel> robot_model;
+		std::vector<RobotPlacement> robot_placements;
+		bool robot_instancing;
 
-    class CameraSimulator : public NUClear::Reactor, Ogre::FrameListener, Ogre::RenderTargetListener {
+		std::vector<std::unique_ptr<World>> worlds;
+		size_t world_count;
+		std::deque<ScenarioJob> scenarios;
+		bool run_scenarios;
 
-    	Ogre::Root* ogre_root;
-    	Ogre::Camera* camera;
-    	Ogre::SceneManager* scene_mgr;
-    	Ogre::RenderWindow* window;
-    	Ogre::RenderTexture* render_target;
-		Ogre::TexturePtr rtt_tex;
+		std::unique_ptr<WorkerPool> workers;
+		unsigned int conversion_threads;
 
 		bool is_initialised;
+		bool is_running;
+		bool headless;
+		bool software_gl;
 
-		std::chrono::steady_clock::time_point last_time;
-		double time_tally;
+		SimulationClock clock;
+		ClockMode clock_mode;
+		std::chrono::duration<double> clock_step;
 
-		IGus igus;
+		FrameScheduler scheduler;
+		double scheduler_rate;
+		LatePolicy scheduler_policy;
+		unsigned int scheduler_max_catch_up;
+		std::chrono::duration<double> scheduler_report_interval;
 
-		Ogre::AnimationState* flag0_anim;		
-		Ogre::AnimationState* flag1_anim;
-		Ogre::AnimationState* flag2_anim;
-		Ogre::AnimationState* flag3_anim;
+		// time the render thread spent rendering and reading back since the last report
+		std::chrono::steady_clock::duration render_time;
+		std::chrono::steady_clock::duration readback_time;
+		std::vector<uint64_t> world_frames;
 
-		Ogre::SceneNode* ball_node;
-    	Ogre::GpuProgramParametersSharedPtr params;
+		// per stage latencies, reported and emitted with the scheduler's report
+		Profiler profiler;
 
-		Ogre::SceneNode* noise_node;
-		std::vector<Ogre::TexturePtr> noise_tex;
-		Ogre::Rectangle2D* noise;
-		Ogre::Rectangle2D* screen_noise;
-    	int cur_noise_index;
-		Ogre::TexturePtr noise_tex0;
-		std::vector<uint8_t> image_yuyv;
+		// the quality tiers, cheapest first, and which one is rendered. With a target rate the controller
+		// moves between them by the time the render thread spends on each frame
+		std::vector<QualityTier> quality_tiers;
+		QualityController quality;
 
-   	private:
+		LensModel lens;
+		YUYVConverter yuyv_converter;
+		SensorNoise sensor_noise;
+		std::shared_ptr<message::input::ImageBufferPool> image_pool;
+		size_t image_pool_size;
+		// what the images are emitted as, and the pool for them when that isn't the YUYV we convert into
+		message::input::ImageFormat image_format;
+		std::shared_ptr<message::input::ImageBufferPool> native_pool;
+		// the lower resolution levels emitted with every image, built strip by strip as it is converted. No
+		// pool when there are no levels
+		PyramidBuilder pyramid;
+		std::shared_ptr<message::input::ImageBufferPool> pyramid_pool;
+
+		// when recording, every emitted image is appended to the log with the state of the world it was
+		// rendered from. Frames are read back a few frames after they render, so the state and cameras are
+		// kept from then, and the recorder never has to look at the worlds themselves
+		struct RenderedState {
+			WorldState state;
+			std::vector<CameraConfig> camera_configs;
+			size_t images_left;
+		};
+		std::string record_path;
+		std::unique_ptr<utility::simulation::FrameLogWriter> recorder;
+		std::map<std::pair<unsigned int, NUClear::clock::time_point>, RenderedState> rendered_states;
+		std::mutex recorder_mutex;
+
+		// the optional label pass, rendered every label_every frames at 1 / label_scale of the image resolution
+		bool labels_enabled;
+		unsigned int label_every;
+		unsigned int label_scale;
+		std::map<std::string, uint8_t> label_classes;
+		std::unique_ptr<LabelScheme> label_scheme;
+		uint64_t label_frame;
 
-   		void initialise_scene();
-   		void initialise_ogre();
-   		void calculate_world(std::chrono::duration<double> time_span);
-   		void tex_to_yuyv();
-   		IGus new_igus();
+		// where the goal posts and markings are, for the ground truth and dynamics
+		std::string field_description;
+		std::unique_ptr<FieldFeatures> field_features;
+
+		// the ground truth of every rendered camera, projected from the field features and the world's state
+		bool ground_truth_enabled;
+		std::unique_ptr<GroundTruthProjector> ground_truth;
+
+		// moves every world's ball and robots, one instance per world. Kicks and robot velocities arrive on
+		// other threads and are applied at the start of the next step
+		bool dynamics_enabled;
+		DynamicsParameters dynamics_params;
+		std::unique_ptr<DynamicsEngine> dynamics;
+		std::mutex dynamics_mutex;
+		std::vector<message::simulation::KickBall> pending_kicks;
+		std::vector<message::simulation::RobotVelocity> pending_velocities;
+
+		// randomised episodes are handed to idle worlds like scenarios once those run out, and every frame
+		// they render is listed in the manifest beside the dataset. Each frame's noise level is kept until
+		// it is read back
+		ScenarioGenerator generator;
+		uint64_t next_episode;
+		std::ofstream manifest;
+		uint64_t generated_frames;
+		std::chrono::steady_clock::time_point generation_start;
+		std::map<std::pair<unsigned int, NUClear::clock::time_point>, float> noise_levels;
+
+		// when writing a dataset every emitted image is also encoded to a file, off the render thread
+		std::unique_ptr<DatasetWriter> dataset;
+		DatasetOptions dataset_options;
+		uint64_t image_sequence;
+
+		// where the configuration was read from, config/CameraSimulator.yaml unless WorldProcesses::CONFIG_VARIABLE says
+		std::string config_path;
+
+		// with world_processes every world runs in a simulator process of its own, which renders on its own GL
+		// context, and this one only starts them and merges what they send into its own stream, dataset and
+		// manifest. Images are numbered as they arrive, counted per world for the report
+		bool world_processes_enabled;
+		std::vector<std::string> world_process_command;
+		std::unique_ptr<WorldProcesses> world_processes;
+		std::vector<std::thread> world_readers;
+		std::mutex merge_mutex;
+		std::vector<uint64_t> world_images;
+		size_t worlds_running;
+		std::chrono::steady_clock::time_point merge_report_time;
+
+		// in a world process, its one world's id, its share of the episodes (every episode_stride'th from that
+		// id) and the channel everything it renders is sent up and kicks and velocities come down
+		unsigned int first_world_id;
+		uint64_t episode_stride;
+		uint64_t generated_episodes;
+		std::unique_ptr<WorldChannel> world_channel;
+		std::thread world_channel_reader;
+		std::atomic<bool> parent_gone;
+
+   	private:
 
+   		void load_config();
+   		void report_dataset(double seconds);
+   		void start_world_processes();
+   		void read_world(size_t index);
+   		void supervise_world_processes();
+   		void read_parent();
+   		bool initialise_ogre();
+   		void mark_startup_phase(const std::string& phase);
+   		void report_startup();
+   		size_t emit_images(const std::vector<std::pair<World*, RenderTextureRing::Frame>>& frames);
+   		bool scenarios_finished() const;
+   		void record_image(const message::input::Image& image);
+   		void emit_labels(const std::vector<std::pair<World*, RenderTextureRing::Frame>>& frames);
+   		void emit_ground_truth(const World& world, NUClear::clock::time_point timestamp);
+   		void apply_quality(const QualityTier& tier);
+   		void reset_dynamics(size_t world);
+   		void step_dynamics(std::chrono::duration<double> time_span);
+   		WorldState state_from_scene(const SampledScene& scene) const;
+   		SampledScene scene_from_state(const WorldState& state) const;
 
     public:
         /// @brief Called by the powerplant to build and setup the CameraSimulator reactor.
    		virtual bool frameEnded(const Ogre::FrameEvent& evt);
-   		virtual void preRenderTargetUpdate(const Ogre::RenderTargetEvent& rte);
-   		virtual void postRenderTargetUpdate(const Ogre::RenderTargetEvent& rte);
-   		void RenderNoise(Ogre::TexturePtr tex);
         explicit CameraSimulator(std::unique_ptr<NUClear::Environment> environment);
+        ~CameraSimulator();
     };
 
 }
@@ -0,0 +1,341 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "DatasetWriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        // how long the writer waits for a full batch before writing what it has
+        const std::chrono::milliseconds BATCH_WAIT(100);
+
+        // one past the highest sequence listed in an index, 0 if there is no index or nothing in it
+        uint64_t last_sequence(const std::string& index_path)
+        {
+            std::ifstream index(index_path);
+            uint64_t next = 0;
+            for (std::string line; std::getline(index, line);)
+            {
+                char* end = nullptr;
+                const unsigned long long sequence = std::strtoull(line.c_str(), &end, 10);
+                if (end != line.c_str() && *end == ',')
+                {
+                    next = std::max<uint64_t>(next, sequence + 1);
+                }
+            }
+            return next;
+        }
+    }
+
+    OverflowPolicy overflow_policy_from_string(const std::string& policy)
+    {
+        if (policy == "block")
+        {
+            return OverflowPolicy::BLOCK;
+        }
+        if (policy == "drop")
+        {
+            return OverflowPolicy::DROP;
+        }
+        throw std::runtime_error("Unknown overflow policy " + policy + ", expected block or drop");
+    }
+
+    DatasetWriter::DatasetWriter(const DatasetOptions& options)
+        : settings(options)
+        , index(nullptr)
+        , first_sequence(0)
+        , pending(0)
+        , stopping(false)
+        , counts() {
+
+        if (mkdir(settings.directory.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            throw std::runtime_error("Can't create the dataset directory " + settings.directory + ": " + std::strerror(errno));
+        }
+
+        // carry on numbering after the images an earlier run left here
+        const std::string index_path = settings.directory + "/index.csv";
+        first_sequence = last_sequence(index_path);
+
+        index = std::fopen(index_path.c_str(), "a");
+        if (!index)
+        {
+            throw std::runtime_error("Can't open " + index_path + ": " + std::strerror(errno));
+        }
+        if (std::ftell(index) == 0)
+        {
+            std::fputs("sequence,world_id,camera_id,timestamp_ns,file\n", index);
+        }
+
+        for (unsigned int i = 0; i < std::max(settings.threads, 1u); ++i)
+        {
+            encoders.emplace_back([this] { encode_loop(); });
+        }
+        writer = std::thread([this] { write_loop(); });
+    }
+
+    DatasetWriter::~DatasetWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        job_ready.notify_all();
+        encoded_ready.notify_all();
+
+        for (auto& thread : encoders)
+        {
+            thread.join();
+        }
+        writer.join();
+
+        std::fclose(index);
+    }
+
+    bool DatasetWriter::has_space(size_t count) const
+    {
+        return pending + count <= settings.queue_size;
+    }
+
+    bool DatasetWriter::push(std::shared_ptr<const message::input::Image> image, uint64_t sequence)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (!has_space(1))
+        {
+            if (settings.overflow == OverflowPolicy::DROP)
+            {
+                ++counts.dropped;
+                return false;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            space.wait(lock, [this] { return has_space(1); });
+            counts.blocked_time += std::chrono::steady_clock::now() - start;
+        }
+
+        ++pending;
+        jobs.push_back({ std::move(image), sequence });
+        lock.unlock();
+
+        job_ready.notify_one();
+        return true;
+    }
+
+    void DatasetWriter::wait_for_space(size_t count)
+    {
+        if (settings.overflow == OverflowPolicy::DROP)
+        {
+            return;
+        }
+
+        // asking for more than the queue holds would never return
+        count = std::min(count, settings.queue_size);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!has_space(count))
+        {
+            auto start = std::chrono::steady_clock::now();
+            space.wait(lock, [&] { return has_space(count); });
+            counts.blocked_time += std::chrono::steady_clock::now() - start;
+        }
+    }
+
+    void DatasetWriter::flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        encoded_ready.notify_one();
+        space.wait(lock, [this] { return pending == 0; });
+    }
+
+    DatasetWriter::Report DatasetWriter::report()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Report out = counts;
+        out.queued = pending;
+        counts = Report();
+        return out;
+    }
+
+    const DatasetOptions& DatasetWriter::options() const
+    {
+        return settings;
+    }
+
+    uint64_t DatasetWriter::next_sequence() const
+    {
+        return first_sequence;
+    }
+
+    void DatasetWriter::encode_loop()
+    {
+
+        ImageEncoder encoder(settings.format, settings.quality, settings.level);
+
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty())
+                {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            const message::input::Image& image = *job.image;
+
+            Encoded result;
+            result.sequence = job.sequence;
+            result.world_id = image.world_id;
+            result.camera_id = image.camera_id;
+            result.timestamp = image.timestamp;
+
+            auto start = std::chrono::steady_clock::now();
+            encoder.encode(image, result.data);
+            auto encode_time = std::chrono::steady_clock::now() - start;
+
+            const size_t raw_bytes = message::input::image_size(image.format, image.width, image.height);
+
+            // the pixels go back to their pool now rather than once the file is written
+            job.image.reset();
+
+            bool batch_full;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                counts.encode_time += encode_time;
+                counts.raw_bytes += raw_bytes;
+                encoded.push_back(std::move(result));
+                batch_full = encoded.size() >= settings.batch_size;
+            }
+
+            if (batch_full)
+            {
+                encoded_ready.notify_one();
+            }
+        }
+    }
+
+    void DatasetWriter::write_loop()
+    {
+
+        std::vector<Encoded> batch;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+
+                // a partial batch is written after a short wait, so a slow trickle of images still reaches disk
+                encoded_ready.wait_for(lock, BATCH_WAIT, [this] {
+                    return stopping || encoded.size() >= settings.batch_size;
+                });
+
+                if (encoded.empty())
+                {
+                    if (stopping && pending == 0)
+                    {
+                        return;
+                    }
+                    continue;
+                }
+
+                batch.swap(encoded);
+            }
+
+            const size_t written = write_batch(batch);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending -= batch.size();
+                counts.written += written;
+                for (const auto& file : batch)
+                {
+                    counts.encoded_bytes += file.data.size();
+                }
+            }
+            space.notify_all();
+
+            batch.clear();
+        }
+    }
+
+    size_t DatasetWriter::write_batch(std::vector<Encoded>& batch)
+    {
+
+        std::sort(batch.begin(), batch.end(), [] (const Encoded& a, const Encoded& b) {
+            return a.sequence < b.sequence;
+        });
+
+        std::string lines;
+        char name[32];
+        char line[128];
+        size_t written = 0;
+
+        for (const auto& file : batch)
+        {
+            std::snprintf(name, sizeof(name), "%010llu.%s", (unsigned long long) file.sequence, encoded_extension(settings.format));
+
+            const std::string path = settings.directory + "/" + name;
+            std::FILE* out = std::fopen(path.c_str(), "wb");
+            bool ok = out && std::fwrite(file.data.data(), 1, file.data.size(), out) == file.data.size();
+            if (out && std::fclose(out) != 0)
+            {
+                ok = false;
+            }
+
+            // a file that didn't make it to disk isn't listed, and what there is of it is removed
+            if (!ok)
+            {
+                std::cout << "Failed to write " << path << ": " << std::strerror(errno) << "\n";
+                std::remove(path.c_str());
+                continue;
+            }
+            ++written;
+
+            const long long timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(file.timestamp.time_since_epoch()).count();
+            std::snprintf(line, sizeof(line), "%llu,%u,%u,%lld,%s\n", (unsigned long long) file.sequence,
+                          file.world_id, file.camera_id, timestamp, name);
+            lines += line;
+        }
+
+        std::fwrite(lines.data(), 1, lines.size(), index);
+        std::fflush(index);
+
+        return written;
+    }
+
+}
+}
@@ -0,0 +1,160 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_DATASETWRITER_H
+#define MODULE_SIMULATOR_DATASETWRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "message/input/Image.h"
+
+#include "ImageEncoder.h"
+
+namespace module {
+namespace simulation {
+
+    enum class OverflowPolicy {
+        /// Wait for room, slowing whoever is producing images down to the rate they can be written
+        BLOCK,
+        /// Drop images that don't fit, counting them
+        DROP
+    };
+
+    OverflowPolicy overflow_policy_from_string(const std::string& policy);
+
+    struct DatasetOptions {
+        /// Must already exist or have an existing parent
+        std::string directory;
+        EncodedFormat format = EncodedFormat::PNG;
+        int quality = 90;
+        int level = 1;
+        unsigned int threads = 2;
+        /// Images queued or being encoded or written at once, each holds on to its pixels until it is written
+        size_t queue_size = 16;
+        /// Files written together, in sequence order
+        size_t batch_size = 8;
+        OverflowPolicy overflow = OverflowPolicy::BLOCK;
+    };
+
+    /**
+     * Encodes images on a pool of threads and writes them to a directory as <sequence>.png or .jpg, with a line
+     * per image in index.csv giving its world, camera and timestamp. An existing dataset is added to, and its
+     * producer should number images from next_sequence on so earlier files aren't overwritten.
+     *
+     * Images are shared with their other subscribers rather than copied. At most queue_size of them are held
+     * at once; beyond that push waits or drops depending on the overflow policy, and a producer can wait for
+     * room up front with wait_for_space. One more thread collects the encoded files and writes them in batches
+     * ordered by sequence number, so the disk sees a few large bursts rather than a stream of small writes.
+     */
+    class DatasetWriter {
+    public:
+        struct Report {
+            uint64_t written;
+            uint64_t dropped;
+            uint64_t raw_bytes;
+            uint64_t encoded_bytes;
+            /// Time spent encoding, summed over the encoding threads
+            std::chrono::steady_clock::duration encode_time;
+            /// Time producers spent waiting for room
+            std::chrono::steady_clock::duration blocked_time;
+            size_t queued;
+        };
+
+        /// @throws std::runtime_error if the directory or index can't be created
+        explicit DatasetWriter(const DatasetOptions& options);
+        /// @brief Writes everything still queued before returning
+        ~DatasetWriter();
+
+        DatasetWriter(const DatasetWriter&) = delete;
+        DatasetWriter& operator=(const DatasetWriter&) = delete;
+
+        /**
+         * Queues an image to be written as sequence.
+         *
+         * @return false if the image was dropped because the queue was full
+         */
+        bool push(std::shared_ptr<const message::input::Image> image, uint64_t sequence);
+
+        /// @brief Waits until count more images fit in the queue, returning at once with the drop policy
+        void wait_for_space(size_t count);
+
+        /// @brief Waits until every queued image has been written
+        void flush();
+
+        /// @brief The counts since the last report, clearing them for the next
+        Report report();
+
+        const DatasetOptions& options() const;
+
+        /// @brief One past the highest sequence index.csv held when it was opened, 0 for a new dataset
+        uint64_t next_sequence() const;
+
+    private:
+        struct Job {
+            std::shared_ptr<const message::input::Image> image;
+            uint64_t sequence;
+        };
+
+        struct Encoded {
+            uint64_t sequence;
+            uint32_t world_id;
+            uint32_t camera_id;
+            NUClear::clock::time_point timestamp;
+            std::vector<uint8_t> data;
+        };
+
+        void encode_loop();
+        void write_loop();
+        /// @return how many files of the batch were written, only those get a line in the index
+        size_t write_batch(std::vector<Encoded>& batch);
+        bool has_space(size_t count) const;
+
+        const DatasetOptions settings;
+        std::FILE* index;
+        uint64_t first_sequence;
+
+        std::mutex mutex;
+        std::condition_variable job_ready;
+        std::condition_variable encoded_ready;
+        std::condition_variable space;
+        std::deque<Job> jobs;
+        std::vector<Encoded> encoded;
+        // images pushed that haven't been written yet
+        size_t pending;
+        bool stopping;
+
+        Report counts;
+
+        std::vector<std::thread> encoders;
+        std::thread writer;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_DATASETWRITER_H
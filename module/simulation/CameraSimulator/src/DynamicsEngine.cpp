@@ -0,0 +1,290 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "DynamicsEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        // Instances stepped per task, enough that a block's bodies stay in cache across all its steps
+        constexpr size_t BLOCK = 256;
+
+        // Bounces off a vertical cylinder at (cx, cz) moving at (cvx, cvz), keeping restitution of the speed in
+        inline void bounce_off_circle(float& x, float& z, float& vx, float& vz,
+                                      float cx, float cz, float cvx, float cvz, float distance, float restitution)
+        {
+
+            float dx = x - cx;
+            float dz = z - cz;
+            const float d2 = dx * dx + dz * dz;
+            if (d2 >= distance * distance)
+            {
+                return;
+            }
+
+            // straight through the centre pushes out along x
+            float d = std::sqrt(d2);
+            if (d < 1e-6f)
+            {
+                dx = 1.0f;
+                dz = 0.0f;
+                d = 1.0f;
+            }
+            const float nx = dx / d;
+            const float nz = dz / d;
+
+            x = cx + nx * distance;
+            z = cz + nz * distance;
+
+            const float approach = (vx - cvx) * nx + (vz - cvz) * nz;
+            if (approach < 0)
+            {
+                vx -= (1.0f + restitution) * approach * nx;
+                vz -= (1.0f + restitution) * approach * nz;
+            }
+        }
+
+        inline void bounce_off_wall(float& p, float& v, float low, float high, float restitution)
+        {
+            if (p < low)
+            {
+                p = low;
+                v = std::abs(v) * restitution;
+            }
+            else if (p > high)
+            {
+                p = high;
+                v = -std::abs(v) * restitution;
+            }
+        }
+    }
+
+    DynamicsEngine::DynamicsEngine(const DynamicsParameters& params, size_t instances, size_t robots_per_instance)
+    : params(params)
+    , count(instances)
+    , robot_count(robots_per_instance)
+    , pending(0)
+    , ball_x(instances, 0.0f)
+    , ball_y(instances, params.ground + params.ball_radius)
+    , ball_z(instances, 0.0f)
+    , ball_vx(instances, 0.0f)
+    , ball_vy(instances, 0.0f)
+    , ball_vz(instances, 0.0f)
+    , robot_x(instances * robots_per_instance, 0.0f)
+    , robot_z(instances * robots_per_instance, 0.0f)
+    , robot_vx(instances * robots_per_instance, 0.0f)
+    , robot_vz(instances * robots_per_instance, 0.0f) {}
+
+    size_t DynamicsEngine::instances() const
+    {
+        return count;
+    }
+
+    size_t DynamicsEngine::robots_per_instance() const
+    {
+        return robot_count;
+    }
+
+    const DynamicsParameters& DynamicsEngine::parameters() const
+    {
+        return params;
+    }
+
+    void DynamicsEngine::reset(size_t instance, const float position[3], const float velocity[3], const float* robots)
+    {
+
+        ball_x[instance] = position[0];
+        ball_y[instance] = position[1];
+        ball_z[instance] = position[2];
+        kick(instance, velocity);
+
+        for (size_t j = 0; j < robot_count; ++j)
+        {
+            const size_t r = instance * robot_count + j;
+            robot_x[r] = robots[j * 2];
+            robot_z[r] = robots[j * 2 + 1];
+            robot_vx[r] = 0.0f;
+            robot_vz[r] = 0.0f;
+        }
+    }
+
+    void DynamicsEngine::kick(size_t instance, const float velocity[3])
+    {
+        ball_vx[instance] = velocity[0];
+        ball_vy[instance] = velocity[1];
+        ball_vz[instance] = velocity[2];
+    }
+
+    void DynamicsEngine::set_robot_velocity(size_t instance, size_t robot, float vx, float vz)
+    {
+        robot_vx[instance * robot_count + robot] = vx;
+        robot_vz[instance * robot_count + robot] = vz;
+    }
+
+    unsigned int DynamicsEngine::accumulate(std::chrono::duration<double> time)
+    {
+        pending += time.count();
+        const unsigned int steps = (unsigned int) std::floor(pending / params.step.count());
+        pending -= steps * params.step.count();
+        return steps;
+    }
+
+    void DynamicsEngine::step(size_t first, size_t last, unsigned int steps)
+    {
+
+        const float dt = params.step.count();
+        const float rest_height = params.ground + params.ball_radius;
+        // anything slower than a step of gravity would bounce forever in ever smaller hops
+        const float settle_speed = params.gravity * dt * 2.0f;
+        const float friction = params.rolling_friction * params.gravity * dt;
+        const float robot_distance = params.robot_radius + params.ball_radius;
+        const float post_distance = params.post_radius + params.ball_radius;
+
+        const float ball_min_x = params.boundary[0] + params.ball_radius;
+        const float ball_max_x = params.boundary[1] - params.ball_radius;
+        const float ball_min_z = params.boundary[2] + params.ball_radius;
+        const float ball_max_z = params.boundary[3] - params.ball_radius;
+        const float robot_min_x = params.boundary[0] + params.robot_radius;
+        const float robot_max_x = params.boundary[1] - params.robot_radius;
+        const float robot_min_z = params.boundary[2] + params.robot_radius;
+        const float robot_max_z = params.boundary[3] - params.robot_radius;
+
+        for (unsigned int s = 0; s < steps; ++s)
+        {
+
+            // robots first, the ball then bounces off where they are now
+
+            for (size_t r = first * robot_count; r < last * robot_count; ++r)
+            {
+                robot_x[r] = std::min(std::max(robot_x[r] + robot_vx[r] * dt, robot_min_x), robot_max_x);
+                robot_z[r] = std::min(std::max(robot_z[r] + robot_vz[r] * dt, robot_min_z), robot_max_z);
+            }
+
+            for (size_t i = first; i < last; ++i)
+            {
+                float x = ball_x[i];
+                float y = ball_y[i];
+                float z = ball_z[i];
+                float vx = ball_vx[i];
+                float vy = ball_vy[i];
+                float vz = ball_vz[i];
+
+                const bool grounded = y <= rest_height && vy == 0.0f;
+
+                if (grounded)
+                {
+                    // rolling friction takes a fixed amount of speed off each step until the ball stops
+                    const float speed = std::sqrt(vx * vx + vz * vz);
+                    const float scale = speed > friction ? (speed - friction) / speed : 0.0f;
+                    vx *= scale;
+                    vz *= scale;
+                }
+                else
+                {
+                    vy -= params.gravity * dt;
+                }
+
+                x += vx * dt;
+                y += vy * dt;
+                z += vz * dt;
+
+                if (y < rest_height)
+                {
+                    y = rest_height;
+                    vy = -vy * params.ground_restitution;
+                    if (vy < settle_speed)
+                    {
+                        vy = 0.0f;
+                    }
+                }
+
+                bounce_off_wall(x, vx, ball_min_x, ball_max_x, params.wall_restitution);
+                bounce_off_wall(z, vz, ball_min_z, ball_max_z, params.wall_restitution);
+
+                for (const auto& post : params.posts)
+                {
+                    if (y - params.ball_radius < post.top)
+                    {
+                        bounce_off_circle(x, z, vx, vz, post.x, post.z, 0.0f, 0.0f, post_distance, params.wall_restitution);
+                    }
+                }
+
+                for (size_t r = i * robot_count; r < (i + 1) * robot_count; ++r)
+                {
+                    bounce_off_circle(x, z, vx, vz, robot_x[r], robot_z[r], robot_vx[r], robot_vz[r],
+                                      robot_distance, params.wall_restitution);
+                }
+
+                ball_x[i] = x;
+                ball_y[i] = y;
+                ball_z[i] = z;
+                ball_vx[i] = vx;
+                ball_vy[i] = vy;
+                ball_vz[i] = vz;
+            }
+        }
+    }
+
+    void DynamicsEngine::step(WorkerPool& pool, unsigned int steps)
+    {
+
+        if (steps == 0)
+        {
+            return;
+        }
+
+        const size_t blocks = (count + BLOCK - 1) / BLOCK;
+        pool.run(blocks, [&] (size_t block) {
+            step(block * BLOCK, std::min((block + 1) * BLOCK, count), steps);
+        });
+    }
+
+    void DynamicsEngine::ball_position(size_t instance, float position[3]) const
+    {
+        position[0] = ball_x[instance];
+        position[1] = ball_y[instance];
+        position[2] = ball_z[instance];
+    }
+
+    void DynamicsEngine::ball_velocity(size_t instance, float velocity[3]) const
+    {
+        velocity[0] = ball_vx[instance];
+        velocity[1] = ball_vy[instance];
+        velocity[2] = ball_vz[instance];
+    }
+
+    void DynamicsEngine::robot_position(size_t instance, size_t robot, float& x, float& z) const
+    {
+        x = robot_x[instance * robot_count + robot];
+        z = robot_z[instance * robot_count + robot];
+    }
+
+    bool DynamicsEngine::ball_at_rest(size_t instance) const
+    {
+        return ball_y[instance] <= params.ground + params.ball_radius && ball_vx[instance] == 0.0f
+            && ball_vy[instance] == 0.0f && ball_vz[instance] == 0.0f;
+    }
+
+}
+}
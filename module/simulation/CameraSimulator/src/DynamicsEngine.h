@@ -0,0 +1,123 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_DYNAMICSENGINE_H
+#define MODULE_SIMULATOR_DYNAMICSENGINE_H
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "WorkerPool.h"
+
+namespace module {
+namespace simulation {
+
+    /// The field and the bodies on it, in scene units and seconds
+    struct DynamicsParameters {
+        /// A goal post, a vertical cylinder of post_radius standing from the ground to top
+        struct Post {
+            float x;
+            float z;
+            float top;
+        };
+
+        std::chrono::duration<double> step = std::chrono::duration<double>(1.0 / 240.0);
+        /// The scene is about 7 units to the metre
+        float gravity = 68.7f;
+        float ground = 0.0f;
+        float ball_radius = 0.8f;
+        /// Deceleration of a rolling ball as a fraction of gravity
+        float rolling_friction = 0.05f;
+        /// Fraction of the speed into the ground kept by a bounce, slower bounces stop dead
+        float ground_restitution = 0.5f;
+        /// Fraction of the speed into a post, robot or the boundary kept by a bounce
+        float wall_restitution = 0.6f;
+        /// The walls the ball bounces off and robots stop at: min x, max x, min z, max z
+        float boundary[4] = { -34.0f, 34.0f, -26.5f, 24.0f };
+        /// Robots are vertical cylinders as far as the ball is concerned
+        float robot_radius = 1.5f;
+        float post_radius = 0.3f;
+        std::vector<Post> posts;
+    };
+
+    /**
+     * Fixed step dynamics of a ball and a team of robots in any number of independent instances, for moving
+     * the ball in rendered worlds and for sweeping thousands of scenarios headless.
+     *
+     * The ball falls, bounces, rolls to a stop under rolling friction and bounces off the goal posts, the
+     * robots and the boundary. Robots are kinematic: they move at the velocity they are given and stop at the
+     * boundary, and are never pushed by the ball. Kicks set the ball's velocity.
+     *
+     * Bodies are kept as a structure of arrays with the instances side by side, each robot array holding
+     * robots_per_instance consecutive entries per instance. Instances never interact, so any range of them
+     * can be stepped on its own thread and the results don't depend on how the ranges are split.
+     */
+    class DynamicsEngine {
+    public:
+        DynamicsEngine(const DynamicsParameters& params, size_t instances, size_t robots_per_instance);
+
+        size_t instances() const;
+        size_t robots_per_instance() const;
+        const DynamicsParameters& parameters() const;
+
+        /**
+         * Puts an instance's ball at position with velocity and its robots, stopped, at robots_per_instance
+         * (x, z) pairs.
+         */
+        void reset(size_t instance, const float position[3], const float velocity[3], const float* robots);
+
+        /// @brief Sets the ball's velocity, as a kick would
+        void kick(size_t instance, const float velocity[3]);
+
+        void set_robot_velocity(size_t instance, size_t robot, float vx, float vz);
+
+        /// @brief Adds time to the clock and returns how many whole steps are now due
+        unsigned int accumulate(std::chrono::duration<double> time);
+
+        /// @brief Advances instances [first, last) by steps fixed steps
+        void step(size_t first, size_t last, unsigned int steps);
+
+        /// @brief Advances every instance by steps fixed steps, in blocks across the pool
+        void step(WorkerPool& pool, unsigned int steps);
+
+        void ball_position(size_t instance, float position[3]) const;
+        void ball_velocity(size_t instance, float velocity[3]) const;
+        void robot_position(size_t instance, size_t robot, float& x, float& z) const;
+
+        /// @brief True once the ball is on the ground and has stopped
+        bool ball_at_rest(size_t instance) const;
+
+    private:
+        DynamicsParameters params;
+        size_t count;
+        size_t robot_count;
+        double pending;
+
+        std::vector<float> ball_x, ball_y, ball_z;
+        std::vector<float> ball_vx, ball_vy, ball_vz;
+
+        std::vector<float> robot_x, robot_z;
+        std::vector<float> robot_vx, robot_vz;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_DYNAMICSENGINE_H
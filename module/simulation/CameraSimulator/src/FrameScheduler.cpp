@@ -0,0 +1,126 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace module {
+namespace simulation {
+
+    LatePolicy late_policy_from_string(const std::string& policy)
+    {
+        if (policy == "drop")     return LatePolicy::DROP;
+        if (policy == "catch_up") return LatePolicy::CATCH_UP;
+
+        throw std::invalid_argument("Unknown late frame policy " + policy);
+    }
+
+    FrameScheduler::FrameScheduler()
+    {
+        reset(0.0, LatePolicy::DROP, 0);
+    }
+
+    void FrameScheduler::reset(double rate, LatePolicy policy, unsigned int max_catch_up)
+    {
+        this->period = rate > 0.0
+            ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate))
+            : clock::duration::zero();
+        this->policy = policy;
+        this->max_catch_up = max_catch_up;
+
+        started = false;
+        window_start = clock::now();
+
+        frames = 0;
+        missed = 0;
+        dropped = 0;
+        worst_lateness = clock::duration::zero();
+    }
+
+    void FrameScheduler::wait()
+    {
+        if (period == clock::duration::zero())
+            return;
+
+        auto now = clock::now();
+
+        // The grid starts at the first frame, so time spent setting up isn't counted as lateness
+        if (!started)
+        {
+            started = true;
+            next = now + period;
+            return;
+        }
+
+        if (now < next)
+        {
+            std::this_thread::sleep_until(next);
+        }
+        else if (now > next)
+        {
+            ++missed;
+            worst_lateness = std::max(worst_lateness, now - next);
+
+            // Whole periods we are behind by, not counting the frame we are about to render
+            uint64_t behind = (now - next) / period;
+
+            if (policy == LatePolicy::DROP || behind > max_catch_up)
+            {
+                // Move to the latest deadline that has passed and render that one now
+                dropped += behind;
+                next += behind * period;
+            }
+        }
+
+        next += period;
+    }
+
+    void FrameScheduler::rendered()
+    {
+        ++frames;
+    }
+
+    bool FrameScheduler::report(std::chrono::duration<double> interval, Report& out)
+    {
+        auto now = clock::now();
+        std::chrono::duration<double> elapsed = now - window_start;
+
+        if (elapsed < interval)
+            return false;
+
+        out.achieved_rate = frames / elapsed.count();
+        out.frames = frames;
+        out.missed = missed;
+        out.dropped = dropped;
+        out.worst_lateness = worst_lateness;
+
+        window_start = now;
+        frames = 0;
+        missed = 0;
+        dropped = 0;
+        worst_lateness = clock::duration::zero();
+
+        return true;
+    }
+
+}
+}
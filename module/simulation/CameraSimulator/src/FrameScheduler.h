@@ -0,0 +1,95 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_FRAMESCHEDULER_H
+#define MODULE_SIMULATOR_FRAMESCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace module {
+namespace simulation {
+
+    enum class LatePolicy {
+        /// Skip the frames whose deadlines have already passed and carry on from the next one
+        DROP,
+        /// Render the missed frames back to back until we are on schedule again
+        CATCH_UP
+    };
+
+    LatePolicy late_policy_from_string(const std::string& policy);
+
+    /**
+     * Paces frames to a fixed rate like a real camera driver.
+     *
+     * Frame deadlines are kept on a fixed grid (start + n * period) so that sleeping jitter does not
+     * accumulate into drift. The render thread sleeps until each deadline rather than spinning.
+     */
+    class FrameScheduler {
+    public:
+        struct Report {
+            double achieved_rate;
+            /// Frames rendered since the last report, see rendered
+            uint64_t frames;
+            uint64_t missed;
+            uint64_t dropped;
+            /// The latest a frame started after its deadline
+            std::chrono::duration<double> worst_lateness;
+        };
+
+        FrameScheduler();
+
+        /// @brief A rate of 0 disables pacing entirely
+        void reset(double rate, LatePolicy policy, unsigned int max_catch_up);
+
+        /// @brief Blocks until the next frame is due
+        void wait();
+
+        /// @brief Counts a frame that was actually rendered and emitted, a wait that came to nothing isn't one
+        void rendered();
+
+        /**
+         * Fills in the statistics of the frames since the last report once every interval.
+         *
+         * @return true if a report was made
+         */
+        bool report(std::chrono::duration<double> interval, Report& out);
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        clock::duration period;
+        LatePolicy policy;
+        unsigned int max_catch_up;
+
+        bool started;
+        clock::time_point next;
+        clock::time_point window_start;
+
+        uint64_t frames;
+        uint64_t missed;
+        uint64_t dropped;
+        clock::duration worst_lateness;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_FRAMESCHEDULER_H
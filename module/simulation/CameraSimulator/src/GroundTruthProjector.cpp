@@ -0,0 +1,434 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "GroundTruthProjector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+namespace module {
+namespace simulation {
+
+    using message::simulation::GroundTruth;
+
+    namespace {
+
+        // Segment ends closer than this fraction to the target still count as reaching it
+        constexpr float END_TOLERANCE = 1e-3f;
+
+        struct Vec3 {
+            float x, y, z;
+        };
+
+        Vec3 transform(const float m[16], const Vec3& p)
+        {
+            return { m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3]
+                   , m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7]
+                   , m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11] };
+        }
+
+        Vec3 to_vec(const float p[3])
+        {
+            return { p[0], p[1], p[2] };
+        }
+
+        // A point of camera space on the image, false if it is behind the camera or nearer than the near plane
+        bool project_point(const float projection[16], const LensModel& lens, const Vec3& p, double& u, double& v)
+        {
+
+            const float* m = projection;
+            const float x = m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3];
+            const float y = m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7];
+            const float z = m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11];
+            const float w = m[12] * p.x + m[13] * p.y + m[14] * p.z + m[15];
+
+            if (w <= 0 || z < -w)
+            {
+                return false;
+            }
+
+            lens.project(x / w, y / w, u, v);
+            return true;
+        }
+
+        bool inside(const LensModel& lens, double u, double v)
+        {
+            return u >= 0 && v >= 0 && u < lens.width() && v < lens.height();
+        }
+
+        // Whether the segment from a to b passes through the box, by clipping it against each pair of slabs
+        bool segment_hits_box(const Vec3& a, const Vec3& b, const ProxyBox& box)
+        {
+
+            const float origin[3] = { a.x, a.y, a.z };
+            const float delta[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+            float t0 = 0.0f;
+            float t1 = 1.0f - END_TOLERANCE;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                if (std::abs(delta[i]) < 1e-9f)
+                {
+                    if (origin[i] < box.min[i] || origin[i] > box.max[i])
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                float near = (box.min[i] - origin[i]) / delta[i];
+                float far = (box.max[i] - origin[i]) / delta[i];
+                if (near > far)
+                {
+                    std::swap(near, far);
+                }
+                t0 = std::max(t0, near);
+                t1 = std::min(t1, far);
+                if (t0 > t1)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool segment_hits_sphere(const Vec3& a, const Vec3& b, const Vec3& centre, float radius)
+        {
+
+            const Vec3 d = { b.x - a.x, b.y - a.y, b.z - a.z };
+            const Vec3 f = { a.x - centre.x, a.y - centre.y, a.z - centre.z };
+            const float dd = d.x * d.x + d.y * d.y + d.z * d.z;
+            if (dd <= 0)
+            {
+                return false;
+            }
+
+            // the nearest point of the segment to the centre
+            float t = -(f.x * d.x + f.y * d.y + f.z * d.z) / dd;
+            t = std::min(std::max(t, 0.0f), 1.0f - END_TOLERANCE);
+            const Vec3 p = { f.x + d.x * t, f.y + d.y * t, f.z + d.z * t };
+            return p.x * p.x + p.y * p.y + p.z * p.z < radius * radius;
+        }
+
+        // What stands between the camera and a point, skipping the point's own occluder
+        struct Occluders {
+            Vec3 camera;
+            Vec3 ball;
+            float ball_radius;
+            const std::vector<ProxyBox>& posts;
+            const std::vector<ProxyBox>& robots;
+
+            enum Owner { NONE, BALL, POST, ROBOT };
+
+            bool occluded(const Vec3& target, Owner owner = NONE, size_t index = 0) const
+            {
+
+                if (owner != BALL && segment_hits_sphere(camera, target, ball, ball_radius))
+                {
+                    return true;
+                }
+                for (size_t i = 0; i < posts.size(); ++i)
+                {
+                    if (!(owner == POST && i == index) && segment_hits_box(camera, target, posts[i]))
+                    {
+                        return true;
+                    }
+                }
+                for (size_t i = 0; i < robots.size(); ++i)
+                {
+                    if (!(owner == ROBOT && i == index) && segment_hits_box(camera, target, robots[i]))
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
+
+        GroundTruth::FeatureType feature_type_from_string(const std::string& type)
+        {
+
+            if (type == "L")
+            {
+                return GroundTruth::FeatureType::L_INTERSECTION;
+            }
+            if (type == "T")
+            {
+                return GroundTruth::FeatureType::T_INTERSECTION;
+            }
+            if (type == "X")
+            {
+                return GroundTruth::FeatureType::X_INTERSECTION;
+            }
+            if (type == "centre_mark")
+            {
+                return GroundTruth::FeatureType::CENTRE_MARK;
+            }
+            if (type == "penalty_mark")
+            {
+                return GroundTruth::FeatureType::PENALTY_MARK;
+            }
+
+            throw std::runtime_error("Unknown field feature " + type);
+        }
+
+        void read_position(const YAML::Node& node, float position[3])
+        {
+
+            std::vector<float> values = node.as<std::vector<float>>();
+            if (values.size() != 3)
+            {
+                throw std::runtime_error("Field feature positions are [x, y, z]");
+            }
+            std::copy(values.begin(), values.end(), position);
+        }
+    }
+
+    FieldFeatures FieldFeatures::load(const std::string& path)
+    {
+
+        std::ifstream in(path);
+        if (!in)
+        {
+            throw std::runtime_error("Can't read the field features " + path);
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+
+        return parse(text.str(), path);
+    }
+
+    FieldFeatures FieldFeatures::parse(const std::string& description, const std::string& source)
+    {
+
+        FieldFeatures field;
+
+        try
+        {
+            YAML::Node root = YAML::Load(description);
+
+            if (root["ball_radius"])
+            {
+                field.ball_radius = root["ball_radius"].as<float>();
+            }
+            if (root["post_radius"])
+            {
+                field.post_radius = root["post_radius"].as<float>();
+            }
+
+            for (const auto& post : root["goal_posts"])
+            {
+                const uint32_t id = field.posts.size();
+
+                Point base = { GroundTruth::FeatureType::GOAL_POST_BASE, id, {} };
+                Point top = { GroundTruth::FeatureType::GOAL_POST_TOP, id, {} };
+                read_position(post["base"], base.position);
+                read_position(post["top"], top.position);
+                field.points.push_back(base);
+                field.points.push_back(top);
+
+                ProxyBox box;
+                for (int i = 0; i < 3; ++i)
+                {
+                    box.min[i] = std::min(base.position[i], top.position[i]) - field.post_radius;
+                    box.max[i] = std::max(base.position[i], top.position[i]) + field.post_radius;
+                }
+                field.posts.push_back(box);
+            }
+
+            uint32_t id = 0;
+            for (const auto& point : root["points"])
+            {
+                Point feature = { feature_type_from_string(point["type"].as<std::string>()), id++, {} };
+                read_position(point["position"], feature.position);
+                field.points.push_back(feature);
+            }
+        }
+        catch (const YAML::Exception& e)
+        {
+            throw std::runtime_error("Invalid field features " + source + ": " + e.what());
+        }
+        catch (const std::runtime_error& e)
+        {
+            throw std::runtime_error("Invalid field features " + source + ": " + e.what());
+        }
+
+        return field;
+    }
+
+    GroundTruthProjector::GroundTruthProjector(const FieldFeatures& field, const LensModel& lens)
+    : field(field)
+    , lens(lens) {}
+
+    void GroundTruthProjector::project(const float view[16], const float projection[16], const float ball[3],
+                                       const std::vector<ProxyBox>& robots, GroundTruth& truth) const
+    {
+
+        truth.width = lens.width();
+        truth.height = lens.height();
+
+        // the camera sits at -R^T t of its view transform
+        const Vec3 camera = { -(view[0] * view[3] + view[4] * view[7] + view[8] * view[11])
+                            , -(view[1] * view[3] + view[5] * view[7] + view[9] * view[11])
+                            , -(view[2] * view[3] + view[6] * view[7] + view[10] * view[11]) };
+
+        const Occluders occluders = { camera, to_vec(ball), field.ball_radius, field.posts, robots };
+
+        // the field's points, all through the same two transforms
+
+        truth.features.resize(field.points.size());
+        for (size_t i = 0; i < field.points.size(); ++i)
+        {
+            const FieldFeatures::Point& point = field.points[i];
+            GroundTruth::Feature& feature = truth.features[i];
+
+            const Vec3 world = to_vec(point.position);
+            const Vec3 p = transform(view, world);
+
+            double u = 0;
+            double v = 0;
+            const bool projected = project_point(projection, lens, p, u, v);
+
+            const bool is_post = point.type == GroundTruth::FeatureType::GOAL_POST_BASE
+                              || point.type == GroundTruth::FeatureType::GOAL_POST_TOP;
+
+            feature.type = point.type;
+            feature.id = point.id;
+            feature.x = u;
+            feature.y = v;
+            feature.depth = -p.z;
+            feature.in_image = projected && inside(lens, u, v);
+            feature.occluded = feature.in_image
+                            && occluders.occluded(world, is_post ? Occluders::POST : Occluders::NONE, point.id);
+        }
+
+        // the ball's outline is where the rays that graze it land, found at four points around it
+
+        {
+            const Vec3 c = transform(view, to_vec(ball));
+            const float distance = std::sqrt(c.x * c.x + c.y * c.y + c.z * c.z);
+
+            GroundTruth::Ball& out = truth.ball;
+            out = GroundTruth::Ball();
+            out.depth = -c.z;
+
+            double u = 0;
+            double v = 0;
+            bool projected = distance > field.ball_radius && project_point(projection, lens, c, u, v);
+
+            if (projected)
+            {
+                const Vec3 axis = { c.x / distance, c.y / distance, c.z / distance };
+
+                // two directions across the line of sight
+                Vec3 across = { -axis.z, 0.0f, axis.x };
+                float length = std::sqrt(across.x * across.x + across.z * across.z);
+                if (length < 1e-6f)
+                {
+                    across = { 1.0f, 0.0f, 0.0f };
+                    length = 1.0f;
+                }
+                across = { across.x / length, 0.0f, across.z / length };
+                const Vec3 up = { axis.y * across.z - axis.z * across.y
+                                , axis.z * across.x - axis.x * across.z
+                                , axis.x * across.y - axis.y * across.x };
+
+                const float sin_a = field.ball_radius / distance;
+                const float cos_a = std::sqrt(1.0f - sin_a * sin_a);
+
+                double radius = 0;
+                for (int i = 0; i < 4 && projected; ++i)
+                {
+                    const Vec3& side = i < 2 ? across : up;
+                    const float sign = i % 2 == 0 ? 1.0f : -1.0f;
+                    const Vec3 edge = { axis.x * cos_a + side.x * sin_a * sign
+                                      , axis.y * cos_a + side.y * sin_a * sign
+                                      , axis.z * cos_a + side.z * sin_a * sign };
+
+                    double eu = 0;
+                    double ev = 0;
+                    projected = project_point(projection, lens, { edge.x * distance, edge.y * distance, edge.z * distance }, eu, ev);
+                    radius += std::hypot(eu - u, ev - v) * 0.25;
+                }
+
+                out.x = u;
+                out.y = v;
+                out.radius = radius;
+            }
+
+            out.in_image = projected && out.x + out.radius >= 0 && out.y + out.radius >= 0
+                        && out.x - out.radius < lens.width() && out.y - out.radius < lens.height();
+            out.occluded = out.in_image && occluders.occluded(occluders.ball, Occluders::BALL);
+        }
+
+        // robots are the image rectangle around their box's corners
+
+        truth.robots.resize(robots.size());
+        for (size_t i = 0; i < robots.size(); ++i)
+        {
+            const ProxyBox& box = robots[i];
+            GroundTruth::Robot& out = truth.robots[i];
+
+            out = GroundTruth::Robot();
+            out.id = i;
+
+            bool projected = true;
+            double x_min = HUGE_VAL;
+            double y_min = HUGE_VAL;
+            double x_max = -HUGE_VAL;
+            double y_max = -HUGE_VAL;
+
+            for (int corner = 0; corner < 8 && projected; ++corner)
+            {
+                const Vec3 world = { corner & 1 ? box.max[0] : box.min[0]
+                                   , corner & 2 ? box.max[1] : box.min[1]
+                                   , corner & 4 ? box.max[2] : box.min[2] };
+                double u = 0;
+                double v = 0;
+                projected = project_point(projection, lens, transform(view, world), u, v);
+                x_min = std::min(x_min, u);
+                y_min = std::min(y_min, v);
+                x_max = std::max(x_max, u);
+                y_max = std::max(y_max, v);
+            }
+
+            const Vec3 centre = { (box.min[0] + box.max[0]) * 0.5f
+                                , (box.min[1] + box.max[1]) * 0.5f
+                                , (box.min[2] + box.max[2]) * 0.5f };
+            out.depth = -transform(view, centre).z;
+
+            // a box partly behind the camera has no sensible rectangle, so it is left out of the image
+            if (projected)
+            {
+                out.x_min = x_min;
+                out.y_min = y_min;
+                out.x_max = x_max;
+                out.y_max = y_max;
+            }
+
+            out.in_image = projected && x_max >= 0 && y_max >= 0 && x_min < lens.width() && y_min < lens.height();
+            out.occluded = out.in_image && occluders.occluded(centre, Occluders::ROBOT, i);
+        }
+    }
+
+}
+}
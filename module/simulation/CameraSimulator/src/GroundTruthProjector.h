@@ -0,0 +1,96 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_GROUNDTRUTHPROJECTOR_H
+#define MODULE_SIMULATOR_GROUNDTRUTHPROJECTOR_H
+
+#include <string>
+#include <vector>
+
+#include "message/simulation/GroundTruth.h"
+
+#include "LensModel.h"
+
+namespace module {
+namespace simulation {
+
+    /// An axis aligned box in scene coordinates
+    struct ProxyBox {
+        float min[3];
+        float max[3];
+    };
+
+    /**
+     * The parts of the field whose image positions the ground truth reports, in scene coordinates. Goal posts
+     * give a base and a top point each and stand in for the posts as occluders.
+     */
+    struct FieldFeatures {
+        struct Point {
+            message::simulation::GroundTruth::FeatureType type;
+            uint32_t id;
+            float position[3];
+        };
+
+        float ball_radius = 0.8f;
+        float post_radius = 0.25f;
+        std::vector<Point> points;
+        /// Boxes around each goal post, post_radius either side of the line from its base to its top
+        std::vector<ProxyBox> posts;
+
+        /// @throws std::runtime_error if the description can't be read or is invalid
+        static FieldFeatures load(const std::string& path);
+
+        /// @throws std::runtime_error if the description is invalid
+        static FieldFeatures parse(const std::string& description, const std::string& source);
+    };
+
+    /**
+     * Projects the ball, the field's features and the robots into a camera's image on the CPU, for scoring
+     * detectors against the truth without rendering anything.
+     *
+     * Everything is transformed by the same view and projection matrices the camera rendered with and then
+     * through the lens, so points land where they are drawn in the emitted image. Occlusion is decided
+     * analytically against a coarse stand in for the scene, a sphere for the ball and boxes for the goal
+     * posts and robots: a point is occluded if the segment from the camera to it passes through any of them
+     * other than its own. A frame is a few hundred segment tests, a few microseconds.
+     */
+    class GroundTruthProjector {
+    public:
+        GroundTruthProjector(const FieldFeatures& field, const LensModel& lens);
+
+        /**
+         * Fills in everything but the message's timestamp and ids.
+         *
+         * @param view       row major world to camera transform, the camera looking down -z
+         * @param projection row major camera to clip transform with OpenGL's -1 to 1 depth range
+         * @param ball       the ball's centre
+         * @param robots     each robot's bounding box, in the order of their ids
+         */
+        void project(const float view[16], const float projection[16], const float ball[3],
+                     const std::vector<ProxyBox>& robots, message::simulation::GroundTruth& truth) const;
+
+    private:
+        const FieldFeatures& field;
+        const LensModel& lens;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_GROUNDTRUTHPROJECTOR_H
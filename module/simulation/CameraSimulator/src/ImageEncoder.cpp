@@ -0,0 +1,299 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "ImageEncoder.h"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <jpeglib.h>
+#include <png.h>
+
+using message::input::Image;
+using message::input::ImageFormat;
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        void png_append(png_structp png, png_bytep data, png_size_t length)
+        {
+            auto& out = *static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png));
+            out.insert(out.end(), data, data + length);
+        }
+
+        void png_flush(png_structp)
+        {
+        }
+
+        // libpng errors longjmp back to the encoder like libjpeg's, after keeping the message
+        void png_error_handler(png_structp png, png_const_charp message)
+        {
+            std::strncpy(static_cast<char*>(png_get_error_ptr(png)), message, 199);
+            png_longjmp(png, 1);
+        }
+
+        void png_warning_handler(png_structp, png_const_charp)
+        {
+        }
+
+        // libjpeg errors longjmp back to the encoder, which throws once the compressor is destroyed
+        struct JpegError {
+            jpeg_error_mgr manager;
+            std::jmp_buf jump;
+            char message[JMSG_LENGTH_MAX];
+        };
+
+        void jpeg_error_handler(j_common_ptr cinfo)
+        {
+            JpegError* error = reinterpret_cast<JpegError*>(cinfo->err);
+            (*cinfo->err->format_message)(cinfo, error->message);
+            std::longjmp(error->jump, 1);
+        }
+
+        // Destination that grows a vector, so nothing touches the disk until the writer has a batch
+        struct JpegDestination {
+            jpeg_destination_mgr manager;
+            std::vector<uint8_t>* out;
+        };
+
+        const size_t JPEG_CHUNK = 64 * 1024;
+
+        void jpeg_init(j_compress_ptr cinfo)
+        {
+            JpegDestination* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+            dest->out->resize(JPEG_CHUNK);
+            dest->manager.next_output_byte = dest->out->data();
+            dest->manager.free_in_buffer = dest->out->size();
+        }
+
+        boolean jpeg_empty(j_compress_ptr cinfo)
+        {
+            // libjpeg only calls this with the whole buffer used, free_in_buffer is not meaningful here
+            JpegDestination* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+            const size_t used = dest->out->size();
+            dest->out->resize(used * 2);
+            dest->manager.next_output_byte = dest->out->data() + used;
+            dest->manager.free_in_buffer = dest->out->size() - used;
+            return TRUE;
+        }
+
+        void jpeg_term(j_compress_ptr cinfo)
+        {
+            JpegDestination* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+            dest->out->resize(dest->out->size() - dest->manager.free_in_buffer);
+        }
+    }
+
+    EncodedFormat encoded_format_from_string(const std::string& format)
+    {
+        if (format == "png")
+        {
+            return EncodedFormat::PNG;
+        }
+        if (format == "jpeg" || format == "jpg")
+        {
+            return EncodedFormat::JPEG;
+        }
+        throw std::runtime_error("Unknown encoded image format " + format + ", expected png or jpeg");
+    }
+
+    const char* encoded_extension(EncodedFormat format)
+    {
+        return format == EncodedFormat::PNG ? "png" : "jpg";
+    }
+
+    ImageEncoder::ImageEncoder(EncodedFormat format, int quality, int level)
+        : encoded(format)
+        , quality(std::min(std::max(quality, 1), 100))
+        , level(std::min(std::max(level, 0), 9)) {
+    }
+
+    EncodedFormat ImageEncoder::format() const
+    {
+        return encoded;
+    }
+
+    void ImageEncoder::encode(const Image& image, std::vector<uint8_t>& out)
+    {
+        out.clear();
+        if (encoded == EncodedFormat::PNG)
+        {
+            encode_png(image, out);
+        }
+        else
+        {
+            encode_jpeg(image, out);
+        }
+    }
+
+    void ImageEncoder::encode_png(const Image& image, std::vector<uint8_t>& out)
+    {
+
+        const bool gray = image.format == ImageFormat::GRAY8;
+        const size_t row_bytes = size_t(image.width) * (gray ? 1 : 3);
+
+        char error_message[200] = {};
+        png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, error_message, png_error_handler, png_warning_handler);
+        png_infop info = png ? png_create_info_struct(png) : nullptr;
+        if (!info)
+        {
+            png_destroy_write_struct(&png, nullptr);
+            throw std::runtime_error("PNG encoding failed: out of memory");
+        }
+
+        // formats other than YUYV, RGB and gray are converted whole, they are rare enough not to matter
+        std::vector<uint8_t> converted;
+        if (!gray && image.format != ImageFormat::RGB24 && image.format != ImageFormat::YUYV)
+        {
+            converted.resize(row_bytes * image.height);
+            image.to_rgb(converted.data());
+        }
+
+        if (setjmp(png_jmpbuf(png)))
+        {
+            png_destroy_write_struct(&png, &info);
+            throw std::runtime_error(std::string("PNG encoding failed: ") + error_message);
+        }
+
+        png_set_write_fn(png, &out, png_append, png_flush);
+        png_set_IHDR(png, info, image.width, image.height, 8, gray ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGB,
+                     PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_set_compression_level(png, level);
+        // the sub filter is cheap and does nearly as well as adaptive filtering on rendered images
+        png_set_filter(png, PNG_FILTER_TYPE_BASE, level <= 3 ? PNG_FILTER_SUB : PNG_ALL_FILTERS);
+        png_write_info(png, info);
+
+        row.resize(row_bytes);
+        for (unsigned int y = 0; y < image.height; ++y)
+        {
+            const uint8_t* pixels;
+            if (image.format == ImageFormat::YUYV)
+            {
+                message::input::yuyv_to_rgb(image.pixels() + size_t(y) * image.width * 2, image.width, row.data());
+                pixels = row.data();
+            }
+            else if (converted.empty())
+            {
+                pixels = image.pixels() + y * row_bytes;
+            }
+            else
+            {
+                pixels = converted.data() + y * row_bytes;
+            }
+            png_write_row(png, const_cast<png_bytep>(pixels));
+        }
+
+        png_write_end(png, nullptr);
+        png_destroy_write_struct(&png, &info);
+    }
+
+    void ImageEncoder::encode_jpeg(const Image& image, std::vector<uint8_t>& out)
+    {
+
+        const bool gray = image.format == ImageFormat::GRAY8;
+        const bool yuyv = image.format == ImageFormat::YUYV;
+
+        std::vector<uint8_t> converted;
+        if (!gray && !yuyv && image.format != ImageFormat::RGB24)
+        {
+            converted.resize(size_t(image.width) * image.height * 3);
+            image.to_rgb(converted.data());
+        }
+
+        jpeg_compress_struct cinfo;
+        JpegError error;
+        cinfo.err = jpeg_std_error(&error.manager);
+        error.manager.error_exit = jpeg_error_handler;
+
+        JpegDestination destination;
+        destination.manager.init_destination = jpeg_init;
+        destination.manager.empty_output_buffer = jpeg_empty;
+        destination.manager.term_destination = jpeg_term;
+        destination.out = &out;
+
+        if (setjmp(error.jump))
+        {
+            jpeg_destroy_compress(&cinfo);
+            throw std::runtime_error(std::string("JPEG encoding failed: ") + error.message);
+        }
+
+        jpeg_create_compress(&cinfo);
+        cinfo.dest = &destination.manager;
+        cinfo.image_width = image.width;
+        cinfo.image_height = image.height;
+        cinfo.input_components = gray ? 1 : 3;
+        cinfo.in_color_space = gray ? JCS_GRAYSCALE : yuyv ? JCS_YCbCr : JCS_RGB;
+        jpeg_set_defaults(&cinfo);
+        jpeg_set_quality(&cinfo, quality, TRUE);
+        cinfo.dct_method = JDCT_IFAST;
+
+        if (!gray)
+        {
+            // 4:2:2, the chroma resolution the camera has
+            cinfo.comp_info[0].h_samp_factor = 2;
+            cinfo.comp_info[0].v_samp_factor = 1;
+        }
+
+        jpeg_start_compress(&cinfo, TRUE);
+
+        row.resize(size_t(image.width) * cinfo.input_components);
+        while (cinfo.next_scanline < cinfo.image_height)
+        {
+            const size_t y = cinfo.next_scanline;
+            JSAMPROW pixels;
+
+            if (yuyv)
+            {
+                // libjpeg takes interleaved 4:4:4 and subsamples the chroma straight back to what we had
+                const uint8_t* in = image.pixels() + y * image.width * 2;
+                uint8_t* out_row = row.data();
+                for (unsigned int x = 0; x < image.width; x += 2, in += 4, out_row += 6)
+                {
+                    out_row[0] = in[0];
+                    out_row[1] = in[1];
+                    out_row[2] = in[3];
+                    out_row[3] = in[2];
+                    out_row[4] = in[1];
+                    out_row[5] = in[3];
+                }
+                pixels = row.data();
+            }
+            else if (converted.empty())
+            {
+                pixels = const_cast<JSAMPROW>(image.pixels() + y * row.size());
+            }
+            else
+            {
+                pixels = converted.data() + y * row.size();
+            }
+
+            jpeg_write_scanlines(&cinfo, &pixels, 1);
+        }
+
+        jpeg_finish_compress(&cinfo);
+        jpeg_destroy_compress(&cinfo);
+    }
+
+}
+}
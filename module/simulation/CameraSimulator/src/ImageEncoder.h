@@ -0,0 +1,80 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_IMAGEENCODER_H
+#define MODULE_SIMULATOR_IMAGEENCODER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "message/input/Image.h"
+
+namespace module {
+namespace simulation {
+
+    enum class EncodedFormat {
+        /// Lossless, RGB or grayscale
+        PNG,
+        /// Lossy, YCbCr 4:2:2 or grayscale
+        JPEG
+    };
+
+    EncodedFormat encoded_format_from_string(const std::string& format);
+
+    /// @brief The file extension for a format, without the dot
+    const char* encoded_extension(EncodedFormat format);
+
+    /**
+     * Compresses images into PNG or JPEG files in memory. Each call is independent so one encoder per thread
+     * can run in parallel.
+     *
+     * GRAY8 images stay grayscale. YUYV goes into JPEG as it is, since full range BT.601 is the YCbCr JPEG
+     * uses and the camera's 4:2:2 chroma is what a 2x1 subsampled JPEG keeps. Everything else is encoded as
+     * RGB.
+     */
+    class ImageEncoder {
+    public:
+        /**
+         * @param quality JPEG quality from 1 to 100
+         * @param level   PNG zlib level from 0 to 9, low levels are much faster and only a little larger
+         */
+        ImageEncoder(EncodedFormat format, int quality = 90, int level = 1);
+
+        /// @brief Replaces out with the encoded image, keeping its capacity
+        /// @throws std::runtime_error if the encoder fails
+        void encode(const message::input::Image& image, std::vector<uint8_t>& out);
+
+        EncodedFormat format() const;
+
+    private:
+        void encode_png(const message::input::Image& image, std::vector<uint8_t>& out);
+        void encode_jpeg(const message::input::Image& image, std::vector<uint8_t>& out);
+
+        EncodedFormat encoded;
+        int quality;
+        int level;
+        // one row of whatever the encoder is fed, reused between images
+        std::vector<uint8_t> row;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_IMAGEENCODER_H
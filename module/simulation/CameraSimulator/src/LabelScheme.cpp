@@ -0,0 +1,89 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "LabelScheme.h"
+
+#include <OgreMaterial.h>
+#include <OgrePass.h>
+#include <OgreTechnique.h>
+#include <OgreTextureUnitState.h>
+
+namespace module {
+namespace simulation {
+
+    const char* const LabelScheme::SCHEME = "Labels";
+
+    LabelScheme::LabelScheme(const std::map<std::string, uint8_t>& classes)
+    : classes(classes) {
+    }
+
+    Ogre::Technique* LabelScheme::handleSchemeNotFound(unsigned short
+                                                     , const Ogre::String& scheme_name
+                                                     , Ogre::Material* original
+                                                     , unsigned short
+                                                     , const Ogre::Renderable*)
+    {
+
+        if (scheme_name != SCHEME)
+        {
+            return nullptr;
+        }
+
+        // a technique added earlier but not compiled into the material's scheme list yet
+        for (unsigned short i = 0; i < original->getNumTechniques(); ++i)
+        {
+            if (original->getTechnique(i)->getSchemeName() == SCHEME)
+            {
+                return original->getTechnique(i);
+            }
+        }
+
+        // keep the original's culling so single sided geometry such as the nets covers the same pixels
+        Ogre::CullingMode culling = Ogre::CULL_CLOCKWISE;
+        Ogre::Technique* best = original->getBestTechnique();
+        if (best && best->getNumPasses() > 0)
+        {
+            culling = best->getPass(0)->getCullingMode();
+        }
+
+        Ogre::Technique* technique = original->createTechnique();
+        technique->setSchemeName(SCHEME);
+
+        Ogre::Pass* pass = technique->createPass();
+        pass->setLightingEnabled(false);
+        pass->setFog(true, Ogre::FOG_NONE);
+        pass->setCullingMode(culling);
+        pass->setShadingMode(Ogre::SO_FLAT);
+
+        // the id is exact in any 8 bit channel, so the readback can take whichever byte comes first
+        const Ogre::Real level = label(original->getName()) / Ogre::Real(255);
+        Ogre::TextureUnitState* colour = pass->createTextureUnitState();
+        colour->setColourOperationEx(Ogre::LBX_SOURCE1, Ogre::LBS_MANUAL, Ogre::LBS_CURRENT, Ogre::ColourValue(level, level, level));
+
+        return technique;
+    }
+
+    uint8_t LabelScheme::label(const std::string& material) const
+    {
+        auto found = classes.find(material);
+        return found == classes.end() ? 0 : found->second;
+    }
+
+}
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_LABELSCHEME_H
+#define MODULE_SIMULATOR_LABELSCHEME_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include <OgreMaterialManager.h>
+
+namespace module {
+namespace simulation {
+
+    /**
+     * The material scheme the label pass renders with, where every material draws as a flat grey of its
+     * class id.
+     *
+     * The scene's materials already say what each object is (SoccerField, SoccerBall, stadiumwhite,
+     * iguswhite...), so rather than tagging entities the scheme is filled in lazily: the first time Ogre looks
+     * for the label technique of a material it doesn't have one, and this listener adds an unlit, untextured,
+     * fogless pass coloured by the material's class. Materials missing from the class table draw as 0.
+     */
+    class LabelScheme : public Ogre::MaterialManager::Listener {
+    public:
+        static const char* const SCHEME;
+
+        explicit LabelScheme(const std::map<std::string, uint8_t>& classes);
+
+        Ogre::Technique* handleSchemeNotFound(unsigned short scheme_index
+                                            , const Ogre::String& scheme_name
+                                            , Ogre::Material* original
+                                            , unsigned short lod_index
+                                            , const Ogre::Renderable* renderable) override;
+
+        /// @brief The class id a material is labelled with
+        uint8_t label(const std::string& material) const;
+
+    private:
+        std::map<std::string, uint8_t> classes;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_LABELSCHEME_H
@@ -0,0 +1,494 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "LensModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define LENS_MODEL_X86
+    #include <immintrin.h>
+#endif
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        // A pinhole can't render rays this far off axis, wider fisheye rays are clamped to the edge of the render
+        constexpr double MAX_THETA = 80.0 * M_PI / 180.0;
+
+        // Textures larger than this aren't supported everywhere
+        constexpr unsigned int MAX_RENDER_SIZE = 4096;
+
+        constexpr int WEIGHT_ONE = 128;
+        constexpr int WEIGHT_SHIFT = 14;
+        constexpr int WEIGHT_ROUND = 1 << (WEIGHT_SHIFT - 1);
+
+        unsigned int round_even(double v)
+        {
+            return std::max(2u, 2 * (unsigned int) std::lround(v / 2.0));
+        }
+
+        // Finds the undistorted pinhole coordinates (x, y) on the z = 1 plane of a distorted normalised point
+        void undistort(const LensParameters& params, double xd, double yd, double& x, double& y)
+        {
+
+            const double* k = params.k;
+
+            switch (params.projection)
+            {
+                case LensProjection::PINHOLE:
+                {
+                    x = xd;
+                    y = yd;
+                } break;
+
+                case LensProjection::RADIAL_TANGENTIAL:
+                {
+                    // The same fixed point iteration as OpenCV's undistortPoints
+                    x = xd;
+                    y = yd;
+                    for (int i = 0; i < 20; ++i)
+                    {
+                        const double r2 = x * x + y * y;
+                        const double radial = 1 + r2 * (k[0] + r2 * (k[1] + r2 * k[2]));
+                        const double dx = 2 * params.p1 * x * y + params.p2 * (r2 + 2 * x * x);
+                        const double dy = params.p1 * (r2 + 2 * y * y) + 2 * params.p2 * x * y;
+                        x = (xd - dx) / radial;
+                        y = (yd - dy) / radial;
+                    }
+                } break;
+
+                case LensProjection::EQUIDISTANT:
+                {
+                    const double theta_d = std::sqrt(xd * xd + yd * yd);
+                    if (theta_d < 1e-12)
+                    {
+                        x = xd;
+                        y = yd;
+                        break;
+                    }
+
+                    // Newton's method on theta_d = theta (1 + k1 theta^2 + k2 theta^4 + k3 theta^6 + k4 theta^8)
+                    double theta = theta_d;
+                    for (int i = 0; i < 20; ++i)
+                    {
+                        const double t2 = theta * theta;
+                        const double f = theta * (1 + t2 * (k[0] + t2 * (k[1] + t2 * (k[2] + t2 * k[3])))) - theta_d;
+                        const double df = 1 + t2 * (3 * k[0] + t2 * (5 * k[1] + t2 * (7 * k[2] + t2 * 9 * k[3])));
+                        theta -= f / df;
+                    }
+                    theta = std::min(std::max(theta, 0.0), MAX_THETA);
+
+                    const double scale = std::tan(theta) / theta_d;
+                    x = xd * scale;
+                    y = yd * scale;
+                } break;
+            }
+        }
+
+        // The forward model undistort inverts, from pinhole coordinates on the z = 1 plane to distorted ones
+        void distort(const LensParameters& params, double x, double y, double& xd, double& yd)
+        {
+
+            const double* k = params.k;
+
+            switch (params.projection)
+            {
+                case LensProjection::PINHOLE:
+                {
+                    xd = x;
+                    yd = y;
+                } break;
+
+                case LensProjection::RADIAL_TANGENTIAL:
+                {
+                    const double r2 = x * x + y * y;
+                    const double radial = 1 + r2 * (k[0] + r2 * (k[1] + r2 * k[2]));
+                    xd = x * radial + 2 * params.p1 * x * y + params.p2 * (r2 + 2 * x * x);
+                    yd = y * radial + params.p1 * (r2 + 2 * y * y) + 2 * params.p2 * x * y;
+                } break;
+
+                case LensProjection::EQUIDISTANT:
+                {
+                    const double r = std::sqrt(x * x + y * y);
+                    if (r < 1e-12)
+                    {
+                        xd = x;
+                        yd = y;
+                        break;
+                    }
+
+                    const double theta = std::atan(r);
+                    const double t2 = theta * theta;
+                    const double theta_d = theta * (1 + t2 * (k[0] + t2 * (k[1] + t2 * (k[2] + t2 * k[3]))));
+                    xd = x * theta_d / r;
+                    yd = y * theta_d / r;
+                } break;
+            }
+        }
+
+#ifdef LENS_MODEL_X86
+        __attribute__((target("avx2")))
+        inline __m256i avx2_channel(__m256i p, int shift)
+        {
+            return _mm256_and_si256(_mm256_srli_epi32(p, shift), _mm256_set1_epi32(0xFF));
+        }
+
+        // Bilinear blend of 8 four byte pixels at a time, bit identical to the scalar loop
+        __attribute__((target("avx2")))
+        unsigned int avx2_remap_row(const PixelSource& src, const int32_t* lut_x, const int32_t* lut_y,
+                                    const int32_t* lut_weight, unsigned int width, uint8_t* dst)
+        {
+
+            const int* p00_base = reinterpret_cast<const int*>(src.data);
+            const int* p01_base = reinterpret_cast<const int*>(src.data + 4);
+            const int* p10_base = reinterpret_cast<const int*>(src.data + src.stride);
+            const int* p11_base = reinterpret_cast<const int*>(src.data + src.stride + 4);
+
+            const __m256i stride = _mm256_set1_epi32(int(src.stride));
+            const __m256i one = _mm256_set1_epi32(WEIGHT_ONE);
+            const __m256i low = _mm256_set1_epi32(0xFFFF);
+            const __m256i round = _mm256_set1_epi32(WEIGHT_ROUND);
+
+            unsigned int x = 0;
+            for (; x + 8 <= width; x += 8)
+            {
+
+                const __m256i xs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lut_x + x));
+                const __m256i ys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lut_y + x));
+                const __m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(ys, stride), _mm256_slli_epi32(xs, 2));
+
+                const __m256i p00 = _mm256_i32gather_epi32(p00_base, offset, 1);
+                const __m256i p01 = _mm256_i32gather_epi32(p01_base, offset, 1);
+                const __m256i p10 = _mm256_i32gather_epi32(p10_base, offset, 1);
+                const __m256i p11 = _mm256_i32gather_epi32(p11_base, offset, 1);
+
+                const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lut_weight + x));
+                const __m256i wx = _mm256_and_si256(w, low);
+                const __m256i wy = _mm256_srli_epi32(w, 16);
+                const __m256i iwx = _mm256_sub_epi32(one, wx);
+                const __m256i iwy = _mm256_sub_epi32(one, wy);
+
+                const __m256i w00 = _mm256_mullo_epi32(iwx, iwy);
+                const __m256i w01 = _mm256_mullo_epi32(wx, iwy);
+                const __m256i w10 = _mm256_mullo_epi32(iwx, wy);
+                const __m256i w11 = _mm256_mullo_epi32(wx, wy);
+
+                __m256i out = _mm256_setzero_si256();
+                for (int shift = 0; shift < 24; shift += 8)
+                {
+                    __m256i sum = _mm256_add_epi32(_mm256_mullo_epi32(avx2_channel(p00, shift), w00),
+                                                   _mm256_mullo_epi32(avx2_channel(p01, shift), w01));
+                    sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(avx2_channel(p10, shift), w10));
+                    sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(avx2_channel(p11, shift), w11));
+                    sum = _mm256_srli_epi32(_mm256_add_epi32(sum, round), WEIGHT_SHIFT);
+                    out = _mm256_or_si256(out, _mm256_slli_epi32(sum, shift));
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), out);
+            }
+
+            return x;
+        }
+#endif
+    }
+
+    LensProjection lens_projection_from_string(const std::string& projection)
+    {
+
+        if (projection == "pinhole")
+        {
+            return LensProjection::PINHOLE;
+        }
+        if (projection == "radial_tangential")
+        {
+            return LensProjection::RADIAL_TANGENTIAL;
+        }
+        if (projection == "equidistant")
+        {
+            return LensProjection::EQUIDISTANT;
+        }
+
+        throw std::invalid_argument("Unknown lens projection " + projection);
+    }
+
+    LensModel::LensModel()
+    : needs_remap(false)
+    , render_w(640)
+    , render_h(480)
+    , fov_y(0)
+    , tan_x(0)
+    , tan_y(0)
+    , use_avx2(false) {}
+
+    void LensModel::reset(const LensParameters& params)
+    {
+
+        if (params.width % 2 != 0)
+        {
+            throw std::invalid_argument("YUYV images need an even width");
+        }
+
+        this->params = params;
+
+        const size_t pixels = size_t(params.width) * params.height;
+
+        // Undistort every output pixel centre once, these are what the lookup table samples
+
+        std::vector<double> ux(pixels);
+        std::vector<double> uy(pixels);
+        double tx_max = 0;
+        double ty_max = 0;
+
+        for (unsigned int v = 0; v < params.height; ++v)
+        {
+            for (unsigned int u = 0; u < params.width; ++u)
+            {
+                const size_t i = size_t(v) * params.width + u;
+                undistort(params, (u + 0.5 - params.cx) / params.fx, (v + 0.5 - params.cy) / params.fy, ux[i], uy[i]);
+                tx_max = std::max(tx_max, std::abs(ux[i]));
+                ty_max = std::max(ty_max, std::abs(uy[i]));
+            }
+        }
+
+        // The frustum has to cover whole pixels, not just their centres, so also take the outer edges of the
+        // border pixels half a pixel further out. For a centred pinhole this is exactly (h / 2) / fy.
+        auto widen = [&] (double u, double v) {
+            double x = 0;
+            double y = 0;
+            undistort(params, (u - params.cx) / params.fx, (v - params.cy) / params.fy, x, y);
+            tx_max = std::max(tx_max, std::abs(x));
+            ty_max = std::max(ty_max, std::abs(y));
+        };
+        for (unsigned int u = 0; u <= params.width; ++u)
+        {
+            widen(u, 0);
+            widen(u, params.height);
+        }
+        for (unsigned int v = 0; v <= params.height; ++v)
+        {
+            widen(0, v);
+            widen(params.width, v);
+        }
+
+        tx_max = std::min(tx_max, std::tan(MAX_THETA));
+        ty_max = std::min(ty_max, std::tan(MAX_THETA));
+
+        needs_remap = params.projection != LensProjection::PINHOLE
+                   || std::abs(params.cx - params.width * 0.5) > 1e-6
+                   || std::abs(params.cy - params.height * 0.5) > 1e-6;
+
+        if (needs_remap)
+        {
+            // Square render pixels, as many vertically as render_scale asks for
+            double scale = params.render_scale;
+            double aspect = tx_max / ty_max;
+            double largest = std::max(params.height * scale * aspect, params.height * scale);
+            if (largest > MAX_RENDER_SIZE)
+            {
+                scale *= MAX_RENDER_SIZE / largest;
+            }
+            render_h = round_even(params.height * scale);
+            // round the width up so the square pixel render is never narrower than tx_max
+            render_w = std::min(MAX_RENDER_SIZE, 2 * (unsigned int) std::ceil(render_h * aspect / 2.0));
+        }
+        else
+        {
+            render_w = params.width;
+            render_h = params.height;
+        }
+        fov_y = 2.0 * std::atan(ty_max);
+        tan_y = ty_max;
+        // what the render actually spans across, Ogre derives it from fov_y and the aspect ratio
+        tan_x = needs_remap ? ty_max * render_w / render_h : tx_max;
+
+        lut_x.clear();
+        lut_y.clear();
+        lut_weight.clear();
+
+        if (needs_remap)
+        {
+            lut_x.resize(pixels);
+            lut_y.resize(pixels);
+            lut_weight.resize(pixels);
+
+            for (size_t i = 0; i < pixels; ++i)
+            {
+                // Continuous source coordinates with pixel centres on the integers, tan_x and tan_y being the
+                // outer edges of the render's border pixels just as the frustum was sized from pixel edges
+                double sx = (ux[i] / tan_x + 1.0) * render_w * 0.5 - 0.5;
+                double sy = (uy[i] / tan_y + 1.0) * render_h * 0.5 - 0.5;
+                sx = std::min(std::max(sx, 0.0), render_w - 1.0);
+                sy = std::min(std::max(sy, 0.0), render_h - 1.0);
+
+                const int x0 = std::min(int(sx), int(render_w) - 2);
+                const int y0 = std::min(int(sy), int(render_h) - 2);
+                const int wx = int(std::lround((sx - x0) * WEIGHT_ONE));
+                const int wy = int(std::lround((sy - y0) * WEIGHT_ONE));
+
+                lut_x[i] = x0;
+                lut_y[i] = y0;
+                lut_weight[i] = wx | (wy << 16);
+            }
+        }
+
+#ifdef LENS_MODEL_X86
+        use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    bool LensModel::remaps() const
+    {
+        return needs_remap;
+    }
+
+    unsigned int LensModel::width() const
+    {
+        return params.width;
+    }
+
+    unsigned int LensModel::height() const
+    {
+        return params.height;
+    }
+
+    unsigned int LensModel::render_width() const
+    {
+        return render_w;
+    }
+
+    unsigned int LensModel::render_height() const
+    {
+        return render_h;
+    }
+
+    double LensModel::render_fov_y() const
+    {
+        return fov_y;
+    }
+
+    PixelLayout LensModel::remapped_layout(PixelLayout layout)
+    {
+
+        switch (layout)
+        {
+            case PixelLayout::BGR: return PixelLayout::BGRX;
+            case PixelLayout::RGB: return PixelLayout::RGBX;
+            default: return layout;
+        }
+    }
+
+    void LensModel::remap_row(const PixelSource& src, unsigned int row, uint8_t* dst) const
+    {
+
+        const size_t n = YUYVConverter::bytes_per_pixel(src.layout);
+        const size_t first = size_t(row) * params.width;
+        const int32_t* xs = lut_x.data() + first;
+        const int32_t* ys = lut_y.data() + first;
+        const int32_t* weights = lut_weight.data() + first;
+
+        unsigned int x = 0;
+
+#ifdef LENS_MODEL_X86
+        if (use_avx2 && n == 4)
+        {
+            x = avx2_remap_row(src, xs, ys, weights, params.width, dst);
+        }
+#endif
+
+        for (; x < params.width; ++x)
+        {
+
+            const uint8_t* p00 = src.data + ys[x] * src.stride + xs[x] * n;
+            const uint8_t* p01 = p00 + n;
+            const uint8_t* p10 = p00 + src.stride;
+            const uint8_t* p11 = p10 + n;
+
+            const int wx = weights[x] & 0xFFFF;
+            const int wy = weights[x] >> 16;
+            const int w00 = (WEIGHT_ONE - wx) * (WEIGHT_ONE - wy);
+            const int w01 = wx * (WEIGHT_ONE - wy);
+            const int w10 = (WEIGHT_ONE - wx) * wy;
+            const int w11 = wx * wy;
+
+            uint8_t* out = dst + x * 4;
+            for (int c = 0; c < 3; ++c)
+            {
+                out[c] = uint8_t((p00[c] * w00 + p01[c] * w01 + p10[c] * w10 + p11[c] * w11 + WEIGHT_ROUND) >> WEIGHT_SHIFT);
+            }
+            out[3] = 0;
+        }
+    }
+
+    void LensModel::sample_row_nearest(const PixelSource& src, unsigned int row, unsigned int step, uint8_t* dst) const
+    {
+
+        const size_t n = YUYVConverter::bytes_per_pixel(src.layout);
+        const unsigned int out_width = params.width / step;
+
+        if (!needs_remap)
+        {
+            const uint8_t* in = src.data + size_t(row) * src.stride;
+            for (unsigned int x = 0; x < out_width; ++x)
+            {
+                dst[x] = in[x * n];
+            }
+            return;
+        }
+
+        // the sample's nearest render pixel is whichever corner of its 2x2 neighbourhood it weighs most
+        const size_t first = size_t(row) * step * params.width;
+        const unsigned int max_x = src.width - 1;
+        const unsigned int max_y = src.height - 1;
+
+        for (unsigned int x = 0; x < out_width; ++x)
+        {
+            const size_t i = first + size_t(x) * step;
+            const int wx = lut_weight[i] & 0xFFFF;
+            const int wy = lut_weight[i] >> 16;
+            const unsigned int sx = std::min((lut_x[i] + (wx * 2 >= WEIGHT_ONE)) / step, max_x);
+            const unsigned int sy = std::min((lut_y[i] + (wy * 2 >= WEIGHT_ONE)) / step, max_y);
+            dst[x] = src.data[sy * src.stride + sx * n];
+        }
+    }
+
+    void LensModel::project(double ndc_x, double ndc_y, double& u, double& v) const
+    {
+
+        if (!needs_remap)
+        {
+            u = (ndc_x + 1.0) * params.width * 0.5;
+            v = (1.0 - ndc_y) * params.height * 0.5;
+            return;
+        }
+
+        // the inverse of the lookup table, whose render rows run top down
+        double xd = 0;
+        double yd = 0;
+        distort(params, ndc_x * tan_x, -ndc_y * tan_y, xd, yd);
+        u = xd * params.fx + params.cx;
+        v = yd * params.fy + params.cy;
+    }
+
+}
+}
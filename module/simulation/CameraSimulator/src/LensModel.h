@@ -0,0 +1,129 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_LENSMODEL_H
+#define MODULE_SIMULATOR_LENSMODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "YUYVConverter.h"
+
+namespace module {
+namespace simulation {
+
+    enum class LensProjection {
+        /// An ideal pinhole, only remapped when the principal point is off centre
+        PINHOLE,
+        /// Pinhole with Brown-Conrady radial (k1, k2, k3) and tangential (p1, p2) distortion
+        RADIAL_TANGENTIAL,
+        /// Equidistant fisheye, r = f * theta(1 + k1 theta^2 + k2 theta^4 + k3 theta^6 + k4 theta^8)
+        EQUIDISTANT
+    };
+
+    LensProjection lens_projection_from_string(const std::string& projection);
+
+    /**
+     * Camera intrinsics in pixels of the output image. The k and p terms follow OpenCV's conventions for the
+     * same projection so calibrations of the real cameras can be pasted in.
+     */
+    struct LensParameters {
+        LensProjection projection = LensProjection::PINHOLE;
+        unsigned int width = 640;
+        unsigned int height = 480;
+        double fx = 0;
+        double fy = 0;
+        double cx = 0;
+        double cy = 0;
+        double k[4] = { 0, 0, 0, 0 };
+        double p1 = 0;
+        double p2 = 0;
+        /// Rendered pixels per output pixel along the vertical axis, to keep detail in the stretched centre
+        double render_scale = 1.5;
+    };
+
+    /**
+     * Produces lens distorted images from pinhole renders.
+     *
+     * Ogre can only render a pinhole projection, so the camera renders a symmetric pinhole frustum wide enough
+     * to cover every ray the lens sees and each output pixel is then bilinearly sampled from it. Where each
+     * output pixel samples from is computed once into a fixed point lookup table; each frame is only a gather
+     * and a blend, done a row at a time so it can be split across threads and fed straight to the YUYV
+     * converter.
+     */
+    class LensModel {
+    public:
+        LensModel();
+
+        void reset(const LensParameters& params);
+
+        /// @brief False when the render can be converted as is
+        bool remaps() const;
+
+        unsigned int width() const;
+        unsigned int height() const;
+
+        /// @brief The size and vertical field of view (in radians) the camera must render at
+        unsigned int render_width() const;
+        unsigned int render_height() const;
+        double render_fov_y() const;
+
+        /// @brief The four byte layout remap_row writes for a source layout
+        static PixelLayout remapped_layout(PixelLayout layout);
+
+        /// @brief Samples output row row from a render_width x render_height source into width pixels of remapped_layout
+        void remap_row(const PixelSource& src, unsigned int row, uint8_t* dst) const;
+
+        /**
+         * Fills a row of a width / step x height / step label image with the nearest source pixel to each
+         * sample, taking one byte per pixel. The source is rendered step times smaller than render_width x
+         * render_height. Blending neighbouring class ids would invent classes, hence no interpolation.
+         */
+        void sample_row_nearest(const PixelSource& src, unsigned int row, unsigned int step, uint8_t* dst) const;
+
+        /**
+         * Where a point of the render lands in the output image. The point is given in the render's normalised
+         * device coordinates (-1 to 1, y up) and (u, v) are continuous output pixel coordinates, (0, 0) being
+         * the top left corner of the first pixel. Points the render holds can still fall outside the output
+         * when the lens doesn't see all of it.
+         */
+        void project(double ndc_x, double ndc_y, double& u, double& v) const;
+
+    private:
+        LensParameters params;
+        bool needs_remap;
+        unsigned int render_w;
+        unsigned int render_h;
+        double fov_y;
+        // tangents of the render's half field of view across and down, which the lookup table samples within
+        double tan_x;
+        double tan_y;
+
+        // Per output pixel: the top left source pixel of the 2x2 neighbourhood and its Q7 weights (wx | wy << 16)
+        std::vector<int32_t> lut_x;
+        std::vector<int32_t> lut_y;
+        std::vector<int32_t> lut_weight;
+        bool use_avx2;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_LENSMODEL_H
@@ -0,0 +1,211 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace module {
+namespace simulation {
+
+    const char* profile_stage_name(ProfileStage stage)
+    {
+        switch (stage)
+        {
+            case ProfileStage::FRAME: return "frame";
+            case ProfileStage::CALCULATE_WORLD: return "calculate_world";
+            case ProfileStage::RENDER_ONE_FRAME: return "render_one_frame";
+            case ProfileStage::ANIMATE: return "animate";
+            case ProfileStage::SWAP_BUFFERS: return "swap_buffers";
+            case ProfileStage::RENDER_WORLDS: return "render_worlds";
+            case ProfileStage::GROUND_TRUTH: return "ground_truth";
+            case ProfileStage::READBACK: return "readback";
+            case ProfileStage::CONVERT: return "convert";
+            case ProfileStage::FORMAT_CONVERT: return "format_convert";
+            case ProfileStage::EMIT: return "emit";
+            case ProfileStage::LABELS: return "labels";
+            default: return "unknown";
+        }
+    }
+
+    constexpr unsigned int LatencyHistogram::SUB_BUCKETS;
+    constexpr unsigned int LatencyHistogram::OCTAVES;
+
+    LatencyHistogram::LatencyHistogram()
+    {
+        clear();
+    }
+
+    // Below SUB_BUCKETS every nanosecond has its own bucket, above it each power of two is split into
+    // SUB_BUCKETS buckets by the bits after the leading one
+    unsigned int LatencyHistogram::bucket(uint64_t ns)
+    {
+        if (ns < SUB_BUCKETS)
+        {
+            return ns;
+        }
+
+        const unsigned int exponent = 63 - __builtin_clzll(ns);
+        const unsigned int sub = (ns >> (exponent - 4)) - SUB_BUCKETS;
+        return std::min((exponent - 3) * SUB_BUCKETS + sub, SUB_BUCKETS * OCTAVES - 1);
+    }
+
+    // The middle of the bucket
+    uint64_t LatencyHistogram::bucket_value(unsigned int bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+        {
+            return bucket;
+        }
+
+        const unsigned int exponent = bucket / SUB_BUCKETS + 3;
+        const uint64_t lower = uint64_t(SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - 4);
+        return lower + ((uint64_t(1) << (exponent - 4)) >> 1);
+    }
+
+    void LatencyHistogram::record(std::chrono::nanoseconds latency)
+    {
+        const uint64_t ns = std::max<int64_t>(latency.count(), 0);
+        ++buckets[bucket(ns)];
+        ++total;
+        sum += ns;
+        largest = std::max(largest, ns);
+    }
+
+    void LatencyHistogram::clear()
+    {
+        buckets.fill(0);
+        total = 0;
+        sum = 0;
+        largest = 0;
+    }
+
+    uint64_t LatencyHistogram::count() const
+    {
+        return total;
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::max() const
+    {
+        return std::chrono::nanoseconds(largest);
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::mean() const
+    {
+        return std::chrono::nanoseconds(total ? sum / total : 0);
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::quantile(double q) const
+    {
+        if (total == 0)
+        {
+            return std::chrono::nanoseconds(0);
+        }
+
+        const uint64_t rank = std::max<uint64_t>(std::ceil(std::min(std::max(q, 0.0), 1.0) * total), 1);
+
+        uint64_t seen = 0;
+        for (unsigned int i = 0; i < buckets.size(); ++i)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+            {
+                return std::chrono::nanoseconds(std::min(bucket_value(i), largest));
+            }
+        }
+        return std::chrono::nanoseconds(largest);
+    }
+
+    Profiler::Profiler() : enabled(false) {}
+
+    void Profiler::reset(bool enabled, const std::string& csv_path)
+    {
+        this->enabled = enabled;
+
+        for (auto& stage : stages)
+        {
+            stage.clear();
+        }
+
+        csv.close();
+        if (enabled && !csv_path.empty())
+        {
+            csv.open(csv_path, std::ios::out | std::ios::app);
+            if (csv.tellp() == 0)
+            {
+                csv << "timestamp,stage,count,mean_us,p50_us,p95_us,p99_us,max_us\n";
+            }
+        }
+    }
+
+    void Profiler::record(ProfileStage stage, std::chrono::steady_clock::duration latency)
+    {
+        stages[size_t(stage)].record(std::chrono::duration_cast<std::chrono::nanoseconds>(latency));
+    }
+
+    message::simulation::FrameProfile Profiler::report(NUClear::clock::time_point timestamp, std::chrono::duration<double> interval)
+    {
+
+        message::simulation::FrameProfile profile;
+        profile.timestamp = timestamp;
+        profile.interval = interval;
+
+        auto seconds = [] (std::chrono::nanoseconds ns) {
+            return std::chrono::duration<double>(ns).count();
+        };
+
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            LatencyHistogram& histogram = stages[i];
+            if (histogram.count() == 0)
+            {
+                continue;
+            }
+
+            message::simulation::FrameProfile::Stage stage;
+            stage.name = profile_stage_name(ProfileStage(i));
+            stage.count = histogram.count();
+            stage.mean = seconds(histogram.mean());
+            stage.p50 = seconds(histogram.quantile(0.50));
+            stage.p95 = seconds(histogram.quantile(0.95));
+            stage.p99 = seconds(histogram.quantile(0.99));
+            stage.max = seconds(histogram.max());
+            profile.stages.push_back(stage);
+
+            histogram.clear();
+        }
+
+        if (csv.is_open())
+        {
+            const auto since_epoch = std::chrono::duration<double>(timestamp.time_since_epoch()).count();
+            for (const auto& stage : profile.stages)
+            {
+                csv << std::fixed << since_epoch << "," << stage.name << "," << stage.count
+                    << "," << stage.mean * 1e6 << "," << stage.p50 * 1e6 << "," << stage.p95 * 1e6
+                    << "," << stage.p99 * 1e6 << "," << stage.max * 1e6 << "\n";
+            }
+            csv.flush();
+        }
+
+        return profile;
+    }
+
+}
+}
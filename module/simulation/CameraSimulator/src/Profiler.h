@@ -0,0 +1,157 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_PROFILER_H
+#define MODULE_SIMULATOR_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "message/simulation/FrameProfile.h"
+
+// Defining CAMERA_SIMULATOR_NO_PROFILING compiles every PROFILE_STAGE out
+#ifdef CAMERA_SIMULATOR_NO_PROFILING
+#define PROFILE_STAGE(profiler, stage)
+#else
+#define PROFILE_STAGE_NAME2(line) profile_scope_##line
+#define PROFILE_STAGE_NAME(line) PROFILE_STAGE_NAME2(line)
+#define PROFILE_STAGE(profiler, stage) ::module::simulation::Profiler::Scope PROFILE_STAGE_NAME(__LINE__)(profiler, stage)
+#endif
+
+namespace module {
+namespace simulation {
+
+    /// The stages of a simulated frame, in the order they run
+    enum class ProfileStage {
+        /// The whole frame, from the scheduler letting it start to its images being emitted
+        FRAME,
+        CALCULATE_WORLD,
+        /// Ogre's renderOneFrame, which runs the frame listeners and so the animations
+        RENDER_ONE_FRAME,
+        ANIMATE,
+        SWAP_BUFFERS,
+        /// Rendering every active world into its readback ring
+        RENDER_WORLDS,
+        /// Projecting and emitting the ground truth of every rendered camera, part of RENDER_WORLDS
+        GROUND_TRUTH,
+        /// Locking the ready textures, which waits for the GPU if it hasn't finished them
+        READBACK,
+        /// Lens remap, YUYV conversion and sensor noise of every tile, across the worker pool
+        CONVERT,
+        /// Conversion from YUYV to the emitted format
+        FORMAT_CONVERT,
+        EMIT,
+        /// Reading back, sampling and emitting the label images
+        LABELS,
+        COUNT
+    };
+
+    const char* profile_stage_name(ProfileStage stage);
+
+    /**
+     * A histogram of latencies with buckets a fixed fraction of their value wide, so quantiles have the same
+     * relative error from nanoseconds to seconds. Recording is a couple of integer operations.
+     */
+    class LatencyHistogram {
+    public:
+        /// Buckets per power of two, each about 4.4% of its value wide
+        static constexpr unsigned int SUB_BUCKETS = 16;
+        static constexpr unsigned int OCTAVES = 40;
+
+        LatencyHistogram();
+
+        void record(std::chrono::nanoseconds latency);
+        void clear();
+
+        uint64_t count() const;
+        std::chrono::nanoseconds max() const;
+        std::chrono::nanoseconds mean() const;
+
+        /// @brief The latency q (0 to 1) of the recorded ones are at or below, 0 if none were recorded
+        std::chrono::nanoseconds quantile(double q) const;
+
+    private:
+        static unsigned int bucket(uint64_t ns);
+        static uint64_t bucket_value(unsigned int bucket);
+
+        std::array<uint32_t, SUB_BUCKETS * OCTAVES> buckets;
+        uint64_t total;
+        uint64_t sum;
+        uint64_t largest;
+    };
+
+    /**
+     * Times the stages of the frame pipeline into one histogram each.
+     *
+     * Stages are timed on the render thread only, work spread over the worker pool is timed as a whole.
+     * When disabled a Scope costs a branch; with CAMERA_SIMULATOR_NO_PROFILING it isn't compiled at all.
+     */
+    class Profiler {
+    public:
+        class Scope {
+        public:
+            Scope(Profiler& profiler, ProfileStage stage)
+            : profiler(profiler.enabled ? &profiler : nullptr)
+            , stage(stage) {
+                if (this->profiler) {
+                    start = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~Scope() {
+                if (profiler) {
+                    profiler->record(stage, std::chrono::steady_clock::now() - start);
+                }
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            Profiler* profiler;
+            ProfileStage stage;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        Profiler();
+
+        /**
+         * @param csv_path if not empty every report is also appended to this file as one row per stage
+         */
+        void reset(bool enabled, const std::string& csv_path);
+
+        void record(ProfileStage stage, std::chrono::steady_clock::duration latency);
+
+        /// @brief The stages recorded since the last report, clearing them for the next
+        message::simulation::FrameProfile report(NUClear::clock::time_point timestamp, std::chrono::duration<double> interval);
+
+        bool enabled;
+
+    private:
+        std::array<LatencyHistogram, size_t(ProfileStage::COUNT)> stages;
+        std::ofstream csv;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_PROFILER_H
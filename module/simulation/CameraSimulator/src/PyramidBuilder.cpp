@@ -0,0 +1,242 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "PyramidBuilder.h"
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define PYRAMID_BUILDER_X86
+    #include <immintrin.h>
+#endif
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        // Four input pixels (two YUYV pairs) of two rows make one output pair, luma from each 2x2 block and chroma
+        // from both pairs of both rows
+        void scalar_tail(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, unsigned int x, unsigned int width)
+        {
+            for (; x + 4 <= width; x += 4)
+            {
+                const uint8_t* a = top + x * 2;
+                const uint8_t* b = bottom + x * 2;
+                uint8_t* d = dst + x;
+                d[0] = (a[0] + a[2] + b[0] + b[2] + 2) >> 2;
+                d[1] = (a[1] + a[5] + b[1] + b[5] + 2) >> 2;
+                d[2] = (a[4] + a[6] + b[4] + b[6] + 2) >> 2;
+                d[3] = (a[3] + a[7] + b[3] + b[7] + 2) >> 2;
+            }
+        }
+
+        void scalar_kernel(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, unsigned int width)
+        {
+            scalar_tail(top, bottom, dst, 0, width);
+        }
+
+#ifdef PYRAMID_BUILDER_X86
+
+        /*
+         * SSE2: 8 pixels per step.
+         *
+         * The two rows are widened to 16 bits and added, then each pair of YUYV pairs [y0 u0 y1 v0 y2 u1 y3 v1] is
+         * reordered to [y0 y1 u0 v0 | y2 y3 u1 v1] so madd sums the luma of each block and adding the two halves
+         * sums the chroma. The low 64 bits of the result are [y0+y1, u0+u1, y2+y3, v0+v1].
+         */
+        __attribute__((target("sse2")))
+        inline __m128i sse2_halve_pairs(__m128i sums)
+        {
+
+            __m128i t = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sums, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+
+            // [y0+y1, y2+y3, ...] as 32 bit lanes
+            __m128i luma = _mm_shuffle_epi32(_mm_madd_epi16(t, _mm_set1_epi16(1)), _MM_SHUFFLE(3, 1, 2, 0));
+
+            // u0+u1 | v0+v1 << 16 in every 32 bit lane, then moved to the top half of the two lanes they go in
+            __m128i chroma = _mm_shuffle_epi32(_mm_add_epi16(t, _mm_srli_si128(t, 8)), _MM_SHUFFLE(1, 1, 1, 1));
+            chroma = _mm_unpacklo_epi32(_mm_slli_epi32(chroma, 16), _mm_and_si128(chroma, _mm_set1_epi32(0xFFFF0000)));
+
+            return _mm_or_si128(luma, chroma);
+        }
+
+        __attribute__((target("sse2")))
+        void sse2_kernel(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, unsigned int width)
+        {
+
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i round = _mm_set1_epi16(2);
+            unsigned int x = 0;
+
+            for (; x + 8 <= width; x += 8)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x * 2));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x * 2));
+
+                __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+                __m128i sums = _mm_unpacklo_epi64(sse2_halve_pairs(lo), sse2_halve_pairs(hi));
+                __m128i out = _mm_srli_epi16(_mm_add_epi16(sums, round), 2);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(out, out));
+            }
+
+            scalar_tail(top, bottom, dst, x, width);
+        }
+
+        /*
+         * AVX2: 16 pixels per step.
+         *
+         * Each 128 bit half of the widened row sums holds two YUYV pairs, so in lane shuffles gather the first and
+         * second sample of every output sample and adding them finishes the block. The halves come out as output
+         * pairs 0, 2 and 1, 3, which one cross lane permute puts in order.
+         */
+        __attribute__((target("avx2")))
+        inline __m256i avx2_row_sums(const uint8_t* top, const uint8_t* bottom)
+        {
+            return _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top))),
+                                    _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom))));
+        }
+
+        __attribute__((target("avx2")))
+        void avx2_kernel(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, unsigned int width)
+        {
+
+            // [y0 u0 y2 v0] and [y1 u1 y3 v1] of each half, into its low or high four 16 bit lanes
+            const __m256i first_lo = _mm256_setr_epi8(0, 1, 2, 3, 8, 9, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                      0, 1, 2, 3, 8, 9, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+            const __m256i second_lo = _mm256_setr_epi8(4, 5, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                       4, 5, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+            const __m256i first_hi = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 2, 3, 8, 9, 6, 7,
+                                                      -1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 2, 3, 8, 9, 6, 7);
+            const __m256i second_hi = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 4, 5, 10, 11, 12, 13, 14, 15,
+                                                       -1, -1, -1, -1, -1, -1, -1, -1, 4, 5, 10, 11, 12, 13, 14, 15);
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+            const __m256i round = _mm256_set1_epi16(2);
+            unsigned int x = 0;
+
+            for (; x + 16 <= width; x += 16)
+            {
+                __m256i s0 = avx2_row_sums(top + x * 2, bottom + x * 2);
+                __m256i s1 = avx2_row_sums(top + x * 2 + 16, bottom + x * 2 + 16);
+
+                __m256i sums = _mm256_add_epi16(_mm256_add_epi16(_mm256_shuffle_epi8(s0, first_lo), _mm256_shuffle_epi8(s0, second_lo)),
+                                                _mm256_add_epi16(_mm256_shuffle_epi8(s1, first_hi), _mm256_shuffle_epi8(s1, second_hi)));
+                __m256i out = _mm256_srli_epi16(_mm256_add_epi16(sums, round), 2);
+                out = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(out, out), order);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm256_castsi256_si128(out));
+            }
+
+            scalar_tail(top, bottom, dst, x, width);
+        }
+
+#endif  // PYRAMID_BUILDER_X86
+    }
+
+    PyramidBuilder::PyramidBuilder() : PyramidBuilder(YUYVConverter::best_kernel()) {}
+
+    PyramidBuilder::PyramidBuilder(ConversionKernel kernel) : base_width(0), total(0)
+    {
+
+        selected = YUYVConverter::is_supported(kernel) ? kernel : ConversionKernel::SCALAR;
+
+        switch (selected)
+        {
+#ifdef PYRAMID_BUILDER_X86
+            case ConversionKernel::AVX2: row_function = avx2_kernel; break;
+            case ConversionKernel::SSE2: row_function = sse2_kernel; break;
+#endif
+            default: row_function = scalar_kernel; break;
+        }
+    }
+
+    void PyramidBuilder::reset(unsigned int width, unsigned int height, unsigned int levels)
+    {
+
+        if (width % (2u << levels) != 0 || height % (1u << levels) != 0)
+        {
+            throw std::runtime_error("A " + std::to_string(width) + "x" + std::to_string(height) + " image can't be halved "
+                                     + std::to_string(levels) + " times into whole YUYV pixel pairs");
+        }
+
+        base_width = width;
+        level_layout.clear();
+        total = 0;
+        for (unsigned int i = 0; i < levels; ++i)
+        {
+            width /= 2;
+            height /= 2;
+            level_layout.push_back({ width, height, total });
+            total += size_t(width) * height * 2;
+        }
+    }
+
+    unsigned int PyramidBuilder::row_alignment() const
+    {
+        return 1u << level_layout.size();
+    }
+
+    const std::vector<message::input::ImagePyramid::Level>& PyramidBuilder::levels() const
+    {
+        return level_layout;
+    }
+
+    size_t PyramidBuilder::size() const
+    {
+        return total;
+    }
+
+    void PyramidBuilder::build_rows(const uint8_t* image, uint8_t* pyramid, unsigned int first_row, unsigned int last_row) const
+    {
+
+        // every level reads the rows of the one above it that this strip has just written
+        const uint8_t* src = image;
+        unsigned int src_width = base_width;
+
+        for (const auto& level : level_layout)
+        {
+            first_row /= 2;
+            last_row /= 2;
+            uint8_t* dst = pyramid + level.offset;
+
+            for (unsigned int row = first_row; row < last_row; ++row)
+            {
+                const uint8_t* top = src + size_t(row) * 2 * src_width * 2;
+                row_function(top, top + src_width * 2, dst + size_t(row) * level.width * 2, src_width);
+            }
+
+            src = dst;
+            src_width = level.width;
+        }
+    }
+
+    void PyramidBuilder::halve_row(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, unsigned int width) const
+    {
+        row_function(top, bottom, dst, width);
+    }
+
+    ConversionKernel PyramidBuilder::kernel() const
+    {
+        return selected;
+    }
+
+}
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_PYRAMIDBUILDER_H
+#define MODULE_SIMULATOR_PYRAMIDBUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "message/input/ImagePyramid.h"
+
+#include "YUYVConverter.h"
+
+namespace module {
+namespace simulation {
+
+    /**
+     * Builds the levels of a message::input::ImagePyramid from a YUYV image, a strip of rows at a time.
+     *
+     * Each level is a 2x2 box filter of the one above, rounded to nearest: luma from the four pixels under
+     * it and chroma from the two pixel pairs, so a level is exactly the mean of the YUYV samples it covers.
+     * A strip whose rows start and end on a multiple of 2^levels only reads its own rows, which lets the
+     * pyramid be built inside the conversion, straight after each strip is converted, while its rows are
+     * still in cache. Kernels are picked like the YUYVConverter's and all match the scalar one exactly.
+     */
+    class PyramidBuilder {
+    public:
+        /// @brief No levels, using the fastest kernel the running CPU supports
+        PyramidBuilder();
+        explicit PyramidBuilder(ConversionKernel kernel);
+
+        /**
+         * Lays out levels levels below a width x height image.
+         *
+         * @throws std::runtime_error if the width isn't a multiple of 2^(levels + 1) or the height of 2^levels,
+         *         so that every level is whole YUYV pixel pairs
+         */
+        void reset(unsigned int width, unsigned int height, unsigned int levels);
+
+        /// @brief The rows a strip has to start on, 2^levels
+        unsigned int row_alignment() const;
+
+        const std::vector<message::input::ImagePyramid::Level>& levels() const;
+
+        /// @brief Bytes of every level together
+        size_t size() const;
+
+        /**
+         * Downsamples rows [first_row, last_row) of image into every level of pyramid.
+         *
+         * @param first_row a multiple of row_alignment()
+         * @param last_row  a multiple of row_alignment(), or the image's height
+         */
+        void build_rows(const uint8_t* image, uint8_t* pyramid, unsigned int first_row, unsigned int last_row) const;
+
+        /**
+         * Halves two YUYV rows of width pixels into one of width / 2.
+         *
+         * @param width a multiple of 4
+         */
+        void halve_row(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, unsigned int width) const;
+
+        ConversionKernel kernel() const;
+
+    private:
+        using RowFunction = void (*)(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, unsigned int width);
+
+        ConversionKernel selected;
+        RowFunction row_function;
+
+        unsigned int base_width;
+        std::vector<message::input::ImagePyramid::Level> level_layout;
+        size_t total;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_PYRAMIDBUILDER_H
@@ -0,0 +1,246 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "RenderQuality.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <yaml-cpp/yaml.h>
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        // the longest a failed tier is waited out, in windows
+        const unsigned int MAX_COOLDOWN = 64;
+    }
+
+    ShadowQuality shadow_quality_from_string(const std::string& shadows)
+    {
+        if (shadows == "none")
+        {
+            return ShadowQuality::NONE;
+        }
+        if (shadows == "stencil_modulative")
+        {
+            return ShadowQuality::STENCIL_MODULATIVE;
+        }
+        if (shadows == "stencil_additive")
+        {
+            return ShadowQuality::STENCIL_ADDITIVE;
+        }
+        if (shadows == "texture_modulative")
+        {
+            return ShadowQuality::TEXTURE_MODULATIVE;
+        }
+        throw std::runtime_error("Unknown shadow technique " + shadows
+                                 + ", expected none, stencil_modulative, stencil_additive or texture_modulative");
+    }
+
+    TextureFiltering texture_filtering_from_string(const std::string& filtering)
+    {
+        if (filtering == "none")
+        {
+            return TextureFiltering::NONE;
+        }
+        if (filtering == "bilinear")
+        {
+            return TextureFiltering::BILINEAR;
+        }
+        if (filtering == "trilinear")
+        {
+            return TextureFiltering::TRILINEAR;
+        }
+        if (filtering == "anisotropic")
+        {
+            return TextureFiltering::ANISOTROPIC;
+        }
+        throw std::runtime_error("Unknown texture filtering " + filtering + ", expected none, bilinear, trilinear or anisotropic");
+    }
+
+    QualityTier QualityTier::parse(const YAML::Node& node)
+    {
+
+        QualityTier tier;
+        tier.name = node["name"] ? node["name"].as<std::string>() : "";
+        if (node["shadows"])
+        {
+            tier.shadows = shadow_quality_from_string(node["shadows"].as<std::string>());
+        }
+        if (node["filtering"])
+        {
+            tier.filtering = texture_filtering_from_string(node["filtering"].as<std::string>());
+        }
+        if (node["anisotropy"])
+        {
+            tier.anisotropy = std::max(node["anisotropy"].as<unsigned int>(), 1u);
+        }
+        if (node["mipmaps"])
+        {
+            tier.mipmaps = node["mipmaps"].as<unsigned int>();
+        }
+        if (node["sky"])
+        {
+            tier.sky = node["sky"].as<bool>();
+        }
+        if (node["lod_bias"])
+        {
+            tier.lod_bias = node["lod_bias"].as<float>();
+        }
+        if (node["shadow_casters"])
+        {
+            tier.stadium_shadows = tier.ball_shadows = tier.robot_shadows = false;
+            for (const auto& caster : node["shadow_casters"].as<std::vector<std::string>>())
+            {
+                if (caster == "stadium")
+                {
+                    tier.stadium_shadows = true;
+                }
+                else if (caster == "ball")
+                {
+                    tier.ball_shadows = true;
+                }
+                else if (caster == "robots")
+                {
+                    tier.robot_shadows = true;
+                }
+                else
+                {
+                    throw std::runtime_error("Unknown shadow caster " + caster + ", expected stadium, ball or robots");
+                }
+            }
+        }
+        return tier;
+    }
+
+    std::vector<QualityTier> default_quality_tiers()
+    {
+
+        QualityTier low;
+        low.name = "low";
+        low.shadows = ShadowQuality::NONE;
+        low.filtering = TextureFiltering::BILINEAR;
+        low.anisotropy = 1;
+        low.mipmaps = 0;
+        low.sky = false;
+        low.lod_bias = 0.5f;
+        low.stadium_shadows = low.ball_shadows = low.robot_shadows = false;
+
+        QualityTier medium;
+        medium.name = "medium";
+        medium.shadows = ShadowQuality::STENCIL_MODULATIVE;
+        medium.filtering = TextureFiltering::TRILINEAR;
+        medium.anisotropy = 1;
+        medium.mipmaps = 3;
+        medium.lod_bias = 0.75f;
+        medium.stadium_shadows = false;
+
+        QualityTier high;
+        high.name = "high";
+
+        return { low, medium, high };
+    }
+
+    QualityController::QualityController()
+    {
+        reset(1, 0, 0.0, 1, 0.0, 1);
+    }
+
+    void QualityController::reset(size_t tiers, size_t start, double target_rate, unsigned int window, double headroom,
+                                  unsigned int cooldown)
+    {
+        tier_count = std::max(tiers, size_t(1));
+        current = std::min(start, tier_count - 1);
+        budget = target_rate > 0.0 ? 1.0 / target_rate : 0.0;
+        this->window = std::max(window, 1u);
+        this->headroom = headroom;
+        base_cooldown = std::max(cooldown, 1u);
+        this->cooldown = base_cooldown;
+
+        frames = 0;
+        total = 0.0;
+        last_mean = 0.0;
+        windows_held = 0;
+        raised = false;
+        // the first frame is as slow as the loading it finishes
+        settling = true;
+    }
+
+    bool QualityController::record(std::chrono::steady_clock::duration frame_time)
+    {
+
+        if (budget <= 0.0 || tier_count < 2)
+        {
+            return false;
+        }
+
+        // the first frame after a change pays for the change itself, which says nothing about the tier
+        if (settling)
+        {
+            settling = false;
+            return false;
+        }
+
+        total += std::chrono::duration<double>(frame_time).count();
+        if (++frames < window)
+        {
+            return false;
+        }
+
+        last_mean = total / frames;
+        total = 0.0;
+        frames = 0;
+        ++windows_held;
+
+        if (last_mean > budget && current > 0)
+        {
+            cooldown = raised && windows_held == 1 ? std::min(cooldown * 2, MAX_COOLDOWN) : base_cooldown;
+            --current;
+            raised = false;
+            windows_held = 0;
+            settling = true;
+            return true;
+        }
+
+        if (last_mean < budget * (1.0 - headroom) && current + 1 < tier_count && windows_held >= cooldown)
+        {
+            ++current;
+            raised = true;
+            windows_held = 0;
+            settling = true;
+            return true;
+        }
+
+        return false;
+    }
+
+    size_t QualityController::tier() const
+    {
+        return current;
+    }
+
+    double QualityController::mean_frame_time() const
+    {
+        return last_mean;
+    }
+
+}
+}
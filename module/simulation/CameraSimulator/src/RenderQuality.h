@@ -0,0 +1,122 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_RENDERQUALITY_H
+#define MODULE_SIMULATOR_RENDERQUALITY_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace YAML {
+    class Node;
+}
+
+namespace module {
+namespace simulation {
+
+    enum class ShadowQuality { NONE, STENCIL_MODULATIVE, STENCIL_ADDITIVE, TEXTURE_MODULATIVE };
+
+    enum class TextureFiltering { NONE, BILINEAR, TRILINEAR, ANISOTROPIC };
+
+    ShadowQuality shadow_quality_from_string(const std::string& shadows);
+    TextureFiltering texture_filtering_from_string(const std::string& filtering);
+
+    /// How well the worlds are rendered, everything that trades image quality for frame time
+    struct QualityTier {
+        std::string name;
+        ShadowQuality shadows = ShadowQuality::STENCIL_ADDITIVE;
+        TextureFiltering filtering = TextureFiltering::ANISOTROPIC;
+        unsigned int anisotropy = 8;
+        /// Textures are only loaded once, so only the starting tier's mipmaps are used
+        unsigned int mipmaps = 5;
+        bool sky = true;
+        /// Multiplies the distance meshes and materials switch level of detail at, lower is coarser
+        float lod_bias = 1.0f;
+        /// Which of the stadium, ball and robots cast shadows, of the entities described as casting them
+        bool stadium_shadows = true;
+        bool ball_shadows = true;
+        bool robot_shadows = true;
+
+        /**
+         * Reads a tier, { name, shadows, filtering, anisotropy, mipmaps, sky, lod_bias, shadow_casters } where
+         * shadow_casters lists any of stadium, ball and robots. Missing values are the high tier's.
+         *
+         * @throws std::runtime_error if a value isn't one of the choices above
+         */
+        static QualityTier parse(const YAML::Node& node);
+    };
+
+    /// @brief low, medium and high, cheapest first. high is everything on
+    std::vector<QualityTier> default_quality_tiers();
+
+    /**
+     * Moves between quality tiers to hold a target frame rate.
+     *
+     * Frame times are averaged over windows of frames. A window over the frame budget steps down a tier
+     * straight away; one with headroom to spare steps up once the tier has been held for cooldown windows.
+     * A tier that is too slow again as soon as it is stepped up to doubles the wait before it is next tried,
+     * so a budget that sits between two tiers settles on the cheaper one instead of flickering.
+     */
+    class QualityController {
+    public:
+        /// @brief Never changes tier
+        QualityController();
+
+        /**
+         * @param tiers       number of tiers, cheapest first
+         * @param start       the tier to start in
+         * @param target_rate frames per second to hold, 0 never changes tier
+         * @param window      frames averaged for each decision
+         * @param headroom    fraction of the budget a window has to leave spare before the next tier is tried
+         * @param cooldown    windows a tier is held before the next one up is tried
+         */
+        void reset(size_t tiers, size_t start, double target_rate, unsigned int window, double headroom,
+                   unsigned int cooldown);
+
+        /// @brief Adds the time one frame took, returning true if tier() has changed
+        bool record(std::chrono::steady_clock::duration frame_time);
+
+        size_t tier() const;
+
+        /// @brief The mean frame time of the last whole window, in seconds
+        double mean_frame_time() const;
+
+    private:
+        size_t tier_count;
+        size_t current;
+        double budget;
+        unsigned int window;
+        double headroom;
+        unsigned int base_cooldown;
+        unsigned int cooldown;
+
+        unsigned int frames;
+        double total;
+        double last_mean;
+        unsigned int windows_held;
+        bool raised;
+        bool settling;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_RENDERQUALITY_H
@@ -0,0 +1,149 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "RenderTextureRing.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <OgreHardwarePixelBuffer.h>
+#include <OgreRenderTexture.h>
+#include <OgreStringConverter.h>
+#include <OgreViewport.h>
+
+namespace module {
+namespace simulation {
+
+    RenderTextureRing::RenderTextureRing(const Ogre::String& name
+                                       , const std::vector<Ogre::Camera*>& cameras
+                                       , unsigned int tile_width
+                                       , unsigned int tile_height
+                                       , Ogre::PixelFormat format
+                                       , size_t depth
+                                       , Ogre::RenderTargetListener* listener)
+    : frames(std::max<size_t>(depth, 1))
+    , head(0)
+    , pending(0) {
+
+        // Lay the cameras out on the squarest grid that fits them
+
+        const unsigned int columns = std::ceil(std::sqrt(double(cameras.size())));
+        const unsigned int rows = (cameras.size() + columns - 1) / columns;
+
+        for (size_t i = 0; i < cameras.size(); ++i)
+        {
+            tile_origins.push_back({ unsigned(i % columns) * tile_width, unsigned(i / columns) * tile_height });
+        }
+
+        for (size_t i = 0; i < frames.size(); ++i)
+        {
+            frames[i].texture = Ogre::TextureManager::getSingleton().createManual(name + Ogre::StringConverter::toString(i),
+                    Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, Ogre::TEX_TYPE_2D,
+                    columns * tile_width, rows * tile_height, 0, format, Ogre::TU_RENDERTARGET);
+
+            Ogre::RenderTexture* target = frames[i].texture->getBuffer()->getRenderTarget();
+
+            // We decide when each texture is rendered, not renderOneFrame
+            target->setAutoUpdated(false);
+
+            for (size_t c = 0; c < cameras.size(); ++c)
+            {
+                Ogre::Viewport* viewport = target->addViewport(cameras[c], c
+                        , Ogre::Real(tile_origins[c].x) / (columns * tile_width)
+                        , Ogre::Real(tile_origins[c].y) / (rows * tile_height)
+                        , Ogre::Real(1) / columns
+                        , Ogre::Real(1) / rows);
+                viewport->setClearEveryFrame(true);
+                viewport->setBackgroundColour(Ogre::ColourValue::Black);
+                viewport->setOverlaysEnabled(false);
+            }
+
+            if (listener)
+            {
+                target->addListener(listener);
+            }
+        }
+    }
+
+    RenderTextureRing::~RenderTextureRing()
+    {
+        for (auto& frame : frames)
+        {
+            Ogre::TextureManager::getSingleton().remove(frame.texture->getHandle());
+        }
+    }
+
+    void RenderTextureRing::render(NUClear::clock::time_point timestamp)
+    {
+        Frame& frame = frames[(head + pending) % frames.size()];
+
+        frame.timestamp = timestamp;
+        frame.texture->getBuffer()->getRenderTarget()->update(false);
+
+        ++pending;
+    }
+
+    bool RenderTextureRing::full() const
+    {
+        return pending == frames.size();
+    }
+
+    bool RenderTextureRing::empty() const
+    {
+        return pending == 0;
+    }
+
+    const RenderTextureRing::Frame& RenderTextureRing::oldest() const
+    {
+        return frames[head];
+    }
+
+    void RenderTextureRing::pop()
+    {
+        head = (head + 1) % frames.size();
+        --pending;
+    }
+
+    size_t RenderTextureRing::depth() const
+    {
+        return frames.size();
+    }
+
+    const std::vector<RenderTextureRing::Tile>& RenderTextureRing::tiles() const
+    {
+        return tile_origins;
+    }
+
+    void RenderTextureRing::set_material_scheme(const Ogre::String& scheme, bool skies, bool shadows)
+    {
+        for (auto& frame : frames)
+        {
+            Ogre::RenderTexture* target = frame.texture->getBuffer()->getRenderTarget();
+            for (unsigned short i = 0; i < target->getNumViewports(); ++i)
+            {
+                Ogre::Viewport* viewport = target->getViewport(i);
+                viewport->setMaterialScheme(scheme);
+                viewport->setSkiesEnabled(skies);
+                viewport->setShadowsEnabled(shadows);
+            }
+        }
+    }
+
+}
+}
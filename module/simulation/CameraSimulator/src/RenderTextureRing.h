@@ -0,0 +1,100 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_RENDERTEXTURERING_H
+#define MODULE_SIMULATOR_RENDERTEXTURERING_H
+
+#include <nuclear>
+#include <vector>
+
+#include <OgreCamera.h>
+#include <OgreRenderTargetListener.h>
+#include <OgreTextureManager.h>
+
+namespace module {
+namespace simulation {
+
+    /**
+     * A ring of render textures that are rendered to and read back in FIFO order.
+     *
+     * Locking a render texture straight after rendering to it waits for the GPU to finish that frame.
+     * Instead each frame is rendered into the next free texture and only read back once depth - 1 newer
+     * frames have been queued behind it, by which point the driver has long finished with it. A depth
+     * of 1 is the old synchronous behaviour.
+     *
+     * Each texture is an atlas with one tile_width x tile_height viewport per camera laid out on a grid,
+     * so any number of cameras are rendered and read back in a single pass.
+     */
+    class RenderTextureRing {
+    public:
+        struct Frame {
+            Ogre::TexturePtr texture;
+            /// The time the frame was rendered, not the time it was read back
+            NUClear::clock::time_point timestamp;
+        };
+
+        struct Tile {
+            unsigned int x;
+            unsigned int y;
+        };
+
+        RenderTextureRing(const Ogre::String& name
+                        , const std::vector<Ogre::Camera*>& cameras
+                        , unsigned int tile_width
+                        , unsigned int tile_height
+                        , Ogre::PixelFormat format
+                        , size_t depth
+                        , Ogre::RenderTargetListener* listener);
+        ~RenderTextureRing();
+
+        RenderTextureRing(const RenderTextureRing&) = delete;
+        RenderTextureRing& operator=(const RenderTextureRing&) = delete;
+
+        /// @brief Renders the camera into the next texture. Must not be called while full()
+        void render(NUClear::clock::time_point timestamp);
+
+        /// @brief True when every texture holds a frame that has not been read back
+        bool full() const;
+        bool empty() const;
+
+        /// @brief The oldest frame that has not been read back
+        const Frame& oldest() const;
+
+        /// @brief Releases the oldest frame so its texture can be rendered to again
+        void pop();
+
+        size_t depth() const;
+
+        /// @brief The top left pixel of each camera's viewport in the atlas, in the order the cameras were given
+        const std::vector<Tile>& tiles() const;
+
+        /// @brief Renders every viewport with a material scheme, and optionally without the sky and shadows
+        void set_material_scheme(const Ogre::String& scheme, bool skies, bool shadows);
+
+    private:
+        std::vector<Frame> frames;
+        std::vector<Tile> tile_origins;
+        size_t head;
+        size_t pending;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_RENDERTEXTURERING_H
@@ -0,0 +1,189 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "ResourceLoader.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include <OgreConfigFile.h>
+#include <OgreMaterialManager.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreRoot.h>
+#include <OgreTechnique.h>
+#include <OgreWorkQueue.h>
+
+namespace module {
+namespace simulation {
+
+    void ResourceLoader::declare(const std::string& config_file)
+    {
+        Ogre::ConfigFile cf;
+        cf.load(config_file);
+
+        Ogre::ConfigFile::SectionIterator seci = cf.getSectionIterator();
+        while (seci.hasMoreElements())
+        {
+            Ogre::String sec_name = seci.peekNextKey();
+            Ogre::ConfigFile::SettingsMultiMap* settings = seci.getNext();
+
+            for (auto i = settings->begin(); i != settings->end(); ++i)
+            {
+                Ogre::ResourceGroupManager::getSingleton().addResourceLocation(i->second, i->first, sec_name);
+            }
+
+            if (!settings->empty() && std::find(declared_groups.begin(), declared_groups.end(), sec_name) == declared_groups.end())
+            {
+                declared_groups.push_back(sec_name);
+            }
+        }
+    }
+
+    void ResourceLoader::initialise(const std::vector<std::string>& groups)
+    {
+        for (const auto& group : groups.empty() ? declared_groups : groups)
+        {
+            if (!Ogre::ResourceGroupManager::getSingleton().resourceGroupExists(group))
+            {
+                std::cout << "Resource group " << group << " is not declared in resources.cfg\n";
+                continue;
+            }
+            Ogre::ResourceGroupManager::getSingleton().initialiseResourceGroup(group);
+        }
+    }
+
+    void ResourceLoader::prefetch(const SceneCache& scene, const std::vector<std::string>& extra_materials)
+    {
+        for (size_t i = 0; i < scene.entity_count(); ++i)
+        {
+            const SceneEntityRecord& entity = scene.entities()[i];
+
+            Ogre::String mesh = scene.string(entity.mesh);
+            if (mesh != "plane")
+                prepare("Mesh", mesh);
+
+            prepare_material(scene.string(entity.material));
+        }
+
+        for (const auto& name : extra_materials)
+            prepare_material(name);
+    }
+
+    void ResourceLoader::prefetch(const RobotModel& robot)
+    {
+        for (const auto& entity : robot.entities)
+        {
+            prepare("Mesh", entity.mesh);
+            prepare_material(entity.material);
+            if (!entity.instanced_material.empty())
+                prepare_material(entity.instanced_material);
+        }
+    }
+
+    void ResourceLoader::wait()
+    {
+        Ogre::ResourceBackgroundQueue& queue = Ogre::ResourceBackgroundQueue::getSingleton();
+        Ogre::WorkQueue* work_queue = Ogre::Root::getSingleton().getWorkQueue();
+
+        // Responses are delivered on this thread, so keep pumping them until every ticket is done
+        for (auto ticket : tickets)
+        {
+            while (!queue.isProcessComplete(ticket))
+            {
+                work_queue->processResponses();
+                std::this_thread::yield();
+            }
+        }
+        tickets.clear();
+
+        // Uploading to the GPU has to happen here on the render thread
+        for (const auto& name : materials)
+        {
+            Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().getByName(name);
+            if (!material.isNull())
+                material->load();
+        }
+    }
+
+    void ResourceLoader::set_texture_filtering(Ogre::TextureFilterOptions filtering, unsigned int anisotropy)
+    {
+        for (const auto& name : materials)
+        {
+            Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().getByName(name);
+            if (!material.isNull())
+            {
+                material->setTextureFiltering(filtering);
+                material->setTextureAnisotropy(anisotropy);
+            }
+        }
+    }
+
+    size_t ResourceLoader::queued() const
+    {
+        return requested.size();
+    }
+
+    void ResourceLoader::prepare_material(const Ogre::String& name)
+    {
+        if (!materials.insert(name).second)
+            return;
+
+        // Materials are already parsed, their textures are what is worth reading in the background
+
+        Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().getByName(name);
+        if (material.isNull())
+            return;
+
+        Ogre::Material::TechniqueIterator techniques = material->getTechniqueIterator();
+        while (techniques.hasMoreElements())
+        {
+            Ogre::Technique::PassIterator passes = techniques.getNext()->getPassIterator();
+            while (passes.hasMoreElements())
+            {
+                Ogre::Pass::TextureUnitStateIterator units = passes.getNext()->getTextureUnitStateIterator();
+                while (units.hasMoreElements())
+                {
+                    Ogre::TextureUnitState* unit = units.getNext();
+                    for (unsigned int frame = 0; frame < unit->getNumFrames(); ++frame)
+                    {
+                        const Ogre::String& texture = unit->getFrameTextureName(frame);
+                        if (!texture.empty())
+                            prepare("Texture", texture);
+                    }
+                }
+            }
+        }
+    }
+
+    void ResourceLoader::prepare(const Ogre::String& type, const Ogre::String& name)
+    {
+        if (!requested.insert(std::make_pair(type, name)).second)
+            return;
+
+        // Resources the scene names that no location declares are left for Ogre to complain about when used
+        if (!Ogre::ResourceGroupManager::getSingleton().resourceExistsInAnyGroup(name))
+            return;
+
+        const Ogre::String& group = Ogre::ResourceGroupManager::getSingleton().findGroupContainingResource(name);
+        tickets.push_back(Ogre::ResourceBackgroundQueue::getSingleton().prepare(type, name, group));
+    }
+
+}
+}
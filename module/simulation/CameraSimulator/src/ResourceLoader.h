@@ -0,0 +1,81 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_RESOURCELOADER_H
+#define MODULE_SIMULATOR_RESOURCELOADER_H
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <OgreCommon.h>
+#include <OgreResourceBackgroundQueue.h>
+#include <OgreString.h>
+
+#include "RobotModel.h"
+#include "SceneCache.h"
+
+namespace module {
+namespace simulation {
+
+    /**
+     * Declares the resources in resources.cfg without loading them, then loads only what a scene uses.
+     *
+     * initialiseAllResourceGroups parses the scripts of every group listed, sample media included. Instead only
+     * the groups asked for are initialised, and the meshes and textures the scene references are prepared
+     * (read and decoded) on Ogre's work queue threads while the rest of startup carries on. wait() then
+     * finishes them on the render thread, which is the only one allowed to touch the GPU.
+     */
+    class ResourceLoader {
+    public:
+        /// @brief Adds every location in config_file, remembering the groups it declares
+        void declare(const std::string& config_file);
+
+        /// @brief Parses the scripts of the given groups, or of every declared group if none are given. Groups
+        ///        resources.cfg doesn't declare are skipped
+        void initialise(const std::vector<std::string>& groups);
+
+        /// @brief Starts preparing the scene's meshes and the textures of its materials and any extra materials
+        void prefetch(const SceneCache& scene, const std::vector<std::string>& extra_materials);
+
+        /// @brief Starts preparing a robot's meshes and the textures of its materials
+        void prefetch(const RobotModel& robot);
+
+        /// @brief Blocks until everything prefetched is prepared, then loads the materials
+        void wait();
+
+        /// @brief Changes the texture filtering of every material loaded so far
+        void set_texture_filtering(Ogre::TextureFilterOptions filtering, unsigned int anisotropy);
+
+        size_t queued() const;
+
+    private:
+        void prepare_material(const Ogre::String& name);
+        void prepare(const Ogre::String& type, const Ogre::String& name);
+
+        std::vector<std::string> declared_groups;
+        std::set<Ogre::String> materials;
+        std::set<std::pair<Ogre::String, Ogre::String>> requested;
+        std::vector<Ogre::BackgroundProcessTicket> tickets;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_RESOURCELOADER_H
@@ -0,0 +1,199 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "RobotFactory.h"
+
+#include <algorithm>
+
+#include <OgreEntity.h>
+#include <OgreInstancedEntity.h>
+#include <OgreMaterialManager.h>
+#include <OgreMeshManager.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreRoot.h>
+#include <OgreStringConverter.h>
+
+namespace module {
+namespace simulation {
+
+    RobotFactory::RobotFactory(Ogre::SceneManager* scene_mgr, const RobotModel& model, bool instancing, size_t robots_per_batch)
+    : scene_mgr(scene_mgr)
+    , model(model) {
+
+        const Ogre::RenderSystemCapabilities* caps = Ogre::Root::getSingleton().getRenderSystem()->getCapabilities();
+        instancing = instancing && caps->hasCapability(Ogre::RSC_VERTEX_BUFFER_INSTANCE_DATA);
+
+        for (size_t i = 0; i < model.entities.size(); ++i)
+        {
+            const RobotEntity& entity = model.entities[i];
+            const Ogre::String group = Ogre::ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME;
+
+            meshes.push_back(Ogre::MeshManager::getSingleton().load(entity.mesh, group));
+            materials.push_back(Ogre::MaterialManager::getSingleton().getByName(entity.material));
+
+            // one manager per mesh, made the first time a mesh is seen
+            Ogre::InstanceManager* manager = nullptr;
+            if (instancing && !entity.instanced_material.empty())
+            {
+                for (size_t j = 0; j < i; ++j)
+                {
+                    if (model.entities[j].mesh == entity.mesh && instance_managers[j])
+                    {
+                        manager = instance_managers[j];
+                    }
+                }
+
+                if (!manager)
+                {
+                    manager = scene_mgr->createInstanceManager("Robot/" + Ogre::StringConverter::toString(i)
+                                                             , entity.mesh
+                                                             , group
+                                                             , Ogre::InstanceManager::HWInstancingBasic
+                                                             , robots_per_batch);
+                    manager->setSetting(Ogre::InstanceManager::CAST_SHADOWS, entity.cast_shadows);
+                }
+            }
+            instance_managers.push_back(manager);
+        }
+
+        for (const auto& joint : model.joints)
+        {
+            const RobotLink& link = model.links[joint.link];
+            rest.emplace_back(link.orientation[0], link.orientation[1], link.orientation[2], link.orientation[3]);
+            axes.emplace_back(joint.axis[0], joint.axis[1], joint.axis[2]);
+        }
+    }
+
+    size_t RobotFactory::spawn(const RobotPlacement& placement)
+    {
+
+        Robot robot;
+        robot.root = scene_mgr->getRootSceneNode()->createChildSceneNode();
+        robot.root->setScale(model.scale, model.scale, model.scale);
+        robot.joints.resize(model.joints.size());
+
+        // links always come after their parents so one pass builds the whole robot
+
+        std::vector<Ogre::SceneNode*> nodes(model.links.size());
+        for (size_t i = 0; i < model.links.size(); ++i)
+        {
+            const RobotLink& link = model.links[i];
+
+            Ogre::SceneNode* parent = link.parent < 0 ? robot.root : nodes[link.parent];
+            Ogre::SceneNode* node = parent->createChildSceneNode();
+            node->setPosition(link.position[0], link.position[1], link.position[2]);
+            node->setOrientation(link.orientation[0], link.orientation[1], link.orientation[2], link.orientation[3]);
+            nodes[i] = node;
+
+            if (link.joint >= 0)
+            {
+                robot.joints[link.joint] = node;
+            }
+
+            for (uint32_t j = link.first_entity; j < link.first_entity + link.entity_count; ++j)
+            {
+                if (instance_managers[j])
+                {
+                    Ogre::InstancedEntity* entity = scene_mgr->createInstancedEntity(model.entities[j].instanced_material
+                                                                                    , instance_managers[j]->getName());
+                    node->attachObject(entity);
+                }
+                else
+                {
+                    Ogre::Entity* entity = scene_mgr->createEntity(meshes[j]);
+                    if (!materials[j].isNull())
+                    {
+                        entity->setMaterial(materials[j]);
+                    }
+                    entity->setCastShadows(model.entities[j].cast_shadows);
+                    node->attachObject(entity);
+
+                    if (model.entities[j].cast_shadows)
+                    {
+                        casters.push_back(entity);
+                    }
+                }
+            }
+        }
+
+        robots.push_back(robot);
+        place(robots.size() - 1, placement);
+
+        return robots.size() - 1;
+    }
+
+    void RobotFactory::place(size_t robot, const RobotPlacement& placement)
+    {
+        robots[robot].root->setPosition(placement.position);
+        robots[robot].root->setOrientation(Ogre::Quaternion(placement.yaw, Ogre::Vector3::UNIT_Y));
+    }
+
+    void RobotFactory::set_joint_angles(const float* angles, size_t count)
+    {
+
+        const size_t joints = model.joints.size();
+        count = std::min(count, robots.size() * joints);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t joint = i % joints;
+            robots[i / joints].joints[joint]->setOrientation(rest[joint] * Ogre::Quaternion(Ogre::Radian(angles[i]), axes[joint]));
+        }
+    }
+
+    size_t RobotFactory::size() const
+    {
+        return robots.size();
+    }
+
+    size_t RobotFactory::joint_count() const
+    {
+        return model.joints.size();
+    }
+
+    Ogre::AxisAlignedBox RobotFactory::bounds(size_t robot) const
+    {
+        // scene nodes merge their children's bounds into their own when the scene graph is updated
+        return robots[robot].root->_getWorldAABB();
+    }
+
+    void RobotFactory::set_cast_shadows(bool cast)
+    {
+        for (auto entity : casters)
+        {
+            entity->setCastShadows(cast);
+        }
+    }
+
+    size_t RobotFactory::instanced_meshes() const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < instance_managers.size(); ++i)
+        {
+            if (instance_managers[i] && std::find(instance_managers.begin(), instance_managers.begin() + i, instance_managers[i])
+                                            == instance_managers.begin() + i)
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+}
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_ROBOTFACTORY_H
+#define MODULE_SIMULATOR_ROBOTFACTORY_H
+
+#include <vector>
+
+#include <OgreAxisAlignedBox.h>
+#include <OgreInstanceManager.h>
+#include <OgreMaterial.h>
+#include <OgreMesh.h>
+#include <OgreSceneManager.h>
+
+#include "RobotModel.h"
+
+namespace module {
+namespace simulation {
+
+    /// Where a robot stands on the field
+    struct RobotPlacement {
+        Ogre::Vector3 position;
+        Ogre::Degree yaw;
+    };
+
+    /**
+     * Spawns robots described by a RobotModel into one scene manager.
+     *
+     * Meshes and materials are looked up once, when the factory is made, and every robot's entities are made
+     * straight from them so they all share the same prepared geometry. Meshes the model gives an instanced
+     * material for are drawn with hardware instancing when the render system supports it, so each extra robot
+     * costs its scene nodes and a slot in an instance batch rather than its own draw calls. Entity names
+     * are left to Ogre so any number of robots can be spawned.
+     */
+    class RobotFactory {
+    public:
+        RobotFactory(Ogre::SceneManager* scene_mgr, const RobotModel& model, bool instancing, size_t robots_per_batch);
+
+        RobotFactory(const RobotFactory&) = delete;
+        RobotFactory& operator=(const RobotFactory&) = delete;
+
+        /// @brief Adds a robot with every joint at zero, returning its index
+        size_t spawn(const RobotPlacement& placement);
+
+        /// @brief Moves a robot to a new place on the field
+        void place(size_t robot, const RobotPlacement& placement);
+
+        /**
+         * Sets the joint angles of every robot at once.
+         *
+         * @param angles radians, size() rows of joint_count() angles, in the order of the model's joints
+         * @param count  number of angles, rows past it are left as they are
+         */
+        void set_joint_angles(const float* angles, size_t count);
+
+        size_t size() const;
+        size_t joint_count() const;
+
+        /// @brief The world space box around all of a robot's links, as of the last time the scene was rendered
+        Ogre::AxisAlignedBox bounds(size_t robot) const;
+
+        /// @brief Turns the shadows of the entities the model says cast them on or off
+        void set_cast_shadows(bool cast);
+
+        /// @brief Number of the model's meshes being drawn with hardware instancing
+        size_t instanced_meshes() const;
+
+    private:
+        struct Robot {
+            Ogre::SceneNode* root;
+            std::vector<Ogre::SceneNode*> joints;
+        };
+
+        Ogre::SceneManager* scene_mgr;
+        const RobotModel& model;
+
+        // per entity of the model: its mesh, its material and the manager drawing it, or nullptr for a plain entity
+        std::vector<Ogre::MeshPtr> meshes;
+        std::vector<Ogre::MaterialPtr> materials;
+        std::vector<Ogre::InstanceManager*> instance_managers;
+
+        // per joint, the rest orientation of its link and the axis it turns about
+        std::vector<Ogre::Quaternion> rest;
+        std::vector<Ogre::Vector3> axes;
+
+        std::vector<Robot> robots;
+        std::vector<Ogre::Entity*> casters;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_ROBOTFACTORY_H
@@ -0,0 +1,152 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "RobotModel.h"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+#include "SceneCache.h"
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        void add_link(RobotModel& model, const YAML::Node& node, int32_t parent)
+        {
+
+            RobotLink link;
+            link.name = node["name"].as<std::string>();
+            link.parent = parent;
+
+            YAML::Node position = node["position"];
+            for (int i = 0; i < 3; ++i)
+            {
+                link.position[i] = position ? position[i].as<float>() : 0.0f;
+            }
+
+            scene_rotation(node["rotate"], link.orientation);
+
+            link.joint = -1;
+            if (node["joint"])
+            {
+                RobotJoint joint;
+                joint.name = node["joint"]["name"].as<std::string>();
+                joint.link = model.links.size();
+
+                if (model.joint_index(joint.name) >= 0)
+                {
+                    throw std::runtime_error("Joint " + joint.name + " is defined twice");
+                }
+
+                std::vector<float> axis = node["joint"]["axis"].as<std::vector<float>>();
+                const float length = axis.size() == 3 ? std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]) : 0.0f;
+                if (length == 0.0f)
+                {
+                    throw std::runtime_error("Joint " + joint.name + " needs a non zero [x, y, z] axis");
+                }
+                for (int i = 0; i < 3; ++i)
+                {
+                    joint.axis[i] = axis[i] / length;
+                }
+
+                link.joint = model.joints.size();
+                model.joints.push_back(joint);
+            }
+
+            YAML::Node entity_list = node["entities"];
+            link.first_entity = model.entities.size();
+            link.entity_count = entity_list ? entity_list.size() : 0;
+            for (const auto& entity : entity_list)
+            {
+                RobotEntity e;
+                e.mesh = entity["mesh"].as<std::string>();
+                e.material = entity["material"].as<std::string>();
+                e.instanced_material = entity["instanced_material"] ? entity["instanced_material"].as<std::string>() : "";
+                e.cast_shadows = entity["cast_shadows"] ? entity["cast_shadows"].as<bool>() : true;
+                model.entities.push_back(e);
+            }
+
+            int32_t index = model.links.size();
+            model.links.push_back(link);
+
+            for (const auto& child : node["children"])
+            {
+                add_link(model, child, index);
+            }
+        }
+    }
+
+    RobotModel RobotModel::load(const std::string& path)
+    {
+
+        std::ifstream in(path);
+        if (!in)
+        {
+            throw std::runtime_error("Can't read the robot description " + path);
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+
+        return parse(text.str(), path);
+    }
+
+    RobotModel RobotModel::parse(const std::string& description, const std::string& source)
+    {
+
+        RobotModel model;
+
+        try
+        {
+            YAML::Node root = YAML::Load(description);
+
+            model.scale = root["scale"] ? root["scale"].as<float>() : 1.0f;
+
+            if (!root["root"])
+            {
+                throw std::runtime_error("The robot description " + source + " has no root link");
+            }
+            add_link(model, root["root"], -1);
+        }
+        catch (const YAML::Exception& e)
+        {
+            throw std::runtime_error("Invalid robot description " + source + ": " + e.what());
+        }
+
+        return model;
+    }
+
+    int RobotModel::joint_index(const std::string& name) const
+    {
+        for (size_t i = 0; i < joints.size(); ++i)
+        {
+            if (joints[i].name == name)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+}
+}
@@ -0,0 +1,92 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_ROBOTMODEL_H
+#define MODULE_SIMULATOR_ROBOTMODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace module {
+namespace simulation {
+
+    /// A rigid part of the robot, posed relative to its parent link when all joint angles are zero
+    struct RobotLink {
+        std::string name;
+        /// Index of an earlier link, or -1 for the root link
+        int32_t parent;
+        float position[3];
+        /// w, x, y, z
+        float orientation[4];
+        /// The joint that rotates this link relative to its parent, or -1 if it is fixed
+        int32_t joint;
+        uint32_t first_entity;
+        uint32_t entity_count;
+    };
+
+    /// A revolute joint, turning its link about axis (in the link's rest frame)
+    struct RobotJoint {
+        std::string name;
+        uint32_t link;
+        float axis[3];
+    };
+
+    struct RobotEntity {
+        std::string mesh;
+        std::string material;
+        /// Material to draw the mesh with when it is hardware instanced, empty if it can't be
+        std::string instanced_material;
+        bool cast_shadows;
+    };
+
+    /**
+     * A robot's kinematic description: a tree of links connected by revolute joints, with the meshes drawn
+     * for each link.
+     *
+     * The description is YAML (see config/robots/Igus.yaml). Links always come after their parents and
+     * joints are numbered in the order they appear, which is the order joint angles are given in.
+     */
+    class RobotModel {
+    public:
+        /**
+         * @throws std::runtime_error if the description can't be read or is invalid
+         */
+        static RobotModel load(const std::string& path);
+
+        /**
+         * @param source what the description came from, for error messages
+         * @throws std::runtime_error if the description is invalid
+         */
+        static RobotModel parse(const std::string& description, const std::string& source);
+
+        /// @brief Index of the named joint, or -1 if there isn't one
+        int joint_index(const std::string& name) const;
+
+        /// Uniform scale from the description's units to the scene's
+        float scale;
+        std::vector<RobotLink> links;
+        std::vector<RobotJoint> joints;
+        std::vector<RobotEntity> entities;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_ROBOTMODEL_H
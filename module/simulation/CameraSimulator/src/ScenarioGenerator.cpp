@@ -0,0 +1,314 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "ScenarioGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+#include "SensorNoise.h"
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        const double PI = 3.14159265358979323846;
+
+        // [0, 1) from the top 53 bits
+        double unit(uint64_t r)
+        {
+            return (r >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        // A vector of three distributions, each defaulting to its element of defaults
+        void parse_vector(const YAML::Node& node, const float defaults[3], Distribution out[3])
+        {
+
+            for (int i = 0; i < 3; ++i)
+            {
+                out[i] = Distribution(defaults[i]);
+            }
+            if (!node)
+            {
+                return;
+            }
+            if (!node.IsSequence() || node.size() != 3)
+            {
+                throw std::runtime_error("Randomised vectors need three distributions");
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                out[i] = Distribution::parse(node[i]);
+            }
+        }
+
+        Distribution parse_scalar(const YAML::Node& node, double fallback)
+        {
+            return node ? Distribution::parse(node) : Distribution(fallback);
+        }
+
+        // A key of a section that may not be there, undefined unless both are
+        YAML::Node child(const YAML::Node& section, const std::string& key)
+        {
+            return section && section.IsMap() && section[key] ? section[key] : YAML::Node(YAML::NodeType::Undefined);
+        }
+
+        // Every parameter draws from its own pair of counters so adding one never changes the others
+        enum Parameter {
+            CAMERA_POSITION = 0,
+            CAMERA_PITCH = 3,
+            CAMERA_YAW,
+            LIGHT_COLOUR,
+            LIGHT_INTENSITY = LIGHT_COLOUR + 3,
+            AMBIENT,
+            SKY,
+            BALL_POSITION,
+            BALL_VELOCITY = BALL_POSITION + 3,
+            NOISE_LEVEL = BALL_VELOCITY + 3,
+            ROBOTS
+        };
+    }
+
+    Distribution::Distribution(double value) : kind(Kind::CONSTANT), a(value), b(0.0) {}
+
+    Distribution::Distribution(Kind kind, double a, double b) : kind(kind), a(a), b(b) {}
+
+    Distribution Distribution::parse(const YAML::Node& node)
+    {
+
+        if (node.IsScalar())
+        {
+            return Distribution(node.as<double>());
+        }
+
+        if (node.IsMap() && node.size() == 1)
+        {
+            const std::string kind = node.begin()->first.as<std::string>();
+            const std::vector<double> range = node.begin()->second.as<std::vector<double>>();
+
+            if (range.size() == 2 && kind == "uniform")
+            {
+                return Distribution(Kind::UNIFORM, range[0], range[1]);
+            }
+            if (range.size() == 2 && kind == "normal")
+            {
+                return Distribution(Kind::NORMAL, range[0], range[1]);
+            }
+        }
+
+        throw std::runtime_error("Distributions are a number, { uniform: [low, high] } or { normal: [mean, sigma] }");
+    }
+
+    double Distribution::sample(uint64_t r0, uint64_t r1) const
+    {
+
+        switch (kind)
+        {
+            case Kind::UNIFORM: return a + (b - a) * unit(r0);
+            // Box-Muller, with u0 kept off zero for the log
+            case Kind::NORMAL: return a + b * std::sqrt(-2.0 * std::log(1.0 - unit(r0))) * std::cos(2.0 * PI * unit(r1));
+            default: return a;
+        }
+    }
+
+    ScenarioGenerator::ScenarioGenerator()
+    : active(false)
+    , seed(0)
+    , episode_count(0)
+    , frame_count(1)
+    , resample_frames(false)
+    , randomise_robots(false) {}
+
+    ScenarioGenerator ScenarioGenerator::parse(const YAML::Node& config, const SampledScene& defaults)
+    {
+
+        ScenarioGenerator generator;
+
+        try
+        {
+            generator.active = config["enabled"] ? config["enabled"].as<bool>() : false;
+            generator.seed = config["seed"] ? config["seed"].as<uint64_t>() : 0;
+            generator.episode_count = config["episodes"] ? config["episodes"].as<uint64_t>() : 1;
+            generator.frame_count = config["frames"] ? std::max(config["frames"].as<unsigned int>(), 1u) : 1;
+
+            const std::string resample = config["resample"] ? config["resample"].as<std::string>() : "episode";
+            if (resample != "episode" && resample != "frame")
+            {
+                throw std::runtime_error("Resample is episode or frame, not " + resample);
+            }
+            generator.resample_frames = resample == "frame";
+
+            const YAML::Node camera = config["camera"];
+            parse_vector(child(camera, "position"), defaults.camera_position, generator.camera_position);
+            generator.camera_pitch = parse_scalar(child(camera, "pitch"), defaults.camera_pitch);
+            generator.camera_yaw = parse_scalar(child(camera, "yaw"), defaults.camera_yaw);
+
+            // the colour is scaled by the intensity, so the defaults are the colour at full intensity
+            const YAML::Node light = config["light"];
+            parse_vector(child(light, "colour"), defaults.light_colour, generator.light_colour);
+            generator.light_intensity = parse_scalar(child(light, "intensity"), 1.0);
+            generator.ambient = parse_scalar(child(light, "ambient"), defaults.ambient);
+
+            if (config["skies"])
+            {
+                generator.sky_materials = config["skies"].as<std::vector<std::string>>();
+            }
+
+            const YAML::Node ball = config["ball"];
+            parse_vector(child(ball, "position"), defaults.ball_position, generator.ball_position);
+            parse_vector(child(ball, "velocity"), defaults.ball_velocity, generator.ball_velocity);
+
+            generator.default_robots = defaults.robots;
+            if (const YAML::Node robots = config["robots"])
+            {
+                const float origin[3] = { 0.0f, 0.0f, 0.0f };
+                generator.randomise_robots = true;
+                parse_vector(child(robots, "position"), origin, generator.robot_position);
+                generator.robot_yaw = parse_scalar(child(robots, "yaw"), 0.0);
+            }
+
+            generator.noise_level = parse_scalar(config["noise_level"], defaults.noise_level);
+        }
+        catch (const YAML::Exception& e)
+        {
+            throw std::runtime_error(std::string("Invalid randomization: ") + e.what());
+        }
+
+        return generator;
+    }
+
+    bool ScenarioGenerator::enabled() const
+    {
+        return active;
+    }
+
+    uint64_t ScenarioGenerator::episodes() const
+    {
+        return episode_count;
+    }
+
+    unsigned int ScenarioGenerator::frames() const
+    {
+        return frame_count;
+    }
+
+    bool ScenarioGenerator::per_frame() const
+    {
+        return resample_frames;
+    }
+
+    const std::vector<std::string>& ScenarioGenerator::skies() const
+    {
+        return sky_materials;
+    }
+
+    SampledScene ScenarioGenerator::sample(uint64_t episode, uint64_t frame) const
+    {
+
+        const uint64_t key = SensorNoise::random(SensorNoise::random(seed, episode), resample_frames ? frame : 0);
+        auto draw = [&] (const Distribution& distribution, uint64_t parameter) {
+            return float(distribution.sample(SensorNoise::random(key, parameter * 2), SensorNoise::random(key, parameter * 2 + 1)));
+        };
+
+        SampledScene scene;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            scene.camera_position[i] = draw(camera_position[i], CAMERA_POSITION + i);
+            scene.ball_position[i] = draw(ball_position[i], BALL_POSITION + i);
+            scene.ball_velocity[i] = draw(ball_velocity[i], BALL_VELOCITY + i);
+        }
+        scene.camera_pitch = draw(camera_pitch, CAMERA_PITCH);
+        scene.camera_yaw = draw(camera_yaw, CAMERA_YAW);
+
+        const float intensity = draw(light_intensity, LIGHT_INTENSITY);
+        for (int i = 0; i < 3; ++i)
+        {
+            scene.light_colour[i] = draw(light_colour[i], LIGHT_COLOUR + i) * intensity;
+        }
+        scene.ambient = draw(ambient, AMBIENT);
+
+        scene.sky = sky_materials.empty() ? 0 : SensorNoise::random(key, SKY * 2) % sky_materials.size();
+        scene.noise_level = std::max(draw(noise_level, NOISE_LEVEL), 0.0f);
+
+        scene.robots = default_robots;
+        if (randomise_robots)
+        {
+            for (size_t robot = 0; robot < scene.robots.size() / 4; ++robot)
+            {
+                const uint64_t parameter = ROBOTS + robot * 4;
+                for (int i = 0; i < 3; ++i)
+                {
+                    scene.robots[robot * 4 + i] = draw(robot_position[i], parameter + i);
+                }
+                scene.robots[robot * 4 + 3] = draw(robot_yaw, parameter + 3);
+            }
+        }
+
+        return scene;
+    }
+
+    void ScenarioGenerator::write_manifest_header(std::ostream& out, size_t robots)
+    {
+
+        out << "episode,frame,world_id,timestamp_ns,camera_x,camera_y,camera_z,camera_pitch,camera_yaw,"
+               "light_r,light_g,light_b,ambient,sky,ball_x,ball_y,ball_z,ball_vx,ball_vy,ball_vz,noise_level";
+        for (size_t i = 0; i < robots; ++i)
+        {
+            out << ",robot" << i << "_x,robot" << i << "_y,robot" << i << "_z,robot" << i << "_yaw";
+        }
+        out << "\n";
+    }
+
+    void ScenarioGenerator::write_manifest_row(std::ostream& out, uint64_t episode, uint64_t frame, unsigned int world,
+                                               int64_t timestamp, const SampledScene& scene) const
+    {
+
+        out << episode << "," << frame << "," << world << "," << timestamp;
+        for (float v : scene.camera_position)
+        {
+            out << "," << v;
+        }
+        out << "," << scene.camera_pitch << "," << scene.camera_yaw;
+        for (float v : scene.light_colour)
+        {
+            out << "," << v;
+        }
+        out << "," << scene.ambient << "," << (scene.sky < sky_materials.size() ? sky_materials[scene.sky] : "");
+        for (float v : scene.ball_position)
+        {
+            out << "," << v;
+        }
+        for (float v : scene.ball_velocity)
+        {
+            out << "," << v;
+        }
+        out << "," << scene.noise_level;
+        for (float v : scene.robots)
+        {
+            out << "," << v;
+        }
+        out << "\n";
+    }
+
+}
+}
@@ -0,0 +1,142 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_SCENARIOGENERATOR_H
+#define MODULE_SIMULATOR_SCENARIOGENERATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace YAML {
+    class Node;
+}
+
+namespace module {
+namespace simulation {
+
+    /**
+     * A distribution a randomised parameter is drawn from, written in YAML as a plain number for a constant,
+     * { uniform: [low, high] } or { normal: [mean, sigma] }.
+     */
+    class Distribution {
+    public:
+        enum class Kind { CONSTANT, UNIFORM, NORMAL };
+
+        /// @brief Always value
+        explicit Distribution(double value = 0.0);
+        Distribution(Kind kind, double a, double b);
+
+        /// @throws std::runtime_error if the node is none of the forms above
+        static Distribution parse(const YAML::Node& node);
+
+        /// @brief Draws a value from two independent uniform 64 bit random numbers
+        double sample(uint64_t r0, uint64_t r1) const;
+
+        Kind kind;
+        double a;
+        double b;
+    };
+
+    /// One draw of every randomised parameter of a world
+    struct SampledScene {
+        float camera_position[3];
+        float camera_pitch;
+        float camera_yaw;
+        float light_colour[3];
+        float ambient;
+        /// Index into the generator's skies
+        uint32_t sky;
+        float ball_position[3];
+        float ball_velocity[3];
+        /// x, y, z and yaw (degrees) of each robot
+        std::vector<float> robots;
+        /// Multiplies the configured sensor noise
+        float noise_level;
+    };
+
+    /**
+     * Draws randomised scenes for generating training data, episodes of frames each with the camera, light,
+     * sky, ball, robots and sensor noise sampled from the configured distributions.
+     *
+     * Draws are a pure function of the seed, the episode and the frame: every parameter is made from the
+     * counter based generator SensorNoise uses, keyed on (seed, episode, frame), so an episode is the same
+     * whichever world renders it and in whatever order. With per_frame each frame of an episode is a new
+     * draw, otherwise every frame of it uses frame 0's.
+     */
+    class ScenarioGenerator {
+    public:
+        /// @brief Disabled
+        ScenarioGenerator();
+
+        /**
+         * Reads the randomization section of the config. Parameters it doesn't randomise keep their values in
+         * defaults, which also says how many robots there are.
+         *
+         * @throws std::runtime_error if a distribution is invalid
+         */
+        static ScenarioGenerator parse(const YAML::Node& config, const SampledScene& defaults);
+
+        bool enabled() const;
+        uint64_t episodes() const;
+        unsigned int frames() const;
+        bool per_frame() const;
+        const std::vector<std::string>& skies() const;
+
+        SampledScene sample(uint64_t episode, uint64_t frame) const;
+
+        /// @brief The column names of a manifest of scenes with robots robots
+        static void write_manifest_header(std::ostream& out, size_t robots);
+
+        /**
+         * One line of the manifest, the world a frame was rendered in, when, and the scene it was rendered
+         * from. The timestamp joins it to the dataset's index.
+         */
+        void write_manifest_row(std::ostream& out, uint64_t episode, uint64_t frame, unsigned int world,
+                                int64_t timestamp, const SampledScene& scene) const;
+
+    private:
+        bool active;
+        uint64_t seed;
+        uint64_t episode_count;
+        unsigned int frame_count;
+        bool resample_frames;
+
+        Distribution camera_position[3];
+        Distribution camera_pitch;
+        Distribution camera_yaw;
+        Distribution light_colour[3];
+        Distribution light_intensity;
+        Distribution ambient;
+        std::vector<std::string> sky_materials;
+        Distribution ball_position[3];
+        Distribution ball_velocity[3];
+        // every robot is drawn from the same distributions, or left at its default place
+        bool randomise_robots;
+        Distribution robot_position[3];
+        Distribution robot_yaw;
+        std::vector<float> default_robots;
+        Distribution noise_level;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_SCENARIOGENERATOR_H
@@ -0,0 +1,407 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "SceneCache.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <yaml-cpp/yaml.h>
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        constexpr char MAGIC[4] = { 'N', 'U', 'S', 'C' };
+        // Bump whenever the records or the meaning of the description change
+        constexpr uint32_t VERSION = 1;
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint64_t source_hash;
+            uint32_t node_count;
+            uint32_t entity_count;
+            uint32_t string_bytes;
+            uint32_t reserved;
+        };
+
+        // FNV-1a, only used to notice that the description changed
+        uint64_t hash(const std::string& text)
+        {
+            uint64_t h = 0xCBF29CE484222325ull ^ VERSION;
+            for (unsigned char c : text)
+            {
+                h = (h ^ c) * 0x100000001B3ull;
+            }
+            return h;
+        }
+
+        struct Quaternion {
+            double w, x, y, z;
+
+            Quaternion operator*(const Quaternion& q) const
+            {
+                return { w * q.w - x * q.x - y * q.y - z * q.z
+                       , w * q.x + x * q.w + y * q.z - z * q.y
+                       , w * q.y - x * q.z + y * q.w + z * q.x
+                       , w * q.z + x * q.y - y * q.x + z * q.w };
+            }
+        };
+
+        class Compiler {
+        public:
+            std::vector<SceneNodeRecord> nodes;
+            std::vector<SceneEntityRecord> entities;
+            std::string strings;
+
+            void compile(const YAML::Node& node, int32_t parent)
+            {
+
+                // Every instance is a copy of the node (and its children) with some of its fields replaced
+                if (node["instances"])
+                {
+                    for (const auto& instance : node["instances"])
+                    {
+                        emit(node, instance, parent);
+                    }
+                }
+                else
+                {
+                    emit(node, YAML::Node(), parent);
+                }
+            }
+
+        private:
+            std::map<std::string, uint32_t> string_offsets;
+
+            uint32_t intern(const std::string& s)
+            {
+                auto it = string_offsets.find(s);
+                if (it != string_offsets.end())
+                {
+                    return it->second;
+                }
+
+                uint32_t offset = strings.size();
+                strings.append(s);
+                strings.push_back('\0');
+                string_offsets[s] = offset;
+                return offset;
+            }
+
+            static YAML::Node field(const YAML::Node& node, const YAML::Node& instance, const char* name)
+            {
+                return instance && instance[name] ? instance[name] : node[name];
+            }
+
+            void emit(const YAML::Node& node, const YAML::Node& instance, int32_t parent)
+            {
+
+                SceneNodeRecord record;
+                record.parent = parent;
+
+                YAML::Node position = field(node, instance, "position");
+                for (int i = 0; i < 3; ++i)
+                {
+                    record.position[i] = position ? position[i].as<float>() : 0.0f;
+                }
+
+                scene_rotation(field(node, instance, "rotate"), record.orientation);
+
+                // A single number scales uniformly
+                YAML::Node scale = field(node, instance, "scale");
+                for (int i = 0; i < 3; ++i)
+                {
+                    record.scale[i] = !scale ? 1.0f : scale.IsSequence() ? scale[i].as<float>() : scale.as<float>();
+                }
+
+                YAML::Node id = field(node, instance, "id");
+                record.id = id ? intern(id.as<std::string>()) : SceneCache::NO_STRING;
+
+                YAML::Node entity_list = node["entities"];
+                record.first_entity = entities.size();
+                record.entity_count = entity_list ? entity_list.size() : 0;
+                for (size_t i = 0; i < record.entity_count; ++i)
+                {
+                    const YAML::Node entity = entity_list[i];
+
+                    SceneEntityRecord e;
+                    e.mesh = intern(entity["mesh"].as<std::string>());
+                    e.material = intern(entity["material"].as<std::string>());
+                    e.animation = entity["animation"] ? intern(entity["animation"].as<std::string>()) : SceneCache::NO_STRING;
+                    e.cast_shadows = entity["cast_shadows"] ? entity["cast_shadows"].as<bool>() : true;
+                    entities.push_back(e);
+                }
+
+                int32_t index = nodes.size();
+                nodes.push_back(record);
+
+                for (const auto& child : node["children"])
+                {
+                    compile(child, index);
+                }
+            }
+        };
+
+        std::vector<char> serialise(const Compiler& compiler, uint64_t source_hash)
+        {
+
+            Header header;
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.source_hash = source_hash;
+            header.node_count = compiler.nodes.size();
+            header.entity_count = compiler.entities.size();
+            header.string_bytes = compiler.strings.size();
+            header.reserved = 0;
+
+            const size_t node_bytes = compiler.nodes.size() * sizeof(SceneNodeRecord);
+            const size_t entity_bytes = compiler.entities.size() * sizeof(SceneEntityRecord);
+
+            std::vector<char> bytes(sizeof(Header) + node_bytes + entity_bytes + compiler.strings.size());
+            char* out = bytes.data();
+            std::memcpy(out, &header, sizeof(Header));
+            std::memcpy(out + sizeof(Header), compiler.nodes.data(), node_bytes);
+            std::memcpy(out + sizeof(Header) + node_bytes, compiler.entities.data(), entity_bytes);
+            std::memcpy(out + sizeof(Header) + node_bytes + entity_bytes, compiler.strings.data(), compiler.strings.size());
+
+            return bytes;
+        }
+
+        // Writes beside the cache and renames so another process never maps a half written file
+        bool write_file(const std::string& path, const std::vector<char>& bytes)
+        {
+
+            const std::string temporary = path + ".tmp" + std::to_string(getpid());
+            {
+                std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+                if (!out.write(bytes.data(), bytes.size()))
+                {
+                    std::remove(temporary.c_str());
+                    return false;
+                }
+            }
+            return std::rename(temporary.c_str(), path.c_str()) == 0;
+        }
+    }
+
+    constexpr uint32_t SceneCache::NO_STRING;
+
+    // Rotations are applied in order about the node's own axes, like Ogre's yaw, pitch and roll
+    void scene_rotation(const YAML::Node& rotate, float orientation[4])
+    {
+
+        Quaternion q = { 1, 0, 0, 0 };
+        for (size_t i = 0; rotate && i < rotate.size(); ++i)
+        {
+            for (const auto& step : rotate[i])
+            {
+                const std::string axis = step.first.as<std::string>();
+                const double half = step.second.as<double>() * M_PI / 360.0;
+                const double s = std::sin(half);
+                const double c = std::cos(half);
+
+                if (axis == "yaw")
+                {
+                    q = q * Quaternion{ c, 0, s, 0 };
+                }
+                else if (axis == "pitch")
+                {
+                    q = q * Quaternion{ c, s, 0, 0 };
+                }
+                else if (axis == "roll")
+                {
+                    q = q * Quaternion{ c, 0, 0, s };
+                }
+                else
+                {
+                    throw std::runtime_error("Unknown rotation " + axis + ", expected yaw, pitch or roll");
+                }
+            }
+        }
+
+        orientation[0] = q.w;
+        orientation[1] = q.x;
+        orientation[2] = q.y;
+        orientation[3] = q.z;
+    }
+
+    SceneCache::SceneCache()
+    : mapping(nullptr)
+    , mapping_size(0)
+    , cached(false)
+    , node_records(nullptr)
+    , entity_records(nullptr)
+    , strings(nullptr)
+    , nodes_size(0)
+    , entities_size(0) {}
+
+    SceneCache::~SceneCache()
+    {
+        if (mapping)
+        {
+            munmap(mapping, mapping_size);
+        }
+    }
+
+    std::unique_ptr<SceneCache> SceneCache::load(const std::string& description, const std::string& cache_path)
+    {
+
+        std::ifstream in(description);
+        if (!in)
+        {
+            throw std::runtime_error("Can't read the scene description " + description);
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+        const uint64_t source_hash = hash(text.str());
+
+        std::unique_ptr<SceneCache> scene(new SceneCache());
+
+        if (scene->map(cache_path, source_hash))
+        {
+            scene->cached = true;
+            return scene;
+        }
+
+        Compiler compiler;
+        try
+        {
+            YAML::Node root = YAML::Load(text.str());
+            for (const auto& node : root["nodes"])
+            {
+                compiler.compile(node, -1);
+            }
+        }
+        catch (const YAML::Exception& e)
+        {
+            throw std::runtime_error("Invalid scene description " + description + ": " + e.what());
+        }
+
+        std::vector<char> bytes = serialise(compiler, source_hash);
+        if (!write_file(cache_path, bytes) || !scene->map(cache_path, source_hash))
+        {
+            scene->adopt(std::move(bytes));
+        }
+
+        return scene;
+    }
+
+    bool SceneCache::map(const std::string& path, uint64_t hash)
+    {
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(Header))
+        {
+            close(fd);
+            return false;
+        }
+
+        void* memory = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED)
+        {
+            return false;
+        }
+
+        const Header* header = static_cast<const Header*>(memory);
+        const size_t expected = sizeof(Header) + header->node_count * sizeof(SceneNodeRecord)
+                              + header->entity_count * sizeof(SceneEntityRecord) + header->string_bytes;
+
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION
+            || header->source_hash != hash || expected != size_t(info.st_size))
+        {
+            munmap(memory, info.st_size);
+            return false;
+        }
+
+        mapping = memory;
+        mapping_size = info.st_size;
+
+        const char* base = static_cast<const char*>(memory);
+        node_records = reinterpret_cast<const SceneNodeRecord*>(base + sizeof(Header));
+        entity_records = reinterpret_cast<const SceneEntityRecord*>(node_records + header->node_count);
+        strings = reinterpret_cast<const char*>(entity_records + header->entity_count);
+        nodes_size = header->node_count;
+        entities_size = header->entity_count;
+
+        return true;
+    }
+
+    void SceneCache::adopt(std::vector<char>&& bytes)
+    {
+
+        owned = std::move(bytes);
+
+        const Header* header = reinterpret_cast<const Header*>(owned.data());
+        node_records = reinterpret_cast<const SceneNodeRecord*>(owned.data() + sizeof(Header));
+        entity_records = reinterpret_cast<const SceneEntityRecord*>(node_records + header->node_count);
+        strings = reinterpret_cast<const char*>(entity_records + header->entity_count);
+        nodes_size = header->node_count;
+        entities_size = header->entity_count;
+    }
+
+    const SceneNodeRecord* SceneCache::nodes() const
+    {
+        return node_records;
+    }
+
+    size_t SceneCache::node_count() const
+    {
+        return nodes_size;
+    }
+
+    const SceneEntityRecord* SceneCache::entities() const
+    {
+        return entity_records;
+    }
+
+    size_t SceneCache::entity_count() const
+    {
+        return entities_size;
+    }
+
+    const char* SceneCache::string(uint32_t offset) const
+    {
+        return strings + offset;
+    }
+
+    bool SceneCache::from_cache() const
+    {
+        return cached;
+    }
+
+}
+}
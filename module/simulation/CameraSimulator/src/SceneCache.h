@@ -0,0 +1,125 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_SCENECACHE_H
+#define MODULE_SIMULATOR_SCENECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace YAML {
+    class Node;
+}
+
+namespace module {
+namespace simulation {
+
+    /// A scene node with its transform relative to its parent, flattened from the scene description
+    struct SceneNodeRecord {
+        /// Index of an earlier node, or -1 for children of the scene root
+        int32_t parent;
+        float position[3];
+        /// w, x, y, z
+        float orientation[4];
+        float scale[3];
+        /// String offset of the id code can look the node up by, or SceneCache::NO_STRING
+        uint32_t id;
+        uint32_t first_entity;
+        uint32_t entity_count;
+    };
+
+    struct SceneEntityRecord {
+        /// String offsets, mesh is "plane" for Ogre's built in plane
+        uint32_t mesh;
+        uint32_t material;
+        /// Animation to play on a loop, or SceneCache::NO_STRING
+        uint32_t animation;
+        uint32_t cast_shadows;
+    };
+
+    /**
+     * Turns a description's rotate field, a list of yaw, pitch and roll steps in degrees, into an orientation.
+     *
+     * @param orientation receives w, x, y, z
+     * @throws std::runtime_error for an axis other than yaw, pitch or roll
+     */
+    void scene_rotation(const YAML::Node& rotate, float orientation[4]);
+
+    /**
+     * A scene description compiled into flat records.
+     *
+     * The description is YAML (see config/scenes/Stadium.yaml). Parsing it and resolving the instances and
+     * rotations only happens when it changes: the result is written to a binary cache, which later runs mmap
+     * and build their scene nodes straight from. The cache records a hash of the description it came from
+     * and is rebuilt whenever that no longer matches.
+     */
+    class SceneCache {
+    public:
+        static constexpr uint32_t NO_STRING = 0xFFFFFFFF;
+
+        /**
+         * Loads the scene in the description file, from cache_path if that is up to date and otherwise by
+         * compiling the description and writing cache_path for next time.
+         *
+         * @throws std::runtime_error if the description can't be read or is invalid
+         */
+        static std::unique_ptr<SceneCache> load(const std::string& description, const std::string& cache_path);
+
+        ~SceneCache();
+
+        SceneCache(const SceneCache&) = delete;
+        SceneCache& operator=(const SceneCache&) = delete;
+
+        const SceneNodeRecord* nodes() const;
+        size_t node_count() const;
+
+        const SceneEntityRecord* entities() const;
+        size_t entity_count() const;
+
+        const char* string(uint32_t offset) const;
+
+        /// @brief True if this was read from an existing cache rather than compiled
+        bool from_cache() const;
+
+    private:
+        SceneCache();
+
+        bool map(const std::string& path, uint64_t hash);
+        void adopt(std::vector<char>&& bytes);
+
+        // Either a mapped cache file or, if the cache couldn't be written, the compiled bytes
+        void* mapping;
+        size_t mapping_size;
+        std::vector<char> owned;
+        bool cached;
+
+        const SceneNodeRecord* node_records;
+        const SceneEntityRecord* entity_records;
+        const char* strings;
+        size_t nodes_size;
+        size_t entities_size;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_SCENECACHE_H
@@ -0,0 +1,131 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "SensorNoise.h"
+
+#include <cmath>
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        // The splitmix64 finaliser, which is a good enough bijective mix for noise
+        inline uint64_t mix(uint64_t x)
+        {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        inline uint8_t clamp_round(float v)
+        {
+            return v <= 0.0f ? 0 : v >= 255.0f ? 255 : uint8_t(v + 0.5f);
+        }
+
+        // The standard normal quantile function, by bisection on erf as it is only used to build a table
+        double normal_quantile(double p)
+        {
+
+            double lo = -10.0;
+            double hi = 10.0;
+            for (int i = 0; i < 64; ++i)
+            {
+                double mid = 0.5 * (lo + hi);
+                if (0.5 * std::erfc(-mid / std::sqrt(2.0)) < p)
+                {
+                    lo = mid;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            return 0.5 * (lo + hi);
+        }
+    }
+
+    SensorNoise::SensorNoise()
+    {
+        reset(0, 0.0, 0.0);
+    }
+
+    void SensorNoise::reset(uint64_t seed, double read_sigma, double shot_gain)
+    {
+
+        this->seed = seed;
+        active = read_sigma > 0.0 || shot_gain > 0.0;
+
+        for (size_t i = 0; i < normal.size(); ++i)
+        {
+            normal[i] = float(normal_quantile((i + 0.5) / normal.size()));
+        }
+
+        for (size_t v = 0; v < luma_sigma.size(); ++v)
+        {
+            luma_sigma[v] = float(std::sqrt(read_sigma * read_sigma + shot_gain * v));
+        }
+        chroma_sigma = float(read_sigma);
+    }
+
+    bool SensorNoise::enabled() const
+    {
+        return active;
+    }
+
+    uint64_t SensorNoise::random(uint64_t key, uint64_t counter)
+    {
+        return mix(key + counter * 0x9E3779B97F4A7C15ull);
+    }
+
+    void SensorNoise::apply_rows(uint8_t* yuyv, unsigned int width, uint64_t frame, uint64_t stream,
+                                 unsigned int first_row, unsigned int last_row, float level) const
+    {
+
+        if (!active || level <= 0.0f)
+        {
+            return;
+        }
+
+        const float chroma = chroma_sigma * level;
+
+        constexpr uint64_t mask = (1 << NORMAL_BITS) - 1;
+
+        for (unsigned int row = first_row; row < last_row; ++row)
+        {
+
+            const uint64_t key = mix(mix(mix(mix(seed) ^ frame) ^ stream) ^ row);
+            uint8_t* p = yuyv + size_t(row) * width * 2;
+
+            // One 64 bit draw covers the four samples of a Y0 U Y1 V pixel pair
+            for (unsigned int pair = 0; pair < width / 2; ++pair, p += 4)
+            {
+
+                const uint64_t r = random(key, pair);
+
+                p[0] = clamp_round(p[0] + luma_sigma[p[0]] * level * normal[r & mask]);
+                p[1] = clamp_round(p[1] + chroma * normal[(r >> NORMAL_BITS) & mask]);
+                p[2] = clamp_round(p[2] + luma_sigma[p[2]] * level * normal[(r >> (2 * NORMAL_BITS)) & mask]);
+                p[3] = clamp_round(p[3] + chroma * normal[(r >> (3 * NORMAL_BITS)) & mask]);
+            }
+        }
+    }
+
+}
+}
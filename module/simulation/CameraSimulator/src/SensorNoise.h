@@ -0,0 +1,78 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_SENSORNOISE_H
+#define MODULE_SIMULATOR_SENSORNOISE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace module {
+namespace simulation {
+
+    /**
+     * Adds camera sensor noise to a YUYV image after it has been read back.
+     *
+     * Every sample gets Gaussian read noise of read_sigma levels, and luma additionally gets shot noise whose
+     * variance grows with the signal (shot_gain * Y), the Gaussian approximation of photon counting noise.
+     *
+     * The random numbers come from a counter based generator: each row hashes (seed, frame, stream, row) into a
+     * key and each sample is a hash of that key and its position. No state is shared between rows, so any split
+     * of the rows across threads gives the same image for the same seed.
+     */
+    class SensorNoise {
+    public:
+        /// @brief Starts with no noise
+        SensorNoise();
+
+        void reset(uint64_t seed, double read_sigma, double shot_gain);
+
+        /// @brief False when both noise sources are zero, in which case apply_rows does nothing
+        bool enabled() const;
+
+        /**
+         * Adds noise to rows [first_row, last_row) of a width x height YUYV image.
+         *
+         * @param frame  identifies the frame, e.g. its timestamp, so consecutive frames get different noise
+         * @param stream identifies the source (camera, world) so simultaneous images get different noise
+         * @param level  scales the noise's standard deviation, to vary it between frames without a reset
+         */
+        void apply_rows(uint8_t* yuyv, unsigned int width, uint64_t frame, uint64_t stream,
+                        unsigned int first_row, unsigned int last_row, float level = 1.0f) const;
+
+        /// @brief The counter based generator, a stateless 64 bit hash of a key and a counter
+        static uint64_t random(uint64_t key, uint64_t counter);
+
+    private:
+        // Standard normal samples at evenly spaced quantiles, indexed by NORMAL_BITS random bits
+        static constexpr unsigned int NORMAL_BITS = 10;
+
+        uint64_t seed;
+        bool active;
+        std::array<float, 1 << NORMAL_BITS> normal;
+        // Total standard deviation for each luma and chroma value
+        std::array<float, 256> luma_sigma;
+        float chroma_sigma;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_SENSORNOISE_H
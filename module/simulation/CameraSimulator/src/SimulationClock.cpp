@@ -0,0 +1,138 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "SimulationClock.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace module {
+namespace simulation {
+
+    ClockMode clock_mode_from_string(const std::string& mode)
+    {
+        if (mode == "realtime")  return ClockMode::REALTIME;
+        if (mode == "max_speed") return ClockMode::MAX_SPEED;
+        if (mode == "lockstep")  return ClockMode::LOCKSTEP;
+
+        throw std::invalid_argument("Unknown clock mode " + mode);
+    }
+
+    SimulationClock::SimulationClock() : SimulationClock(ClockMode::REALTIME, std::chrono::duration<double>(0.0)) {}
+
+    SimulationClock::SimulationClock(ClockMode mode, std::chrono::duration<double> step)
+    : clock_mode(mode)
+    , step(step)
+    , current(mode == ClockMode::REALTIME ? NUClear::clock::now() : NUClear::clock::time_point())
+    , previous_step(0.0)
+    , last_wall(std::chrono::steady_clock::now())
+    , acks_expected(0)
+    , acks_received(0) {}
+
+    void SimulationClock::reset(ClockMode mode, std::chrono::duration<double> step)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        clock_mode = mode;
+        this->step = step;
+        current = mode == ClockMode::REALTIME ? NUClear::clock::now() : NUClear::clock::time_point();
+        previous_step = std::chrono::duration<double>(0.0);
+        last_wall = std::chrono::steady_clock::now();
+        acks_expected = 0;
+        acks_received = 0;
+    }
+
+    bool SimulationClock::wait(std::chrono::milliseconds timeout)
+    {
+        if (clock_mode != ClockMode::LOCKSTEP)
+            return true;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        return acknowledged.wait_for(lock, timeout, [this] { return acks_received >= acks_expected; });
+    }
+
+    std::chrono::duration<double> SimulationClock::advance()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (clock_mode == ClockMode::REALTIME)
+        {
+            auto wall = std::chrono::steady_clock::now();
+            previous_step = std::chrono::duration_cast<std::chrono::duration<double>>(wall - last_wall);
+            last_wall = wall;
+            current = NUClear::clock::now();
+        }
+        else
+        {
+            previous_step = step;
+            current += std::chrono::duration_cast<NUClear::clock::duration>(step);
+
+            // Nothing is known about the new frame until its images have been emitted
+            acks_expected = clock_mode == ClockMode::LOCKSTEP ? std::numeric_limits<size_t>::max() : 0;
+            acks_received = 0;
+        }
+
+        return previous_step;
+    }
+
+    void SimulationClock::expect(size_t images)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (clock_mode != ClockMode::LOCKSTEP)
+                return;
+
+            // Consumers may already have acknowledged some of the images while the rest were being emitted
+            acks_expected = images;
+        }
+        acknowledged.notify_all();
+    }
+
+    void SimulationClock::acknowledge(NUClear::clock::time_point timestamp)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // Late acknowledgements of older frames must not count towards the current one
+            if (timestamp != current)
+                return;
+
+            ++acks_received;
+        }
+        acknowledged.notify_all();
+    }
+
+    NUClear::clock::time_point SimulationClock::now() const
+    {
+        return current;
+    }
+
+    std::chrono::duration<double> SimulationClock::last_step() const
+    {
+        return previous_step;
+    }
+
+    ClockMode SimulationClock::mode() const
+    {
+        return clock_mode;
+    }
+
+}
+}
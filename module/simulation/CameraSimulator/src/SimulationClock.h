@@ -0,0 +1,104 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_SIMULATIONCLOCK_H
+#define MODULE_SIMULATOR_SIMULATIONCLOCK_H
+
+#include <nuclear>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+namespace module {
+namespace simulation {
+
+    enum class ClockMode {
+        /// Steps by however much wall time has passed, the old behaviour
+        REALTIME,
+        /// Steps by a fixed amount as fast as frames can be rendered
+        MAX_SPEED,
+        /// Steps by a fixed amount, but only once every image of the previous frame has been acknowledged
+        LOCKSTEP
+    };
+
+    ClockMode clock_mode_from_string(const std::string& mode);
+
+    /**
+     * The time of the simulated world.
+     *
+     * In the fixed step modes simulated time starts at the NUClear clock's epoch and advances by exactly step
+     * seconds per frame, so the same scenario produces the same frames and timestamps whatever the load on the
+     * machine. In realtime mode it follows NUClear::clock.
+     *
+     * A lockstep frame may be made of several images, one per camera of every world. The clock counts
+     * acknowledgements of the current timestamp and only releases once there is one for each image emitted.
+     *
+     * acknowledge may be called from any thread, everything else belongs to the render thread.
+     */
+    class SimulationClock {
+    public:
+        SimulationClock();
+        SimulationClock(ClockMode mode, std::chrono::duration<double> step);
+
+        /// @brief Restarts the clock from its epoch in the given mode
+        void reset(ClockMode mode, std::chrono::duration<double> step);
+
+        /**
+         * Waits until the clock may advance. Only lockstep mode ever waits, and only until every image stamped
+         * with the current time has been acknowledged or the timeout passes.
+         *
+         * @return true if the clock may advance
+         */
+        bool wait(std::chrono::milliseconds timeout);
+
+        /// @brief Advances simulated time by one frame and returns how far it moved
+        std::chrono::duration<double> advance();
+
+        /**
+         * Sets how many images were emitted with the current timestamp, and so how many acknowledgements lockstep
+         * mode waits for. Until it is called after advance the current frame is never released.
+         */
+        void expect(size_t images);
+
+        /// @brief Marks one image with the given timestamp as consumed
+        void acknowledge(NUClear::clock::time_point timestamp);
+
+        NUClear::clock::time_point now() const;
+        std::chrono::duration<double> last_step() const;
+        ClockMode mode() const;
+
+    private:
+        ClockMode clock_mode;
+        std::chrono::duration<double> step;
+
+        NUClear::clock::time_point current;
+        std::chrono::duration<double> previous_step;
+        std::chrono::steady_clock::time_point last_wall;
+
+        std::mutex mutex;
+        std::condition_variable acknowledged;
+        size_t acks_expected;
+        size_t acks_received;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_SIMULATIONCLOCK_H
@@ -0,0 +1,122 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "WorkerPool.h"
+
+namespace module {
+namespace simulation {
+
+    WorkerPool::WorkerPool(unsigned int threads)
+    : current(nullptr)
+    , count(0)
+    , next(0)
+    , active(0)
+    , generation(0)
+    , stopping(false) {
+
+        // The caller is one of the workers
+        for (unsigned int i = 1; i < threads; ++i)
+        {
+            this->threads.emplace_back(&WorkerPool::work, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    void WorkerPool::run(size_t count, const std::function<void(size_t)>& task)
+    {
+        // Not worth waking anyone for a single item
+        if (threads.empty() || count <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+                task(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &task;
+            this->count = count;
+            next = 0;
+            active = threads.size();
+            ++generation;
+        }
+        start.notify_all();
+
+        drain();
+
+        // The task is owned by our caller so every worker must be done with it before we return
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return active == 0; });
+        current = nullptr;
+    }
+
+    unsigned int WorkerPool::size() const
+    {
+        return threads.size() + 1;
+    }
+
+    void WorkerPool::work()
+    {
+        size_t seen = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [&] { return stopping || generation != seen; });
+
+                if (stopping)
+                    return;
+
+                seen = generation;
+            }
+
+            drain();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --active;
+            }
+            finished.notify_one();
+        }
+    }
+
+    void WorkerPool::drain()
+    {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            (*current)(i);
+        }
+    }
+
+}
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_WORKERPOOL_H
+#define MODULE_SIMULATOR_WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace module {
+namespace simulation {
+
+    /**
+     * A fixed set of threads for splitting per frame CPU work (such as converting image tiles) across cores.
+     *
+     * The work has to finish while the render thread still holds the texture locks, so unlike a NUClear
+     * task run is a blocking parallel for: the calling thread works through the indices alongside the pool
+     * and returns once every index has been processed.
+     */
+    class WorkerPool {
+    public:
+        /// @brief threads is the total number of threads working, including the caller
+        explicit WorkerPool(unsigned int threads);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /// @brief Calls task(i) for every i in [0, count) and waits for them all to finish
+        void run(size_t count, const std::function<void(size_t)>& task);
+
+        unsigned int size() const;
+
+    private:
+        void work();
+        void drain();
+
+        std::vector<std::thread> threads;
+
+        std::mutex mutex;
+        std::condition_variable start;
+        std::condition_variable finished;
+
+        const std::function<void(size_t)>* current;
+        size_t count;
+        std::atomic<size_t> next;
+        size_t active;
+        size_t generation;
+        bool stopping;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_WORKERPOOL_H
@@ -0,0 +1,333 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "World.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <OgreHardwarePixelBuffer.h>
+#include <OgreMaterialManager.h>
+#include <OgreRenderTexture.h>
+#include <OgreStringConverter.h>
+#include <OgreTextureManager.h>
+#include <OgreViewport.h>
+
+#include "LabelScheme.h"
+
+namespace module {
+namespace simulation {
+
+    const char* const World::SKY_MATERIAL = "Examples/CloudySky";
+
+    namespace {
+
+        Ogre::ShadowTechnique shadow_technique(ShadowQuality shadows)
+        {
+            switch (shadows)
+            {
+                case ShadowQuality::STENCIL_MODULATIVE: return Ogre::SHADOWTYPE_STENCIL_MODULATIVE;
+                case ShadowQuality::STENCIL_ADDITIVE:   return Ogre::SHADOWTYPE_STENCIL_ADDITIVE;
+                case ShadowQuality::TEXTURE_MODULATIVE: return Ogre::SHADOWTYPE_TEXTURE_MODULATIVE;
+                default:                                return Ogre::SHADOWTYPE_NONE;
+            }
+        }
+    }
+
+    World::World(unsigned int id
+               , Ogre::Root* root
+               , const SceneCache& scene
+               , const RobotModel& robot_model
+               , const std::vector<RobotPlacement>& robot_placements
+               , bool robot_instancing
+               , const std::vector<CameraConfig>& camera_configs
+               , unsigned int width
+               , unsigned int height
+               , size_t readback_buffers
+               , unsigned int label_scale)
+    : id(id)
+    , camera_configs(camera_configs)
+    , placements(robot_placements)
+    , free_running(true)
+    , frames_remaining(0)
+    , ogre_root(root)
+    , prefix("World" + Ogre::StringConverter::toString(id) + "/")
+    , time_tally(0) {
+
+        // Setup lights/cameras
+
+        scene_mgr = ogre_root->createSceneManager(Ogre::ST_GENERIC, prefix + "SceneManager");
+
+        scene_mgr->setShadowTechnique(Ogre::SHADOWTYPE_STENCIL_ADDITIVE);
+        scene_mgr->setAmbientLight(Ogre::ColourValue(0.5f, 0.5f, 0.5f));
+
+        for (size_t i = 0; i < camera_configs.size(); ++i)
+        {
+            const CameraConfig& config = camera_configs[i];
+            Ogre::Camera* cam = scene_mgr->createCamera(i == 0 ? Ogre::String("PlayerCam")
+                                                               : "Camera" + Ogre::StringConverter::toString(i));
+
+            cam->setNearClipDistance(5);
+            cam->setAspectRatio((double)width/(double)height);
+            cam->setFOVy(config.fov_y);
+            cam->setPosition(config.position);
+            cam->setDirection(sin(config.yaw) * cos(config.pitch), sin(config.pitch), -cos(config.yaw) * cos(config.pitch));
+
+            cameras.push_back(cam);
+        }
+
+        // the window looks through the first camera
+
+        camera = cameras.front();
+
+        sky = SKY_MATERIAL;
+        sky_enabled = true;
+        scene_mgr->setSkyDome(sky_enabled, sky, 5, 8);
+
+        light = scene_mgr->createLight();
+        light->setPosition(20, 80, 50);
+        light->setDiffuseColour(1.0, 1.0, 1.0);
+
+        initialise_scene(scene);
+
+        robots = std::make_unique<RobotFactory>(scene_mgr, robot_model, robot_instancing, std::max(robot_placements.size(), size_t(1)));
+        for (const auto& placement : robot_placements)
+            robots->spawn(placement);
+
+        // the state we start in is what the scene was built with
+
+        state.camera_pos = camera_configs.front().position;
+        state.camera_pitch = camera_configs.front().pitch;
+        state.camera_yaw = camera_configs.front().yaw;
+        state.ball_pos = ball_node->getPosition();
+        state.last_ball_pos = state.ball_pos;
+        state.ball_velocity = Ogre::Vector3::ZERO;
+        state.joint_angles.assign(robots->size() * robots->joint_count(), 0.0f);
+        state.robot_placements = robot_placements;
+
+        // setup render to texture
+
+        readback = std::make_unique<RenderTextureRing>(prefix + "RttTex", cameras, width, height,
+                Ogre::PF_R8G8B8, readback_buffers, nullptr);
+
+        // the label pass sees the same cameras through the label scheme, flat and without sky or shadows
+
+        if (label_scale > 0)
+        {
+            labels = std::make_unique<RenderTextureRing>(prefix + "LabelTex", cameras, width / label_scale, height / label_scale,
+                    Ogre::PF_R8G8B8, readback_buffers, nullptr);
+            labels->set_material_scheme(LabelScheme::SCHEME, false, false);
+        }
+    }
+
+    World::~World()
+    {
+        labels.reset();
+        readback.reset();
+        robots.reset();
+        ogre_root->destroySceneManager(scene_mgr);
+    }
+
+    void World::start_job(const ScenarioJob& job)
+    {
+        this->job = job;
+        free_running = false;
+        frames_remaining = job.frames;
+        state = job.initial_state;
+        time_tally = 0;
+
+        // joints the scenario doesn't give start at zero
+        state.joint_angles.resize(robots->size() * robots->joint_count(), 0.0f);
+
+        apply_state();
+    }
+
+    bool World::is_active() const
+    {
+        return free_running || frames_remaining > 0;
+    }
+
+    void World::apply_state()
+    {
+        camera->setPosition(state.camera_pos);
+        camera->setDirection(sin(state.camera_yaw) * cos(state.camera_pitch)
+                           , sin(state.camera_pitch)
+                           , -cos(state.camera_yaw) * cos(state.camera_pitch));
+        ball_node->setPosition(state.ball_pos);
+        robots->set_joint_angles(state.joint_angles.data(), state.joint_angles.size());
+
+        if (!state.robot_placements.empty())
+        {
+            placements = state.robot_placements;
+            for (size_t i = 0; i < std::min(placements.size(), robots->size()); ++i)
+                robots->place(i, placements[i]);
+        }
+
+        light->setDiffuseColour(state.light_colour);
+        scene_mgr->setAmbientLight(state.ambient_light);
+
+        // the dome is only rebuilt when the sky actually changes
+        const Ogre::String& next_sky = state.sky.empty() ? Ogre::String(SKY_MATERIAL) : state.sky;
+        if (next_sky != sky)
+        {
+            sky = next_sky;
+            scene_mgr->setSkyDome(sky_enabled, sky, 5, 8);
+        }
+    }
+
+    void World::set_quality(const QualityTier& tier)
+    {
+        scene_mgr->setShadowTechnique(shadow_technique(tier.shadows));
+
+        // as in apply_state, the dome is only rebuilt when the tier turns the sky on or off
+        if (tier.sky != sky_enabled)
+        {
+            sky_enabled = tier.sky;
+            scene_mgr->setSkyDome(sky_enabled, sky, 5, 8);
+        }
+
+        for (auto cam : cameras)
+            cam->setLodBias(tier.lod_bias);
+
+        for (auto caster : stadium_casters)
+            caster->setCastShadows(tier.stadium_shadows);
+        for (auto caster : ball_casters)
+            caster->setCastShadows(tier.ball_shadows);
+        robots->set_cast_shadows(tier.robot_shadows);
+    }
+
+    void World::set_state(const WorldState& state)
+    {
+        this->state = state;
+        apply_state();
+    }
+
+    void World::set_joint_angles(const std::vector<float>& angles)
+    {
+        state.joint_angles = angles;
+        robots->set_joint_angles(angles.data(), angles.size());
+    }
+
+    void World::render(NUClear::clock::time_point timestamp, bool with_labels)
+    {
+        readback->render(timestamp);
+
+        if (labels && with_labels)
+            labels->render(timestamp);
+
+        if (!free_running && frames_remaining > 0)
+            --frames_remaining;
+    }
+
+    void World::animate(Ogre::Real step)
+    {
+        for (auto animation : animations)
+            animation->addTime(step);
+    }
+
+    void World::calculate_world(std::chrono::duration<double> time_span)
+    {
+        time_tally += time_span.count();
+        //camera->yaw(Ogre::Radian(cos(time_tally * 2.0) / 30.0));
+    }
+
+    void World::move_ball(const Ogre::Vector3& position, Ogre::Real radius)
+    {
+        state.last_ball_pos = state.ball_pos;
+        state.ball_pos = position;
+        ball_node->setPosition(position);
+
+        // rolling without slipping turns the ball about the horizontal axis across its path
+        Ogre::Vector3 moved = position - state.last_ball_pos;
+        moved.y = 0;
+        Ogre::Real distance = moved.length();
+        if (distance > 1e-6f && radius > 0)
+        {
+            Ogre::Vector3 axis = Ogre::Vector3::UNIT_Y.crossProduct(moved / distance);
+            ball_node->rotate(axis, Ogre::Radian(distance / radius), Ogre::Node::TS_WORLD);
+        }
+    }
+
+    void World::move_robot(size_t robot, Ogre::Real x, Ogre::Real z)
+    {
+        placements[robot].position.x = x;
+        placements[robot].position.z = z;
+        robots->place(robot, placements[robot]);
+
+        if (robot < state.robot_placements.size())
+            state.robot_placements[robot] = placements[robot];
+    }
+
+    void World::initialise_scene(const SceneCache& scene)
+    {
+        // nodes always come after their parents so one pass builds the whole tree
+
+        std::vector<Ogre::SceneNode*> nodes(scene.node_count());
+        ball_node = nullptr;
+
+        for (size_t i = 0; i < scene.node_count(); ++i)
+        {
+            const SceneNodeRecord& record = scene.nodes()[i];
+
+            Ogre::SceneNode* parent = record.parent < 0 ? scene_mgr->getRootSceneNode() : nodes[record.parent];
+            Ogre::SceneNode* node = parent->createChildSceneNode();
+            node->setPosition(record.position[0], record.position[1], record.position[2]);
+            node->setOrientation(record.orientation[0], record.orientation[1], record.orientation[2], record.orientation[3]);
+            node->setScale(record.scale[0], record.scale[1], record.scale[2]);
+            nodes[i] = node;
+
+            const bool is_ball = record.id != SceneCache::NO_STRING && Ogre::String(scene.string(record.id)) == "ball";
+
+            for (uint32_t j = 0; j < record.entity_count; ++j)
+            {
+                const SceneEntityRecord& e = scene.entities()[record.first_entity + j];
+
+                Ogre::String mesh = scene.string(e.mesh);
+                Ogre::Entity* entity = mesh == "plane" ? scene_mgr->createEntity(Ogre::SceneManager::PT_PLANE)
+                                                       : scene_mgr->createEntity(mesh);
+                entity->setMaterialName(scene.string(e.material));
+                entity->setCastShadows(e.cast_shadows != 0);
+                node->attachObject(entity);
+
+                if (e.cast_shadows)
+                    (is_ball ? ball_casters : stadium_casters).push_back(entity);
+
+                if (e.animation != SceneCache::NO_STRING)
+                {
+                    Ogre::AnimationState* animation = entity->getAnimationState(scene.string(e.animation));
+                    animation->setEnabled(true);
+                    animation->setLoop(true);
+                    animations.push_back(animation);
+                }
+            }
+
+            if (is_ball)
+            {
+                ball_node = node;
+            }
+        }
+
+        // the ball is moved by scenarios so the scene has to have one
+        if (!ball_node)
+        {
+            ball_node = scene_mgr->getRootSceneNode()->createChildSceneNode();
+        }
+    }
+}
+}
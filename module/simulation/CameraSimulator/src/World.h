@@ -0,0 +1,196 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_WORLD_H
+#define MODULE_SIMULATOR_WORLD_H
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <OgreCamera.h>
+#include <OgreEntity.h>
+#include <OgreRoot.h>
+#include <OgreSceneManager.h>
+
+#include "RenderQuality.h"
+#include "RenderTextureRing.h"
+#include "RobotFactory.h"
+#include "SceneCache.h"
+
+namespace module {
+namespace simulation {
+
+	class WorldState {
+
+	public:
+
+		Ogre::Vector3 camera_pos;
+		Ogre::Real camera_pitch;
+		Ogre::Real camera_yaw;
+
+		Ogre::Vector3 ball_pos;
+		Ogre::Vector3 last_ball_pos;
+		// what the ball starts a scenario moving at, once the dynamics take over the ball moves itself
+		Ogre::Vector3 ball_velocity;
+
+		// one row of the robot model's joint angles per robot, radians
+		std::vector<float> joint_angles;
+
+		// the light the world is lit by, and its sky's material or empty for SKY_MATERIAL
+		Ogre::ColourValue light_colour = Ogre::ColourValue::White;
+		Ogre::ColourValue ambient_light = Ogre::ColourValue(0.5f, 0.5f, 0.5f);
+		Ogre::String sky;
+
+		// where each robot stands, empty leaves them where they are
+		std::vector<RobotPlacement> robot_placements;
+
+		// multiplies the configured sensor noise of frames rendered from this state
+		float noise_level = 1.0f;
+	};
+
+	class CameraConfig {
+
+	public:
+
+		unsigned int id;
+		Ogre::Vector3 position;
+		Ogre::Real pitch;
+		Ogre::Real yaw;
+		Ogre::Degree fov_y;
+	};
+
+	/**
+	 * A piece of work for a world: start from initial_state and render frames frames.
+	 */
+	class ScenarioJob {
+
+	public:
+
+		unsigned int id;
+		unsigned int frames;
+		WorldState initial_state;
+		// drawn by the ScenarioGenerator, whose episode id is
+		bool generated = false;
+	};
+
+	/**
+	 * One independent copy of the stadium: its own scene manager, cameras, render target ring and state.
+	 *
+	 * Ogre only allows a single Root per process so every world shares it (and its GL context), which means
+	 * worlds are rendered one after another on the render thread. What they buy is that the scene graph,
+	 * state and readback of each are independent, so their CPU work can run in parallel and they can each
+	 * be given different scenarios.
+	 */
+	class World {
+
+	public:
+
+		World(unsigned int id
+			, Ogre::Root* root
+			, const SceneCache& scene
+			, const RobotModel& robot_model
+			, const std::vector<RobotPlacement>& robot_placements
+			, bool robot_instancing
+			, const std::vector<CameraConfig>& camera_configs
+			, unsigned int width
+			, unsigned int height
+			, size_t readback_buffers
+			, unsigned int label_scale);
+		~World();
+
+		/// The sky every world uses, which isn't part of the scene description
+		static const char* const SKY_MATERIAL;
+
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		/// @brief Starts a scenario, moving the first camera and the ball to its initial state
+		void start_job(const ScenarioJob& job);
+
+		/// @brief True while the world has a scenario with frames left to render, or always if it is free running
+		bool is_active() const;
+
+		/// @brief Changes the world to state in place, moving what has moved and relighting it
+		void set_state(const WorldState& state);
+
+		/// @brief Renders with tier's shadows, sky, level of detail and shadow casters from the next frame on
+		void set_quality(const QualityTier& tier);
+
+		/// @brief Poses every robot, see WorldState::joint_angles
+		void set_joint_angles(const std::vector<float>& angles);
+
+		void calculate_world(std::chrono::duration<double> time_span);
+
+		/// @brief Moves the ball, rolling it over the ground by as far as it went as a ball of radius would
+		void move_ball(const Ogre::Vector3& position, Ogre::Real radius);
+
+		/// @brief Moves a robot across the field, keeping its height and heading
+		void move_robot(size_t robot, Ogre::Real x, Ogre::Real z);
+		void animate(Ogre::Real step);
+
+		/// @brief Renders the next frame into the readback ring, counting it against the current job
+		void render(NUClear::clock::time_point timestamp, bool with_labels);
+
+
+		const unsigned int id;
+		WorldState state;
+
+		Ogre::SceneManager* scene_mgr;
+		Ogre::Camera* camera;
+		std::vector<Ogre::Camera*> cameras;
+		std::vector<CameraConfig> camera_configs;
+		std::unique_ptr<RenderTextureRing> readback;
+		// class ids of the same views at 1 / label_scale resolution, only on the frames asked for. Null when
+		// there is no label pass
+		std::unique_ptr<RenderTextureRing> labels;
+		std::unique_ptr<RobotFactory> robots;
+		// where each robot stands now, starting where it was placed
+		std::vector<RobotPlacement> placements;
+
+		bool free_running;
+		ScenarioJob job;
+		unsigned int frames_remaining;
+
+	private:
+
+		void initialise_scene(const SceneCache& scene);
+		void apply_state();
+
+		Ogre::Root* ogre_root;
+		Ogre::String prefix;
+
+		double time_tally;
+
+		std::vector<Ogre::AnimationState*> animations;
+
+		Ogre::SceneNode* ball_node;
+		Ogre::Light* light;
+		Ogre::String sky;
+		bool sky_enabled;
+
+		// the scene's entities described as casting shadows, which the quality tier can turn off
+		std::vector<Ogre::MovableObject*> stadium_casters;
+		std::vector<Ogre::MovableObject*> ball_casters;
+	};
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_WORLD_H
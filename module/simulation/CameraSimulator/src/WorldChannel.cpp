@@ -0,0 +1,311 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "WorldChannel.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace module {
+namespace simulation {
+
+    using message::input::Image;
+    using message::input::ImageFormat;
+    using message::simulation::GroundTruth;
+    using message::simulation::LabelImage;
+
+    namespace {
+
+        const uint32_t MAGIC = 0x43444c57;
+
+        // far beyond any image, a bigger size means the stream is out of step
+        const uint64_t MAX_SIZE = uint64_t(1) << 32;
+
+        struct Header {
+            uint32_t magic;
+            uint32_t kind;
+            uint64_t size;
+        };
+
+        struct ImageFields {
+            int64_t timestamp;
+            uint32_t width;
+            uint32_t height;
+            uint32_t format;
+            uint32_t camera_id;
+            uint32_t world_id;
+            uint32_t padding;
+        };
+
+        struct LabelFields {
+            int64_t timestamp;
+            uint32_t width;
+            uint32_t height;
+            uint32_t scale;
+            uint32_t camera_id;
+            uint32_t world_id;
+            uint32_t padding;
+        };
+
+        struct TruthFields {
+            int64_t timestamp;
+            uint32_t camera_id;
+            uint32_t world_id;
+            uint32_t width;
+            uint32_t height;
+            GroundTruth::Ball ball;
+            uint32_t features;
+            uint32_t robots;
+        };
+
+        int64_t ticks(NUClear::clock::time_point time)
+        {
+            return time.time_since_epoch().count();
+        }
+
+        NUClear::clock::time_point time_point(int64_t ticks)
+        {
+            return NUClear::clock::time_point(NUClear::clock::duration(ticks));
+        }
+
+        bool write_all(int fd, const void* data, size_t size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            while (size > 0)
+            {
+                // a world that has gone away shouldn't take its sender down with SIGPIPE
+                ssize_t written = ::send(fd, bytes, size, MSG_NOSIGNAL);
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (written <= 0)
+                {
+                    return false;
+                }
+                bytes += written;
+                size -= written;
+            }
+            return true;
+        }
+
+        bool read_all(int fd, void* data, size_t size)
+        {
+            uint8_t* bytes = static_cast<uint8_t*>(data);
+            while (size > 0)
+            {
+                ssize_t got = ::recv(fd, bytes, size, 0);
+                if (got < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (got <= 0)
+                {
+                    return false;
+                }
+                bytes += got;
+                size -= got;
+            }
+            return true;
+        }
+    }
+
+    WorldChannel::WorldChannel(int fd)
+    : fd(fd) {}
+
+    WorldChannel::~WorldChannel()
+    {
+        ::close(fd);
+    }
+
+    bool WorldChannel::send(Kind kind, std::initializer_list<Part> parts)
+    {
+        Header header = { MAGIC, uint32_t(kind), 0 };
+        for (const auto& part : parts)
+        {
+            header.size += part.size;
+        }
+
+        std::lock_guard<std::mutex> lock(send_mutex);
+
+        if (!write_all(fd, &header, sizeof(header)))
+        {
+            return false;
+        }
+        for (const auto& part : parts)
+        {
+            if (!write_all(fd, part.data, part.size))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool WorldChannel::send(const Image& image)
+    {
+        ImageFields fields = { ticks(image.timestamp), image.width, image.height, uint32_t(image.format)
+                             , image.camera_id, image.world_id, 0 };
+
+        return send(Kind::IMAGE, { { &fields, sizeof(fields) }
+                                 , { image.pixels(), message::input::image_size(image.format, image.width, image.height) } });
+    }
+
+    bool WorldChannel::send(const LabelImage& labels)
+    {
+        LabelFields fields = { ticks(labels.timestamp), labels.width, labels.height, labels.scale
+                             , labels.camera_id, labels.world_id, 0 };
+
+        return send(Kind::LABELS, { { &fields, sizeof(fields) }, { labels.labels.data(), labels.labels.size() } });
+    }
+
+    bool WorldChannel::send(const GroundTruth& truth)
+    {
+        TruthFields fields = { ticks(truth.timestamp), truth.camera_id, truth.world_id, truth.width, truth.height
+                             , truth.ball, uint32_t(truth.features.size()), uint32_t(truth.robots.size()) };
+
+        return send(Kind::GROUND_TRUTH, { { &fields, sizeof(fields) }
+                                        , { truth.features.data(), truth.features.size() * sizeof(GroundTruth::Feature) }
+                                        , { truth.robots.data(), truth.robots.size() * sizeof(GroundTruth::Robot) } });
+    }
+
+    bool WorldChannel::send(const message::simulation::KickBall& kick)
+    {
+        return send(Kind::KICK, { { &kick, sizeof(kick) } });
+    }
+
+    bool WorldChannel::send(const message::simulation::RobotVelocity& velocity)
+    {
+        return send(Kind::VELOCITY, { { &velocity, sizeof(velocity) } });
+    }
+
+    bool WorldChannel::send_manifest_row(const std::string& row)
+    {
+        return send(Kind::MANIFEST_ROW, { { row.data(), row.size() } });
+    }
+
+    bool WorldChannel::receive(Message& message)
+    {
+        Header header;
+        if (!read_all(fd, &header, sizeof(header)) || header.magic != MAGIC || header.size > MAX_SIZE)
+        {
+            return false;
+        }
+
+        message.kind = Kind(header.kind);
+        switch (message.kind)
+        {
+            case Kind::IMAGE:
+            {
+                // the pixels are read straight into the image's own buffer
+                ImageFields fields;
+                if (header.size < sizeof(fields) || !read_all(fd, &fields, sizeof(fields))
+                    || fields.format >= message::input::IMAGE_FORMAT_COUNT)
+                {
+                    return false;
+                }
+
+                std::vector<uint8_t> data(header.size - sizeof(fields));
+                if (data.size() != message::input::image_size(ImageFormat(fields.format), fields.width, fields.height)
+                    || !read_all(fd, data.data(), data.size()))
+                {
+                    return false;
+                }
+
+                message.image = std::make_unique<Image>(fields.width, fields.height, time_point(fields.timestamp)
+                                                      , std::move(data), ImageFormat(fields.format));
+                message.image->camera_id = fields.camera_id;
+                message.image->world_id = fields.world_id;
+                return true;
+            }
+
+            case Kind::LABELS:
+            {
+                LabelFields fields;
+                if (header.size < sizeof(fields) || !read_all(fd, &fields, sizeof(fields))
+                    || header.size - sizeof(fields) != uint64_t(fields.width) * fields.height)
+                {
+                    return false;
+                }
+
+                message.labels = std::make_unique<LabelImage>();
+                message.labels->width = fields.width;
+                message.labels->height = fields.height;
+                message.labels->scale = fields.scale;
+                message.labels->timestamp = time_point(fields.timestamp);
+                message.labels->camera_id = fields.camera_id;
+                message.labels->world_id = fields.world_id;
+                message.labels->labels.resize(header.size - sizeof(fields));
+                return read_all(fd, message.labels->labels.data(), message.labels->labels.size());
+            }
+
+            case Kind::GROUND_TRUTH:
+            {
+                TruthFields fields;
+                if (header.size < sizeof(fields) || !read_all(fd, &fields, sizeof(fields))
+                    || header.size - sizeof(fields) != fields.features * sizeof(GroundTruth::Feature)
+                                                     + fields.robots * sizeof(GroundTruth::Robot))
+                {
+                    return false;
+                }
+
+                message.ground_truth = std::make_unique<GroundTruth>();
+                GroundTruth& truth = *message.ground_truth;
+                truth.timestamp = time_point(fields.timestamp);
+                truth.camera_id = fields.camera_id;
+                truth.world_id = fields.world_id;
+                truth.width = fields.width;
+                truth.height = fields.height;
+                truth.ball = fields.ball;
+                truth.features.resize(fields.features);
+                truth.robots.resize(fields.robots);
+                return read_all(fd, truth.features.data(), truth.features.size() * sizeof(GroundTruth::Feature))
+                    && read_all(fd, truth.robots.data(), truth.robots.size() * sizeof(GroundTruth::Robot));
+            }
+
+            case Kind::MANIFEST_ROW:
+            {
+                message.manifest_row.resize(header.size);
+                return read_all(fd, &message.manifest_row[0], header.size);
+            }
+
+            case Kind::KICK:
+            {
+                return header.size == sizeof(message.kick) && read_all(fd, &message.kick, sizeof(message.kick));
+            }
+
+            case Kind::VELOCITY:
+            {
+                return header.size == sizeof(message.velocity) && read_all(fd, &message.velocity, sizeof(message.velocity));
+            }
+
+            default: return false;
+        }
+    }
+
+    void WorldChannel::shutdown()
+    {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+
+}
+}
@@ -0,0 +1,110 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_WORLDCHANNEL_H
+#define MODULE_SIMULATOR_WORLDCHANNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "message/input/Image.h"
+#include "message/simulation/GroundTruth.h"
+#include "message/simulation/KickBall.h"
+#include "message/simulation/LabelImage.h"
+#include "message/simulation/RobotVelocity.h"
+
+namespace module {
+namespace simulation {
+
+    /**
+     * One end of the socket between the simulator and a world it runs in a process of its own.
+     *
+     * The world sends up everything it renders (images, label images, ground truth and manifest rows) and is
+     * sent the kicks and robot velocities meant for it. Each message is a small header and its fields, written
+     * whole under a lock so any thread can send. Both ends are the same program, so fields go in native layout.
+     * Images travel without their sequence, which the receiving simulator numbers in its own stream.
+     */
+    class WorldChannel {
+    public:
+        enum class Kind : uint32_t {
+            IMAGE,
+            LABELS,
+            GROUND_TRUTH,
+            MANIFEST_ROW,
+            KICK,
+            VELOCITY
+        };
+
+        /// What receive read, only the member that kind names is filled in
+        struct Message {
+            Kind kind;
+            std::unique_ptr<message::input::Image> image;
+            std::unique_ptr<message::simulation::LabelImage> labels;
+            std::unique_ptr<message::simulation::GroundTruth> ground_truth;
+            std::string manifest_row;
+            message::simulation::KickBall kick;
+            message::simulation::RobotVelocity velocity;
+        };
+
+        /// @brief Takes over a connected stream socket, which is closed with the channel
+        explicit WorldChannel(int fd);
+        ~WorldChannel();
+
+        WorldChannel(const WorldChannel&) = delete;
+        WorldChannel& operator=(const WorldChannel&) = delete;
+
+        /// @return false once the other end has gone
+        bool send(const message::input::Image& image);
+        bool send(const message::simulation::LabelImage& labels);
+        bool send(const message::simulation::GroundTruth& truth);
+        bool send(const message::simulation::KickBall& kick);
+        bool send(const message::simulation::RobotVelocity& velocity);
+        bool send_manifest_row(const std::string& row);
+
+        /**
+         * Waits for the next message. Only one thread may receive.
+         *
+         * @return false once the other end has gone or shut down, or if what arrived isn't a message
+         */
+        bool receive(Message& message);
+
+        /// @brief Ends the stream both ways, waking a blocked receive on either end without closing the socket under it
+        void shutdown();
+
+    private:
+        struct Part {
+            const void* data;
+            size_t size;
+        };
+
+        /// @brief Sends the header and then each part, as one message
+        bool send(Kind kind, std::initializer_list<Part> parts);
+
+        const int fd;
+        std::mutex send_mutex;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_WORLDCHANNEL_H
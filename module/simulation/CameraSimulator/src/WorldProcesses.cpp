@@ -0,0 +1,233 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "WorldProcesses.h"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        // how long stopped worlds get to shut their renderers down before they are killed
+        const std::chrono::seconds STOP_TIMEOUT(5);
+
+        void wait_for(const std::vector<pid_t>& pids)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + STOP_TIMEOUT;
+
+            for (size_t i = 0; i < pids.size(); ++i)
+            {
+                int status = 0;
+                pid_t done = 0;
+                while ((done = waitpid(pids[i], &status, WNOHANG)) == 0 && std::chrono::steady_clock::now() < deadline)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+
+                if (done == 0)
+                {
+                    std::cout << "World " << i << " didn't stop, killing it\n";
+                    kill(pids[i], SIGKILL);
+                    waitpid(pids[i], &status, 0);
+                }
+                else if (done > 0 && !(WIFEXITED(status) && WEXITSTATUS(status) == 0))
+                {
+                    std::cout << "World " << i << " exited with "
+                              << (WIFSIGNALED(status) ? "signal " : "status ")
+                              << (WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status)) << "\n";
+                }
+            }
+        }
+    }
+
+    const char* const WorldProcesses::CONFIG_VARIABLE = "CAMERA_SIMULATOR_CONFIG";
+
+    YAML::Node WorldProcesses::world_config(const YAML::Node& config, size_t index, size_t count, int channel_fd)
+    {
+        YAML::Node world = YAML::Clone(config);
+        world["worlds"] = 1;
+        world.remove("world_processes");
+        world.remove("dataset");
+        world.remove("record");
+
+        // scenarios keep the id they would have had in one process
+        if (YAML::Node scenario_list = config["scenarios"])
+        {
+            YAML::Node share(YAML::NodeType::Sequence);
+            for (size_t i = index; i < scenario_list.size(); i += count)
+            {
+                YAML::Node scenario = YAML::Clone(scenario_list[i]);
+                if (!scenario["id"])
+                    scenario["id"] = i;
+                share.push_back(scenario);
+            }
+            world["scenarios"] = share;
+        }
+
+        world["world_process"]["index"] = index;
+        world["world_process"]["count"] = count;
+        world["world_process"]["channel"] = channel_fd;
+        return world;
+    }
+
+    std::vector<std::string> WorldProcesses::own_command()
+    {
+        // the arguments are nul terminated, and the program is run again through its link so a moved or
+        // relative argv[0] doesn't matter
+        std::ifstream cmdline("/proc/self/cmdline", std::ios::binary);
+        std::string arguments((std::istreambuf_iterator<char>(cmdline)), std::istreambuf_iterator<char>());
+
+        std::vector<std::string> command = { "/proc/self/exe" };
+        size_t start = arguments.find('\0');
+        while (start != std::string::npos && start + 1 < arguments.size())
+        {
+            size_t end = arguments.find('\0', start + 1);
+            command.push_back(arguments.substr(start + 1, end - start - 1));
+            start = end;
+        }
+        return command;
+    }
+
+    WorldProcesses::WorldProcesses(const std::vector<std::string>& command, const YAML::Node& config, size_t count)
+    {
+        if (command.empty())
+        {
+            throw std::runtime_error("World processes need a command to run");
+        }
+
+        try
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                // our end is closed on exec so each world only ever holds its own
+                int fds[2];
+                if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+                {
+                    throw std::runtime_error(std::string("Can't connect to a world process: ") + std::strerror(errno));
+                }
+                channels.push_back(std::make_unique<WorldChannel>(fds[0]));
+
+                char path[] = "/tmp/CameraSimulator.world.XXXXXX";
+                int config_fd = mkstemp(path);
+                if (config_fd < 0)
+                {
+                    close(fds[1]);
+                    throw std::runtime_error(std::string("Can't write a world configuration: ") + std::strerror(errno));
+                }
+                close(config_fd);
+                config_paths.push_back(path);
+
+                YAML::Emitter out;
+                out << world_config(config, i, count, fds[1]);
+                std::ofstream(path) << out.c_str() << "\n";
+
+                // only async signal safe calls are allowed between fork and exec, so everything is built first
+
+                std::vector<std::string> environment = { std::string(CONFIG_VARIABLE) + "=" + path };
+                for (char** variable = environ; *variable; ++variable)
+                {
+                    if (std::strncmp(*variable, CONFIG_VARIABLE, std::strlen(CONFIG_VARIABLE)) != 0
+                        || (*variable)[std::strlen(CONFIG_VARIABLE)] != '=')
+                        environment.push_back(*variable);
+                }
+
+                std::vector<char*> argv;
+                for (const auto& argument : command)
+                    argv.push_back(const_cast<char*>(argument.c_str()));
+                argv.push_back(nullptr);
+
+                std::vector<char*> envp;
+                for (const auto& variable : environment)
+                    envp.push_back(const_cast<char*>(variable.c_str()));
+                envp.push_back(nullptr);
+
+                pid_t pid = fork();
+                if (pid == 0)
+                {
+                    fcntl(fds[1], F_SETFD, 0);
+                    execve(argv[0], argv.data(), envp.data());
+                    _exit(127);
+                }
+                close(fds[1]);
+
+                if (pid < 0)
+                {
+                    throw std::runtime_error(std::string("Can't start a world process: ") + std::strerror(errno));
+                }
+                pids.push_back(pid);
+            }
+        }
+        catch (...)
+        {
+            stop();
+            wait_for(pids);
+            for (const auto& path : config_paths)
+                std::remove(path.c_str());
+            throw;
+        }
+    }
+
+    WorldProcesses::~WorldProcesses()
+    {
+        stop();
+        wait_for(pids);
+
+        for (const auto& path : config_paths)
+        {
+            std::remove(path.c_str());
+        }
+    }
+
+    size_t WorldProcesses::size() const
+    {
+        return channels.size();
+    }
+
+    WorldChannel& WorldProcesses::channel(size_t index)
+    {
+        return *channels[index];
+    }
+
+    void WorldProcesses::stop()
+    {
+        for (auto& channel : channels)
+        {
+            channel->shutdown();
+        }
+    }
+
+}
+}
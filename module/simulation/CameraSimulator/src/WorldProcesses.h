@@ -0,0 +1,90 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_WORLDPROCESSES_H
+#define MODULE_SIMULATOR_WORLDPROCESSES_H
+
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+#include "WorldChannel.h"
+
+namespace module {
+namespace simulation {
+
+    /**
+     * Runs every world of the simulator in a process of its own.
+     *
+     * Ogre allows one root per process, so worlds sharing a process share its GL context and render one after
+     * another. Started as separate processes of the same program each world gets a context and render thread
+     * of its own, and worlds render in parallel until the GPU or rasteriser runs out. Each process is given
+     * a copy of the configuration cut down to its share (see world_config) through CONFIG_VARIABLE, which
+     * also says which of its descriptors is its WorldChannel back to this process.
+     */
+    class WorldProcesses {
+    public:
+        /// The environment variable the simulator reads its configuration path from
+        static const char* const CONFIG_VARIABLE;
+
+        /**
+         * The configuration of world index of count: one world, whose id is index, every count'th scenario
+         * starting from index (keeping their ids), and without world processes, a dataset or a recording,
+         * which stay with the process that started it. world_process tells it which share of the randomised
+         * episodes is its and where its channel is.
+         */
+        static YAML::Node world_config(const YAML::Node& config, size_t index, size_t count, int channel_fd);
+
+        /// @brief This program as it was started, to run again for each world
+        static std::vector<std::string> own_command();
+
+        /**
+         * Starts count processes running command, the first element being the program, each with its
+         * world_config of config.
+         *
+         * @throws std::runtime_error if a configuration can't be written or a process can't be started
+         */
+        WorldProcesses(const std::vector<std::string>& command, const YAML::Node& config, size_t count);
+
+        /// @brief Stops the worlds and waits for them, killing any still running after a few seconds
+        ~WorldProcesses();
+
+        WorldProcesses(const WorldProcesses&) = delete;
+        WorldProcesses& operator=(const WorldProcesses&) = delete;
+
+        size_t size() const;
+
+        /// @brief The channel to the world whose id is index
+        WorldChannel& channel(size_t index);
+
+        /// @brief Shuts every channel down, which each world takes as its cue to stop, and wakes its readers
+        void stop();
+
+    private:
+        std::vector<pid_t> pids;
+        std::vector<std::unique_ptr<WorldChannel>> channels;
+        std::vector<std::string> config_paths;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_WORLDPROCESSES_H
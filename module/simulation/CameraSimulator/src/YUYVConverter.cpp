@@ -0,0 +1,366 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "YUYVConverter.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define YUYV_CONVERTER_X86
+    #include <immintrin.h>
+#endif
+
+namespace module {
+namespace simulation {
+
+    namespace {
+
+        // Luma coefficients (Q15)
+        constexpr int Y_R = 9798;
+        constexpr int Y_G = 19235;
+        constexpr int Y_B = 3735;
+        constexpr int Y_ROUND = 1 << 14;
+
+        // Chroma coefficients (Q15), applied to the sum of a pixel pair so the shift is one larger
+        constexpr int CB_R = -5529;
+        constexpr int CB_G = -10855;
+        constexpr int CB_B = 16384;
+        constexpr int CR_R = 16384;
+        constexpr int CR_G = -13720;
+        constexpr int CR_B = -2664;
+        // Halves round down, otherwise saturated blue or red (16384 * 510 + 2^23 + 2^15) comes to 256
+        constexpr int C_OFFSET = (128 << 16) + (1 << 15) - 1;
+
+        template <int R, int G, int B, int N>
+        void scalar_row(const uint8_t* src, uint8_t* dst, unsigned int x, unsigned int width)
+        {
+
+            for (; x < width; x += 2)
+            {
+                const uint8_t* p = src + x * N;
+
+                const int r0 = p[R];
+                const int g0 = p[G];
+                const int b0 = p[B];
+                const int r1 = p[N + R];
+                const int g1 = p[N + G];
+                const int b1 = p[N + B];
+
+                const int rs = r0 + r1;
+                const int gs = g0 + g1;
+                const int bs = b0 + b1;
+
+                uint8_t* out = dst + x * 2;
+                out[0] = uint8_t((Y_R * r0 + Y_G * g0 + Y_B * b0 + Y_ROUND) >> 15);
+                out[1] = uint8_t((CB_R * rs + CB_G * gs + CB_B * bs + C_OFFSET) >> 16);
+                out[2] = uint8_t((Y_R * r1 + Y_G * g1 + Y_B * b1 + Y_ROUND) >> 15);
+                out[3] = uint8_t((CR_R * rs + CR_G * gs + CR_B * bs + C_OFFSET) >> 16);
+            }
+        }
+
+        // Converts pixels [x, width) of a row, used directly and to finish the tail of the SIMD kernels
+        void scalar_tail(const uint8_t* src, uint8_t* dst, unsigned int x, unsigned int width, PixelLayout layout)
+        {
+
+            switch (layout)
+            {
+                case PixelLayout::BGRX: scalar_row<2, 1, 0, 4>(src, dst, x, width); break;
+                case PixelLayout::RGBX: scalar_row<0, 1, 2, 4>(src, dst, x, width); break;
+                case PixelLayout::BGR:  scalar_row<2, 1, 0, 3>(src, dst, x, width); break;
+                case PixelLayout::RGB:  scalar_row<0, 1, 2, 3>(src, dst, x, width); break;
+            }
+        }
+
+        void scalar_kernel(const uint8_t* src, uint8_t* dst, unsigned int width, PixelLayout layout)
+        {
+            scalar_tail(src, dst, 0, width, layout);
+        }
+
+        bool is_red_first(PixelLayout layout)
+        {
+            return layout == PixelLayout::RGBX || layout == PixelLayout::RGB;
+        }
+
+#ifdef YUYV_CONVERTER_X86
+
+        uint32_t load_u32(const uint8_t* p)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        /*
+         * SSE2: 8 pixels per step.
+         *
+         * Each pixel is widened to a 32 bit lane holding its three bytes, the channels are narrowed to 16 bits and
+         * the dot products are done with madd. Chroma uses madd against a broadcast coefficient, which sums each
+         * adjacent pixel pair for free. The result lanes are Y0 | Cb << 8 | Y1 << 16 | Cr << 24, which is YUYV.
+         */
+        __attribute__((target("sse2")))
+        inline __m128i sse2_yuyv(__m128i r, __m128i g, __m128i b)
+        {
+
+            const __m128i k_rg  = _mm_set1_epi32((Y_G << 16) | Y_R);
+            const __m128i k_b   = _mm_set1_epi32((Y_ROUND << 16) | Y_B);
+            const __m128i one   = _mm_set1_epi16(1);
+
+            __m128i rg_lo = _mm_unpacklo_epi16(r, g);
+            __m128i rg_hi = _mm_unpackhi_epi16(r, g);
+            __m128i b_lo  = _mm_unpacklo_epi16(b, one);
+            __m128i b_hi  = _mm_unpackhi_epi16(b, one);
+
+            __m128i y_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(rg_lo, k_rg), _mm_madd_epi16(b_lo, k_b)), 15);
+            __m128i y_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(rg_hi, k_rg), _mm_madd_epi16(b_hi, k_b)), 15);
+            __m128i y    = _mm_packs_epi32(y_lo, y_hi);
+
+            const __m128i offset = _mm_set1_epi32(C_OFFSET);
+
+            __m128i cb = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(r, _mm_set1_epi16(CB_R)),
+                                                     _mm_madd_epi16(g, _mm_set1_epi16(CB_G))),
+                                       _mm_add_epi32(_mm_madd_epi16(b, _mm_set1_epi16(CB_B)), offset));
+            __m128i cr = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(r, _mm_set1_epi16(CR_R)),
+                                                     _mm_madd_epi16(g, _mm_set1_epi16(CR_G))),
+                                       _mm_add_epi32(_mm_madd_epi16(b, _mm_set1_epi16(CR_B)), offset));
+            cb = _mm_srai_epi32(cb, 16);
+            cr = _mm_srai_epi32(cr, 16);
+
+            return _mm_or_si128(y, _mm_or_si128(_mm_slli_epi32(cb, 8), _mm_slli_epi32(cr, 24)));
+        }
+
+        // Splits two vectors of four widened pixels into eight 16 bit values of each channel and converts them
+        __attribute__((target("sse2")))
+        inline __m128i sse2_from_lanes(__m128i a, __m128i b, bool red_first)
+        {
+
+            const __m128i mask = _mm_set1_epi32(0xFF);
+
+            __m128i c0 = _mm_packs_epi32(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+            __m128i c1 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 8), mask),
+                                         _mm_and_si128(_mm_srli_epi32(b, 8), mask));
+            __m128i c2 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 16), mask),
+                                         _mm_and_si128(_mm_srli_epi32(b, 16), mask));
+
+            return red_first ? sse2_yuyv(c0, c1, c2) : sse2_yuyv(c2, c1, c0);
+        }
+
+        __attribute__((target("sse2")))
+        void sse2_kernel(const uint8_t* src, uint8_t* dst, unsigned int width, PixelLayout layout)
+        {
+
+            const bool red_first = is_red_first(layout);
+            unsigned int x = 0;
+
+            if (layout == PixelLayout::BGRX || layout == PixelLayout::RGBX)
+            {
+                for (; x + 8 <= width; x += 8)
+                {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4 + 16));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 2), sse2_from_lanes(a, b, red_first));
+                }
+            }
+            else
+            {
+                // Each 32 bit load reads one byte past its pixel, so stay two pixels clear of the end of the row
+                for (; x + 10 <= width; x += 8)
+                {
+                    const uint8_t* p = src + x * 3;
+                    __m128i a = _mm_set_epi32(load_u32(p + 9),  load_u32(p + 6),  load_u32(p + 3),  load_u32(p));
+                    __m128i b = _mm_set_epi32(load_u32(p + 21), load_u32(p + 18), load_u32(p + 15), load_u32(p + 12));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 2), sse2_from_lanes(a, b, red_first));
+                }
+            }
+
+            scalar_tail(src, dst, x, width, layout);
+        }
+
+        /*
+         * AVX2: 16 pixels per step, the same arithmetic as SSE2 in each 128 bit half.
+         *
+         * The in-lane packs leave the pixel pairs ordered 0-3, 8-11 | 4-7, 12-15, so the output is put back in
+         * order with a single 64 bit permute.
+         */
+        __attribute__((target("avx2")))
+        inline __m256i avx2_yuyv(__m256i r, __m256i g, __m256i b)
+        {
+
+            const __m256i k_rg = _mm256_set1_epi32((Y_G << 16) | Y_R);
+            const __m256i k_b  = _mm256_set1_epi32((Y_ROUND << 16) | Y_B);
+            const __m256i one  = _mm256_set1_epi16(1);
+
+            __m256i rg_lo = _mm256_unpacklo_epi16(r, g);
+            __m256i rg_hi = _mm256_unpackhi_epi16(r, g);
+            __m256i b_lo  = _mm256_unpacklo_epi16(b, one);
+            __m256i b_hi  = _mm256_unpackhi_epi16(b, one);
+
+            __m256i y_lo = _mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_madd_epi16(rg_lo, k_rg), _mm256_madd_epi16(b_lo, k_b)), 15);
+            __m256i y_hi = _mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_madd_epi16(rg_hi, k_rg), _mm256_madd_epi16(b_hi, k_b)), 15);
+            __m256i y    = _mm256_packs_epi32(y_lo, y_hi);
+
+            const __m256i offset = _mm256_set1_epi32(C_OFFSET);
+
+            __m256i cb = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(r, _mm256_set1_epi16(CB_R)),
+                                                           _mm256_madd_epi16(g, _mm256_set1_epi16(CB_G))),
+                                          _mm256_add_epi32(_mm256_madd_epi16(b, _mm256_set1_epi16(CB_B)), offset));
+            __m256i cr = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(r, _mm256_set1_epi16(CR_R)),
+                                                           _mm256_madd_epi16(g, _mm256_set1_epi16(CR_G))),
+                                          _mm256_add_epi32(_mm256_madd_epi16(b, _mm256_set1_epi16(CR_B)), offset));
+            cb = _mm256_srai_epi32(cb, 16);
+            cr = _mm256_srai_epi32(cr, 16);
+
+            __m256i out = _mm256_or_si256(y, _mm256_or_si256(_mm256_slli_epi32(cb, 8), _mm256_slli_epi32(cr, 24)));
+            return _mm256_permute4x64_epi64(out, 0xD8);
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i avx2_from_lanes(__m256i a, __m256i b, bool red_first)
+        {
+
+            const __m256i mask = _mm256_set1_epi32(0xFF);
+
+            __m256i c0 = _mm256_packs_epi32(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask));
+            __m256i c1 = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(a, 8), mask),
+                                            _mm256_and_si256(_mm256_srli_epi32(b, 8), mask));
+            __m256i c2 = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(a, 16), mask),
+                                            _mm256_and_si256(_mm256_srli_epi32(b, 16), mask));
+
+            return red_first ? avx2_yuyv(c0, c1, c2) : avx2_yuyv(c2, c1, c0);
+        }
+
+        // Loads 8 packed three byte pixels, four into each half, widened to 32 bit lanes
+        __attribute__((target("avx2")))
+        inline __m256i avx2_load_packed(const uint8_t* p)
+        {
+
+            const __m256i widen = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                   0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12));
+            return _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), widen);
+        }
+
+        __attribute__((target("avx2")))
+        void avx2_kernel(const uint8_t* src, uint8_t* dst, unsigned int width, PixelLayout layout)
+        {
+
+            const bool red_first = is_red_first(layout);
+            unsigned int x = 0;
+
+            if (layout == PixelLayout::BGRX || layout == PixelLayout::RGBX)
+            {
+                for (; x + 16 <= width; x += 16)
+                {
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+                    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4 + 32));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 2), avx2_from_lanes(a, b, red_first));
+                }
+            }
+            else
+            {
+                // The last 16 byte load reads four bytes past its pixels, so stay two pixels clear of the end
+                for (; x + 18 <= width; x += 16)
+                {
+                    const uint8_t* p = src + x * 3;
+                    __m256i a = avx2_load_packed(p);
+                    __m256i b = avx2_load_packed(p + 24);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 2), avx2_from_lanes(a, b, red_first));
+                }
+            }
+
+            scalar_tail(src, dst, x, width, layout);
+        }
+
+#endif  // YUYV_CONVERTER_X86
+    }
+
+    YUYVConverter::YUYVConverter() : YUYVConverter(best_kernel()) {}
+
+    YUYVConverter::YUYVConverter(ConversionKernel kernel)
+    {
+
+        selected = is_supported(kernel) ? kernel : ConversionKernel::SCALAR;
+
+        switch (selected)
+        {
+#ifdef YUYV_CONVERTER_X86
+            case ConversionKernel::AVX2: row_function = avx2_kernel; break;
+            case ConversionKernel::SSE2: row_function = sse2_kernel; break;
+#endif
+            default: row_function = scalar_kernel; break;
+        }
+    }
+
+    void YUYVConverter::convert(const PixelSource& src, uint8_t* dst) const
+    {
+        convert_rows(src, dst, 0, src.height);
+    }
+
+    void YUYVConverter::convert_rows(const PixelSource& src, uint8_t* dst, unsigned int first_row, unsigned int last_row) const
+    {
+
+        for (unsigned int row = first_row; row < last_row; ++row)
+        {
+            row_function(src.data + row * src.stride, dst + size_t(row) * src.width * 2, src.width, src.layout);
+        }
+    }
+
+    ConversionKernel YUYVConverter::kernel() const
+    {
+        return selected;
+    }
+
+    bool YUYVConverter::is_supported(ConversionKernel kernel)
+    {
+
+        switch (kernel)
+        {
+            case ConversionKernel::SCALAR: return true;
+#ifdef YUYV_CONVERTER_X86
+            case ConversionKernel::SSE2: return __builtin_cpu_supports("sse2");
+            case ConversionKernel::AVX2: return __builtin_cpu_supports("avx2");
+#endif
+            default: return false;
+        }
+    }
+
+    ConversionKernel YUYVConverter::best_kernel()
+    {
+
+        if (is_supported(ConversionKernel::AVX2))
+        {
+            return ConversionKernel::AVX2;
+        }
+        if (is_supported(ConversionKernel::SSE2))
+        {
+            return ConversionKernel::SSE2;
+        }
+        return ConversionKernel::SCALAR;
+    }
+
+    size_t YUYVConverter::bytes_per_pixel(PixelLayout layout)
+    {
+        return (layout == PixelLayout::BGRX || layout == PixelLayout::RGBX) ? 4 : 3;
+    }
+
+}
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_YUYVCONVERTER_H
+#define MODULE_SIMULATOR_YUYVCONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace module {
+namespace simulation {
+
+    /**
+     * Byte order of a pixel in memory (not the Ogre::PixelFormat name, which is native endian).
+     * The X byte of the four byte layouts is ignored.
+     */
+    enum class PixelLayout {
+        BGRX,
+        RGBX,
+        BGR,
+        RGB
+    };
+
+    enum class ConversionKernel {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    /**
+     * A locked block of rendered pixels. stride is the distance between rows in bytes, which may be
+     * larger than width * bytes per pixel when the driver pads rows.
+     */
+    struct PixelSource {
+        const uint8_t* data;
+        unsigned int width;
+        unsigned int height;
+        size_t stride;
+        PixelLayout layout;
+    };
+
+    /**
+     * Converts RGB to YUYV (full range BT.601, the same as JPEG) using 15 bit fixed point.
+     *
+     *     Y  = ( 9798 R + 19235 G +  3735 B + 2^14) >> 15
+     *     Cb = (-5529 Rs - 10855 Gs + 16384 Bs + 2^23 + 2^15 - 1) >> 16
+     *     Cr = (16384 Rs - 13720 Gs -  2664 Bs + 2^23 + 2^15 - 1) >> 16
+     *
+     * where Rs, Gs and Bs are the channel sums over each horizontal pixel pair. The coefficients of each
+     * row sum to 2^15 (or 0 for the chroma) and chroma rounds halves down, so every result lands in [0, 255]
+     * without clamping.
+     *
+     * All kernels produce bit identical output to the scalar kernel. width must be even and dst must hold
+     * width * height * 2 bytes.
+     */
+    class YUYVConverter {
+    public:
+        /// @brief Uses the fastest kernel supported by the running CPU
+        YUYVConverter();
+        /// @brief Uses the given kernel, falling back to the scalar kernel if the CPU does not support it
+        explicit YUYVConverter(ConversionKernel kernel);
+
+        void convert(const PixelSource& src, uint8_t* dst) const;
+
+        /// @brief Converts rows [first_row, last_row) only, so a frame can be split across threads
+        void convert_rows(const PixelSource& src, uint8_t* dst, unsigned int first_row, unsigned int last_row) const;
+
+        ConversionKernel kernel() const;
+
+        static bool is_supported(ConversionKernel kernel);
+        static ConversionKernel best_kernel();
+        static size_t bytes_per_pixel(PixelLayout layout);
+
+    private:
+        using RowFunction = void (*)(const uint8_t* src, uint8_t* dst, unsigned int width, PixelLayout layout);
+
+        ConversionKernel selected;
+        RowFunction row_function;
+    };
+
+}
+}
+
+#endif  // MODULE_SIMULATOR_YUYVCONVERTER_H
@@ -0,0 +1,107 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MODULE_SIMULATOR_TESTS_BENCHMARK_H
+#define MODULE_SIMULATOR_TESTS_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <yaml-cpp/yaml.h>
+
+/*
+ * Benchmarks are hidden Catch tests tagged [benchmark], run with
+ *
+ *     TestCameraSimulator [benchmark]
+ *
+ * Every result is printed as one line of JSON, and appended to $BENCHMARK_OUTPUT if set. Pointing
+ * $BENCHMARK_BASELINE at the output of an earlier build fails any benchmark that got worse by more than
+ * $BENCHMARK_THRESHOLD (a fraction, 0.1 by default).
+ */
+namespace benchmark {
+
+    // Milliseconds per call of f, the best of a few batches so a stray context switch doesn't count
+    template <typename F>
+    double time_ms(F&& f, int runs = 20, int batches = 5) {
+        double best = 0;
+        for (int batch = 0; batch < batches; ++batch) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < runs; ++i) {
+                f();
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+            best = batch == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    inline std::map<std::string, double> load_baseline() {
+        std::map<std::string, double> baseline;
+
+        const char* path = std::getenv("BENCHMARK_BASELINE");
+        std::ifstream in(path ? path : "");
+        std::string line;
+        while (std::getline(in, line)) {
+            // JSON is YAML
+            YAML::Node result = YAML::Load(line);
+            if (result["name"] && result["value"]) {
+                baseline[result["name"].as<std::string>()] = result["value"].as<double>();
+            }
+        }
+        return baseline;
+    }
+
+    /**
+     * Reports one result.
+     *
+     * @return false if a baseline is given and this is more than the threshold worse than it
+     */
+    inline bool report(const std::string& name, double value, const std::string& unit, bool higher_is_better) {
+
+        static const std::map<std::string, double> baseline = load_baseline();
+        const char* threshold_env = std::getenv("BENCHMARK_THRESHOLD");
+        const double threshold = threshold_env ? std::atof(threshold_env) : 0.1;
+
+        std::ostringstream line;
+        line << "{\"name\": \"" << name << "\", \"value\": " << value << ", \"unit\": \"" << unit << "\"";
+
+        bool ok = true;
+        auto previous = baseline.find(name);
+        if (previous != baseline.end() && previous->second > 0) {
+            const double change = (value - previous->second) / previous->second;
+            ok = higher_is_better ? change >= -threshold : change <= threshold;
+            line << ", \"baseline\": " << previous->second << ", \"regressed\": " << (ok ? "false" : "true");
+        }
+        line << "}";
+
+        std::cout << line.str() << std::endl;
+        if (const char* output = std::getenv("BENCHMARK_OUTPUT")) {
+            std::ofstream(output, std::ios::app) << line.str() << "\n";
+        }
+
+        return ok;
+    }
+}
+
+#endif  // MODULE_SIMULATOR_TESTS_BENCHMARK_H
@@ -0,0 +1,171 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "message/input/Image.h"
+#include "message/input/ImageFormat.h"
+
+#include "../src/ImageEncoder.h"
+#include "../src/PyramidBuilder.h"
+#include "../src/SensorNoise.h"
+#include "../src/YUYVConverter.h"
+#include "Benchmark.h"
+
+using message::input::ImageFormat;
+using module::simulation::ConversionKernel;
+using module::simulation::EncodedFormat;
+using module::simulation::ImageEncoder;
+using module::simulation::PixelLayout;
+using module::simulation::PixelSource;
+using module::simulation::PyramidBuilder;
+using module::simulation::SensorNoise;
+using module::simulation::YUYVConverter;
+
+namespace {
+
+    const unsigned int WIDTH = 1280;
+    const unsigned int HEIGHT = 1024;
+
+    std::vector<uint8_t> random_bytes(size_t size) {
+        std::vector<uint8_t> data(size);
+        std::srand(1);
+        for (auto& byte : data) {
+            byte = std::rand();
+        }
+        return data;
+    }
+}
+
+TEST_CASE("YUYV conversion benchmark", "[.][benchmark][YUYVConverter]") {
+
+    const std::pair<PixelLayout, std::string> layouts[] = {
+        { PixelLayout::BGRX, "bgrx" }, { PixelLayout::RGBX, "rgbx" }, { PixelLayout::BGR, "bgr" }, { PixelLayout::RGB, "rgb" }
+    };
+    const std::pair<ConversionKernel, std::string> kernels[] = {
+        { ConversionKernel::SCALAR, "scalar" }, { ConversionKernel::SSE2, "sse2" }, { ConversionKernel::AVX2, "avx2" }
+    };
+
+    std::vector<uint8_t> yuyv(WIDTH * HEIGHT * 2);
+
+    for (const auto& layout : layouts) {
+        const size_t stride = WIDTH * YUYVConverter::bytes_per_pixel(layout.first);
+        const std::vector<uint8_t> pixels = random_bytes(stride * HEIGHT);
+        PixelSource source = { pixels.data(), WIDTH, HEIGHT, stride, layout.first };
+
+        for (const auto& kernel : kernels) {
+            if (!YUYVConverter::is_supported(kernel.first)) {
+                continue;
+            }
+
+            YUYVConverter converter(kernel.first);
+            double ms = benchmark::time_ms([&] { converter.convert(source, yuyv.data()); });
+            CHECK(benchmark::report("yuyv_convert/" + kernel.second + "/" + layout.second, ms, "ms", false));
+        }
+    }
+}
+
+TEST_CASE("Image format conversion benchmark", "[.][benchmark][ImageFormat]") {
+
+    const std::vector<uint8_t> yuyv = random_bytes(WIDTH * HEIGHT * 2);
+
+    const std::pair<ImageFormat, std::string> formats[] = {
+        { ImageFormat::RGB24, "rgb24" },
+        { ImageFormat::GRAY8, "gray8" },
+        { ImageFormat::BAYER_BGGR, "bayer_bggr" },
+        { ImageFormat::I420, "i420" },
+    };
+
+    for (const auto& format : formats) {
+        std::vector<uint8_t> out(message::input::image_size(format.first, WIDTH, HEIGHT));
+        double to = benchmark::time_ms([&] {
+            message::input::convert_image(ImageFormat::YUYV, yuyv.data(), format.first, out.data(), WIDTH, HEIGHT);
+        });
+        CHECK(benchmark::report("image_format/yuyv_to_" + format.second, to, "ms", false));
+
+        std::vector<uint8_t> back(yuyv.size());
+        double from = benchmark::time_ms([&] {
+            message::input::convert_image(format.first, out.data(), ImageFormat::YUYV, back.data(), WIDTH, HEIGHT);
+        });
+        CHECK(benchmark::report("image_format/" + format.second + "_to_yuyv", from, "ms", false));
+    }
+}
+
+TEST_CASE("Sensor noise benchmark", "[.][benchmark][SensorNoise]") {
+
+    std::vector<uint8_t> yuyv = random_bytes(WIDTH * HEIGHT * 2);
+
+    SensorNoise noise;
+    noise.reset(1, 2.0, 0.05);
+
+    uint64_t frame = 0;
+    double ms = benchmark::time_ms([&] { noise.apply_rows(yuyv.data(), WIDTH, ++frame, 0, 0, HEIGHT); });
+    CHECK(benchmark::report("sensor_noise", ms, "ms", false));
+}
+
+TEST_CASE("Image pyramid benchmark", "[.][benchmark][PyramidBuilder]") {
+
+    const std::vector<uint8_t> yuyv = random_bytes(WIDTH * HEIGHT * 2);
+
+    const std::pair<ConversionKernel, std::string> kernels[] = {
+        { ConversionKernel::SCALAR, "scalar" }, { ConversionKernel::SSE2, "sse2" }, { ConversionKernel::AVX2, "avx2" }
+    };
+
+    for (const auto& kernel : kernels) {
+        if (!YUYVConverter::is_supported(kernel.first)) {
+            continue;
+        }
+
+        PyramidBuilder builder(kernel.first);
+        builder.reset(WIDTH, HEIGHT, 3);
+        std::vector<uint8_t> pyramid(builder.size());
+
+        double ms = benchmark::time_ms([&] { builder.build_rows(yuyv.data(), pyramid.data(), 0, HEIGHT); });
+        CHECK(benchmark::report("image_pyramid/" + kernel.second, ms, "ms", false));
+    }
+}
+
+TEST_CASE("Image encoding benchmark", "[.][benchmark][ImageEncoder]") {
+
+    // a smooth render compresses very differently from noise, so encode a gradient with a little noise on it
+    std::vector<uint8_t> yuyv(WIDTH * HEIGHT * 2);
+    for (unsigned int y = 0; y < HEIGHT; ++y) {
+        for (unsigned int x = 0; x < WIDTH * 2; ++x) {
+            yuyv[y * WIDTH * 2 + x] = (x % 2 ? 128 : (x + y) / 8) + std::rand() % 4;
+        }
+    }
+    const message::input::Image image(WIDTH, HEIGHT, NUClear::clock::now(), std::move(yuyv));
+
+    const std::pair<ImageEncoder, std::string> encoders[] = {
+        { ImageEncoder(EncodedFormat::PNG, 90, 1), "png_level1" },
+        { ImageEncoder(EncodedFormat::PNG, 90, 6), "png_level6" },
+        { ImageEncoder(EncodedFormat::JPEG, 90), "jpeg_quality90" },
+    };
+
+    for (auto encoder : encoders) {
+        std::vector<uint8_t> file;
+        double ms = benchmark::time_ms([&] { encoder.first.encode(image, file); });
+        CHECK(benchmark::report("image_encode/" + encoder.second, ms, "ms", false));
+        CHECK(benchmark::report("image_encode/" + encoder.second + "_ratio", double(WIDTH * HEIGHT * 2) / file.size(), "x", true));
+    }
+}
@@ -0,0 +1,265 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "../src/DynamicsEngine.h"
+#include "Benchmark.h"
+
+using module::simulation::DynamicsEngine;
+using module::simulation::DynamicsParameters;
+using module::simulation::WorkerPool;
+
+namespace {
+
+    const float STILL[3] = { 0, 0, 0 };
+
+    // Robots far off in a corner, out of the ball's way
+    std::vector<float> robots_in_corner(size_t robots) {
+        std::vector<float> positions;
+        for (size_t i = 0; i < robots; ++i) {
+            positions.push_back(-30.0f);
+            positions.push_back(-20.0f);
+        }
+        return positions;
+    }
+
+    void run_for(DynamicsEngine& dynamics, double seconds) {
+        dynamics.step(0, dynamics.instances(), dynamics.accumulate(std::chrono::duration<double>(seconds)));
+    }
+}
+
+TEST_CASE("A rolling ball stops where rolling friction says it should", "[DynamicsEngine]") {
+
+    DynamicsParameters params;
+    DynamicsEngine dynamics(params, 1, 0);
+
+    const float start[3] = { -20, params.ground + params.ball_radius, 0 };
+    const float kick[3] = { 10, 0, 0 };
+    dynamics.reset(0, start, kick, nullptr);
+
+    run_for(dynamics, 10.0);
+    REQUIRE(dynamics.ball_at_rest(0));
+
+    // v^2 / 2a, to within a step's worth of travel
+    float position[3];
+    dynamics.ball_position(0, position);
+    const float expected = 10.0f * 10.0f / (2.0f * params.rolling_friction * params.gravity);
+    REQUIRE(std::abs(position[0] - (start[0] + expected)) < 10.0f * params.step.count() * 2);
+    REQUIRE(position[1] == start[1]);
+    REQUIRE(position[2] == 0.0f);
+}
+
+TEST_CASE("A dropped ball bounces lower each time and settles", "[DynamicsEngine]") {
+
+    DynamicsParameters params;
+    DynamicsEngine dynamics(params, 1, 0);
+
+    const float start[3] = { 0, 10, 0 };
+    dynamics.reset(0, start, STILL, nullptr);
+
+    // the highest point after each bounce
+    std::vector<float> peaks;
+    float last_vy = 0;
+    for (int i = 0; i < 240 * 5; ++i) {
+        dynamics.step(0, 1, 1);
+        float velocity[3];
+        dynamics.ball_velocity(0, velocity);
+        if (last_vy > 0 && velocity[1] <= 0) {
+            float position[3];
+            dynamics.ball_position(0, position);
+            peaks.push_back(position[1]);
+        }
+        last_vy = velocity[1];
+    }
+
+    REQUIRE(peaks.size() >= 2);
+    for (size_t i = 1; i < peaks.size(); ++i) {
+        REQUIRE(peaks[i] < peaks[i - 1]);
+    }
+    REQUIRE(peaks.front() < start[1]);
+    REQUIRE(dynamics.ball_at_rest(0));
+}
+
+TEST_CASE("The ball bounces off the boundary, posts and robots", "[DynamicsEngine]") {
+
+    DynamicsParameters params;
+    params.rolling_friction = 0;
+    params.posts.push_back({ 10, 0, 6 });
+
+    DynamicsEngine dynamics(params, 3, 1);
+    const float y = params.ground + params.ball_radius;
+
+    // one at the boundary, one at the post, one at a robot standing at (-10, 0)
+    const float towards_wall[3] = { 30, y, -10 };
+    const float towards_post[3] = { 5, y, 0 };
+    const float towards_robot[3] = { -5, y, 0 };
+    const float right[3] = { 10, 0, 0 };
+    const float left[3] = { -10, 0, 0 };
+    const float robot[2] = { -10, 0 };
+
+    dynamics.reset(0, towards_wall, right, robots_in_corner(1).data());
+    dynamics.reset(1, towards_post, right, robots_in_corner(1).data());
+    dynamics.reset(2, towards_robot, left, robot);
+
+    run_for(dynamics, 1.0);
+
+    for (size_t i = 0; i < 3; ++i) {
+        float velocity[3];
+        dynamics.ball_velocity(i, velocity);
+        REQUIRE(std::abs(velocity[0]) == Approx(10 * params.wall_restitution));
+        REQUIRE(velocity[2] == Approx(0).margin(1e-4));
+    }
+
+    float position[3];
+    float velocity[3];
+    dynamics.ball_position(0, position);
+    dynamics.ball_velocity(0, velocity);
+    REQUIRE(velocity[0] < 0);
+    REQUIRE(position[0] <= params.boundary[1] - params.ball_radius);
+
+    dynamics.ball_position(1, position);
+    dynamics.ball_velocity(1, velocity);
+    REQUIRE(velocity[0] < 0);
+    REQUIRE(position[0] < 10 - params.post_radius - params.ball_radius);
+
+    dynamics.ball_position(2, position);
+    dynamics.ball_velocity(2, velocity);
+    REQUIRE(velocity[0] > 0);
+    REQUIRE(position[0] > -10 + params.robot_radius + params.ball_radius);
+}
+
+TEST_CASE("A lofted ball flies over a goal post", "[DynamicsEngine]") {
+
+    DynamicsParameters params;
+    params.posts.push_back({ 10, 0, 1 });
+    DynamicsEngine dynamics(params, 1, 0);
+
+    const float start[3] = { 0, params.ground + params.ball_radius, 0 };
+    const float lob[3] = { 20, 30, 0 };
+    dynamics.reset(0, start, lob, nullptr);
+
+    run_for(dynamics, 1.0);
+
+    float position[3];
+    dynamics.ball_position(0, position);
+    REQUIRE(position[0] > 10);
+}
+
+TEST_CASE("Robots move at their velocity and stop at the boundary", "[DynamicsEngine]") {
+
+    DynamicsParameters params;
+    DynamicsEngine dynamics(params, 1, 2);
+
+    const float ball[3] = { 0, params.ground + params.ball_radius, 20 };
+    const float robots[4] = { 0, 0, 20, 0 };
+    dynamics.reset(0, ball, STILL, robots);
+    dynamics.set_robot_velocity(0, 0, 1, -2);
+    dynamics.set_robot_velocity(0, 1, 100, 0);
+
+    run_for(dynamics, 1.0);
+
+    float x;
+    float z;
+    dynamics.robot_position(0, 0, x, z);
+    REQUIRE(x == Approx(1).epsilon(1e-3));
+    REQUIRE(z == Approx(-2).epsilon(1e-3));
+    dynamics.robot_position(0, 1, x, z);
+    REQUIRE(x == Approx(params.boundary[1] - params.robot_radius));
+}
+
+TEST_CASE("Stepping instances across a pool matches stepping them in one go", "[DynamicsEngine]") {
+
+    DynamicsParameters params;
+    params.posts.push_back({ 30, -8, 6 });
+    params.posts.push_back({ 30, 5.5f, 6 });
+
+    const size_t instances = 1000;
+    DynamicsEngine serial(params, instances, 3);
+    DynamicsEngine parallel(params, instances, 3);
+
+    for (size_t i = 0; i < instances; ++i) {
+        const float position[3] = { float(i % 50) - 25.0f, params.ball_radius + float(i % 3), float(i % 40) - 20.0f };
+        const float velocity[3] = { float(i % 17) * 3.0f - 20.0f, float(i % 5), float(i % 13) * 2.0f - 12.0f };
+        const float robots[6] = { 5, 0, -5, 10, 15, -10 };
+        serial.reset(i, position, velocity, robots);
+        parallel.reset(i, position, velocity, robots);
+    }
+
+    WorkerPool pool(4);
+    serial.step(0, instances, 480);
+    parallel.step(pool, 480);
+
+    for (size_t i = 0; i < instances; ++i) {
+        float a[3];
+        float b[3];
+        serial.ball_position(i, a);
+        parallel.ball_position(i, b);
+        REQUIRE(a[0] == b[0]);
+        REQUIRE(a[1] == b[1]);
+        REQUIRE(a[2] == b[2]);
+    }
+}
+
+TEST_CASE("Time is stepped in whole fixed steps", "[DynamicsEngine]") {
+
+    DynamicsParameters params;
+    params.step = std::chrono::duration<double>(0.01);
+    DynamicsEngine dynamics(params, 1, 0);
+
+    REQUIRE(dynamics.accumulate(std::chrono::duration<double>(0.025)) == 2);
+    REQUIRE(dynamics.accumulate(std::chrono::duration<double>(0.006)) == 1);
+    REQUIRE(dynamics.accumulate(std::chrono::duration<double>(0.0)) == 0);
+}
+
+/*
+ * A second of simulated play in each of 4096 independent instances of a team of robots and a kicked ball,
+ * the scale of a headless parameter sweep.
+ */
+TEST_CASE("Dynamics sweep benchmark", "[.][benchmark][DynamicsEngine]") {
+
+    DynamicsParameters params;
+    params.posts.push_back({ 30.28f, -7.9f, 6.2f });
+    params.posts.push_back({ 30.28f, 5.54f, 6.2f });
+    params.posts.push_back({ -30.28f, -7.9f, 6.2f });
+    params.posts.push_back({ -30.28f, 5.54f, 6.2f });
+
+    const size_t instances = 4096;
+    const size_t robots = 4;
+    DynamicsEngine dynamics(params, instances, robots);
+
+    for (size_t i = 0; i < instances; ++i) {
+        const float position[3] = { 0, params.ball_radius, 0 };
+        const float velocity[3] = { 40.0f * std::cos(i * 0.01f), 5.0f, 40.0f * std::sin(i * 0.01f) };
+        const float placements[8] = { 10, 0, -10, 0, 0, 10, 0, -10 };
+        dynamics.reset(i, position, velocity, placements);
+        for (size_t j = 0; j < robots; ++j) {
+            dynamics.set_robot_velocity(i, j, 2.0f, 1.0f);
+        }
+    }
+
+    const unsigned int steps = std::lround(1.0 / params.step.count());
+    WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u));
+
+    double ms = benchmark::time_ms([&] { dynamics.step(pool, steps); }, 5);
+    CHECK(benchmark::report("dynamics/instance_seconds_per_second", instances / (ms / 1000.0), "instances/s", true));
+}
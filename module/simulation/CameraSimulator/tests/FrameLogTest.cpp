@@ -0,0 +1,202 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "message/input/Image.h"
+#include "utility/simulation/FrameLog.h"
+
+using message::input::Image;
+using message::input::ImageBuffer;
+using message::input::ImageFormat;
+using utility::simulation::FrameLogReader;
+using utility::simulation::FrameLogRecord;
+using utility::simulation::FrameLogWriter;
+
+namespace {
+
+    std::string log_path() {
+        return "/tmp/FrameLogTest." + std::to_string(getpid()) + ".nufl";
+    }
+
+    void remove_log(const std::string& path) {
+        std::remove(path.c_str());
+        std::remove((path + ".index").c_str());
+    }
+
+    // A 4x2 YUYV frame whose bytes all start from seed
+    std::vector<uint8_t> frame(uint8_t seed) {
+        std::vector<uint8_t> data(4 * 2 * 2);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = seed + i;
+        }
+        return data;
+    }
+
+    FrameLogRecord record(int64_t timestamp, uint32_t camera_id) {
+        FrameLogRecord record = {};
+        record.format = uint32_t(ImageFormat::YUYV);
+        record.width = 4;
+        record.height = 2;
+        record.camera_id = camera_id;
+        record.timestamp = timestamp;
+        record.pose.camera_position[1] = 0.5f;
+        record.pose.ball_position[0] = float(timestamp);
+        return record;
+    }
+
+    void write_frames(const std::string& path, int64_t first, int64_t count) {
+        FrameLogWriter writer(path);
+        for (int64_t t = first; t < first + count; ++t) {
+            std::vector<uint8_t> data = frame(t);
+            writer.append(record(t, t % 2), data.data(), data.size());
+        }
+    }
+}
+
+TEST_CASE("Frame logs read back what was written, in timestamp order", "[FrameLog]") {
+
+    const std::string path = log_path();
+    remove_log(path);
+
+    {
+        FrameLogWriter writer(path);
+        // appended slightly out of order, as images from several threads may be
+        const int64_t order[] = { 1, 0, 2, 4, 3 };
+        for (int64_t t : order) {
+            std::vector<uint8_t> data = frame(t);
+            writer.append(record(t, t % 2), data.data(), data.size());
+        }
+        REQUIRE(writer.frames() == 5);
+    }
+
+    auto reader = FrameLogReader::open(path);
+    REQUIRE(reader->size() == 5);
+    for (size_t i = 0; i < reader->size(); ++i) {
+        const FrameLogRecord& r = reader->record(i);
+        REQUIRE(r.timestamp == int64_t(i));
+        REQUIRE(r.camera_id == i % 2);
+        REQUIRE(r.width == 4);
+        REQUIRE(r.bytes == 16);
+        REQUIRE(r.pose.camera_position[1] == 0.5f);
+        REQUIRE(r.pose.ball_position[0] == float(i));
+        REQUIRE(std::vector<uint8_t>(reader->data(i), reader->data(i) + r.bytes) == frame(i));
+        // pixels start aligned for the SIMD conversions
+        REQUIRE(reinterpret_cast<uintptr_t>(reader->data(i)) % 32 == 0);
+    }
+
+    remove_log(path);
+}
+
+TEST_CASE("Frame logs carry on after the last complete frame", "[FrameLog]") {
+
+    const std::string path = log_path();
+    remove_log(path);
+
+    write_frames(path, 0, 3);
+
+    // a crash part way through writing a frame
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        FrameLogRecord partial = record(3, 0);
+        partial.magic = 0x5246554E;
+        partial.bytes = 16;
+        file.write(reinterpret_cast<const char*>(&partial), sizeof(partial));
+    }
+
+    REQUIRE(FrameLogReader::open(path)->size() == 3);
+
+    write_frames(path, 3, 2);
+
+    auto reader = FrameLogReader::open(path);
+    REQUIRE(reader->size() == 5);
+    REQUIRE(std::vector<uint8_t>(reader->data(4), reader->data(4) + 16) == frame(4));
+
+    remove_log(path);
+}
+
+TEST_CASE("Frame logs without a usable index are scanned", "[FrameLog]") {
+
+    const std::string path = log_path();
+    remove_log(path);
+
+    write_frames(path, 0, 4);
+
+    std::ofstream(path + ".index", std::ios::binary) << "not an index";
+    REQUIRE(FrameLogReader::open(path)->size() == 4);
+
+    std::remove((path + ".index").c_str());
+    REQUIRE(FrameLogReader::open(path)->size() == 4);
+
+    remove_log(path);
+}
+
+TEST_CASE("Files that are not frame logs are rejected", "[FrameLog]") {
+
+    const std::string path = log_path();
+    remove_log(path);
+
+    std::ofstream(path, std::ios::binary) << std::string(128, 'x');
+    REQUIRE_THROWS_AS(FrameLogReader::open(path), std::runtime_error);
+    REQUIRE_THROWS_AS(FrameLogWriter{ path }, std::runtime_error);
+
+    remove_log(path);
+}
+
+TEST_CASE("Images can borrow their pixels from a mapped frame log", "[FrameLog][Image]") {
+
+    const std::string path = log_path();
+    remove_log(path);
+
+    write_frames(path, 7, 1);
+
+    std::weak_ptr<FrameLogReader> alive;
+    {
+        auto reader = FrameLogReader::open(path);
+        alive = reader;
+
+        Image image(4, 2, NUClear::clock::now(), ImageBuffer(reader->data(0), reader->record(0).bytes, reader));
+        reader.reset();
+
+        // the image keeps the mapping alive, and reads it without copying
+        REQUIRE(!alive.expired());
+        const uint8_t* pixels = image.pixels();
+        REQUIRE(int(image(0, 0).y) == 7);
+        REQUIRE(int(image(1, 0).y) == 9);
+        REQUIRE(int(image(0, 1).cb) == 16);
+
+        // copies share the borrowed pixels
+        Image copy = image;
+        REQUIRE(copy.pixels() == pixels);
+
+        // asking for a vector copies once
+        REQUIRE(image.source() == frame(7));
+        REQUIRE(image.source().data() != pixels);
+        REQUIRE(image.as(ImageFormat::YUYV).data() == image.source().data());
+    }
+    REQUIRE(alive.expired());
+
+    remove_log(path);
+}
@@ -0,0 +1,185 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <nuclear>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+#include "message/input/Image.h"
+
+#include "../src/CameraSimulator.h"
+#include "Benchmark.h"
+
+namespace {
+
+    // Images received before timing starts, while the first frames fill the readback rings and caches warm up
+    const uint64_t WARMUP = 30;
+    const uint64_t IMAGES = 600;
+
+    const char* const CONFIG = "config/CameraSimulator.yaml";
+
+    struct Timing {
+        std::mutex mutex;
+        uint64_t images = 0;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+    };
+
+    Timing timing;
+
+    // Counts the simulator's images and shuts the power plant down once enough have been timed
+    class ImageCounter : public NUClear::Reactor {
+    public:
+        explicit ImageCounter(std::unique_ptr<NUClear::Environment> environment)
+        : Reactor(std::move(environment)) {
+
+            on<Trigger<message::input::Image>>().then([this] (const message::input::Image&) {
+                std::lock_guard<std::mutex> lock(timing.mutex);
+
+                auto now = std::chrono::steady_clock::now();
+                if (++timing.images == WARMUP) {
+                    timing.start = now;
+                }
+                timing.end = now;
+
+                if (timing.images == WARMUP + IMAGES) {
+                    powerplant.shutdown();
+                }
+            });
+        }
+    };
+
+    // Runs the simulator as configured until enough images have been timed and returns images per second
+    double images_per_second() {
+
+        {
+            std::lock_guard<std::mutex> lock(timing.mutex);
+            timing.images = 0;
+        }
+
+        NUClear::PowerPlant::Configuration config;
+        config.threadCount = 4;
+
+        NUClear::PowerPlant plant(config);
+        plant.install<module::simulation::CameraSimulator>();
+        plant.install<ImageCounter>();
+        plant.start();
+
+        // the simulator may also stop by itself once its scenarios are done
+        REQUIRE(timing.images > WARMUP + 1);
+
+        const double seconds = std::chrono::duration<double>(timing.end - timing.start).count();
+        return (timing.images - WARMUP) / seconds;
+    }
+
+    // A copy of config/CameraSimulator.yaml with the world count and world processes set, which the simulator
+    // reads through CAMERA_SIMULATOR_CONFIG while it exists so the shared file is never touched
+    class WorldConfig {
+    public:
+        WorldConfig(size_t worlds, bool processes) {
+            YAML::Node config = YAML::LoadFile(CONFIG);
+            config["worlds"] = worlds;
+            config["world_processes"]["enabled"] = processes;
+            // each world runs this benchmark's world process case below
+            config["world_processes"]["command"] = std::vector<std::string>({ "/proc/self/exe", "[world_process]" });
+
+            char name[] = "/tmp/FrameRateBenchmark.XXXXXX";
+            int fd = mkstemp(name);
+            REQUIRE(fd >= 0);
+            close(fd);
+            path = name;
+
+            YAML::Emitter out;
+            out << config;
+            std::ofstream(path, std::ios::trunc) << out.c_str() << "\n";
+            setenv(module::simulation::WorldProcesses::CONFIG_VARIABLE, path.c_str(), 1);
+        }
+
+        ~WorldConfig() {
+            unsetenv(module::simulation::WorldProcesses::CONFIG_VARIABLE);
+            std::remove(path.c_str());
+        }
+
+    private:
+        std::string path;
+    };
+}
+
+/*
+ * The whole render, readback, convert and emit loop, as configured by config/CameraSimulator.yaml. Run it from
+ * the build directory with headless: true and clock mode max_speed (or a scheduler rate of 0) so it measures
+ * how fast frames can be made rather than how well they are paced.
+ */
+TEST_CASE("End to end headless frame rate benchmark", "[.][benchmark][CameraSimulator]") {
+
+    CHECK(benchmark::report("end_to_end/images_per_second", images_per_second(), "images/s", true));
+}
+
+/*
+ * The same loop with 1, 2, 4 and 8 worlds, first all in this process and then each in a process of its own.
+ * In one process every world is rendered in turn on the one Ogre root and GL context, so only conversion runs
+ * in parallel and total images per second is expected to stay close to the single world rate. In processes of
+ * their own each world has its own context and render thread and the rate should grow until the GPU or
+ * rasteriser runs out. scaling is the rate over world count times the single world rate of the same mode: 1 is
+ * linear scaling, 1 / worlds means adding worlds only divided the same throughput between them.
+ */
+TEST_CASE("End to end headless world scaling benchmark", "[.][benchmark][CameraSimulator]") {
+
+    for (bool processes : { false, true }) {
+        double single = 0;
+        for (size_t worlds : { 1, 2, 4, 8 }) {
+            double rate;
+            {
+                WorldConfig config(worlds, processes);
+                rate = images_per_second();
+            }
+            if (worlds == 1) {
+                single = rate;
+            }
+
+            const std::string name = std::string("world_scaling/") + (processes ? "processes" : "serial")
+                                   + "/worlds_" + std::to_string(worlds);
+            CHECK(benchmark::report(name + "/images_per_second", rate, "images/s", true));
+            CHECK(benchmark::report(name + "/scaling", rate / (worlds * single), "fraction", true));
+        }
+    }
+}
+
+/*
+ * Not a benchmark: what each world process of the world scaling benchmark runs, the simulator on its own with
+ * the configuration it was started with until the benchmark's simulator stops it.
+ */
+TEST_CASE("World process of the world scaling benchmark", "[.][world_process]") {
+
+    NUClear::PowerPlant::Configuration config;
+    config.threadCount = 4;
+
+    NUClear::PowerPlant plant(config);
+    plant.install<module::simulation::CameraSimulator>();
+    plant.start();
+}
@@ -0,0 +1,133 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "../src/FrameScheduler.h"
+
+using module::simulation::FrameScheduler;
+using module::simulation::LatePolicy;
+using module::simulation::late_policy_from_string;
+
+namespace {
+
+    // 20 ms frames, with a stall that makes one frame 70 ms late: three whole periods behind, give or take 10 ms
+    const double RATE = 50.0;
+    const std::chrono::milliseconds STALL(90);
+
+    // Starts the grid, stalls the first frame and waits for the late one plus catch_up more
+    FrameScheduler::Report stall(LatePolicy policy, unsigned int max_catch_up, int catch_up) {
+        FrameScheduler scheduler;
+        scheduler.reset(RATE, policy, max_catch_up);
+
+        scheduler.wait();
+        scheduler.rendered();
+        std::this_thread::sleep_for(STALL);
+
+        for (int i = 0; i <= catch_up; ++i) {
+            scheduler.wait();
+            scheduler.rendered();
+        }
+
+        FrameScheduler::Report report;
+        REQUIRE(scheduler.report(std::chrono::duration<double>(0.0), report));
+        REQUIRE(report.frames == uint64_t(catch_up + 2));
+        REQUIRE(report.worst_lateness >= std::chrono::milliseconds(60));
+        return report;
+    }
+}
+
+TEST_CASE("Late frame policies are parsed from the configuration", "[FrameScheduler]") {
+
+    REQUIRE(late_policy_from_string("drop") == LatePolicy::DROP);
+    REQUIRE(late_policy_from_string("catch_up") == LatePolicy::CATCH_UP);
+    REQUIRE_THROWS_AS(late_policy_from_string("skip"), std::invalid_argument);
+}
+
+TEST_CASE("Only frames that were rendered are counted", "[FrameScheduler]") {
+
+    FrameScheduler scheduler;
+    scheduler.reset(0.0, LatePolicy::DROP, 0);
+
+    // waits that come to nothing, such as a lockstep frame that was never acknowledged
+    for (int i = 0; i < 5; ++i) {
+        scheduler.wait();
+    }
+    for (int i = 0; i < 3; ++i) {
+        scheduler.wait();
+        scheduler.rendered();
+    }
+
+    FrameScheduler::Report report;
+    REQUIRE(scheduler.report(std::chrono::duration<double>(0.0), report));
+    REQUIRE(report.frames == 3);
+    REQUIRE(report.missed == 0);
+    REQUIRE(report.dropped == 0);
+
+    // and each report starts from zero
+    REQUIRE(scheduler.report(std::chrono::duration<double>(0.0), report));
+    REQUIRE(report.frames == 0);
+}
+
+TEST_CASE("Dropping skips the missed deadlines and renders the latest one", "[FrameScheduler]") {
+
+    FrameScheduler::Report report = stall(LatePolicy::DROP, 3, 0);
+    REQUIRE(report.missed == 1);
+    REQUIRE(report.dropped == 3);
+}
+
+TEST_CASE("Catching up renders the missed frames back to back", "[FrameScheduler]") {
+
+    // the stalled frame and the three it fell behind by are all rendered late
+    FrameScheduler::Report report = stall(LatePolicy::CATCH_UP, 3, 3);
+    REQUIRE(report.missed == 4);
+    REQUIRE(report.dropped == 0);
+}
+
+TEST_CASE("Catching up drops instead when too far behind", "[FrameScheduler]") {
+
+    FrameScheduler::Report report = stall(LatePolicy::CATCH_UP, 1, 0);
+    REQUIRE(report.missed == 1);
+    REQUIRE(report.dropped == 3);
+}
+
+TEST_CASE("A paced scheduler sleeps until each deadline", "[FrameScheduler]") {
+
+    FrameScheduler scheduler;
+    scheduler.reset(RATE, LatePolicy::DROP, 0);
+
+    scheduler.wait();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 5; ++i) {
+        scheduler.wait();
+        scheduler.rendered();
+    }
+
+    // five periods of 20 ms, less however long the first wait took to return
+    REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(95));
+
+    FrameScheduler::Report report;
+    REQUIRE(scheduler.report(std::chrono::duration<double>(0.0), report));
+    REQUIRE(report.frames == 5);
+    REQUIRE(report.dropped == 0);
+}
@@ -0,0 +1,286 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "../src/GroundTruthProjector.h"
+#include "Benchmark.h"
+
+using message::simulation::GroundTruth;
+using module::simulation::FieldFeatures;
+using module::simulation::GroundTruthProjector;
+using module::simulation::LensModel;
+using module::simulation::LensParameters;
+using module::simulation::LensProjection;
+using module::simulation::ProxyBox;
+
+namespace {
+
+    const double PI = 3.14159265358979323846;
+
+    // Two posts of a goal 10 to the camera's right and a line intersection and a penalty mark ahead of it
+    const char* const FIELD = R"(
+ball_radius: 1
+post_radius: 0.5
+goal_posts:
+  - { base: [10, 0, -40], top: [10, 8, -40] }
+  - { base: [10, 0, -60], top: [10, 8, -60] }
+points:
+  - { type: L, position: [0, 0, -20] }
+  - { type: penalty_mark, position: [-5, 0, -30] }
+)";
+
+    // A camera at the origin looking down -z, as Ogre's camera is
+    const float IDENTITY[16] = { 1, 0, 0, 0
+                               , 0, 1, 0, 0
+                               , 0, 0, 1, 0
+                               , 0, 0, 0, 1 };
+
+    // OpenGL's perspective projection, which is what Ogre's getProjectionMatrix gives
+    std::vector<float> perspective(double fov_y, double aspect, double near, double far) {
+        const double f = 1.0 / std::tan(fov_y * 0.5);
+        return { float(f / aspect), 0, 0, 0
+               , 0, float(f), 0, 0
+               , 0, 0, float((far + near) / (near - far)), float(2 * far * near / (near - far))
+               , 0, 0, -1, 0 };
+    }
+
+    LensModel pinhole(double fov_y) {
+        LensParameters params;
+        params.width = 640;
+        params.height = 480;
+        params.fy = params.height * 0.5 / std::tan(fov_y * 0.5);
+        params.fx = params.fy;
+        params.cx = 320;
+        params.cy = 240;
+
+        LensModel lens;
+        lens.reset(params);
+        return lens;
+    }
+
+    const GroundTruth::Feature& find(const GroundTruth& truth, GroundTruth::FeatureType type, uint32_t id) {
+        for (const auto& feature : truth.features) {
+            if (feature.type == type && feature.id == id) {
+                return feature;
+            }
+        }
+        FAIL("No such feature");
+        return truth.features.front();
+    }
+}
+
+TEST_CASE("Field features are read with boxes around the goal posts", "[GroundTruth]") {
+
+    FieldFeatures field = FieldFeatures::parse(FIELD, "test");
+
+    REQUIRE(field.ball_radius == 1.0f);
+    REQUIRE(field.points.size() == 6);
+    REQUIRE(field.posts.size() == 2);
+
+    REQUIRE(field.points[0].type == GroundTruth::FeatureType::GOAL_POST_BASE);
+    REQUIRE(field.points[1].type == GroundTruth::FeatureType::GOAL_POST_TOP);
+    REQUIRE(field.points[3].id == 1);
+    REQUIRE(field.points[5].type == GroundTruth::FeatureType::PENALTY_MARK);
+    REQUIRE(field.points[5].id == 1);
+
+    REQUIRE(field.posts[0].min[0] == 9.5f);
+    REQUIRE(field.posts[0].max[1] == 8.5f);
+    REQUIRE(field.posts[0].min[2] == -40.5f);
+
+    REQUIRE_THROWS_AS(FieldFeatures::parse("points: [{ type: Y, position: [0, 0, 0] }]", "test"), std::runtime_error);
+}
+
+TEST_CASE("Points project where a pinhole camera sees them", "[GroundTruth]") {
+
+    const double fov_y = 45.0 * PI / 180.0;
+    const double f = 240.0 / std::tan(fov_y * 0.5);
+
+    FieldFeatures field = FieldFeatures::parse(FIELD, "test");
+    LensModel lens = pinhole(fov_y);
+    GroundTruthProjector projector(field, lens);
+
+    // the ball far out of the way behind the camera
+    const float ball[3] = { 0, 0, 100 };
+    std::vector<float> projection = perspective(fov_y, 640.0 / 480.0, 5, 1000);
+
+    GroundTruth truth;
+    projector.project(IDENTITY, projection.data(), ball, {}, truth);
+
+    REQUIRE(truth.width == 640);
+    REQUIRE(truth.height == 480);
+    REQUIRE(!truth.ball.in_image);
+
+    const GroundTruth::Feature& base = find(truth, GroundTruth::FeatureType::GOAL_POST_BASE, 0);
+    REQUIRE(base.in_image);
+    REQUIRE(!base.occluded);
+    REQUIRE(base.depth == Approx(40));
+    REQUIRE(base.x == Approx(320 + f * 10 / 40).epsilon(1e-4));
+    REQUIRE(base.y == Approx(240).epsilon(1e-4));
+
+    const GroundTruth::Feature& top = find(truth, GroundTruth::FeatureType::GOAL_POST_TOP, 0);
+    REQUIRE(top.y == Approx(240 - f * 8 / 40).epsilon(1e-4));
+
+    const GroundTruth::Feature& mark = find(truth, GroundTruth::FeatureType::PENALTY_MARK, 1);
+    REQUIRE(mark.x == Approx(320 - f * 5 / 30).epsilon(1e-4));
+
+    // nearer than the near plane isn't drawn
+    field.points[2].position[2] = -2;
+    projector.project(IDENTITY, projection.data(), ball, {}, truth);
+    REQUIRE(!truth.features[2].in_image);
+}
+
+TEST_CASE("The ball's outline is the cone of rays grazing it", "[GroundTruth]") {
+
+    const double fov_y = 60.0 * PI / 180.0;
+    const double f = 240.0 / std::tan(fov_y * 0.5);
+
+    FieldFeatures field = FieldFeatures::parse(FIELD, "test");
+    LensModel lens = pinhole(fov_y);
+    GroundTruthProjector projector(field, lens);
+    std::vector<float> projection = perspective(fov_y, 640.0 / 480.0, 5, 1000);
+
+    const float ball[3] = { 0, 0, -10 };
+    GroundTruth truth;
+    projector.project(IDENTITY, projection.data(), ball, {}, truth);
+
+    REQUIRE(truth.ball.in_image);
+    REQUIRE(!truth.ball.occluded);
+    REQUIRE(truth.ball.x == Approx(320));
+    REQUIRE(truth.ball.y == Approx(240));
+    REQUIRE(truth.ball.depth == Approx(10));
+    REQUIRE(truth.ball.radius == Approx(f * std::tan(std::asin(0.1))).epsilon(1e-3));
+
+    // and it hides the intersection straight behind it
+    REQUIRE(find(truth, GroundTruth::FeatureType::L_INTERSECTION, 0).occluded);
+    REQUIRE(!find(truth, GroundTruth::FeatureType::PENALTY_MARK, 1).occluded);
+}
+
+TEST_CASE("Robots are rectangles that hide what is behind them but not their own centre", "[GroundTruth]") {
+
+    const double fov_y = 60.0 * PI / 180.0;
+
+    FieldFeatures field = FieldFeatures::parse(FIELD, "test");
+    LensModel lens = pinhole(fov_y);
+    GroundTruthProjector projector(field, lens);
+    std::vector<float> projection = perspective(fov_y, 640.0 / 480.0, 5, 1000);
+
+    const float ball[3] = { 0, 0, 100 };
+    // one robot in front of the base of the first goal post, one behind the second post
+    std::vector<ProxyBox> robots = { { { 6.5f, -1, -31 }, { 8.5f, 3, -29 } }
+                                   , { { 10.5f, -1, -71 }, { 12.5f, 3, -69 } } };
+
+    GroundTruth truth;
+    projector.project(IDENTITY, projection.data(), ball, robots, truth);
+
+    REQUIRE(truth.robots.size() == 2);
+    REQUIRE(truth.robots[0].in_image);
+    REQUIRE(!truth.robots[0].occluded);
+    REQUIRE(truth.robots[0].x_min < truth.robots[0].x_max);
+    REQUIRE(truth.robots[0].y_min < truth.robots[0].y_max);
+    REQUIRE(truth.robots[0].depth == Approx(30));
+
+    // the nearer robot hides the base of the first post but not its top, a post doesn't hide itself
+    REQUIRE(find(truth, GroundTruth::FeatureType::GOAL_POST_BASE, 0).occluded);
+    REQUIRE(!find(truth, GroundTruth::FeatureType::GOAL_POST_TOP, 0).occluded);
+    REQUIRE(!find(truth, GroundTruth::FeatureType::GOAL_POST_BASE, 1).occluded);
+
+    // the far robot is behind the second post, which covers its centre
+    REQUIRE(truth.robots[1].occluded);
+
+    // a robot straddling the camera has no rectangle
+    robots[0] = { { -1, -1, -1 }, { 1, 1, 1 } };
+    projector.project(IDENTITY, projection.data(), ball, robots, truth);
+    REQUIRE(!truth.robots[0].in_image);
+}
+
+TEST_CASE("Points are distorted where the lens model draws them", "[GroundTruth][LensModel]") {
+
+    LensParameters params;
+    params.projection = LensProjection::EQUIDISTANT;
+    params.width = 320;
+    params.height = 240;
+    params.fx = params.fy = 120;
+    params.cx = 160;
+    params.cy = 120;
+
+    LensModel lens;
+    lens.reset(params);
+    REQUIRE(lens.remaps());
+
+    // with no k terms a pixel's ray is at theta = r / f, so its render coordinate is known
+    const double tan_y = std::tan(lens.render_fov_y() * 0.5);
+    for (double v : { 5.0, 60.0, 120.0, 200.0 }) {
+        const double theta = (v - params.cy) / params.fy;
+        double u = 0;
+        double out_v = 0;
+        lens.project(0, -std::tan(theta) / tan_y, u, out_v);
+        REQUIRE(u == Approx(params.cx));
+        REQUIRE(out_v == Approx(v).epsilon(1e-6));
+    }
+}
+
+/*
+ * A frame of ground truth for the stadium with a team of robots on the field, from a camera in the stands.
+ * Uses config/scenes/StadiumFeatures.yaml so run it from the build directory.
+ */
+TEST_CASE("Ground truth projection benchmark", "[.][benchmark][GroundTruth]") {
+
+    FieldFeatures field = FieldFeatures::load("config/scenes/StadiumFeatures.yaml");
+    LensModel lens = pinhole(45.0 * PI / 180.0);
+    GroundTruthProjector projector(field, lens);
+    std::vector<float> projection = perspective(45.0 * PI / 180.0, 640.0 / 480.0, 5, 1000);
+
+    // the default camera, at (-20, 8, -5) yawed 1.8 radians and pitched down 0.18
+    const double yaw = 1.8;
+    const double pitch = -0.18;
+    const float position[3] = { -20, 8, -5 };
+    const float forward[3] = { float(std::sin(yaw) * std::cos(pitch)), float(std::sin(pitch)), float(-std::cos(yaw) * std::cos(pitch)) };
+    const float right[3] = { float(std::cos(yaw)), 0, float(std::sin(yaw)) };
+    const float up[3] = { right[1] * forward[2] - right[2] * forward[1]
+                        , right[2] * forward[0] - right[0] * forward[2]
+                        , right[0] * forward[1] - right[1] * forward[0] };
+
+    float view[16] = {};
+    for (int i = 0; i < 3; ++i) {
+        view[i] = right[i];
+        view[4 + i] = up[i];
+        view[8 + i] = -forward[i];
+    }
+    for (int row = 0; row < 3; ++row) {
+        view[row * 4 + 3] = -(view[row * 4] * position[0] + view[row * 4 + 1] * position[1] + view[row * 4 + 2] * position[2]);
+    }
+    view[15] = 1;
+
+    std::vector<ProxyBox> robots;
+    for (int i = 0; i < 10; ++i) {
+        const float x = -25.0f + 5.0f * i;
+        const float z = (i % 2 == 0 ? -8.0f : 6.0f);
+        robots.push_back({ { x - 1.5f, 0, z - 1.5f }, { x + 1.5f, 7, z + 1.5f } });
+    }
+
+    const float ball[3] = { 22, 0.8f, 0 };
+    GroundTruth truth;
+
+    double ms = benchmark::time_ms([&] { projector.project(view, projection.data(), ball, robots, truth); }, 1000);
+    CHECK(benchmark::report("ground_truth/frame", ms * 1000.0, "us", false));
+}
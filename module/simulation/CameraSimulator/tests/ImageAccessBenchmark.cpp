@@ -0,0 +1,153 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#include "message/input/Image.h"
+
+#include "Benchmark.h"
+
+using message::input::Image;
+
+namespace {
+
+    Image random_image(uint width, uint height) {
+        std::vector<uint8_t> data(width * height * 2);
+        std::srand(1);
+        for (auto& byte : data) {
+            byte = std::rand();
+        }
+        return Image(width, height, NUClear::clock::now(), std::move(data));
+    }
+
+    // The reference inverse transform, in floating point
+    void reference_rgb(const Image::Pixel& p, int rgb[3]) {
+        rgb[0] = int(p.y + 1.402 * (p.cr - 128));
+        rgb[1] = int(p.y - 0.344136 * (p.cb - 128) - 0.714136 * (p.cr - 128));
+        rgb[2] = int(p.y + 1.772 * (p.cb - 128));
+        for (int c = 0; c < 3; ++c) {
+            rgb[c] = rgb[c] < 0 ? 0 : rgb[c] > 255 ? 255 : rgb[c];
+        }
+    }
+}
+
+TEST_CASE("Image row, tile and subsampled access match the per pixel accessor", "[Image]") {
+
+    const Image image = random_image(640, 480);
+
+    for (uint y = 0; y < image.height; y += 7) {
+        const Image::Row row = image.row(y);
+        for (uint x = 0; x < image.width; ++x) {
+            const Image::Pixel a = image(x, y);
+            const Image::Pixel b = row[x];
+            REQUIRE(a.y == b.y);
+            REQUIRE(a.cb == b.cb);
+            REQUIRE(a.cr == b.cr);
+            REQUIRE(row.y(x) == a.y);
+        }
+    }
+
+    const Image::Tile tile = image.tile(101, 33, 64, 48);
+    for (uint y = 0; y < tile.height; ++y) {
+        for (uint x = 0; x < tile.width; ++x) {
+            REQUIRE(tile(x, y).y == image(x + 101, y + 33).y);
+            REQUIRE(tile(x, y).cb == image(x + 101, y + 33).cb);
+        }
+    }
+
+    size_t visited = 0;
+    for (auto it = tile.subsample(3, 5).begin(), end = tile.subsample(3, 5).end(); it != end; ++it) {
+        REQUIRE((it.x() - 101) % 3 == 0);
+        REQUIRE((it.y() - 33) % 5 == 0);
+        REQUIRE((*it).cr == image(it.x(), it.y()).cr);
+        ++visited;
+    }
+    REQUIRE(visited == 22 * 10);
+}
+
+TEST_CASE("Image bulk conversions match the per pixel accessor", "[Image]") {
+
+    const Image image = random_image(642, 10);
+
+    std::vector<uint8_t> y(image.width * image.height);
+    std::vector<uint8_t> cb(image.width * image.height / 2);
+    std::vector<uint8_t> cr(image.width * image.height / 2);
+    image.to_planar(y.data(), cb.data(), cr.data());
+
+    std::vector<uint8_t> rgb(image.width * image.height * 3);
+    image.to_rgb(rgb.data());
+
+    for (uint row = 0; row < image.height; ++row) {
+        for (uint x = 0; x < image.width; ++x) {
+            const size_t i = row * image.width + x;
+            const Image::Pixel p = image(x, row);
+            REQUIRE(y[i] == p.y);
+            REQUIRE(cb[i / 2] == p.cb);
+            REQUIRE(cr[i / 2] == p.cr);
+
+            int expected[3];
+            reference_rgb(p, expected);
+            for (int c = 0; c < 3; ++c) {
+                REQUIRE(std::abs(rgb[i * 3 + c] - expected[c]) <= 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Image access benchmark", "[.][benchmark][Image]") {
+
+    const Image image = random_image(1280, 1024);
+    std::vector<uint8_t> y(image.width * image.height);
+    std::vector<uint8_t> cb(image.width * image.height / 2);
+    std::vector<uint8_t> cr(image.width * image.height / 2);
+    std::vector<uint8_t> rgb(image.width * image.height * 3);
+
+    // Sum the luma so the compiler can't throw the loops away
+    uint64_t per_pixel_sum = 0;
+    double per_pixel = benchmark::time_ms([&] {
+        for (uint row = 0; row < image.height; ++row) {
+            for (uint x = 0; x < image.width; ++x) {
+                per_pixel_sum += image(x, row).y;
+            }
+        }
+    });
+
+    uint64_t row_sum = 0;
+    double rows = benchmark::time_ms([&] {
+        for (uint row = 0; row < image.height; ++row) {
+            const Image::Row r = image.row(row);
+            for (uint x = 0; x < r.size(); ++x) {
+                row_sum += r[x].y;
+            }
+        }
+    });
+
+    double planar = benchmark::time_ms([&] { image.to_planar(y.data(), cb.data(), cr.data()); });
+    double packed = benchmark::time_ms([&] { image.to_rgb(rgb.data()); });
+
+    REQUIRE(per_pixel_sum == row_sum);
+
+    CHECK(benchmark::report("image/per_pixel", per_pixel, "ms", false));
+    CHECK(benchmark::report("image/rows", rows, "ms", false));
+    CHECK(benchmark::report("image/to_planar", planar, "ms", false));
+    CHECK(benchmark::report("image/to_rgb", packed, "ms", false));
+}
@@ -0,0 +1,155 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "message/input/Image.h"
+#include "message/input/ImageBufferPool.h"
+
+using message::input::Image;
+using message::input::ImageBuffer;
+using message::input::ImageBufferPool;
+
+TEST_CASE("Pool buffers go back to the pool when their last holder drops them", "[ImageBufferPool]") {
+
+    auto pool = ImageBufferPool::create(2, 64);
+    REQUIRE(pool->capacity() == 2);
+    REQUIRE(pool->buffer_size() == 64);
+    REQUIRE(pool->in_use() == 0);
+
+    ImageBuffer buffer = pool->acquire();
+    REQUIRE(buffer.size() == 64);
+    REQUIRE(!buffer.borrowed());
+    REQUIRE(pool->in_use() == 1);
+
+    const uint8_t* pixels = buffer.data();
+    auto image = std::make_shared<const Image>(4, 8, NUClear::clock::now(), std::move(buffer));
+    REQUIRE(image->pixels() == pixels);
+
+    // sharing the image, as emitted messages are, keeps the buffer out of the pool until the last one goes
+    std::shared_ptr<const Image> other = image;
+    image.reset();
+    REQUIRE(pool->in_use() == 1);
+
+    // a copy of the image owns its own pixels and never goes back to the pool
+    auto copy = std::make_unique<Image>(*other);
+    REQUIRE(copy->pixels() != pixels);
+
+    other.reset();
+    REQUIRE(pool->in_use() == 0);
+    copy.reset();
+    REQUIRE(pool->in_use() == 0);
+
+    // and the same memory is handed out again
+    ImageBuffer again = pool->acquire();
+    REQUIRE(again.data() == pixels);
+    REQUIRE(pool->exhausted() == 0);
+}
+
+TEST_CASE("An exhausted pool allocates temporary buffers and counts them", "[ImageBufferPool]") {
+
+    auto pool = ImageBufferPool::create(2, 16);
+
+    std::vector<ImageBuffer> held;
+    held.push_back(pool->acquire());
+    held.push_back(pool->acquire());
+    REQUIRE(pool->in_use() == 2);
+    REQUIRE(pool->exhausted() == 0);
+
+    held.push_back(pool->acquire());
+    held.push_back(pool->acquire());
+    REQUIRE(pool->exhausted() == 2);
+    REQUIRE(pool->in_use() == 2);
+    for (const auto& buffer : held) {
+        REQUIRE(buffer.size() == 16);
+    }
+
+    // temporary buffers are freed rather than growing the pool past its capacity
+    held.clear();
+    REQUIRE(pool->in_use() == 0);
+    held.push_back(pool->acquire());
+    held.push_back(pool->acquire());
+    held.push_back(pool->acquire());
+    REQUIRE(pool->exhausted() == 3);
+    REQUIRE(pool->in_use() == 2);
+}
+
+TEST_CASE("Pool buffers can be released from other threads and after the pool is gone", "[ImageBufferPool]") {
+
+    auto pool = ImageBufferPool::create(8, 32);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool] {
+            for (int i = 0; i < 1000; ++i) {
+                ImageBuffer a = pool->acquire();
+                ImageBuffer b = std::move(a);
+                a = pool->acquire();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(pool->in_use() == 0);
+    REQUIRE(pool->exhausted() == 0);
+
+    // a buffer that outlives its pool is simply freed
+    ImageBuffer orphan = pool->acquire();
+    pool.reset();
+    orphan = ImageBuffer(std::vector<uint8_t>(4));
+    REQUIRE(orphan.size() == 4);
+}
+
+TEST_CASE("Borrowed buffers keep their owner alive without copying or pooling", "[ImageBufferPool]") {
+
+    auto pool = ImageBufferPool::create(1, 16);
+    auto memory = std::make_shared<std::vector<uint8_t>>(16, 7);
+    std::weak_ptr<std::vector<uint8_t>> watch = memory;
+
+    ImageBuffer buffer(memory->data(), memory->size(), memory);
+    memory.reset();
+    REQUIRE(!watch.expired());
+    REQUIRE(buffer.borrowed());
+    REQUIRE(buffer.size() == 16);
+    REQUIRE(buffer.bytes().empty());
+    REQUIRE(buffer.data()[15] == 7);
+
+    // copies share the memory rather than copying it
+    ImageBuffer copy = buffer;
+    REQUIRE(copy.borrowed());
+    REQUIRE(copy.data() == buffer.data());
+
+    // moving a pool buffer over a borrowed one releases the borrow and the pool buffer returns as usual
+    buffer = pool->acquire();
+    REQUIRE(!buffer.borrowed());
+    REQUIRE(pool->in_use() == 1);
+    REQUIRE(!watch.expired());
+
+    copy = ImageBuffer();
+    REQUIRE(watch.expired());
+
+    buffer = ImageBuffer();
+    REQUIRE(pool->in_use() == 0);
+}
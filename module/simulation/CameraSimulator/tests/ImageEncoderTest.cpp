@@ -0,0 +1,337 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include <jpeglib.h>
+#include <png.h>
+
+#include "message/input/Image.h"
+
+#include "../src/DatasetWriter.h"
+#include "../src/ImageEncoder.h"
+
+using message::input::Image;
+using message::input::ImageFormat;
+using module::simulation::DatasetOptions;
+using module::simulation::DatasetWriter;
+using module::simulation::EncodedFormat;
+using module::simulation::ImageEncoder;
+using module::simulation::OverflowPolicy;
+
+namespace {
+
+    const unsigned int WIDTH = 64;
+    const unsigned int HEIGHT = 48;
+
+    // Smooth gradients like a render, with an edge through the middle
+    std::shared_ptr<Image> gradient(ImageFormat format) {
+        std::vector<uint8_t> rgb(WIDTH * HEIGHT * 3);
+        for (unsigned int y = 0; y < HEIGHT; ++y) {
+            for (unsigned int x = 0; x < WIDTH; ++x) {
+                uint8_t* p = &rgb[(y * WIDTH + x) * 3];
+                p[0] = x * 4;
+                p[1] = y * 5;
+                p[2] = x < WIDTH / 2 ? 40 : 200;
+            }
+        }
+        std::vector<uint8_t> data(message::input::image_size(format, WIDTH, HEIGHT));
+        message::input::convert_image(ImageFormat::RGB24, rgb.data(), format, data.data(), WIDTH, HEIGHT);
+        return std::make_shared<Image>(WIDTH, HEIGHT, NUClear::clock::now(), std::move(data), format);
+    }
+
+    std::vector<uint8_t> decode_png(const std::vector<uint8_t>& file, png_uint_32 format) {
+        png_image image = {};
+        image.version = PNG_IMAGE_VERSION;
+        REQUIRE(png_image_begin_read_from_memory(&image, file.data(), file.size()));
+        REQUIRE(image.width == WIDTH);
+        REQUIRE(image.height == HEIGHT);
+        image.format = format;
+        std::vector<uint8_t> pixels(PNG_IMAGE_SIZE(image));
+        REQUIRE(png_image_finish_read(&image, nullptr, pixels.data(), 0, nullptr));
+        return pixels;
+    }
+
+    std::vector<uint8_t> decode_jpeg(const std::vector<uint8_t>& file, int& components) {
+        jpeg_decompress_struct cinfo;
+        jpeg_error_mgr error;
+        cinfo.err = jpeg_std_error(&error);
+        jpeg_create_decompress(&cinfo);
+        jpeg_mem_src(&cinfo, const_cast<uint8_t*>(file.data()), file.size());
+        jpeg_read_header(&cinfo, TRUE);
+        jpeg_start_decompress(&cinfo);
+
+        components = cinfo.output_components;
+        std::vector<uint8_t> pixels(cinfo.output_width * cinfo.output_height * components);
+        while (cinfo.output_scanline < cinfo.output_height) {
+            JSAMPROW row = &pixels[cinfo.output_scanline * cinfo.output_width * components];
+            jpeg_read_scanlines(&cinfo, &row, 1);
+        }
+        jpeg_finish_decompress(&cinfo);
+        jpeg_destroy_decompress(&cinfo);
+        return pixels;
+    }
+
+    double psnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+        double error = 0.0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            error += (a[i] - b[i]) * (a[i] - b[i]);
+        }
+        return 10.0 * std::log10(255.0 * 255.0 / (error / a.size()));
+    }
+
+    std::string temporary_directory() {
+        return "/tmp/ImageEncoderTest." + std::to_string(getpid());
+    }
+
+    std::vector<std::string> read_lines(const std::string& path) {
+        std::ifstream file(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(file, line);) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+}
+
+TEST_CASE("PNG encoding is lossless", "[ImageEncoder]") {
+
+    ImageEncoder encoder(EncodedFormat::PNG);
+    std::vector<uint8_t> file;
+
+    for (ImageFormat format : { ImageFormat::YUYV, ImageFormat::RGB24, ImageFormat::I420 }) {
+        auto image = gradient(format);
+        std::vector<uint8_t> rgb(WIDTH * HEIGHT * 3);
+        image->to_rgb(rgb.data());
+
+        encoder.encode(*image, file);
+        REQUIRE(decode_png(file, PNG_FORMAT_RGB) == rgb);
+    }
+
+    auto gray = gradient(ImageFormat::GRAY8);
+    encoder.encode(*gray, file);
+    REQUIRE(decode_png(file, PNG_FORMAT_GRAY) == gray->source());
+}
+
+TEST_CASE("JPEG encoding keeps YUYV close to the original", "[ImageEncoder]") {
+
+    ImageEncoder encoder(EncodedFormat::JPEG, 90);
+    std::vector<uint8_t> file;
+
+    auto image = gradient(ImageFormat::YUYV);
+    std::vector<uint8_t> rgb(WIDTH * HEIGHT * 3);
+    image->to_rgb(rgb.data());
+
+    encoder.encode(*image, file);
+    REQUIRE(file.size() < image->source().size() / 2);
+
+    int components;
+    std::vector<uint8_t> decoded = decode_jpeg(file, components);
+    REQUIRE(components == 3);
+    REQUIRE(psnr(decoded, rgb) > 30.0);
+
+    auto gray = gradient(ImageFormat::GRAY8);
+    encoder.encode(*gray, file);
+    decoded = decode_jpeg(file, components);
+    REQUIRE(components == 1);
+    REQUIRE(psnr(decoded, gray->source()) > 30.0);
+}
+
+TEST_CASE("Dataset writer writes numbered files and an index in sequence order", "[DatasetWriter]") {
+
+    const std::string directory = temporary_directory();
+
+    DatasetOptions options;
+    options.directory = directory;
+    options.format = EncodedFormat::PNG;
+    options.threads = 3;
+    options.queue_size = 4;
+    options.batch_size = 3;
+
+    const uint64_t images = 10;
+    {
+        DatasetWriter writer(options);
+        for (uint64_t i = 0; i < images; ++i) {
+            auto image = gradient(ImageFormat::YUYV);
+            image->camera_id = i % 2;
+            writer.push(image, i);
+        }
+        writer.flush();
+
+        DatasetWriter::Report report = writer.report();
+        REQUIRE(report.written == images);
+        REQUIRE(report.dropped == 0);
+        REQUIRE(report.queued == 0);
+        REQUIRE(report.encoded_bytes > 0);
+        REQUIRE(report.raw_bytes == images * WIDTH * HEIGHT * 2);
+    }
+
+    std::vector<std::string> index = read_lines(directory + "/index.csv");
+    REQUIRE(index.size() == images + 1);
+    REQUIRE(index[0] == "sequence,world_id,camera_id,timestamp_ns,file");
+
+    // batches are written in order, and each file decodes
+    std::vector<uint64_t> sequences;
+    for (uint64_t i = 1; i <= images; ++i) {
+        std::istringstream line(index[i]);
+        uint64_t sequence;
+        line >> sequence;
+        sequences.push_back(sequence);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%010llu.png", (unsigned long long) sequence);
+        REQUIRE(index[i].substr(index[i].size() - std::string(name).size()) == name);
+        REQUIRE(index[i].find(sequence % 2 ? ",1," : ",0,") != std::string::npos);
+
+        std::ifstream file(directory + "/" + name, std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        decode_png(data, PNG_FORMAT_RGB);
+        std::remove((directory + "/" + name).c_str());
+    }
+    std::sort(sequences.begin(), sequences.end());
+    for (uint64_t i = 0; i < images; ++i) {
+        REQUIRE(sequences[i] == i);
+    }
+
+    std::remove((directory + "/index.csv").c_str());
+    rmdir(directory.c_str());
+}
+
+TEST_CASE("Dataset writer drops images that don't fit when told to", "[DatasetWriter]") {
+
+    const std::string directory = temporary_directory();
+
+    DatasetOptions options;
+    options.directory = directory;
+    options.format = EncodedFormat::JPEG;
+    options.threads = 1;
+    options.queue_size = 2;
+    options.overflow = OverflowPolicy::DROP;
+
+    uint64_t pushed = 0;
+    const uint64_t images = 50;
+    {
+        DatasetWriter writer(options);
+        for (uint64_t i = 0; i < images; ++i) {
+            pushed += writer.push(gradient(ImageFormat::YUYV), i);
+        }
+        writer.flush();
+
+        DatasetWriter::Report report = writer.report();
+        REQUIRE(report.written == pushed);
+        REQUIRE(report.written + report.dropped == images);
+    }
+
+    for (uint64_t i = 0; i < images; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/%010llu.jpg", (unsigned long long) i);
+        std::remove((directory + name).c_str());
+    }
+    std::remove((directory + "/index.csv").c_str());
+    rmdir(directory.c_str());
+}
+
+TEST_CASE("Dataset writer adds to an existing dataset without overwriting it", "[DatasetWriter]") {
+
+    const std::string directory = temporary_directory();
+
+    DatasetOptions options;
+    options.directory = directory;
+    options.format = EncodedFormat::PNG;
+    options.threads = 1;
+
+    const uint64_t images = 3;
+    {
+        DatasetWriter writer(options);
+        REQUIRE(writer.next_sequence() == 0);
+        for (uint64_t i = 0; i < images; ++i) {
+            writer.push(gradient(ImageFormat::YUYV), i);
+        }
+    }
+
+    // the second run numbers on from the first
+    {
+        DatasetWriter writer(options);
+        REQUIRE(writer.next_sequence() == images);
+        for (uint64_t i = 0; i < images; ++i) {
+            writer.push(gradient(ImageFormat::YUYV), writer.next_sequence() + i);
+        }
+    }
+
+    std::vector<std::string> index = read_lines(directory + "/index.csv");
+    REQUIRE(index.size() == 2 * images + 1);
+    REQUIRE(index[0] == "sequence,world_id,camera_id,timestamp_ns,file");
+    for (uint64_t i = 0; i < 2 * images; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%010llu.png", (unsigned long long) i);
+        REQUIRE(index[i + 1].find(name) != std::string::npos);
+        REQUIRE(std::remove((directory + "/" + name).c_str()) == 0);
+    }
+
+    std::remove((directory + "/index.csv").c_str());
+    rmdir(directory.c_str());
+}
+
+TEST_CASE("Dataset writer leaves files it failed to write out of the index", "[DatasetWriter]") {
+
+    const std::string directory = temporary_directory();
+    REQUIRE(mkdir(directory.c_str(), 0755) == 0);
+
+    // a non empty directory where the second image should go can't be opened as a file or removed
+    const std::string blocker = directory + "/0000000001.png";
+    REQUIRE(mkdir(blocker.c_str(), 0755) == 0);
+    std::ofstream((blocker + "/keep").c_str()).put('x');
+
+    DatasetOptions options;
+    options.directory = directory;
+    options.format = EncodedFormat::PNG;
+    options.threads = 1;
+
+    {
+        DatasetWriter writer(options);
+        for (uint64_t i = 0; i < 3; ++i) {
+            writer.push(gradient(ImageFormat::YUYV), i);
+        }
+        writer.flush();
+        REQUIRE(writer.report().written == 2);
+    }
+
+    std::vector<std::string> index = read_lines(directory + "/index.csv");
+    REQUIRE(index.size() == 3);
+    REQUIRE(index[1].find("0000000000.png") != std::string::npos);
+    REQUIRE(index[2].find("0000000002.png") != std::string::npos);
+
+    std::remove((directory + "/0000000000.png").c_str());
+    std::remove((directory + "/0000000002.png").c_str());
+    std::remove((blocker + "/keep").c_str());
+    rmdir(blocker.c_str());
+    std::remove((directory + "/index.csv").c_str());
+    rmdir(directory.c_str());
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "message/input/Image.h"
+
+using message::input::Image;
+using message::input::ImageFormat;
+
+namespace {
+
+    // A smooth image, so chroma subsampling and demosaicing lose little
+    std::vector<uint8_t> gradient_rgb(uint width, uint height) {
+        std::vector<uint8_t> rgb(width * height * 3);
+        for (uint y = 0; y < height; ++y) {
+            for (uint x = 0; x < width; ++x) {
+                uint8_t* p = &rgb[(y * width + x) * 3];
+                p[0] = 40 + x;
+                p[1] = 60 + y;
+                p[2] = 200 - (x + y) / 2;
+            }
+        }
+        return rgb;
+    }
+
+    int max_difference(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+        int worst = 0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            worst = std::max(worst, std::abs(a[i] - b[i]));
+        }
+        return worst;
+    }
+}
+
+TEST_CASE("Images convert between formats", "[Image][ImageFormat]") {
+
+    const uint width = 64;
+    const uint height = 32;
+    const std::vector<uint8_t> rgb = gradient_rgb(width, height);
+
+    const Image source(width, height, NUClear::clock::now(), std::vector<uint8_t>(rgb), ImageFormat::RGB24);
+
+    REQUIRE(source.as(ImageFormat::RGB24).data() == source.source().data());
+
+    for (ImageFormat format : { ImageFormat::YUYV, ImageFormat::I420, ImageFormat::BAYER_BGGR, ImageFormat::BAYER_RGGB }) {
+        const std::vector<uint8_t>& converted = source.as(format);
+        REQUIRE(converted.size() == message::input::image_size(format, width, height));
+
+        // Back to RGB from an image that is natively in this format
+        const Image native(width, height, NUClear::clock::now(), std::vector<uint8_t>(converted), format);
+        REQUIRE(max_difference(native.as(ImageFormat::RGB24), rgb) <= 4);
+    }
+
+    // Grey loses chroma, so compare against the luma of the YUYV copy
+    const std::vector<uint8_t>& gray = source.as(ImageFormat::GRAY8);
+    for (uint y = 0; y < height; ++y) {
+        for (uint x = 0; x < width; ++x) {
+            REQUIRE(gray[y * width + x] == source(x, y).y);
+        }
+    }
+}
+
+TEST_CASE("Conversions are made once and shared between threads", "[Image][ImageFormat]") {
+
+    const Image image(640, 480, NUClear::clock::now(), gradient_rgb(640, 480), ImageFormat::RGB24);
+
+    std::vector<const uint8_t*> seen(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < seen.size(); ++i) {
+        threads.emplace_back([&, i] { seen[i] = image.as(ImageFormat::I420).data(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const uint8_t* data : seen) {
+        REQUIRE(data == seen.front());
+    }
+}
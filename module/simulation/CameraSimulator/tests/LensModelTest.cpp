@@ -0,0 +1,241 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../src/LensModel.h"
+
+using module::simulation::LensModel;
+using module::simulation::LensParameters;
+using module::simulation::LensProjection;
+using module::simulation::PixelLayout;
+using module::simulation::PixelSource;
+
+namespace {
+
+    // Where a ray through (x, y) on the z = 1 plane lands in the output image, straight from the lens equations
+    void distort(const LensParameters& params, double x, double y, double& u, double& v) {
+
+        const double* k = params.k;
+        const double r2 = x * x + y * y;
+        double xd = x;
+        double yd = y;
+
+        if (params.projection == LensProjection::RADIAL_TANGENTIAL) {
+            const double radial = 1 + r2 * (k[0] + r2 * (k[1] + r2 * k[2]));
+            xd = x * radial + 2 * params.p1 * x * y + params.p2 * (r2 + 2 * x * x);
+            yd = y * radial + params.p1 * (r2 + 2 * y * y) + 2 * params.p2 * x * y;
+        }
+        else if (params.projection == LensProjection::EQUIDISTANT && r2 > 0) {
+            const double theta = std::atan(std::sqrt(r2));
+            const double t2 = theta * theta;
+            const double theta_d = theta * (1 + t2 * (k[0] + t2 * (k[1] + t2 * (k[2] + t2 * k[3]))));
+            xd = x * theta_d / std::sqrt(r2);
+            yd = y * theta_d / std::sqrt(r2);
+        }
+
+        u = params.fx * xd + params.cx;
+        v = params.fy * yd + params.cy;
+    }
+
+    // Remaps an RGBX render whose red is its column and green its row, so every output pixel reads back where it
+    // sampled. Coordinates are only kept to a level, so the render is kept to 256 pixels and about 3x the output.
+    void check_remap(const LensParameters& params) {
+
+        LensModel lens;
+        lens.reset(params);
+        REQUIRE(lens.remaps());
+
+        const unsigned int render_w = lens.render_width();
+        const unsigned int render_h = lens.render_height();
+        REQUIRE(render_w <= 256);
+        REQUIRE(render_h <= 256);
+
+        std::vector<uint8_t> render(size_t(render_w) * render_h * 4);
+        for (unsigned int y = 0; y < render_h; ++y) {
+            for (unsigned int x = 0; x < render_w; ++x) {
+                uint8_t* p = &render[(size_t(y) * render_w + x) * 4];
+                p[0] = x;
+                p[1] = y;
+                p[2] = 0;
+                p[3] = 0;
+            }
+        }
+        PixelSource source = { render.data(), render_w, render_h, render_w * 4, PixelLayout::RGBX };
+
+        // The render is a symmetric pinhole with square pixels, up to rounding its size to even
+        const double ty = std::tan(lens.render_fov_y() * 0.5);
+        const double tx = ty * render_w / render_h;
+
+        std::vector<uint8_t> row(params.width * 4);
+        double worst = 0;
+        double total = 0;
+        for (unsigned int v = 0; v < params.height; ++v) {
+            lens.remap_row(source, v, row.data());
+            for (unsigned int u = 0; u < params.width; ++u) {
+                // Back through the render to the ray it sampled, then forward through the lens to the output image
+                const double x = ((row[u * 4 + 0] + 0.5) * 2.0 / render_w - 1.0) * tx;
+                const double y = ((row[u * 4 + 1] + 0.5) * 2.0 / render_h - 1.0) * ty;
+
+                double pu, pv;
+                distort(params, x, y, pu, pv);
+                const double error = std::hypot(pu - (u + 0.5), pv - (v + 0.5));
+                worst = std::max(worst, error);
+                total += error;
+            }
+        }
+
+        INFO("worst " << worst << " mean " << total / (params.width * params.height));
+        REQUIRE(worst < 0.5);
+        REQUIRE(total / (params.width * params.height) < 0.25);
+    }
+
+    // An RGBX render whose every channel is 10 left of column split and 20 from it on
+    std::vector<uint8_t> two_classes(unsigned int width, unsigned int height, unsigned int split) {
+        std::vector<uint8_t> data(size_t(width) * height * 4);
+        for (unsigned int y = 0; y < height; ++y) {
+            for (unsigned int x = 0; x < width; ++x) {
+                for (int c = 0; c < 4; ++c) {
+                    data[(size_t(y) * width + x) * 4 + c] = x < split ? 10 : 20;
+                }
+            }
+        }
+        return data;
+    }
+}
+
+TEST_CASE("Radial tangential remapping samples where the lens equations say", "[LensModel]") {
+
+    LensParameters params;
+    params.projection = LensProjection::RADIAL_TANGENTIAL;
+    params.width = 80;
+    params.height = 60;
+    params.fx = params.fy = 60;
+    params.cx = 41.5;
+    params.cy = 29;
+    params.k[0] = -0.2;
+    params.k[1] = 0.05;
+    params.p1 = 0.001;
+    params.p2 = -0.002;
+    params.render_scale = 3.0;
+
+    check_remap(params);
+}
+
+TEST_CASE("Equidistant remapping samples where the lens equations say", "[LensModel]") {
+
+    LensParameters params;
+    params.projection = LensProjection::EQUIDISTANT;
+    params.width = 80;
+    params.height = 60;
+    params.fx = params.fy = 40;
+    params.cx = 40;
+    params.cy = 30;
+    params.k[0] = 0.05;
+    params.render_scale = 3.0;
+
+    check_remap(params);
+}
+
+TEST_CASE("A pinhole renders its whole field of view, edge to edge", "[LensModel]") {
+
+    LensParameters params;
+    params.width = 320;
+    params.height = 240;
+    params.fx = params.fy = 200;
+    params.cx = 160;
+    params.cy = 120;
+
+    LensModel lens;
+    lens.reset(params);
+    REQUIRE(!lens.remaps());
+    REQUIRE(lens.render_width() == params.width);
+    REQUIRE(lens.render_height() == params.height);
+    REQUIRE(lens.render_fov_y() == Approx(2.0 * std::atan(params.height / (2.0 * params.fy))));
+}
+
+TEST_CASE("Nearest sampling without a remap takes every pixel of the smaller render", "[LensModel]") {
+
+    LensParameters params;
+    params.width = 160;
+    params.height = 120;
+    params.fx = params.fy = 100;
+    params.cx = 80;
+    params.cy = 60;
+
+    LensModel lens;
+    lens.reset(params);
+    REQUIRE(!lens.remaps());
+
+    const unsigned int step = 2;
+    const unsigned int width = lens.render_width() / step;
+    const unsigned int height = lens.render_height() / step;
+    std::vector<uint8_t> render = two_classes(width, height, 30);
+    PixelSource source = { render.data(), width, height, width * 4, PixelLayout::RGBX };
+
+    std::vector<uint8_t> labels(params.width / step);
+    for (unsigned int row = 0; row < params.height / step; ++row) {
+        lens.sample_row_nearest(source, row, step, labels.data());
+        for (unsigned int x = 0; x < labels.size(); ++x) {
+            REQUIRE(int(labels[x]) == (x < 30 ? 10 : 20));
+        }
+    }
+}
+
+TEST_CASE("Nearest sampling through a lens never blends classes", "[LensModel]") {
+
+    LensParameters params;
+    params.projection = LensProjection::EQUIDISTANT;
+    params.width = 160;
+    params.height = 120;
+    params.fx = params.fy = 60;
+    params.cx = 80;
+    params.cy = 60;
+    params.k[0] = 0.05;
+
+    LensModel lens;
+    lens.reset(params);
+    REQUIRE(lens.remaps());
+
+    for (unsigned int step : { 1u, 2u, 4u }) {
+        const unsigned int width = lens.render_width() / step;
+        const unsigned int height = lens.render_height() / step;
+        std::vector<uint8_t> render = two_classes(width, height, width / 2);
+        PixelSource source = { render.data(), width, height, width * 4, PixelLayout::RGBX };
+
+        std::vector<uint8_t> labels(params.width / step);
+        for (unsigned int row = 0; row < params.height / step; ++row) {
+            lens.sample_row_nearest(source, row, step, labels.data());
+
+            // the left and right edges of the image look at either side of the render, with one boundary between
+            REQUIRE(int(labels.front()) == 10);
+            REQUIRE(int(labels.back()) == 20);
+            unsigned int changes = 0;
+            for (unsigned int x = 0; x < labels.size(); ++x) {
+                REQUIRE((labels[x] == 10 || labels[x] == 20));
+                changes += x > 0 && labels[x] != labels[x - 1];
+            }
+            REQUIRE(changes == 1);
+        }
+    }
+}
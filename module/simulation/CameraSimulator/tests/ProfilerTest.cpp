@@ -0,0 +1,104 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <chrono>
+
+#include "../src/Profiler.h"
+
+using module::simulation::LatencyHistogram;
+using module::simulation::ProfileStage;
+using module::simulation::Profiler;
+
+TEST_CASE("Latency histogram quantiles are within a bucket of the truth", "[Profiler]") {
+
+    LatencyHistogram histogram;
+    REQUIRE(histogram.count() == 0);
+    REQUIRE(histogram.quantile(0.5).count() == 0);
+
+    SECTION("Small latencies are exact") {
+        for (int i = 1; i <= 10; ++i) {
+            histogram.record(std::chrono::nanoseconds(i));
+        }
+        REQUIRE(histogram.quantile(0.5).count() == 5);
+        REQUIRE(histogram.quantile(1.0).count() == 10);
+        REQUIRE(histogram.max().count() == 10);
+    }
+
+    SECTION("Large latencies are within 5%") {
+        // 1 us to 100 ms uniformly
+        const int64_t lowest = 1000;
+        const int64_t step = 1000;
+        const int n = 100000;
+        for (int i = 0; i < n; ++i) {
+            histogram.record(std::chrono::nanoseconds(lowest + i * step));
+        }
+
+        REQUIRE(histogram.count() == uint64_t(n));
+        REQUIRE(histogram.max().count() == lowest + (n - 1) * step);
+        REQUIRE(histogram.mean().count() == lowest + (n - 1) * step / 2);
+
+        for (double q : { 0.5, 0.95, 0.99 }) {
+            const double truth = lowest + (q * n - 1) * step;
+            REQUIRE(double(histogram.quantile(q).count()) == Approx(truth).epsilon(0.05));
+        }
+    }
+
+    SECTION("Clearing forgets everything") {
+        histogram.record(std::chrono::milliseconds(3));
+        histogram.clear();
+        REQUIRE(histogram.count() == 0);
+        REQUIRE(histogram.max().count() == 0);
+    }
+}
+
+TEST_CASE("The profiler reports the stages that ran and starts afresh", "[Profiler]") {
+
+    Profiler profiler;
+
+    SECTION("Disabled scopes record nothing") {
+        {
+            PROFILE_STAGE(profiler, ProfileStage::FRAME);
+        }
+        REQUIRE(profiler.report(NUClear::clock::now(), std::chrono::seconds(1)).stages.empty());
+    }
+
+    SECTION("Enabled scopes are reported in pipeline order") {
+        profiler.reset(true, "");
+
+        profiler.record(ProfileStage::EMIT, std::chrono::microseconds(20));
+        {
+            PROFILE_STAGE(profiler, ProfileStage::FRAME);
+            PROFILE_STAGE(profiler, ProfileStage::CONVERT);
+        }
+        profiler.record(ProfileStage::EMIT, std::chrono::microseconds(40));
+
+        auto profile = profiler.report(NUClear::clock::now(), std::chrono::seconds(1));
+        REQUIRE(profile.stages.size() == 3);
+        REQUIRE(profile.stages[0].name == "frame");
+        REQUIRE(profile.stages[1].name == "convert");
+        REQUIRE(profile.stages[2].name == "emit");
+        REQUIRE(profile.stages[2].count == 2);
+        REQUIRE(profile.stages[2].max == Approx(40e-6));
+        REQUIRE(profile.stages[2].mean == Approx(30e-6));
+
+        REQUIRE(profiler.report(NUClear::clock::now(), std::chrono::seconds(1)).stages.empty());
+    }
+}
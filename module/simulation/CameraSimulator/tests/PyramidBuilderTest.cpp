@@ -0,0 +1,130 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/PyramidBuilder.h"
+
+using module::simulation::ConversionKernel;
+using module::simulation::PyramidBuilder;
+using module::simulation::YUYVConverter;
+
+namespace {
+
+    const ConversionKernel KERNELS[] = { ConversionKernel::SCALAR, ConversionKernel::SSE2, ConversionKernel::AVX2 };
+
+    std::vector<uint8_t> random_yuyv(unsigned int width, unsigned int height) {
+        std::vector<uint8_t> data(size_t(width) * height * 2);
+        std::srand(width * height);
+        for (auto& byte : data) {
+            byte = std::rand();
+        }
+        return data;
+    }
+
+    std::vector<uint8_t> build(const PyramidBuilder& builder, const std::vector<uint8_t>& image, unsigned int height,
+                               unsigned int strip_rows) {
+        std::vector<uint8_t> pyramid(builder.size());
+        for (unsigned int row = 0; row < height; row += strip_rows) {
+            builder.build_rows(image.data(), pyramid.data(), row, std::min(row + strip_rows, height));
+        }
+        return pyramid;
+    }
+}
+
+TEST_CASE("Pyramid levels are the rounded mean of the samples they cover", "[PyramidBuilder]") {
+
+    const unsigned int width = 8;
+    const unsigned int height = 2;
+
+    // columns of luma 0 to 7 over 10 to 17, Cb of the pairs 1, 3, 5, 7 and 2, 4, 6, 8 and Cr 100 more
+    std::vector<uint8_t> image(width * height * 2);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int pair = 0; pair < width / 2; ++pair) {
+            uint8_t* p = image.data() + (y * width + pair * 2) * 2;
+            p[0] = y * 10 + pair * 2;
+            p[2] = y * 10 + pair * 2 + 1;
+            p[1] = pair * 2 + 1 + y;
+            p[3] = 100 + pair * 2 + 1 + y;
+        }
+    }
+
+    PyramidBuilder builder(ConversionKernel::SCALAR);
+    builder.reset(width, height, 1);
+    REQUIRE(builder.size() == 4 * 1 * 2);
+
+    std::vector<uint8_t> pyramid = build(builder, image, height, height);
+
+    // (0 + 1 + 10 + 11 + 2) / 4 rounds 6 to 6, the chroma (1 + 3 + 2 + 4 + 2) / 4 to 3
+    const std::vector<uint8_t> expected = { 6, 3, 8, 103, 10, 7, 12, 107 };
+    REQUIRE(pyramid == expected);
+}
+
+TEST_CASE("Every pyramid kernel matches the scalar kernel for any strip split", "[PyramidBuilder]") {
+
+    for (unsigned int width : { 640u, 336u, 96u }) {
+        const unsigned int height = 96;
+        const std::vector<uint8_t> image = random_yuyv(width, height);
+
+        PyramidBuilder scalar(ConversionKernel::SCALAR);
+        scalar.reset(width, height, 3);
+        const std::vector<uint8_t> expected = build(scalar, image, height, height);
+
+        for (auto kernel : KERNELS) {
+            if (!YUYVConverter::is_supported(kernel)) {
+                continue;
+            }
+
+            PyramidBuilder builder(kernel);
+            builder.reset(width, height, 3);
+            REQUIRE(builder.kernel() == kernel);
+
+            for (unsigned int strip_rows : { 8u, 48u, 96u }) {
+                INFO("kernel " << int(kernel) << " width " << width << " strips of " << strip_rows);
+                REQUIRE(build(builder, image, height, strip_rows) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Pyramid levels halve the one above and share one buffer", "[PyramidBuilder]") {
+
+    PyramidBuilder builder;
+    builder.reset(640, 480, 3);
+
+    REQUIRE(builder.row_alignment() == 8);
+    REQUIRE(builder.levels().size() == 3);
+    REQUIRE(builder.levels()[0].width == 320);
+    REQUIRE(builder.levels()[0].height == 240);
+    REQUIRE(builder.levels()[2].width == 80);
+    REQUIRE(builder.levels()[2].height == 60);
+    REQUIRE(builder.levels()[1].offset == 320 * 240 * 2);
+    REQUIRE(builder.size() == (320 * 240 + 160 * 120 + 80 * 60) * 2);
+
+    // a flat image stays flat all the way down
+    std::vector<uint8_t> image(640 * 480 * 2, 77);
+    REQUIRE(build(builder, image, 480, 48) == std::vector<uint8_t>(builder.size(), 77));
+
+    REQUIRE_THROWS_AS(builder.reset(640, 480, 6), std::runtime_error);
+    REQUIRE_THROWS_AS(builder.reset(644, 480, 2), std::runtime_error);
+}
@@ -0,0 +1,113 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include "../src/RenderQuality.h"
+
+using module::simulation::QualityController;
+using module::simulation::QualityTier;
+using module::simulation::ShadowQuality;
+using module::simulation::TextureFiltering;
+using module::simulation::default_quality_tiers;
+
+namespace {
+
+    // Runs frames frames through the controller with each tier taking its cost, counting the tier changes
+    unsigned int run(QualityController& controller, const std::vector<double>& cost_ms, unsigned int frames) {
+        unsigned int changes = 0;
+        for (unsigned int i = 0; i < frames; ++i) {
+            auto cost = std::chrono::duration<double, std::milli>(cost_ms[controller.tier()]);
+            changes += controller.record(std::chrono::duration_cast<std::chrono::steady_clock::duration>(cost));
+        }
+        return changes;
+    }
+}
+
+TEST_CASE("Quality tiers are read with the high tier's values as defaults", "[RenderQuality]") {
+
+    QualityTier tier = QualityTier::parse(YAML::Load("{ name: ci, shadows: none, filtering: trilinear, sky: false, "
+                                                     "lod_bias: 0.5, shadow_casters: [robots] }"));
+    REQUIRE(tier.name == "ci");
+    REQUIRE(tier.shadows == ShadowQuality::NONE);
+    REQUIRE(tier.filtering == TextureFiltering::TRILINEAR);
+    REQUIRE(tier.anisotropy == 8);
+    REQUIRE(tier.mipmaps == 5);
+    REQUIRE(!tier.sky);
+    REQUIRE(tier.lod_bias == 0.5f);
+    REQUIRE(!tier.stadium_shadows);
+    REQUIRE(!tier.ball_shadows);
+    REQUIRE(tier.robot_shadows);
+
+    REQUIRE_THROWS_AS(QualityTier::parse(YAML::Load("{ shadows: soft }")), std::runtime_error);
+    REQUIRE_THROWS_AS(QualityTier::parse(YAML::Load("{ shadow_casters: [flags] }")), std::runtime_error);
+
+    std::vector<QualityTier> tiers = default_quality_tiers();
+    REQUIRE(tiers.size() == 3);
+    REQUIRE(tiers.back().name == "high");
+    REQUIRE(tiers.back().shadows == ShadowQuality::STENCIL_ADDITIVE);
+    REQUIRE(tiers.back().filtering == TextureFiltering::ANISOTROPIC);
+}
+
+TEST_CASE("Without a target rate the tier never changes", "[RenderQuality]") {
+
+    QualityController controller;
+    controller.reset(3, 2, 0.0, 10, 0.2, 2);
+    REQUIRE(run(controller, { 10.0, 50.0, 100.0 }, 1000) == 0);
+    REQUIRE(controller.tier() == 2);
+}
+
+TEST_CASE("The controller settles on the best tier that holds the frame rate", "[RenderQuality]") {
+
+    // 30 frames a second is a 33 ms budget, which only the bottom two tiers fit in
+    const std::vector<double> cost_ms = { 10.0, 25.0, 40.0 };
+
+    SECTION("Stepping down from a tier that is too slow") {
+        QualityController controller;
+        controller.reset(3, 2, 30.0, 10, 0.2, 2);
+        run(controller, cost_ms, 11);
+        REQUIRE(controller.tier() == 1);
+        REQUIRE(controller.mean_frame_time() == Approx(0.040));
+    }
+
+    SECTION("Stepping up from a tier with room to spare") {
+        QualityController controller;
+        controller.reset(3, 0, 30.0, 10, 0.2, 2);
+        run(controller, cost_ms, 25);
+        REQUIRE(controller.tier() == 1);
+    }
+
+    SECTION("Trying the tier above less and less often") {
+        QualityController controller;
+        controller.reset(3, 1, 30.0, 10, 0.0, 1);
+
+        // every failed attempt at the top tier is a step up and a step down, each waiting twice as long
+        const unsigned int early = run(controller, cost_ms, 1000);
+        const unsigned int late = run(controller, cost_ms, 1000);
+        REQUIRE(early >= 4);
+        REQUIRE(late < early / 2);
+        REQUIRE(late > 0);
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+#include "../src/RobotModel.h"
+
+using module::simulation::RobotModel;
+
+namespace {
+
+    const char* const ARM = R"(
+scale: 8
+root:
+  name: body
+  position: [0, 0.6, 0]
+  entities:
+    - { mesh: body.mesh, material: white, cast_shadows: false }
+  children:
+    - name: shoulder
+      position: [0.1, 0.2, 0]
+      joint: { name: shoulder_pitch, axis: [2, 0, 0] }
+      entities:
+        - { mesh: shoulder.mesh, material: white, instanced_material: white/instanced }
+      children:
+        - name: forearm
+          rotate: [yaw: 90]
+          joint: { name: elbow, axis: [1, 0, 0] }
+          entities:
+            - { mesh: forearm.mesh, material: white }
+            - { mesh: hand.mesh, material: orange }
+    - name: head
+      position: [0, 0.24, 0]
+)";
+}
+
+TEST_CASE("Robot descriptions flatten into links, joints and entities", "[RobotModel]") {
+
+    RobotModel model = RobotModel::parse(ARM, "arm");
+
+    REQUIRE(model.scale == 8.0f);
+    REQUIRE(model.links.size() == 4);
+    REQUIRE(model.joints.size() == 2);
+    REQUIRE(model.entities.size() == 4);
+
+    SECTION("Links come after their parents") {
+        REQUIRE(model.links[0].name == "body");
+        REQUIRE(model.links[0].parent == -1);
+        REQUIRE(model.links[1].parent == 0);
+        REQUIRE(model.links[2].parent == 1);
+        REQUIRE(model.links[3].name == "head");
+        REQUIRE(model.links[3].parent == 0);
+    }
+
+    SECTION("Joints are numbered in the order they appear") {
+        REQUIRE(model.joint_index("shoulder_pitch") == 0);
+        REQUIRE(model.joint_index("elbow") == 1);
+        REQUIRE(model.joint_index("knee") == -1);
+
+        REQUIRE(model.links[0].joint == -1);
+        REQUIRE(model.links[1].joint == 0);
+        REQUIRE(model.joints[0].link == 1);
+        REQUIRE(model.joints[1].link == 2);
+
+        // axes are normalised
+        REQUIRE(model.joints[0].axis[0] == Approx(1.0f));
+        REQUIRE(model.joints[0].axis[1] == Approx(0.0f));
+    }
+
+    SECTION("Links keep their rest transform and entities") {
+        REQUIRE(model.links[1].position[0] == Approx(0.1f));
+        REQUIRE(model.links[2].orientation[0] == Approx(std::sqrt(0.5f)));
+        REQUIRE(model.links[2].orientation[2] == Approx(std::sqrt(0.5f)));
+
+        REQUIRE(model.links[2].first_entity == 2);
+        REQUIRE(model.links[2].entity_count == 2);
+        REQUIRE(model.links[3].entity_count == 0);
+
+        REQUIRE_FALSE(model.entities[0].cast_shadows);
+        REQUIRE(model.entities[1].cast_shadows);
+        REQUIRE(model.entities[1].instanced_material == "white/instanced");
+        REQUIRE(model.entities[3].material == "orange");
+    }
+}
+
+TEST_CASE("Invalid robot descriptions are rejected", "[RobotModel]") {
+
+    REQUIRE_THROWS_AS(RobotModel::parse("scale: 1", "empty"), std::runtime_error);
+    REQUIRE_THROWS_AS(RobotModel::parse("root: { name: a, joint: { name: j, axis: [0, 0, 0] } }", "zero axis"), std::runtime_error);
+    REQUIRE_THROWS_AS(RobotModel::parse("root: { name: a, rotate: [spin: 90] }", "bad rotation"), std::runtime_error);
+    REQUIRE_THROWS_AS(RobotModel::parse("root: { name: a, joint: { name: j, axis: [1, 0, 0] }, "
+                                        "children: [{ name: b, joint: { name: j, axis: [1, 0, 0] } }] }", "duplicate"),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS(RobotModel::load("does/not/exist.yaml"), std::runtime_error);
+}
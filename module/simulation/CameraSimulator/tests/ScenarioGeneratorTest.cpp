@@ -0,0 +1,186 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <yaml-cpp/yaml.h>
+
+#include "../src/ScenarioGenerator.h"
+
+using module::simulation::Distribution;
+using module::simulation::SampledScene;
+using module::simulation::ScenarioGenerator;
+
+namespace {
+
+    const char* const CONFIG = R"(
+enabled: true
+seed: 7
+episodes: 100
+frames: 10
+camera:
+  position: [{ uniform: [-25, -15] }, { uniform: [6, 10] }, -5]
+  yaw: { normal: [1.8, 0.1] }
+light:
+  intensity: { uniform: [0.5, 1.5] }
+skies: [Examples/CloudySky, Examples/EveningSky]
+robots:
+  position: [{ uniform: [-20, 20] }, 0, { uniform: [-15, 15] }]
+  yaw: { uniform: [-180, 180] }
+noise_level: { uniform: [0, 2] }
+)";
+
+    SampledScene defaults() {
+        SampledScene scene = {};
+        scene.camera_position[0] = -20;
+        scene.camera_position[1] = 8;
+        scene.camera_position[2] = -5;
+        scene.camera_pitch = -0.18f;
+        scene.camera_yaw = 1.8f;
+        std::fill(scene.light_colour, scene.light_colour + 3, 1.0f);
+        scene.ambient = 0.5f;
+        scene.ball_position[0] = 22;
+        scene.ball_position[1] = 0.8f;
+        scene.noise_level = 1;
+        // two robots
+        scene.robots = { 9.6f, 0, -3.6672f, -90, -9.6f, 0, 3.6672f, 90 };
+        return scene;
+    }
+
+    bool same(const SampledScene& a, const SampledScene& b) {
+        return std::equal(a.camera_position, a.camera_position + 3, b.camera_position)
+            && a.camera_yaw == b.camera_yaw && a.light_colour[0] == b.light_colour[0] && a.sky == b.sky
+            && a.robots == b.robots && a.noise_level == b.noise_level;
+    }
+}
+
+TEST_CASE("Distributions are constants, uniform or normal", "[ScenarioGenerator]") {
+
+    REQUIRE(Distribution::parse(YAML::Load("3.5")).sample(1, 2) == 3.5);
+    REQUIRE(Distribution::parse(YAML::Load("{ uniform: [1, 2] }")).kind == Distribution::Kind::UNIFORM);
+    REQUIRE(Distribution::parse(YAML::Load("{ normal: [0, 1] }")).kind == Distribution::Kind::NORMAL);
+    REQUIRE_THROWS_AS(Distribution::parse(YAML::Load("{ poisson: [1, 2] }")), std::runtime_error);
+    REQUIRE_THROWS_AS(Distribution::parse(YAML::Load("{ uniform: [1] }")), std::runtime_error);
+
+    // moments of a few thousand draws
+    Distribution uniform(Distribution::Kind::UNIFORM, -1, 3);
+    Distribution normal(Distribution::Kind::NORMAL, 5, 2);
+    double uniform_sum = 0;
+    double normal_sum = 0;
+    double normal_squares = 0;
+    const int n = 20000;
+    for (int i = 0; i < n; ++i) {
+        const uint64_t r0 = uint64_t(i) * 0x9E3779B97F4A7C15ull;
+        const uint64_t r1 = (uint64_t(i) + 12345) * 0xBF58476D1CE4E5B9ull;
+        const double u = uniform.sample(r0, r1);
+        REQUIRE(u >= -1);
+        REQUIRE(u < 3);
+        uniform_sum += u;
+        const double x = normal.sample(r0, r1);
+        normal_sum += x;
+        normal_squares += (x - 5) * (x - 5);
+    }
+    REQUIRE(uniform_sum / n == Approx(1).margin(0.05));
+    REQUIRE(normal_sum / n == Approx(5).margin(0.05));
+    REQUIRE(std::sqrt(normal_squares / n) == Approx(2).margin(0.05));
+}
+
+TEST_CASE("Episodes are drawn the same every time and differently from each other", "[ScenarioGenerator]") {
+
+    ScenarioGenerator generator = ScenarioGenerator::parse(YAML::Load(CONFIG), defaults());
+
+    REQUIRE(generator.enabled());
+    REQUIRE(generator.episodes() == 100);
+    REQUIRE(generator.frames() == 10);
+    REQUIRE(!generator.per_frame());
+
+    REQUIRE(same(generator.sample(3, 0), generator.sample(3, 0)));
+    // without per frame resampling every frame of an episode is its first
+    REQUIRE(same(generator.sample(3, 0), generator.sample(3, 7)));
+    REQUIRE(!same(generator.sample(3, 0), generator.sample(4, 0)));
+
+    YAML::Node per_frame = YAML::Load(CONFIG);
+    per_frame["resample"] = "frame";
+    ScenarioGenerator frames = ScenarioGenerator::parse(per_frame, defaults());
+    REQUIRE(frames.per_frame());
+    REQUIRE(!same(frames.sample(3, 0), frames.sample(3, 7)));
+
+    // a different seed is a different dataset
+    YAML::Node reseeded = YAML::Load(CONFIG);
+    reseeded["seed"] = 8;
+    REQUIRE(!same(ScenarioGenerator::parse(reseeded, defaults()).sample(3, 0), generator.sample(3, 0)));
+}
+
+TEST_CASE("Draws stay in their ranges and unlisted parameters keep their defaults", "[ScenarioGenerator]") {
+
+    ScenarioGenerator generator = ScenarioGenerator::parse(YAML::Load(CONFIG), defaults());
+    const SampledScene fallback = defaults();
+
+    bool both_skies[2] = { false, false };
+    for (uint64_t episode = 0; episode < 200; ++episode) {
+        SampledScene scene = generator.sample(episode, 0);
+
+        REQUIRE(scene.camera_position[0] >= -25);
+        REQUIRE(scene.camera_position[0] < -15);
+        REQUIRE(scene.camera_position[2] == -5);
+        REQUIRE(scene.camera_pitch == fallback.camera_pitch);
+        REQUIRE(scene.light_colour[0] >= 0.5f);
+        REQUIRE(scene.light_colour[0] <= 1.5f);
+        REQUIRE(scene.light_colour[0] == scene.light_colour[2]);
+        REQUIRE(scene.ambient == fallback.ambient);
+        REQUIRE(scene.ball_position[0] == fallback.ball_position[0]);
+        REQUIRE(scene.noise_level >= 0);
+        REQUIRE(scene.noise_level < 2);
+
+        REQUIRE(scene.robots.size() == 8);
+        REQUIRE(scene.robots[4] >= -20);
+        REQUIRE(scene.robots[4] < 20);
+        REQUIRE(scene.robots[5] == 0);
+
+        REQUIRE(scene.sky < 2);
+        both_skies[scene.sky] = true;
+    }
+    REQUIRE(both_skies[0]);
+    REQUIRE(both_skies[1]);
+
+    // and without a robots section they stay where they were placed
+    YAML::Node config = YAML::Load(CONFIG);
+    config.remove("robots");
+    REQUIRE(ScenarioGenerator::parse(config, defaults()).sample(5, 0).robots == fallback.robots);
+}
+
+TEST_CASE("Manifest rows have a value for every column", "[ScenarioGenerator]") {
+
+    ScenarioGenerator generator = ScenarioGenerator::parse(YAML::Load(CONFIG), defaults());
+
+    std::ostringstream out;
+    ScenarioGenerator::write_manifest_header(out, 2);
+    generator.write_manifest_row(out, 3, 1, 0, 123456789, generator.sample(3, 1));
+
+    std::istringstream lines(out.str());
+    std::string header;
+    std::string row;
+    std::getline(lines, header);
+    std::getline(lines, row);
+
+    REQUIRE(std::count(header.begin(), header.end(), ',') == std::count(row.begin(), row.end(), ','));
+    REQUIRE(row.compare(0, 17, "3,1,0,123456789,-") == 0);
+}
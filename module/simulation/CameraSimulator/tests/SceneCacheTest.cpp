@@ -0,0 +1,202 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <yaml-cpp/yaml.h>
+
+#include "../src/SceneCache.h"
+
+using module::simulation::SceneCache;
+using module::simulation::scene_rotation;
+
+namespace {
+
+    const std::string SCENE = R"(
+nodes:
+  - scale: 10
+    position: [1, 2, 3]
+    entities:
+      - { mesh: stadiumgrass.mesh, material: SoccerField, cast_shadows: false }
+  - instances:
+      - { position: [5, 0, 0], id: left }
+      - { position: [-5, 0, 0], id: right }
+    rotate: [yaw: 90]
+    children:
+      - scale: [1, 2, 3]
+        entities:
+          - { mesh: ball.mesh, material: Ball, animation: spin }
+)";
+
+    std::string temp_path(const std::string& extension) {
+        return "/tmp/SceneCacheTest." + std::to_string(getpid()) + extension;
+    }
+
+    void write(const std::string& path, const std::string& text) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << text;
+    }
+
+    std::string read(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST_CASE("Scene descriptions compile into flat node and entity records", "[SceneCache]") {
+
+    const std::string description = temp_path(".yaml");
+    const std::string cache = temp_path(".nusc");
+    write(description, SCENE);
+    std::remove(cache.c_str());
+
+    auto scene = SceneCache::load(description, cache);
+    REQUIRE(!scene->from_cache());
+
+    // the instances are copies of their node and its child, parents always come first
+    REQUIRE(scene->node_count() == 5);
+    REQUIRE(scene->entity_count() == 3);
+
+    const auto* nodes = scene->nodes();
+    REQUIRE(nodes[0].parent == -1);
+    REQUIRE(nodes[0].scale[1] == 10.0f);
+    REQUIRE(nodes[0].position[2] == 3.0f);
+    REQUIRE(nodes[0].id == SceneCache::NO_STRING);
+    REQUIRE(nodes[1].parent == -1);
+    REQUIRE(std::string(scene->string(nodes[1].id)) == "left");
+    REQUIRE(nodes[1].position[0] == 5.0f);
+    REQUIRE(nodes[1].entity_count == 0);
+    REQUIRE(nodes[2].parent == 1);
+    REQUIRE(nodes[2].scale[2] == 3.0f);
+    REQUIRE(nodes[3].parent == -1);
+    REQUIRE(std::string(scene->string(nodes[3].id)) == "right");
+    REQUIRE(nodes[4].parent == 3);
+
+    const auto& grass = scene->entities()[nodes[0].first_entity];
+    REQUIRE(std::string(scene->string(grass.mesh)) == "stadiumgrass.mesh");
+    REQUIRE(grass.cast_shadows == 0);
+    REQUIRE(grass.animation == SceneCache::NO_STRING);
+
+    const auto& ball = scene->entities()[nodes[4].first_entity];
+    REQUIRE(std::string(scene->string(ball.material)) == "Ball");
+    REQUIRE(std::string(scene->string(ball.animation)) == "spin");
+    REQUIRE(ball.cast_shadows == 1);
+
+    scene.reset();
+    std::remove(description.c_str());
+    std::remove(cache.c_str());
+}
+
+TEST_CASE("Scenes load from the cache until their description changes", "[SceneCache]") {
+
+    const std::string description = temp_path(".yaml");
+    const std::string cache = temp_path(".nusc");
+    write(description, SCENE);
+    std::remove(cache.c_str());
+
+    REQUIRE(!SceneCache::load(description, cache)->from_cache());
+
+    auto cached = SceneCache::load(description, cache);
+    REQUIRE(cached->from_cache());
+    REQUIRE(cached->node_count() == 5);
+    REQUIRE(std::string(cached->string(cached->nodes()[1].id)) == "left");
+    cached.reset();
+
+    // any edit to the description, even one that leaves the nodes the same, compiles it again
+    std::string edited = SCENE;
+    edited.replace(edited.find("id: left"), 8, "id: west");
+    write(description, edited);
+
+    auto recompiled = SceneCache::load(description, cache);
+    REQUIRE(!recompiled->from_cache());
+    REQUIRE(std::string(recompiled->string(recompiled->nodes()[1].id)) == "west");
+    recompiled.reset();
+
+    write(description, edited + "\n# a comment\n");
+    REQUIRE(!SceneCache::load(description, cache)->from_cache());
+    REQUIRE(SceneCache::load(description, cache)->from_cache());
+
+    std::remove(description.c_str());
+    std::remove(cache.c_str());
+}
+
+TEST_CASE("Caches from another version or cut short are rebuilt", "[SceneCache]") {
+
+    const std::string description = temp_path(".yaml");
+    const std::string cache = temp_path(".nusc");
+    write(description, SCENE);
+    std::remove(cache.c_str());
+
+    REQUIRE(!SceneCache::load(description, cache)->from_cache());
+    const std::string bytes = read(cache);
+
+    // the version follows the four byte magic
+    std::string other_version = bytes;
+    other_version[4] ^= 0x7F;
+    write(cache, other_version);
+    REQUIRE(!SceneCache::load(description, cache)->from_cache());
+    REQUIRE(read(cache) == bytes);
+
+    write(cache, bytes.substr(0, bytes.size() / 2));
+    REQUIRE(!SceneCache::load(description, cache)->from_cache());
+    REQUIRE(SceneCache::load(description, cache)->from_cache());
+
+    std::remove(description.c_str());
+    std::remove(cache.c_str());
+}
+
+TEST_CASE("Invalid scene descriptions are reported", "[SceneCache]") {
+
+    const std::string cache = temp_path(".nusc");
+    REQUIRE_THROWS_AS(SceneCache::load(temp_path(".missing.yaml"), cache), std::runtime_error);
+
+    const std::string description = temp_path(".yaml");
+    write(description, "nodes:\n  - rotate: [spin: 90]\n");
+    REQUIRE_THROWS_AS(SceneCache::load(description, cache), std::runtime_error);
+
+    std::remove(description.c_str());
+    std::remove(cache.c_str());
+}
+
+TEST_CASE("Scene rotations apply yaw, pitch and roll about the node's own axes in order", "[SceneCache]") {
+
+    float q[4];
+
+    scene_rotation(YAML::Node(), q);
+    REQUIRE(q[0] == 1.0f);
+    REQUIRE(q[1] == 0.0f);
+
+    // yaw turns about y
+    scene_rotation(YAML::Load("[yaw: 90]"), q);
+    REQUIRE(q[0] == Approx(std::sqrt(0.5)));
+    REQUIRE(q[2] == Approx(std::sqrt(0.5)));
+
+    // two half turns about different axes are a half turn about the third
+    scene_rotation(YAML::Load("[pitch: 180, roll: 180]"), q);
+    REQUIRE(std::abs(q[2]) == Approx(1.0f));
+    REQUIRE(q[0] == Approx(0.0f).margin(1e-6));
+
+    REQUIRE_THROWS_AS(scene_rotation(YAML::Load("[spin: 90]"), q), std::runtime_error);
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "../src/SensorNoise.h"
+
+using module::simulation::SensorNoise;
+
+namespace {
+
+    const unsigned int WIDTH = 64;
+    const unsigned int HEIGHT = 37;
+
+    // A YUYV frame covering the whole luma range, so shot noise differs from sample to sample
+    std::vector<uint8_t> gradient() {
+        std::vector<uint8_t> yuyv(WIDTH * HEIGHT * 2);
+        for (size_t i = 0; i < yuyv.size(); ++i) {
+            yuyv[i] = uint8_t(i * 7);
+        }
+        return yuyv;
+    }
+
+    // Applies noise to a copy of the gradient, in strips starting at each of the given rows
+    std::vector<uint8_t> noisy(const SensorNoise& noise,
+                               uint64_t frame,
+                               uint64_t stream,
+                               const std::vector<unsigned int>& strips) {
+        std::vector<uint8_t> yuyv = gradient();
+        for (size_t i = 0; i < strips.size(); ++i) {
+            const unsigned int last = i + 1 < strips.size() ? strips[i + 1] : HEIGHT;
+            noise.apply_rows(yuyv.data(), WIDTH, frame, stream, strips[i], last);
+        }
+        return yuyv;
+    }
+}
+
+TEST_CASE("Sensor noise is the same for the same key however the rows are split", "[SensorNoise]") {
+
+    SensorNoise noise;
+    noise.reset(1234, 2.0, 0.05);
+    REQUIRE(noise.enabled());
+
+    const std::vector<uint8_t> whole = noisy(noise, 1000, 3, { 0 });
+    REQUIRE(whole != gradient());
+
+    // uneven strips, done out of order as the worker pool may
+    std::vector<uint8_t> backwards = gradient();
+    const unsigned int strips[] = { 0, 1, 8, 9, 20, 36, HEIGHT };
+    for (int i = 5; i >= 0; --i) {
+        noise.apply_rows(backwards.data(), WIDTH, 1000, 3, strips[i], strips[i + 1]);
+    }
+
+    REQUIRE(noisy(noise, 1000, 3, { 0, 1, 8, 9, 20, 36 }) == whole);
+    REQUIRE(noisy(noise, 1000, 3, { 0, 5, 10, 15, 20, 25, 30, 35 }) == whole);
+    REQUIRE(backwards == whole);
+
+    // a fresh generator with the same seed repeats it too
+    SensorNoise again;
+    again.reset(1234, 2.0, 0.05);
+    REQUIRE(noisy(again, 1000, 3, { 0, 17 }) == whole);
+}
+
+TEST_CASE("Sensor noise changes with any part of its key", "[SensorNoise]") {
+
+    SensorNoise noise;
+    noise.reset(1234, 2.0, 0.05);
+    const std::vector<uint8_t> whole = noisy(noise, 1000, 3, { 0 });
+
+    // another frame or stream
+    REQUIRE(noisy(noise, 1001, 3, { 0 }) != whole);
+    REQUIRE(noisy(noise, 1000, 4, { 0 }) != whole);
+
+    // another seed
+    SensorNoise other;
+    other.reset(1235, 2.0, 0.05);
+    REQUIRE(noisy(other, 1000, 3, { 0 }) != whole);
+
+    // and every row gets its own noise rather than repeating the first
+    const std::vector<uint8_t> clean = gradient();
+    std::vector<int> first(WIDTH * 2);
+    std::vector<int> second(WIDTH * 2);
+    for (unsigned int i = 0; i < WIDTH * 2; ++i) {
+        first[i] = whole[i] - clean[i];
+        second[i] = whole[WIDTH * 2 + i] - clean[WIDTH * 2 + i];
+    }
+    REQUIRE(first != second);
+}
+
+TEST_CASE("Sensor noise without any noise leaves the image alone", "[SensorNoise]") {
+
+    SensorNoise noise;
+    noise.reset(1234, 0.0, 0.0);
+    REQUIRE(!noise.enabled());
+    REQUIRE(noisy(noise, 1000, 3, { 0, 10 }) == gradient());
+}
@@ -0,0 +1,165 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../src/SimulationClock.h"
+
+using module::simulation::ClockMode;
+using module::simulation::SimulationClock;
+using module::simulation::clock_mode_from_string;
+
+namespace {
+
+    const std::chrono::milliseconds NO_WAIT(0);
+    const std::chrono::milliseconds TIMEOUT(20);
+}
+
+TEST_CASE("Clock modes are parsed from the configuration", "[SimulationClock]") {
+
+    REQUIRE(clock_mode_from_string("realtime") == ClockMode::REALTIME);
+    REQUIRE(clock_mode_from_string("max_speed") == ClockMode::MAX_SPEED);
+    REQUIRE(clock_mode_from_string("lockstep") == ClockMode::LOCKSTEP);
+    REQUIRE_THROWS_AS(clock_mode_from_string("fast"), std::invalid_argument);
+}
+
+TEST_CASE("Fixed step clocks advance from the epoch by exactly one step per frame", "[SimulationClock]") {
+
+    for (ClockMode mode : { ClockMode::MAX_SPEED, ClockMode::LOCKSTEP }) {
+        SimulationClock clock(mode, std::chrono::duration<double>(1.0 / 60.0));
+        REQUIRE(clock.now() == NUClear::clock::time_point());
+
+        for (int frame = 1; frame <= 600; ++frame) {
+            clock.expect(0);
+            REQUIRE(clock.wait(NO_WAIT));
+            REQUIRE(clock.advance().count() == Approx(1.0 / 60.0));
+        }
+
+        // ten simulated seconds, however long that took
+        const auto elapsed = std::chrono::duration<double>(clock.now().time_since_epoch());
+        REQUIRE(elapsed.count() == Approx(10.0).epsilon(1e-6));
+        REQUIRE(clock.last_step().count() == Approx(1.0 / 60.0));
+
+        // and reset goes back to the start
+        clock.reset(mode, std::chrono::duration<double>(0.5));
+        REQUIRE(clock.now() == NUClear::clock::time_point());
+        clock.advance();
+        REQUIRE(std::chrono::duration<double>(clock.now().time_since_epoch()).count() == Approx(0.5));
+    }
+}
+
+TEST_CASE("Realtime and max speed clocks never wait", "[SimulationClock]") {
+
+    SimulationClock realtime(ClockMode::REALTIME, std::chrono::duration<double>(0.0));
+    const auto before = NUClear::clock::now();
+    realtime.advance();
+    REQUIRE(realtime.wait(NO_WAIT));
+    REQUIRE(realtime.now() >= before);
+    REQUIRE(realtime.last_step().count() >= 0.0);
+
+    SimulationClock fast(ClockMode::MAX_SPEED, std::chrono::duration<double>(0.01));
+    fast.advance();
+    REQUIRE(fast.wait(NO_WAIT));
+    fast.expect(3);
+    REQUIRE(fast.wait(NO_WAIT));
+}
+
+TEST_CASE("Lockstep waits for an acknowledgement of every image of the current frame", "[SimulationClock]") {
+
+    SimulationClock clock(ClockMode::LOCKSTEP, std::chrono::duration<double>(0.01));
+
+    // nothing has been rendered yet
+    REQUIRE(clock.wait(NO_WAIT));
+
+    const auto first = clock.now() + std::chrono::duration_cast<NUClear::clock::duration>(std::chrono::duration<double>(0.01));
+    clock.advance();
+    REQUIRE(clock.now() == first);
+
+    // acknowledgements that arrive before the images are counted are kept
+    clock.acknowledge(first);
+    REQUIRE(!clock.wait(TIMEOUT));
+
+    // two worlds with two cameras each
+    clock.expect(4);
+    REQUIRE(!clock.wait(NO_WAIT));
+
+    // a late acknowledgement of an older frame doesn't count
+    clock.acknowledge(NUClear::clock::time_point());
+    clock.acknowledge(first);
+    clock.acknowledge(first);
+    REQUIRE(!clock.wait(TIMEOUT));
+
+    clock.acknowledge(first);
+    REQUIRE(clock.wait(NO_WAIT));
+
+    // the next frame starts counting again
+    clock.advance();
+    clock.expect(1);
+    clock.acknowledge(first);
+    REQUIRE(!clock.wait(NO_WAIT));
+    clock.acknowledge(clock.now());
+    REQUIRE(clock.wait(NO_WAIT));
+
+    // a frame with no images has nothing to wait for
+    clock.advance();
+    clock.expect(0);
+    REQUIRE(clock.wait(NO_WAIT));
+}
+
+TEST_CASE("Lockstep is released by acknowledgements from other threads", "[SimulationClock]") {
+
+    SimulationClock clock(ClockMode::LOCKSTEP, std::chrono::duration<double>(0.01));
+
+    for (int frame = 0; frame < 50; ++frame) {
+        clock.advance();
+        const NUClear::clock::time_point timestamp = clock.now();
+
+        std::vector<std::thread> consumers;
+        for (int i = 0; i < 3; ++i) {
+            consumers.emplace_back([&clock, timestamp] { clock.acknowledge(timestamp); });
+        }
+        clock.expect(3);
+
+        REQUIRE(clock.wait(std::chrono::milliseconds(5000)));
+        for (auto& consumer : consumers) {
+            consumer.join();
+        }
+    }
+}
+
+TEST_CASE("Lockstep gives up waiting after the timeout", "[SimulationClock]") {
+
+    SimulationClock clock(ClockMode::LOCKSTEP, std::chrono::duration<double>(0.01));
+    clock.advance();
+    clock.expect(1);
+
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(!clock.wait(TIMEOUT));
+    REQUIRE(std::chrono::steady_clock::now() - start >= TIMEOUT);
+
+    // the frame is still waiting, so the render loop tries again next time round
+    REQUIRE(!clock.wait(NO_WAIT));
+    clock.acknowledge(clock.now());
+    REQUIRE(clock.wait(NO_WAIT));
+}
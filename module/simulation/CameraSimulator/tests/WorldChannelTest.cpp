@@ -0,0 +1,217 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <memory>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "message/input/Image.h"
+
+#include "../src/WorldChannel.h"
+
+using message::input::Image;
+using message::input::ImageFormat;
+using message::simulation::GroundTruth;
+using message::simulation::KickBall;
+using message::simulation::LabelImage;
+using message::simulation::RobotVelocity;
+using module::simulation::WorldChannel;
+
+namespace {
+
+    // The two ends of a fresh connection
+    void connect(std::unique_ptr<WorldChannel>& a, std::unique_ptr<WorldChannel>& b) {
+        int fds[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        a = std::make_unique<WorldChannel>(fds[0]);
+        b = std::make_unique<WorldChannel>(fds[1]);
+    }
+
+    NUClear::clock::time_point at(int64_t ms) {
+        return NUClear::clock::time_point(std::chrono::milliseconds(ms));
+    }
+}
+
+TEST_CASE("Images cross a world channel whole, far larger than the socket buffer", "[WorldChannel]") {
+
+    std::unique_ptr<WorldChannel> world;
+    std::unique_ptr<WorldChannel> simulator;
+    connect(world, simulator);
+
+    const unsigned int width = 1280;
+    const unsigned int height = 960;
+    std::vector<uint8_t> pixels(width * height * 2);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = uint8_t(i * 7 + i / 4096);
+    }
+    const std::vector<uint8_t> expected = pixels;
+
+    Image image(width, height, at(1234), std::move(pixels), ImageFormat::YUYV);
+    image.camera_id = 2;
+    image.world_id = 5;
+    image.sequence = 99;
+
+    // the receiver has to drain the socket while the image is still being sent
+    bool sent = false;
+    std::thread sender([&] {
+        sent = world->send(image) && world->send(image);
+    });
+
+    for (int i = 0; i < 2; ++i) {
+        WorldChannel::Message message;
+        REQUIRE(simulator->receive(message));
+        REQUIRE(message.kind == WorldChannel::Kind::IMAGE);
+        REQUIRE(message.image->width == width);
+        REQUIRE(message.image->height == height);
+        REQUIRE(message.image->format == ImageFormat::YUYV);
+        REQUIRE(message.image->timestamp == at(1234));
+        REQUIRE(message.image->camera_id == 2);
+        REQUIRE(message.image->world_id == 5);
+        // the sequence is the receiver's to give
+        REQUIRE(message.image->sequence == 0);
+        REQUIRE(message.image->source() == expected);
+    }
+    sender.join();
+    REQUIRE(sent);
+}
+
+TEST_CASE("Labels, ground truth and manifest rows cross a world channel", "[WorldChannel]") {
+
+    std::unique_ptr<WorldChannel> world;
+    std::unique_ptr<WorldChannel> simulator;
+    connect(world, simulator);
+
+    LabelImage labels;
+    labels.width = 4;
+    labels.height = 3;
+    labels.scale = 2;
+    labels.timestamp = at(10);
+    labels.camera_id = 1;
+    labels.world_id = 3;
+    labels.labels = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+    GroundTruth truth;
+    truth.timestamp = at(20);
+    truth.camera_id = 1;
+    truth.world_id = 3;
+    truth.width = 640;
+    truth.height = 480;
+    truth.ball = { 100.5f, 200.25f, 12.0f, 8.0f, true, false };
+    truth.features.push_back({ GroundTruth::FeatureType::GOAL_POST_TOP, 4, 1.0f, 2.0f, 3.0f, true, true });
+    truth.features.push_back({ GroundTruth::FeatureType::CENTRE_MARK, 0, 5.0f, 6.0f, 7.0f, false, false });
+    truth.robots.push_back({ 7, 10.0f, 20.0f, 30.0f, 40.0f, 9.0f, true, false });
+
+    REQUIRE(world->send(labels));
+    REQUIRE(world->send(truth));
+    REQUIRE(world->send_manifest_row("3,0,3,20000000,0.5\n"));
+
+    WorldChannel::Message message;
+    REQUIRE(simulator->receive(message));
+    REQUIRE(message.kind == WorldChannel::Kind::LABELS);
+    REQUIRE(message.labels->width == 4);
+    REQUIRE(message.labels->height == 3);
+    REQUIRE(message.labels->scale == 2);
+    REQUIRE(message.labels->timestamp == at(10));
+    REQUIRE(message.labels->camera_id == 1);
+    REQUIRE(message.labels->world_id == 3);
+    REQUIRE(message.labels->labels == labels.labels);
+
+    REQUIRE(simulator->receive(message));
+    REQUIRE(message.kind == WorldChannel::Kind::GROUND_TRUTH);
+    const GroundTruth& received = *message.ground_truth;
+    REQUIRE(received.timestamp == at(20));
+    REQUIRE(received.width == 640);
+    REQUIRE(received.ball.x == 100.5f);
+    REQUIRE(received.ball.in_image);
+    REQUIRE(received.features.size() == 2);
+    REQUIRE(received.features[0].type == GroundTruth::FeatureType::GOAL_POST_TOP);
+    REQUIRE(received.features[0].occluded);
+    REQUIRE(received.features[1].x == 5.0f);
+    REQUIRE(received.robots.size() == 1);
+    REQUIRE(received.robots[0].id == 7);
+    REQUIRE(received.robots[0].y_max == 40.0f);
+
+    REQUIRE(simulator->receive(message));
+    REQUIRE(message.kind == WorldChannel::Kind::MANIFEST_ROW);
+    REQUIRE(message.manifest_row == "3,0,3,20000000,0.5\n");
+}
+
+TEST_CASE("Kicks and robot velocities go the other way", "[WorldChannel]") {
+
+    std::unique_ptr<WorldChannel> world;
+    std::unique_ptr<WorldChannel> simulator;
+    connect(world, simulator);
+
+    REQUIRE(simulator->send(KickBall { 2, { 1.0f, 2.0f, 3.0f } }));
+    REQUIRE(simulator->send(RobotVelocity { 2, 1, { 0.5f, -0.5f } }));
+
+    WorldChannel::Message message;
+    REQUIRE(world->receive(message));
+    REQUIRE(message.kind == WorldChannel::Kind::KICK);
+    REQUIRE(message.kick.world_id == 2);
+    REQUIRE(message.kick.velocity[2] == 3.0f);
+
+    REQUIRE(world->receive(message));
+    REQUIRE(message.kind == WorldChannel::Kind::VELOCITY);
+    REQUIRE(message.velocity.robot == 1);
+    REQUIRE(message.velocity.velocity[1] == -0.5f);
+}
+
+TEST_CASE("A world channel ends when either side goes or shuts it down", "[WorldChannel]") {
+
+    std::unique_ptr<WorldChannel> world;
+    std::unique_ptr<WorldChannel> simulator;
+    connect(world, simulator);
+
+    // shutting down wakes a receive that is already waiting
+    bool received = true;
+    std::thread receiver([&] {
+        WorldChannel::Message message;
+        received = simulator->receive(message);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    simulator->shutdown();
+    receiver.join();
+    REQUIRE(!received);
+
+    // and the other end sees the stream close rather than a signal
+    WorldChannel::Message message;
+    REQUIRE(!world->receive(message));
+    world.reset();
+    REQUIRE(!simulator->send(KickBall { 0, { 0.0f, 0.0f, 0.0f } }));
+}
+
+TEST_CASE("A world channel refuses bytes that aren't a message", "[WorldChannel]") {
+
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    WorldChannel simulator(fds[0]);
+
+    const char garbage[] = "this is not a message from a world";
+    REQUIRE(write(fds[1], garbage, sizeof(garbage)) == sizeof(garbage));
+    close(fds[1]);
+
+    WorldChannel::Message message;
+    REQUIRE(!simulator.receive(message));
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+#include "../src/WorldProcesses.h"
+
+using module::simulation::WorldChannel;
+using module::simulation::WorldProcesses;
+
+namespace {
+
+    const char* const CONFIG = R"(
+worlds: 3
+world_processes: { enabled: true }
+dataset: { directory: /tmp/dataset }
+record: /tmp/frames.log
+clock: { mode: max_speed }
+scenarios:
+  - { frames: 10 }
+  - { id: 40, frames: 20 }
+  - { frames: 30 }
+  - { frames: 40 }
+  - { frames: 50 }
+)";
+
+    // Reads the world's index and channel from its configuration and sends the index back as a manifest row,
+    // framed by hand: "WLDC", kind 3 and a one byte size, native (little) endian
+    const char* const REPORT_INDEX =
+        "fd=$(sed -n 's/^ *channel: //p' \"$CAMERA_SIMULATOR_CONFIG\");"
+        "index=$(sed -n 's/^ *index: //p' \"$CAMERA_SIMULATOR_CONFIG\");"
+        "printf 'WLDC\\003\\000\\000\\000\\001\\000\\000\\000\\000\\000\\000\\000%s' \"$index\" >&$fd";
+}
+
+TEST_CASE("Each world process is configured with one world and its share of the scenarios", "[WorldProcesses]") {
+
+    const YAML::Node config = YAML::Load(CONFIG);
+
+    for (size_t index = 0; index < 3; ++index) {
+        YAML::Node world = WorldProcesses::world_config(config, index, 3, 10 + index);
+
+        REQUIRE(world["worlds"].as<size_t>() == 1);
+        REQUIRE(!world["world_processes"]);
+        REQUIRE(!world["dataset"]);
+        REQUIRE(!world["record"]);
+        REQUIRE(world["clock"]["mode"].as<std::string>() == "max_speed");
+
+        REQUIRE(world["world_process"]["index"].as<size_t>() == index);
+        REQUIRE(world["world_process"]["count"].as<size_t>() == 3);
+        REQUIRE(world["world_process"]["channel"].as<int>() == int(10 + index));
+
+        // every third scenario from its index, with the ids they had in the full list
+        std::vector<unsigned int> ids;
+        for (const auto& scenario : world["scenarios"]) {
+            ids.push_back(scenario["id"].as<unsigned int>());
+        }
+        const std::vector<std::vector<unsigned int>> expected = { { 0, 3 }, { 40, 4 }, { 2 } };
+        REQUIRE(ids == expected[index]);
+    }
+
+    // the original is left alone
+    REQUIRE(config["dataset"]);
+    REQUIRE(config["scenarios"].size() == 5);
+    REQUIRE(!config["scenarios"][0]["id"]);
+}
+
+TEST_CASE("World processes run the command with their own configuration and channel", "[WorldProcesses]") {
+
+    const YAML::Node config = YAML::Load(CONFIG);
+    WorldProcesses processes({ "/bin/sh", "-c", REPORT_INDEX }, config, 3);
+    REQUIRE(processes.size() == 3);
+
+    for (size_t i = 0; i < processes.size(); ++i) {
+        WorldChannel::Message message;
+        REQUIRE(processes.channel(i).receive(message));
+        REQUIRE(message.kind == WorldChannel::Kind::MANIFEST_ROW);
+        REQUIRE(message.manifest_row == std::to_string(i));
+
+        // then the world exits, which closes its end
+        REQUIRE(!processes.channel(i).receive(message));
+    }
+}
+
+TEST_CASE("The simulator's own command runs this program again", "[WorldProcesses]") {
+
+    std::vector<std::string> command = WorldProcesses::own_command();
+    REQUIRE(!command.empty());
+    REQUIRE(command.front() == "/proc/self/exe");
+}
@@ -0,0 +1,262 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include <catch.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "message/input/Image.h"
+
+#include "../src/YUYVConverter.h"
+
+using message::input::Image;
+using module::simulation::ConversionKernel;
+using module::simulation::PixelLayout;
+using module::simulation::PixelSource;
+using module::simulation::YUYVConverter;
+
+namespace {
+
+    const PixelLayout LAYOUTS[] = { PixelLayout::BGRX, PixelLayout::RGBX, PixelLayout::BGR, PixelLayout::RGB };
+    const ConversionKernel KERNELS[] = { ConversionKernel::SCALAR, ConversionKernel::SSE2, ConversionKernel::AVX2 };
+
+    // Random rows of pixels, any padding at the end of each row must never be read into the output
+    std::vector<uint8_t> random_pixels(unsigned int height, size_t stride) {
+        std::vector<uint8_t> data(stride * height);
+        for (auto& byte : data) {
+            byte = std::rand();
+        }
+        return data;
+    }
+
+    void write_rgb(uint8_t* p, PixelLayout layout, int r, int g, int b) {
+        const bool red_first = layout == PixelLayout::RGBX || layout == PixelLayout::RGB;
+        p[0] = red_first ? r : b;
+        p[1] = g;
+        p[2] = red_first ? b : r;
+        if (YUYVConverter::bytes_per_pixel(layout) == 4) {
+            p[3] = 0xFF;
+        }
+    }
+
+    void read_rgb(const uint8_t* p, PixelLayout layout, int& r, int& g, int& b) {
+        const bool red_first = layout == PixelLayout::RGBX || layout == PixelLayout::RGB;
+        r = red_first ? p[0] : p[2];
+        g = p[1];
+        b = red_first ? p[2] : p[0];
+    }
+
+    std::vector<uint8_t> convert(ConversionKernel kernel, const PixelSource& source) {
+        std::vector<uint8_t> yuyv(source.width * source.height * 2);
+        YUYVConverter(kernel).convert(source, yuyv.data());
+        return yuyv;
+    }
+}
+
+TEST_CASE("YUYV conversion of known colours matches the golden values", "[YUYVConverter]") {
+
+    // RGB of each pixel pair and the Y0 Cb Y1 Cr they must come out as
+    struct Golden {
+        int rgb0[3];
+        int rgb1[3];
+        uint8_t yuyv[4];
+    };
+
+    const Golden golden[] = {
+        { { 255, 255, 255 }, { 255, 255, 255 }, { 255, 128, 255, 128 } },
+        { {   0,   0,   0 }, {   0,   0,   0 }, {   0, 128,   0, 128 } },
+        { { 255,   0,   0 }, { 255,   0,   0 }, {  76,  85,  76, 255 } },
+        { {   0, 255,   0 }, {   0, 255,   0 }, { 150,  44, 150,  21 } },
+        { {   0,   0, 255 }, {   0,   0, 255 }, {  29, 255,  29, 107 } },
+        { { 128, 128, 128 }, { 128, 128, 128 }, { 128, 128, 128, 128 } },
+        { { 255,   0,   0 }, {   0,   0, 255 }, {  76, 170,  29, 181 } },
+        { {  12, 200,  99 }, { 250,   3,  77 }, { 132, 116,  85, 144 } },
+    };
+    const unsigned int pairs = sizeof(golden) / sizeof(golden[0]);
+
+    // repeat the pattern so the SIMD kernels see it in every lane and the scalar tail sees it too
+    const unsigned int repeats = 5;
+    const unsigned int width = pairs * 2 * repeats;
+
+    for (auto layout : LAYOUTS) {
+        const size_t pixel_bytes = YUYVConverter::bytes_per_pixel(layout);
+        std::vector<uint8_t> pixels(width * pixel_bytes);
+        for (unsigned int x = 0; x < width; x += 2) {
+            const Golden& g = golden[(x / 2) % pairs];
+            write_rgb(&pixels[x * pixel_bytes], layout, g.rgb0[0], g.rgb0[1], g.rgb0[2]);
+            write_rgb(&pixels[(x + 1) * pixel_bytes], layout, g.rgb1[0], g.rgb1[1], g.rgb1[2]);
+        }
+
+        PixelSource source = { pixels.data(), width, 1, width * pixel_bytes, layout };
+
+        for (auto kernel : KERNELS) {
+            if (!YUYVConverter::is_supported(kernel)) {
+                continue;
+            }
+
+            INFO("kernel " << int(kernel) << " layout " << int(layout));
+            const std::vector<uint8_t> yuyv = convert(kernel, source);
+            for (unsigned int x = 0; x < width; x += 2) {
+                const Golden& g = golden[(x / 2) % pairs];
+                for (int i = 0; i < 4; ++i) {
+                    REQUIRE(int(yuyv[x * 2 + i]) == int(g.yuyv[i]));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Saturated primaries convert to the same in range bytes in every kernel", "[YUYVConverter]") {
+
+    // Y0 Cb Y1 Cr of each colour, saturated chroma comes to exactly half a level outside [0, 255] before rounding
+    struct Primary {
+        int rgb[3];
+        uint8_t yuyv[4];
+    };
+
+    const Primary primaries[] = {
+        { { 255,   0,   0 }, {  76,  85,  76, 255 } },
+        { {   0, 255,   0 }, { 150,  44, 150,  21 } },
+        { {   0,   0, 255 }, {  29, 255,  29, 107 } },
+        { { 255, 255,   0 }, { 226,   0, 226, 149 } },
+        { {   0, 255, 255 }, { 179, 171, 179,   0 } },
+        { { 255,   0, 255 }, { 105, 212, 105, 235 } },
+        { { 255, 255, 255 }, { 255, 128, 255, 128 } },
+        { {   0,   0,   0 }, {   0, 128,   0, 128 } },
+    };
+
+    // wide enough for the main loop of every SIMD kernel as well as the scalar tail
+    const unsigned int width = 38;
+
+    for (auto layout : LAYOUTS) {
+        for (const auto& primary : primaries) {
+            const size_t pixel_bytes = YUYVConverter::bytes_per_pixel(layout);
+            std::vector<uint8_t> pixels(width * pixel_bytes);
+            for (unsigned int x = 0; x < width; ++x) {
+                write_rgb(&pixels[x * pixel_bytes], layout, primary.rgb[0], primary.rgb[1], primary.rgb[2]);
+            }
+
+            PixelSource source = { pixels.data(), width, 1, width * pixel_bytes, layout };
+
+            const std::vector<uint8_t> expected = convert(ConversionKernel::SCALAR, source);
+            for (unsigned int i = 0; i < expected.size(); ++i) {
+                INFO("layout " << int(layout) << " byte " << i);
+                REQUIRE(int(expected[i]) == int(primary.yuyv[i % 4]));
+            }
+
+            for (auto kernel : KERNELS) {
+                if (!YUYVConverter::is_supported(kernel)) {
+                    continue;
+                }
+
+                INFO("kernel " << int(kernel) << " layout " << int(layout));
+                REQUIRE(convert(kernel, source) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("YUYV conversion is within a level of floating point BT.601", "[YUYVConverter]") {
+
+    const unsigned int width = 130;
+    const unsigned int height = 9;
+
+    for (auto layout : LAYOUTS) {
+        const size_t pixel_bytes = YUYVConverter::bytes_per_pixel(layout);
+        const size_t stride = width * pixel_bytes + 12;
+        const std::vector<uint8_t> pixels = random_pixels(height, stride);
+        PixelSource source = { pixels.data(), width, height, stride, layout };
+
+        const std::vector<uint8_t> yuyv = convert(ConversionKernel::SCALAR, source);
+
+        for (unsigned int y = 0; y < height; ++y) {
+            for (unsigned int x = 0; x < width; x += 2) {
+                int r0, g0, b0, r1, g1, b1;
+                read_rgb(&pixels[y * stride + x * pixel_bytes], layout, r0, g0, b0);
+                read_rgb(&pixels[y * stride + (x + 1) * pixel_bytes], layout, r1, g1, b1);
+
+                const double r = (r0 + r1) * 0.5;
+                const double g = (g0 + g1) * 0.5;
+                const double b = (b0 + b1) * 0.5;
+
+                const uint8_t* out = &yuyv[(y * width + x) * 2];
+                REQUIRE(std::abs(out[0] - (0.299 * r0 + 0.587 * g0 + 0.114 * b0)) <= 1.0);
+                REQUIRE(std::abs(out[1] - (128.0 - 0.168736 * r - 0.331264 * g + 0.5 * b)) <= 1.0);
+                REQUIRE(std::abs(out[2] - (0.299 * r1 + 0.587 * g1 + 0.114 * b1)) <= 1.0);
+                REQUIRE(std::abs(out[3] - (128.0 + 0.5 * r - 0.418688 * g - 0.081312 * b)) <= 1.0);
+            }
+        }
+    }
+}
+
+TEST_CASE("Every YUYV kernel matches the scalar kernel for any width, stride and row split", "[YUYVConverter]") {
+
+    for (auto layout : LAYOUTS) {
+        for (unsigned int width = 2; width <= 74; width += 2) {
+            const unsigned int height = 3;
+            const size_t stride = width * YUYVConverter::bytes_per_pixel(layout) + (width % 7);
+            const std::vector<uint8_t> pixels = random_pixels(height, stride);
+            PixelSource source = { pixels.data(), width, height, stride, layout };
+
+            const std::vector<uint8_t> expected = convert(ConversionKernel::SCALAR, source);
+
+            for (auto kernel : KERNELS) {
+                if (!YUYVConverter::is_supported(kernel)) {
+                    continue;
+                }
+
+                INFO("kernel " << int(kernel) << " layout " << int(layout) << " width " << width);
+                REQUIRE(convert(kernel, source) == expected);
+
+                // converting the rows separately gives the same frame
+                std::vector<uint8_t> split(expected.size());
+                YUYVConverter converter(kernel);
+                for (unsigned int row = height; row-- > 0;) {
+                    converter.convert_rows(source, split.data(), row, row + 1);
+                }
+                REQUIRE(split == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Converted frames read back through Image with the YUYV layout", "[YUYVConverter][Image]") {
+
+    // red then blue: both share the pair's chroma, each has its own luma
+    std::vector<uint8_t> pixels = { 255, 0, 0, 0, 0, 255, 0, 255, 0, 255, 255, 255 };
+    PixelSource source = { pixels.data(), 2, 2, 6, PixelLayout::RGB };
+
+    std::vector<uint8_t> yuyv(2 * 2 * 2);
+    YUYVConverter().convert(source, yuyv.data());
+
+    const Image image(2, 2, NUClear::clock::now(), std::move(yuyv));
+
+    REQUIRE(int(image(0, 0).y) == 76);
+    REQUIRE(int(image(1, 0).y) == 29);
+    REQUIRE(int(image(0, 0).cb) == 170);
+    REQUIRE(int(image(1, 0).cb) == 170);
+    REQUIRE(int(image(0, 0).cr) == 181);
+    REQUIRE(int(image(1, 0).cr) == 181);
+
+    // green then white on the second row
+    REQUIRE(int(image(0, 1).y) == 150);
+    REQUIRE(int(image(1, 1).y) == 255);
+}
@@ -43,6 +43,29 @@ FUNCTION(NUCLEAR_MODULE)
 
     ENDFOREACH(data_file)
 
+    # Get our configuration files
+    FILE(GLOB_RECURSE config_files "${CMAKE_CURRENT_SOURCE_DIR}/config/**")
+
+    # Process the configuration files
+    FOREACH(config_file ${config_files})
+
+        # Calculate the Output Directory
+        FILE(RELATIVE_PATH output_file "${CMAKE_CURRENT_SOURCE_DIR}/config" ${config_file})
+        SET(output_file "${CMAKE_BINARY_DIR}/config/${output_file}")
+
+        # Add the file we will generate to our output
+        LIST(APPEND data "${output_file}")
+
+        # Copy configuration files over as needed
+        ADD_CUSTOM_COMMAND(
+            OUTPUT ${output_file}
+            COMMAND ${CMAKE_COMMAND} -E copy ${config_file} ${output_file}
+            DEPENDS ${config_file}
+            COMMENT "Copying updated configuration file ${config_file}"
+        )
+
+    ENDFOREACH(config_file)
+
     # Include our own source and binary directories
     INCLUDE_DIRECTORIES(${CMAKE_CURRENT_SOURCE_DIR}/src)
     INCLUDE_DIRECTORIES(${CMAKE_CURRENT_BINARY_DIR}/src)
@@ -18,19 +18,65 @@
  */
 
 #include "Image.h"
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <mutex>
 
 namespace message {
     namespace input {
 
-        Image::Image(uint width, uint height, NUClear::clock::time_point timestamp, std::vector<uint8_t>&& data)
+        // One slot per format, each filled at most once however many threads ask for it at the same time
+        struct Image::ConversionCache {
+            std::array<std::once_flag, IMAGE_FORMAT_COUNT> once;
+            std::array<std::vector<uint8_t>, IMAGE_FORMAT_COUNT> data;
+        };
+
+        Image::Image(uint width, uint height, NUClear::clock::time_point timestamp, std::vector<uint8_t>&& data, ImageFormat format)
             : width(width)
             , height(height)
             , timestamp(timestamp)
-            , data(std::move(data)) {
+            , format(format)
+            , data(std::move(data))
+            , cache(std::make_shared<ConversionCache>()) {
+        }
+
+        Image::Image(uint width, uint height, NUClear::clock::time_point timestamp, ImageBuffer&& data, ImageFormat format)
+            : width(width)
+            , height(height)
+            , timestamp(timestamp)
+            , format(format)
+            , data(std::move(data))
+            , cache(std::make_shared<ConversionCache>()) {
+        }
+
+        const std::vector<uint8_t>& Image::as(ImageFormat format) const {
+            if (format == this->format && !data.borrowed()) {
+                return data.bytes();
+            }
+
+            // Borrowed pixels are only copied into a vector when someone asks for one
+            const size_t slot = size_t(format);
+            std::call_once(cache->once[slot], [&] {
+                std::vector<uint8_t> converted(image_size(format, width, height));
+                if (format == this->format) {
+                    std::memcpy(converted.data(), data.data(), converted.size());
+                }
+                else {
+                    convert_image(this->format, data.data(), format, converted.data(), width, height);
+                }
+                cache->data[slot] = std::move(converted);
+            });
+
+            return cache->data[slot];
+        }
+
+        const uint8_t* Image::yuyv() const {
+            return format == ImageFormat::YUYV ? data.data() : as(ImageFormat::YUYV).data();
         }
 
         Image::Pixel Image::operator()(uint x, uint y) const {
+            const uint8_t* data = yuyv();
             int origin = (y * width + x) * 2;
             int shift = (x % 2) * 2;
 
@@ -46,8 +92,75 @@ namespace message {
         }
 
 
+        Image::Subsampled::Subsampled(const uint8_t* data, uint stride, uint x, uint y, uint width, uint height, uint step_x, uint step_y)
+            : data(data)
+            , stride(stride)
+            , x(x)
+            , y(y)
+            , width(width)
+            , height(height)
+            , step_x(std::max(step_x, 1u))
+            , step_y(std::max(step_y, 1u)) {
+        }
+
+        Image::Subsampled::iterator Image::Subsampled::begin() const {
+            if (width == 0 || height == 0) {
+                return end();
+            }
+            return iterator(data, stride, x, x + width, step_x, step_y, x, y);
+        }
+
+        Image::Subsampled::iterator Image::Subsampled::end() const {
+            // The first row on the step grid past the bottom
+            const uint rows = (height + step_y - 1) / step_y;
+            return iterator(data, stride, x, x + width, step_x, step_y, x, y + rows * step_y);
+        }
+
+        Image::Tile::Tile(const uint8_t* data, uint stride, uint x, uint y, uint width, uint height)
+            : x(x)
+            , y(y)
+            , width(width)
+            , height(height)
+            , data(data)
+            , stride(stride) {
+        }
+
+        Image::Subsampled Image::Tile::subsample(uint step_x, uint step_y) const {
+            return Subsampled(data, stride, x, y, width, height, step_x, step_y);
+        }
+
+        Image::Row Image::row(uint y) const {
+            return Row(yuyv() + size_t(y) * width * 2, width);
+        }
+
+        Image::Tile Image::tile(uint x, uint y, uint width, uint height) const {
+            return Tile(yuyv(), this->width, x, y, width, height);
+        }
+
+        Image::Subsampled Image::subsample(uint step_x, uint step_y) const {
+            return Subsampled(yuyv(), width, 0, 0, width, height, step_x, step_y);
+        }
+
+        void Image::to_planar(uint8_t* y, uint8_t* cb, uint8_t* cr) const {
+            // Rows are contiguous and even width, so the whole image is one run of pixel pairs
+            yuyv_to_planar(yuyv(), size_t(width) * height, y, cb, cr);
+        }
+
+        void Image::to_rgb(uint8_t* rgb) const {
+            if (format == ImageFormat::RGB24) {
+                std::memcpy(rgb, data.data(), size_t(width) * height * 3);
+            }
+            else {
+                yuyv_to_rgb(yuyv(), size_t(width) * height, rgb);
+            }
+        }
+
         const std::vector<uint8_t>& Image::source() const {
-            return data;
+            return as(format);
+        }
+
+        const uint8_t* Image::pixels() const {
+            return data.data();
         }
 
     }  // input
@@ -24,13 +24,21 @@
 #include <armadillo>
 #include <cstdint>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
+#include "ImageBufferPool.h"
+#include "ImageFormat.h"
+
 namespace message {
     namespace input {
 
         /**
-         * TODO document
+         * A camera image in any ImageFormat.
+         *
+         * The pixel accessors and views all work in YCbCr. For images that are not YUYV they read a YUYV copy,
+         * which like any conversion asked for with as() is made once on first use and shared by everyone
+         * holding the image.
          *
          * @author Michael Burton
          */
@@ -42,20 +50,173 @@ namespace message {
                 uint8_t cr;
             };
 
-            Image(uint width, uint height, NUClear::clock::time_point, std::vector<uint8_t>&& data);
+            /**
+             * One row of the image. Walking a row avoids recomputing the row offset for every pixel and data()
+             * gives the raw YUYV bytes (two per pixel) for code that wants to process them itself.
+             * Only valid while the image is.
+             */
+            class Row {
+            public:
+                /// @brief A view of width pixels starting at pixel first of the row whose pixel 0 is at data
+                Row(const uint8_t* data, uint width, uint first = 0) : bytes(data), length(width), first(first) {}
+
+                Pixel operator[](uint x) const {
+                    x += first;
+                    const uint8_t* pair = bytes + (x & ~1u) * 2;
+                    return { pair[(x & 1) * 2], pair[1], pair[3] };
+                }
+
+                uint8_t y(uint x) const {
+                    return bytes[(x + first) * 2];
+                }
+
+                /// @brief The YUYV bytes of the first pixel, which starts half way through a pair when first is odd
+                const uint8_t* data() const {
+                    return bytes + first * 2;
+                }
+
+                uint size() const {
+                    return length;
+                }
+
+            private:
+                const uint8_t* bytes;
+                uint length;
+                uint first;
+            };
+
+            /**
+             * Every step_x'th pixel of every step_y'th row of a rectangle, in row major order.
+             *
+             *     for (auto it = image.subsample(4, 4).begin(); it != end; ++it) classify(it.x(), it.y(), *it);
+             */
+            class Subsampled {
+            public:
+                class iterator {
+                public:
+                    iterator(const uint8_t* data, uint stride, uint x0, uint x_end, uint step_x, uint step_y, uint x, uint y)
+                        : data(data), stride(stride), x0(x0), x_end(x_end), step_x(step_x), step_y(step_y), px(x), py(y) {}
+
+                    Pixel operator*() const {
+                        return Row(data + size_t(py) * stride * 2, stride)[px];
+                    }
+
+                    iterator& operator++() {
+                        px += step_x;
+                        if (px >= x_end) {
+                            px = x0;
+                            py += step_y;
+                        }
+                        return *this;
+                    }
+
+                    bool operator==(const iterator& other) const {
+                        return px == other.px && py == other.py;
+                    }
+
+                    bool operator!=(const iterator& other) const {
+                        return !(*this == other);
+                    }
+
+                    uint x() const {
+                        return px;
+                    }
+
+                    uint y() const {
+                        return py;
+                    }
+
+                private:
+                    const uint8_t* data;
+                    uint stride;
+                    uint x0, x_end;
+                    uint step_x, step_y;
+                    uint px, py;
+                };
+
+                Subsampled(const uint8_t* data, uint stride, uint x, uint y, uint width, uint height, uint step_x, uint step_y);
+
+                iterator begin() const;
+                iterator end() const;
+
+            private:
+                const uint8_t* data;
+                uint stride;
+                uint x, y;
+                uint width, height;
+                uint step_x, step_y;
+            };
+
+            /// A rectangular window of the image, with coordinates relative to its top left corner
+            class Tile {
+            public:
+                Tile(const uint8_t* data, uint stride, uint x, uint y, uint width, uint height);
+
+                Pixel operator()(uint x, uint y) const {
+                    return row(y)[x];
+                }
+
+                Row row(uint y) const {
+                    return Row(data + size_t(this->y + y) * stride * 2, width, this->x);
+                }
+
+                Subsampled subsample(uint step_x, uint step_y) const;
+
+                uint x;
+                uint y;
+                uint width;
+                uint height;
+
+            private:
+                const uint8_t* data;
+                uint stride;
+            };
+
+            Image(uint width, uint height, NUClear::clock::time_point, std::vector<uint8_t>&& data, ImageFormat format = ImageFormat::YUYV);
+            // Takes a buffer from an ImageBufferPool, which is returned to the pool when this image is destroyed,
+            // or one borrowing memory that stays alive as long as the image
+            Image(uint width, uint height, NUClear::clock::time_point, ImageBuffer&& data, ImageFormat format = ImageFormat::YUYV);
 
             Pixel operator()(uint x, uint y) const;
             Pixel operator()(const arma::ivec2& p) const;
 
+            Row row(uint y) const;
+            Tile tile(uint x, uint y, uint width, uint height) const;
+            Subsampled subsample(uint step_x, uint step_y) const;
+
+            /// @brief Writes a width x height luma plane and width / 2 x height Cb and Cr planes
+            void to_planar(uint8_t* y, uint8_t* cb, uint8_t* cr) const;
+            /// @brief Writes width x height packed RGB, the inverse of the full range BT.601 the camera encodes
+            void to_rgb(uint8_t* rgb) const;
+
             uint width;
             uint height;
             NUClear::clock::time_point timestamp;
+            /// The format of source()
+            ImageFormat format;
+            /// Which camera took this image, for sources with more than one camera
+            uint camera_id = 0;
+            /// Which simulated world it came from, when a simulator runs more than one
+            uint world_id = 0;
+            /// Counts the images the source has emitted, so images lost on the way show up as gaps
+            uint64_t sequence = 0;
 
             // Returns the raw data that this is using
             const std::vector<uint8_t>& source() const;
+            /// @brief The same bytes as source(), without copying them out of borrowed memory
+            const uint8_t* pixels() const;
+
+            /// @brief The image in another format, converted on the first call for each format and cached. Thread safe
+            const std::vector<uint8_t>& as(ImageFormat format) const;
 
         private:
-            std::vector<uint8_t> data;
+            struct ConversionCache;
+
+            const uint8_t* yuyv() const;
+
+            ImageBuffer data;
+            // Shared by copies, which hold the same pixels
+            std::shared_ptr<ConversionCache> cache;
         };
 
     }  // input
@@ -0,0 +1,183 @@
+/*
+ * This file is part of the NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUBots <nubots@nubots.net>
+ */
+
+#include "ImageBufferPool.h"
+
+namespace message {
+    namespace input {
+
+        ImageBuffer::ImageBuffer(std::vector<uint8_t>&& bytes)
+            : storage(std::move(bytes)) {
+        }
+
+        ImageBuffer::ImageBuffer(std::vector<uint8_t>&& bytes, std::weak_ptr<ImageBufferPool> pool)
+            : storage(std::move(bytes))
+            , pool(std::move(pool)) {
+        }
+
+        ImageBuffer::ImageBuffer(const uint8_t* data, size_t size, std::shared_ptr<const void> owner)
+            : owner(std::move(owner))
+            , view(data)
+            , view_size(size) {
+        }
+
+        ImageBuffer::~ImageBuffer()
+        {
+            release();
+        }
+
+        // Copies own their memory outright, only the original goes back to the pool. Borrowed memory is shared
+        ImageBuffer::ImageBuffer(const ImageBuffer& other)
+            : storage(other.storage)
+            , owner(other.owner)
+            , view(other.view)
+            , view_size(other.view_size) {
+        }
+
+        ImageBuffer& ImageBuffer::operator=(const ImageBuffer& other)
+        {
+            if (this != &other)
+            {
+                release();
+                storage = other.storage;
+                pool.reset();
+                owner = other.owner;
+                view = other.view;
+                view_size = other.view_size;
+            }
+            return *this;
+        }
+
+        ImageBuffer& ImageBuffer::operator=(ImageBuffer&& other)
+        {
+            if (this != &other)
+            {
+                release();
+                storage = std::move(other.storage);
+                pool = std::move(other.pool);
+                owner = std::move(other.owner);
+                view = other.view;
+                view_size = other.view_size;
+            }
+            return *this;
+        }
+
+        std::vector<uint8_t>& ImageBuffer::bytes()
+        {
+            return storage;
+        }
+
+        const std::vector<uint8_t>& ImageBuffer::bytes() const
+        {
+            return storage;
+        }
+
+        const uint8_t* ImageBuffer::data() const
+        {
+            return view ? view : storage.data();
+        }
+
+        size_t ImageBuffer::size() const
+        {
+            return view ? view_size : storage.size();
+        }
+
+        bool ImageBuffer::borrowed() const
+        {
+            return view != nullptr;
+        }
+
+        void ImageBuffer::release()
+        {
+            if (auto owner = pool.lock())
+            {
+                owner->release(std::move(storage));
+            }
+            pool.reset();
+        }
+
+        std::shared_ptr<ImageBufferPool> ImageBufferPool::create(size_t capacity, size_t buffer_size)
+        {
+            // The constructor is private so make_shared can't be used
+            return std::shared_ptr<ImageBufferPool>(new ImageBufferPool(capacity, buffer_size));
+        }
+
+        ImageBufferPool::ImageBufferPool(size_t capacity, size_t buffer_size)
+            : pool_capacity(capacity)
+            , size(buffer_size)
+            , exhausted_count(0) {
+
+            // Reserve up front so returning a buffer never reallocates the free list
+            free.reserve(pool_capacity);
+            for (size_t i = 0; i < pool_capacity; ++i)
+            {
+                free.emplace_back(size);
+            }
+        }
+
+        ImageBuffer ImageBufferPool::acquire()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (free.empty())
+            {
+                ++exhausted_count;
+                return ImageBuffer(std::vector<uint8_t>(size));
+            }
+
+            std::vector<uint8_t> bytes = std::move(free.back());
+            free.pop_back();
+
+            return ImageBuffer(std::move(bytes), shared_from_this());
+        }
+
+        void ImageBufferPool::release(std::vector<uint8_t>&& bytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (free.size() < pool_capacity && bytes.size() == size)
+            {
+                free.push_back(std::move(bytes));
+            }
+        }
+
+        size_t ImageBufferPool::capacity() const
+        {
+            return pool_capacity;
+        }
+
+        size_t ImageBufferPool::buffer_size() const
+        {
+            return size;
+        }
+
+        size_t ImageBufferPool::in_use() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return pool_capacity - free.size();
+        }
+
+        size_t ImageBufferPool::exhausted() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return exhausted_count;
+        }
+
+    }  // input
+}  // message
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUBots <nubots@nubots.net>
+ */
+
+#ifndef MESSAGE_INPUT_IMAGEBUFFERPOOL_H
+#define MESSAGE_INPUT_IMAGEBUFFERPOOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace message {
+    namespace input {
+
+        class ImageBufferPool;
+
+        /**
+         * Pixel storage for an Image that goes back to the pool it came from when it is destroyed.
+         *
+         * Buffers built from a plain vector, or copied from another buffer, do not belong to a pool and are
+         * simply freed.
+         *
+         * A buffer may instead borrow read only memory it does not own, such as a memory mapped recording. It
+         * keeps the memory's owner alive, copies share it rather than copying the pixels, and bytes() is empty.
+         */
+        class ImageBuffer {
+        public:
+            ImageBuffer() = default;
+            ImageBuffer(std::vector<uint8_t>&& bytes);
+            ImageBuffer(std::vector<uint8_t>&& bytes, std::weak_ptr<ImageBufferPool> pool);
+            ImageBuffer(const uint8_t* data, size_t size, std::shared_ptr<const void> owner);
+            ~ImageBuffer();
+
+            ImageBuffer(const ImageBuffer& other);
+            ImageBuffer& operator=(const ImageBuffer& other);
+            ImageBuffer(ImageBuffer&& other) = default;
+            ImageBuffer& operator=(ImageBuffer&& other);
+
+            std::vector<uint8_t>& bytes();
+            const std::vector<uint8_t>& bytes() const;
+
+            /// @brief The pixels, whether owned or borrowed
+            const uint8_t* data() const;
+            size_t size() const;
+            bool borrowed() const;
+
+        private:
+            void release();
+
+            std::vector<uint8_t> storage;
+            std::weak_ptr<ImageBufferPool> pool;
+            std::shared_ptr<const void> owner;
+            const uint8_t* view = nullptr;
+            size_t view_size = 0;
+        };
+
+        /**
+         * A fixed number of equally sized pixel buffers that are reused from frame to frame.
+         *
+         * When every buffer is still held by an Image a temporary buffer is allocated instead and the exhaustion
+         * counter is incremented. Temporary buffers are freed rather than kept once they are released, so the
+         * pool never holds more than its capacity.
+         *
+         * Buffers are returned from whichever thread drops the last reference to their Image, so the pool is
+         * thread safe and must be owned through a shared_ptr.
+         *
+         * @author NUbots
+         */
+        class ImageBufferPool : public std::enable_shared_from_this<ImageBufferPool> {
+        public:
+            static std::shared_ptr<ImageBufferPool> create(size_t capacity, size_t buffer_size);
+
+            ImageBuffer acquire();
+
+            size_t capacity() const;
+            size_t buffer_size() const;
+
+            /// @brief Number of pool buffers currently held by images
+            size_t in_use() const;
+            /// @brief Number of times acquire found no free buffer and had to allocate
+            size_t exhausted() const;
+
+        private:
+            friend class ImageBuffer;
+
+            ImageBufferPool(size_t capacity, size_t buffer_size);
+
+            void release(std::vector<uint8_t>&& bytes);
+
+            mutable std::mutex mutex;
+            std::vector<std::vector<uint8_t>> free;
+            const size_t pool_capacity;
+            const size_t size;
+            size_t exhausted_count;
+        };
+
+    }  // input
+}  // message
+
+#endif  // MESSAGE_INPUT_IMAGEBUFFERPOOL_H
@@ -0,0 +1,488 @@
+/*
+ * This file is part of the NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2013 NUBots <nubots@nubots.net>
+ */
+
+#include "ImageFormat.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define IMAGE_FORMAT_X86
+    #include <immintrin.h>
+#endif
+
+namespace message {
+    namespace input {
+
+        namespace {
+
+            // Full range BT.601 YCbCr to RGB in Q14, applied as ((c - 128) * 4 * coefficient) >> 16
+            // which is exactly what _mm_mulhi_epi16 computes, so the SIMD and scalar paths agree bit for bit
+            constexpr int R_CR = 22970;
+            constexpr int G_CB = -5638;
+            constexpr int G_CR = -11700;
+            constexpr int B_CB = 29032;
+
+            inline uint8_t clamp(int v)
+            {
+                return v < 0 ? 0 : v > 255 ? 255 : uint8_t(v);
+            }
+
+            inline int mulhi(int d, int coefficient)
+            {
+                return (d * coefficient) >> 16;
+            }
+
+            void scalar_planar(const uint8_t* src, size_t pairs, uint8_t* y, uint8_t* cb, uint8_t* cr)
+            {
+                for (size_t i = 0; i < pairs; ++i)
+                {
+                    y[i * 2 + 0] = src[i * 4 + 0];
+                    cb[i]        = src[i * 4 + 1];
+                    y[i * 2 + 1] = src[i * 4 + 2];
+                    cr[i]        = src[i * 4 + 3];
+                }
+            }
+
+            void scalar_rgb(const uint8_t* src, size_t pairs, uint8_t* rgb)
+            {
+                for (size_t i = 0; i < pairs; ++i)
+                {
+                    const uint8_t* p = src + i * 4;
+                    const int d_cb = (p[1] - 128) * 4;
+                    const int d_cr = (p[3] - 128) * 4;
+
+                    const int r = mulhi(d_cr, R_CR);
+                    const int g = mulhi(d_cb, G_CB) + mulhi(d_cr, G_CR);
+                    const int b = mulhi(d_cb, B_CB);
+
+                    for (int j = 0; j < 2; ++j)
+                    {
+                        const int luma = p[j * 2];
+                        uint8_t* out = rgb + (i * 2 + j) * 3;
+                        out[0] = clamp(luma + r);
+                        out[1] = clamp(luma + g);
+                        out[2] = clamp(luma + b);
+                    }
+                }
+            }
+
+#ifdef IMAGE_FORMAT_X86
+            // 16 pixels at a time, returns how many pairs were done
+            __attribute__((target("sse2")))
+            size_t sse2_planar(const uint8_t* src, size_t pairs, uint8_t* y, uint8_t* cb, uint8_t* cr)
+            {
+
+                const __m128i low = _mm_set1_epi16(0x00FF);
+
+                size_t i = 0;
+                for (; i + 8 <= pairs; i += 8)
+                {
+                    const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+                    const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4 + 16));
+
+                    const __m128i luma = _mm_packus_epi16(_mm_and_si128(v0, low), _mm_and_si128(v1, low));
+                    const __m128i chroma = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+                    const __m128i split = _mm_packus_epi16(_mm_and_si128(chroma, low), _mm_srli_epi16(chroma, 8));
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(y + i * 2), luma);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(cb + i), split);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(cr + i), _mm_srli_si128(split, 8));
+                }
+
+                return i;
+            }
+
+            // The R, G and B of 8 pixels from 8 YUYV bytes pairs, as 16 bit lanes
+            __attribute__((target("sse2")))
+            inline void sse2_rgb8(__m128i v, __m128i& r, __m128i& g, __m128i& b)
+            {
+
+                const __m128i luma = _mm_and_si128(v, _mm_set1_epi16(0x00FF));
+                const __m128i chroma = _mm_srli_epi16(v, 8);
+
+                // Every chroma sample belongs to both pixels of its pair
+                __m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chroma, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+                __m128i w = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chroma, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+                u = _mm_slli_epi16(_mm_sub_epi16(u, _mm_set1_epi16(128)), 2);
+                w = _mm_slli_epi16(_mm_sub_epi16(w, _mm_set1_epi16(128)), 2);
+
+                r = _mm_add_epi16(luma, _mm_mulhi_epi16(w, _mm_set1_epi16(R_CR)));
+                g = _mm_add_epi16(luma, _mm_add_epi16(_mm_mulhi_epi16(u, _mm_set1_epi16(G_CB)),
+                                                      _mm_mulhi_epi16(w, _mm_set1_epi16(G_CR))));
+                b = _mm_add_epi16(luma, _mm_mulhi_epi16(u, _mm_set1_epi16(B_CB)));
+            }
+
+            // Selects the bytes of one channel that land in one 16 byte block of packed RGB
+            __attribute__((target("ssse3")))
+            inline __m128i rgb_mask(int block, int channel)
+            {
+                alignas(16) int8_t mask[16];
+                for (int i = 0; i < 16; ++i)
+                {
+                    const int byte = block * 16 + i;
+                    mask[i] = byte % 3 == channel ? int8_t(byte / 3) : int8_t(-128);
+                }
+                return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+            }
+
+            __attribute__((target("ssse3")))
+            size_t ssse3_rgb(const uint8_t* src, size_t pairs, uint8_t* rgb)
+            {
+
+                __m128i masks[3][3];
+                for (int block = 0; block < 3; ++block)
+                {
+                    for (int channel = 0; channel < 3; ++channel)
+                    {
+                        masks[block][channel] = rgb_mask(block, channel);
+                    }
+                }
+
+                size_t i = 0;
+                for (; i + 8 <= pairs; i += 8)
+                {
+                    __m128i r0, g0, b0, r1, g1, b1;
+                    sse2_rgb8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4)), r0, g0, b0);
+                    sse2_rgb8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4 + 16)), r1, g1, b1);
+
+                    const __m128i r = _mm_packus_epi16(r0, r1);
+                    const __m128i g = _mm_packus_epi16(g0, g1);
+                    const __m128i b = _mm_packus_epi16(b0, b1);
+
+                    for (int block = 0; block < 3; ++block)
+                    {
+                        const __m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, masks[block][0]),
+                                                                      _mm_shuffle_epi8(g, masks[block][1])),
+                                                         _mm_shuffle_epi8(b, masks[block][2]));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + i * 6 + block * 16), out);
+                    }
+                }
+
+                return i;
+            }
+#endif
+            // RGB to YCbCr in Q15, the same fixed point transform the simulator's YUYV converter uses
+            inline uint8_t rgb_luma(int r, int g, int b)
+            {
+                return uint8_t((9798 * r + 19235 * g + 3735 * b + (1 << 14)) >> 15);
+            }
+
+            void rgb_to_yuyv(const uint8_t* rgb, size_t pairs, uint8_t* yuyv)
+            {
+                for (size_t i = 0; i < pairs; ++i)
+                {
+                    const uint8_t* p = rgb + i * 6;
+                    const int r = p[0] + p[3];
+                    const int g = p[1] + p[4];
+                    const int b = p[2] + p[5];
+
+                    uint8_t* out = yuyv + i * 4;
+                    out[0] = rgb_luma(p[0], p[1], p[2]);
+                    out[1] = uint8_t((-5529 * r - 10855 * g + 16384 * b + (128 << 16) + (1 << 15) - 1) >> 16);
+                    out[2] = rgb_luma(p[3], p[4], p[5]);
+                    out[3] = uint8_t((16384 * r - 13720 * g - 2664 * b + (128 << 16) + (1 << 15) - 1) >> 16);
+                }
+            }
+
+            void yuyv_to_i420(const uint8_t* yuyv, unsigned int width, unsigned int height, uint8_t* i420)
+            {
+                uint8_t* y = i420;
+                uint8_t* cb = y + size_t(width) * height;
+                uint8_t* cr = cb + size_t(width / 2) * (height / 2);
+
+                for (unsigned int row = 0; row < height; row += 2)
+                {
+                    const uint8_t* a = yuyv + size_t(row) * width * 2;
+                    const uint8_t* b = a + width * 2;
+                    for (unsigned int pair = 0; pair < width / 2; ++pair)
+                    {
+                        y[size_t(row) * width + pair * 2 + 0] = a[pair * 4 + 0];
+                        y[size_t(row) * width + pair * 2 + 1] = a[pair * 4 + 2];
+                        y[size_t(row + 1) * width + pair * 2 + 0] = b[pair * 4 + 0];
+                        y[size_t(row + 1) * width + pair * 2 + 1] = b[pair * 4 + 2];
+
+                        // 4:2:2 to 4:2:0 averages vertically neighbouring chroma
+                        cb[size_t(row / 2) * (width / 2) + pair] = uint8_t((a[pair * 4 + 1] + b[pair * 4 + 1] + 1) >> 1);
+                        cr[size_t(row / 2) * (width / 2) + pair] = uint8_t((a[pair * 4 + 3] + b[pair * 4 + 3] + 1) >> 1);
+                    }
+                }
+            }
+
+            void i420_to_yuyv(const uint8_t* i420, unsigned int width, unsigned int height, uint8_t* yuyv)
+            {
+                const uint8_t* y = i420;
+                const uint8_t* cb = y + size_t(width) * height;
+                const uint8_t* cr = cb + size_t(width / 2) * (height / 2);
+
+                for (unsigned int row = 0; row < height; ++row)
+                {
+                    uint8_t* out = yuyv + size_t(row) * width * 2;
+                    for (unsigned int pair = 0; pair < width / 2; ++pair)
+                    {
+                        out[pair * 4 + 0] = y[size_t(row) * width + pair * 2 + 0];
+                        out[pair * 4 + 1] = cb[size_t(row / 2) * (width / 2) + pair];
+                        out[pair * 4 + 2] = y[size_t(row) * width + pair * 2 + 1];
+                        out[pair * 4 + 3] = cr[size_t(row / 2) * (width / 2) + pair];
+                    }
+                }
+            }
+
+            // Which channel (0 R, 1 G, 2 B) a Bayer pattern records at a pixel
+            inline int bayer_channel(ImageFormat format, unsigned int x, unsigned int y)
+            {
+                const int even = format == ImageFormat::BAYER_BGGR ? 2 : 0;
+                if ((x + y) % 2 == 1)
+                {
+                    return 1;
+                }
+                return y % 2 == 0 ? even : 2 - even;
+            }
+
+            void rgb_to_bayer(ImageFormat format, const uint8_t* rgb, unsigned int width, unsigned int height, uint8_t* bayer)
+            {
+                for (unsigned int y = 0; y < height; ++y)
+                {
+                    for (unsigned int x = 0; x < width; ++x)
+                    {
+                        const size_t i = size_t(y) * width + x;
+                        bayer[i] = rgb[i * 3 + bayer_channel(format, x, y)];
+                    }
+                }
+            }
+
+            // Bilinear demosaic: each missing channel is the mean of the neighbours in the 3x3 window that have it
+            void bayer_to_rgb(ImageFormat format, const uint8_t* bayer, unsigned int width, unsigned int height, uint8_t* rgb)
+            {
+                for (unsigned int y = 0; y < height; ++y)
+                {
+                    for (unsigned int x = 0; x < width; ++x)
+                    {
+                        int sum[3] = { 0, 0, 0 };
+                        int count[3] = { 0, 0, 0 };
+
+                        for (int dy = -1; dy <= 1; ++dy)
+                        {
+                            for (int dx = -1; dx <= 1; ++dx)
+                            {
+                                const int nx = int(x) + dx;
+                                const int ny = int(y) + dy;
+                                if (nx < 0 || ny < 0 || nx >= int(width) || ny >= int(height))
+                                {
+                                    continue;
+                                }
+                                const int c = bayer_channel(format, nx, ny);
+                                sum[c] += bayer[size_t(ny) * width + nx];
+                                ++count[c];
+                            }
+                        }
+
+                        const size_t i = size_t(y) * width + x;
+                        const int own = bayer_channel(format, x, y);
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            rgb[i * 3 + c] = c == own ? bayer[i] : uint8_t((sum[c] + count[c] / 2) / count[c]);
+                        }
+                    }
+                }
+            }
+
+            void to_rgb(ImageFormat from, const uint8_t* src, unsigned int width, unsigned int height, uint8_t* rgb)
+            {
+                const size_t pixels = size_t(width) * height;
+
+                switch (from)
+                {
+                    case ImageFormat::YUYV: yuyv_to_rgb(src, pixels, rgb); break;
+                    case ImageFormat::RGB24: std::memcpy(rgb, src, pixels * 3); break;
+                    case ImageFormat::GRAY8:
+                    {
+                        for (size_t i = 0; i < pixels; ++i)
+                        {
+                            rgb[i * 3 + 0] = rgb[i * 3 + 1] = rgb[i * 3 + 2] = src[i];
+                        }
+                    } break;
+                    case ImageFormat::BAYER_BGGR:
+                    case ImageFormat::BAYER_RGGB: bayer_to_rgb(from, src, width, height, rgb); break;
+                    case ImageFormat::I420:
+                    {
+                        std::vector<uint8_t> yuyv(pixels * 2);
+                        i420_to_yuyv(src, width, height, yuyv.data());
+                        yuyv_to_rgb(yuyv.data(), pixels, rgb);
+                    } break;
+                }
+            }
+
+            void from_rgb(ImageFormat to, const uint8_t* rgb, unsigned int width, unsigned int height, uint8_t* dst)
+            {
+                const size_t pixels = size_t(width) * height;
+
+                switch (to)
+                {
+                    case ImageFormat::YUYV: rgb_to_yuyv(rgb, pixels / 2, dst); break;
+                    case ImageFormat::RGB24: std::memcpy(dst, rgb, pixels * 3); break;
+                    case ImageFormat::GRAY8:
+                    {
+                        for (size_t i = 0; i < pixels; ++i)
+                        {
+                            dst[i] = rgb_luma(rgb[i * 3 + 0], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+                        }
+                    } break;
+                    case ImageFormat::BAYER_BGGR:
+                    case ImageFormat::BAYER_RGGB: rgb_to_bayer(to, rgb, width, height, dst); break;
+                    case ImageFormat::I420:
+                    {
+                        std::vector<uint8_t> yuyv(pixels * 2);
+                        rgb_to_yuyv(rgb, pixels / 2, yuyv.data());
+                        yuyv_to_i420(yuyv.data(), width, height, dst);
+                    } break;
+                }
+            }
+        }
+
+        ImageFormat image_format_from_string(const std::string& format)
+        {
+            if (format == "yuyv")
+            {
+                return ImageFormat::YUYV;
+            }
+            if (format == "rgb24")
+            {
+                return ImageFormat::RGB24;
+            }
+            if (format == "gray8")
+            {
+                return ImageFormat::GRAY8;
+            }
+            if (format == "bayer_bggr")
+            {
+                return ImageFormat::BAYER_BGGR;
+            }
+            if (format == "bayer_rggb")
+            {
+                return ImageFormat::BAYER_RGGB;
+            }
+            if (format == "i420")
+            {
+                return ImageFormat::I420;
+            }
+
+            throw std::invalid_argument("Unknown image format " + format);
+        }
+
+        size_t image_size(ImageFormat format, unsigned int width, unsigned int height)
+        {
+            const size_t pixels = size_t(width) * height;
+
+            switch (format)
+            {
+                case ImageFormat::YUYV: return pixels * 2;
+                case ImageFormat::RGB24: return pixels * 3;
+                case ImageFormat::GRAY8:
+                case ImageFormat::BAYER_BGGR:
+                case ImageFormat::BAYER_RGGB: return pixels;
+                case ImageFormat::I420: return pixels + 2 * size_t(width / 2) * (height / 2);
+            }
+            return 0;
+        }
+
+        void convert_image(ImageFormat from, const uint8_t* src, ImageFormat to, uint8_t* dst,
+                           unsigned int width, unsigned int height)
+        {
+
+            const size_t pixels = size_t(width) * height;
+
+            if (from == to)
+            {
+                std::memcpy(dst, src, image_size(from, width, height));
+                return;
+            }
+
+            // The YUV formats convert between each other directly, anything else goes through RGB
+            if (from == ImageFormat::YUYV && to == ImageFormat::GRAY8)
+            {
+                for (size_t i = 0; i < pixels; ++i)
+                {
+                    dst[i] = src[i * 2];
+                }
+            }
+            else if (from == ImageFormat::YUYV && to == ImageFormat::I420)
+            {
+                yuyv_to_i420(src, width, height, dst);
+            }
+            else if (from == ImageFormat::I420 && to == ImageFormat::YUYV)
+            {
+                i420_to_yuyv(src, width, height, dst);
+            }
+            else if (from == ImageFormat::I420 && to == ImageFormat::GRAY8)
+            {
+                std::memcpy(dst, src, pixels);
+            }
+            else if (from == ImageFormat::GRAY8 && to == ImageFormat::YUYV)
+            {
+                for (size_t i = 0; i < pixels; ++i)
+                {
+                    dst[i * 2 + 0] = src[i];
+                    dst[i * 2 + 1] = 128;
+                }
+            }
+            else if (to == ImageFormat::RGB24)
+            {
+                to_rgb(from, src, width, height, dst);
+            }
+            else if (from == ImageFormat::RGB24)
+            {
+                from_rgb(to, src, width, height, dst);
+            }
+            else
+            {
+                std::vector<uint8_t> rgb(pixels * 3);
+                to_rgb(from, src, width, height, rgb.data());
+                from_rgb(to, rgb.data(), width, height, dst);
+            }
+        }
+
+        void yuyv_to_planar(const uint8_t* yuyv, size_t pixels, uint8_t* y, uint8_t* cb, uint8_t* cr)
+        {
+            const size_t pairs = pixels / 2;
+            size_t done = 0;
+
+#ifdef IMAGE_FORMAT_X86
+            done = sse2_planar(yuyv, pairs, y, cb, cr);
+#endif
+            scalar_planar(yuyv + done * 4, pairs - done, y + done * 2, cb + done, cr + done);
+        }
+
+        void yuyv_to_rgb(const uint8_t* yuyv, size_t pixels, uint8_t* rgb)
+        {
+            const size_t pairs = pixels / 2;
+            size_t done = 0;
+
+#ifdef IMAGE_FORMAT_X86
+            if (__builtin_cpu_supports("ssse3"))
+            {
+                done = ssse3_rgb(yuyv, pairs, rgb);
+            }
+#endif
+            scalar_rgb(yuyv + done * 4, pairs - done, rgb + done * 6);
+        }
+
+    }  // input
+}  // message
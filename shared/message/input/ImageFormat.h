@@ -0,0 +1,65 @@
+/*
+ * This file is part of the NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2013 NUBots <nubots@nubots.net>
+ */
+
+#ifndef MESSAGE_INPUT_IMAGEFORMAT_H
+#define MESSAGE_INPUT_IMAGEFORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace message {
+    namespace input {
+
+        enum class ImageFormat {
+            /// 4:2:2 packed Y0 Cb Y1 Cr, full range BT.601
+            YUYV,
+            /// Packed 8 bit R G B
+            RGB24,
+            /// 8 bit luma only
+            GRAY8,
+            /// Raw Bayer mosaic, one byte per pixel, even rows B G B G and odd rows G R G R
+            BAYER_BGGR,
+            /// Raw Bayer mosaic, one byte per pixel, even rows R G R G and odd rows G B G B
+            BAYER_RGGB,
+            /// 4:2:0 planar: a full size Y plane then quarter size Cb and Cr planes
+            I420
+        };
+
+        constexpr size_t IMAGE_FORMAT_COUNT = 6;
+
+        ImageFormat image_format_from_string(const std::string& format);
+
+        /// @brief Bytes needed for a width x height image. YUYV needs an even width and I420 an even width and height
+        size_t image_size(ImageFormat format, unsigned int width, unsigned int height);
+
+        /// @brief Converts between any two formats, dst must hold image_size(to, width, height) bytes
+        void convert_image(ImageFormat from, const uint8_t* src, ImageFormat to, uint8_t* dst,
+                           unsigned int width, unsigned int height);
+
+        /// @brief Splits YUYV into a luma plane and half width chroma planes
+        void yuyv_to_planar(const uint8_t* yuyv, size_t pixels, uint8_t* y, uint8_t* cb, uint8_t* cr);
+
+        /// @brief Converts YUYV to packed RGB
+        void yuyv_to_rgb(const uint8_t* yuyv, size_t pixels, uint8_t* rgb);
+
+    }  // input
+}  // message
+
+#endif  // MESSAGE_INPUT_IMAGEFORMAT_H
@@ -0,0 +1,66 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MESSAGE_INPUT_IMAGEPYRAMID_H
+#define MESSAGE_INPUT_IMAGEPYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <nuclear>
+
+#include "ImageBufferPool.h"
+
+namespace message {
+    namespace input {
+
+        /**
+         * Half, quarter and smaller resolution copies of a camera image, made once by the camera so its
+         * subscribers don't each downsample it.
+         *
+         * Level 0 is half the resolution of the message::input::Image with the same timestamp, camera_id,
+         * world_id and sequence, and each level after it half the one before, every pixel the mean of the
+         * 2x2 block under it. Levels are YUYV whatever format the image is in, and all of them share one
+         * contiguous buffer, which goes back to its pool with the last copy of the message.
+         */
+        struct ImagePyramid {
+            struct Level {
+                uint32_t width;
+                uint32_t height;
+                /// Where the level starts in data, rows are width * 2 bytes and follow each other
+                size_t offset;
+            };
+
+            const uint8_t* level(size_t i) const {
+                return data.data() + levels[i].offset;
+            }
+
+            NUClear::clock::time_point timestamp;
+            uint32_t camera_id = 0;
+            uint32_t world_id = 0;
+            uint64_t sequence = 0;
+            std::vector<Level> levels;
+            ImageBuffer data;
+        };
+
+    }  // input
+}  // message
+
+#endif  // MESSAGE_INPUT_IMAGEPYRAMID_H
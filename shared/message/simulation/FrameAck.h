@@ -0,0 +1,41 @@
+/*
+ * This file is part of the NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUBots <nubots@nubots.net>
+ */
+
+#ifndef MESSAGE_SIMULATION_FRAMEACK_H
+#define MESSAGE_SIMULATION_FRAMEACK_H
+
+#include <nuclear>
+
+namespace message {
+    namespace simulation {
+
+        /**
+         * Emitted by a consumer once it has finished with a simulated image. When the camera simulator runs in
+         * lockstep mode it will not advance to the next frame until every image of the current one, one for each
+         * camera of every world, has been acknowledged, so emit exactly one of these per image.
+         */
+        struct FrameAck {
+            /// The timestamp of the image that was consumed
+            NUClear::clock::time_point timestamp;
+        };
+
+    }  // simulation
+}  // message
+
+#endif  // MESSAGE_SIMULATION_FRAMEACK_H
@@ -0,0 +1,59 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MESSAGE_SIMULATION_FRAMEPROFILE_H
+#define MESSAGE_SIMULATION_FRAMEPROFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <nuclear>
+
+namespace message {
+    namespace simulation {
+
+        /**
+         * Emitted periodically by the camera simulator with how long each stage of its frame pipeline took
+         * over the last interval. Latencies are in seconds; the percentiles come from a histogram so are
+         * accurate to a few percent, count, mean and max are exact.
+         */
+        struct FrameProfile {
+            struct Stage {
+                std::string name;
+                uint64_t count;
+                double mean;
+                double p50;
+                double p95;
+                double p99;
+                double max;
+            };
+
+            /// When the interval ended
+            NUClear::clock::time_point timestamp;
+            std::chrono::duration<double> interval;
+            /// Stages that ran at least once in the interval, in pipeline order
+            std::vector<Stage> stages;
+        };
+
+    }  // simulation
+}  // message
+
+#endif  // MESSAGE_SIMULATION_FRAMEPROFILE_H
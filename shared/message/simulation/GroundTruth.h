@@ -0,0 +1,102 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MESSAGE_SIMULATION_GROUNDTRUTH_H
+#define MESSAGE_SIMULATION_GROUNDTRUTH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <nuclear>
+
+namespace message {
+    namespace simulation {
+
+        /**
+         * Where the ball, field features and robots are in a simulated camera image, projected from the state
+         * of the world the image was rendered from.
+         *
+         * It has the same timestamp, camera_id and world_id as its message::input::Image, but is emitted when
+         * the frame is rendered, a few frames before the image has been read back. Image coordinates are
+         * continuous pixels of the image with (0, 0) the top left corner of the first pixel, after any lens
+         * distortion. Depths are along the camera's optical axis, in scene units.
+         *
+         * Something is in_image when it projects inside the image and in front of the camera, and occluded
+         * when the simulator's coarse stand in geometry (the ball, goal posts and robot bounding boxes) is
+         * between it and the camera. Field lines and the ground never occlude.
+         */
+        struct GroundTruth {
+            enum class FeatureType : uint8_t {
+                GOAL_POST_BASE,
+                GOAL_POST_TOP,
+                L_INTERSECTION,
+                T_INTERSECTION,
+                X_INTERSECTION,
+                CENTRE_MARK,
+                PENALTY_MARK
+            };
+
+            /// A point on the field. The base and top of a goal post share the post's id
+            struct Feature {
+                FeatureType type;
+                uint32_t id;
+                float x;
+                float y;
+                float depth;
+                bool in_image;
+                bool occluded;
+            };
+
+            /// The ball's outline, as a circle about where its centre projects
+            struct Ball {
+                float x;
+                float y;
+                float radius;
+                float depth;
+                bool in_image;
+                bool occluded;
+            };
+
+            /// The image rectangle around a robot's bounding box, occluded when its centre is
+            struct Robot {
+                uint32_t id;
+                float x_min;
+                float y_min;
+                float x_max;
+                float y_max;
+                float depth;
+                bool in_image;
+                bool occluded;
+            };
+
+            NUClear::clock::time_point timestamp;
+            uint32_t camera_id;
+            uint32_t world_id;
+            uint32_t width;
+            uint32_t height;
+
+            Ball ball;
+            std::vector<Feature> features;
+            std::vector<Robot> robots;
+        };
+
+    }  // simulation
+}  // message
+
+#endif  // MESSAGE_SIMULATION_GROUNDTRUTH_H
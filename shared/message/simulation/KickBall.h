@@ -0,0 +1,40 @@
+/*
+ * This file is part of the NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUBots <nubots@nubots.net>
+ */
+#ifndef MESSAGE_SIMULATION_KICKBALL_H
+#define MESSAGE_SIMULATION_KICKBALL_H
+
+#include <cstdint>
+
+namespace message {
+    namespace simulation {
+
+        /**
+         * Kicks the ball of a simulated world, which then rolls, bounces and stops under the simulator's
+         * dynamics. The kick sets the ball's velocity rather than adding to it.
+         */
+        struct KickBall {
+            uint32_t world_id;
+            /// Scene units per second, y up
+            float velocity[3];
+        };
+
+    }  // simulation
+}  // message
+
+#endif  // MESSAGE_SIMULATION_KICKBALL_H
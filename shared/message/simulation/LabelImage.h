@@ -0,0 +1,53 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef MESSAGE_SIMULATION_LABELIMAGE_H
+#define MESSAGE_SIMULATION_LABELIMAGE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <nuclear>
+
+namespace message {
+    namespace simulation {
+
+        /**
+         * The class of object under every pixel of a simulated camera image, for training classifiers.
+         *
+         * It covers the same view as the message::input::Image with the same timestamp, camera_id and
+         * world_id, at 1 / scale of its resolution. Class ids come from the simulator's label table; 0 is the
+         * background and anything not in the table.
+         */
+        struct LabelImage {
+            uint32_t width;
+            uint32_t height;
+            /// Image pixels per label pixel along each axis
+            uint32_t scale;
+            NUClear::clock::time_point timestamp;
+            uint32_t camera_id;
+            uint32_t world_id;
+            /// One class id per pixel, row major
+            std::vector<uint8_t> labels;
+        };
+
+    }  // simulation
+}  // message
+
+#endif  // MESSAGE_SIMULATION_LABELIMAGE_H
@@ -0,0 +1,326 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#include "FrameLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace utility {
+    namespace simulation {
+
+        namespace {
+
+            constexpr char FILE_MAGIC[4] = { 'N', 'U', 'F', 'L' };
+            // Bump whenever the records change
+            constexpr uint32_t VERSION = 1;
+            constexpr uint32_t RECORD_MAGIC = 0x5246554E;  // "NUFR"
+            constexpr size_t ALIGNMENT = 64;
+
+            struct FileHeader {
+                char magic[4];
+                uint32_t version;
+                uint8_t reserved[56];
+            };
+
+            static_assert(sizeof(FileHeader) == ALIGNMENT, "Records must start aligned");
+            static_assert(sizeof(FrameLogRecord) % 32 == 0, "Pixels must start 32 byte aligned");
+
+            uint64_t record_size(uint64_t bytes)
+            {
+                return (sizeof(FrameLogRecord) + bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            }
+
+            bool valid_header(const FileHeader& header)
+            {
+                return std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 && header.version == VERSION;
+            }
+
+            // A complete record starts at offset in a file of size bytes
+            bool valid_record(const FrameLogRecord& record, uint64_t offset, uint64_t size)
+            {
+                return record.magic == RECORD_MAGIC && offset + record_size(record.bytes) <= size;
+            }
+
+            std::runtime_error error(const std::string& what, const std::string& path)
+            {
+                return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+            }
+        }
+
+        FrameLogWriter::FrameLogWriter(const std::string& path) : fd(-1), index_fd(-1), end(0), count(0)
+        {
+
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0)
+            {
+                throw error("Can't open the frame log", path);
+            }
+
+            struct stat info;
+            fstat(fd, &info);
+
+            std::vector<uint64_t> offsets;
+
+            if (info.st_size == 0)
+            {
+                FileHeader header = {};
+                std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+                header.version = VERSION;
+                if (::write(fd, &header, sizeof(header)) != ssize_t(sizeof(header)))
+                {
+                    close(fd);
+                    throw error("Can't write the frame log", path);
+                }
+                end = sizeof(header);
+            }
+            else
+            {
+                FileHeader header;
+                if (pread(fd, &header, sizeof(header), 0) != ssize_t(sizeof(header)) || !valid_header(header))
+                {
+                    close(fd);
+                    throw std::runtime_error(path + " is not a frame log");
+                }
+
+                // Walk the records to the end of the last complete one, a crash may have left a partial one after it
+                end = sizeof(header);
+                FrameLogRecord record;
+                while (pread(fd, &record, sizeof(record), end) == ssize_t(sizeof(record))
+                       && valid_record(record, end, info.st_size))
+                {
+                    offsets.push_back(end);
+                    end += record_size(record.bytes);
+                }
+
+                if (ftruncate(fd, end) != 0)
+                {
+                    close(fd);
+                    throw error("Can't truncate the frame log", path);
+                }
+            }
+
+            index_fd = ::open((path + ".index").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (index_fd < 0)
+            {
+                close(fd);
+                throw error("Can't open the frame log index", path + ".index");
+            }
+            if (!offsets.empty())
+            {
+                const ssize_t index_bytes = offsets.size() * sizeof(uint64_t);
+                if (::write(index_fd, offsets.data(), index_bytes) != index_bytes)
+                {
+                    close(fd);
+                    close(index_fd);
+                    throw error("Can't write the frame log index", path + ".index");
+                }
+            }
+            count = offsets.size();
+        }
+
+        FrameLogWriter::~FrameLogWriter()
+        {
+            close(index_fd);
+            close(fd);
+        }
+
+        void FrameLogWriter::append(FrameLogRecord record, const uint8_t* data, size_t bytes)
+        {
+
+            record.magic = RECORD_MAGIC;
+            record.bytes = bytes;
+
+            static const uint8_t padding[ALIGNMENT] = {};
+            const size_t total = record_size(bytes);
+
+            iovec parts[3];
+            parts[0].iov_base = &record;
+            parts[0].iov_len = sizeof(record);
+            parts[1].iov_base = const_cast<uint8_t*>(data);
+            parts[1].iov_len = bytes;
+            parts[2].iov_base = const_cast<uint8_t*>(padding);
+            parts[2].iov_len = total - sizeof(record) - bytes;
+
+            // writev may write less than asked, carry on from wherever it stopped
+            size_t written = 0;
+            int part = 0;
+            while (written < total)
+            {
+                ssize_t n = pwritev(fd, parts + part, 3 - part, end + written);
+                if (n <= 0)
+                {
+                    if (n < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw error("Can't append to the frame log", "");
+                }
+                written += n;
+                while (part < 3 && size_t(n) >= parts[part].iov_len)
+                {
+                    n -= parts[part].iov_len;
+                    ++part;
+                }
+                if (part < 3)
+                {
+                    parts[part].iov_base = static_cast<uint8_t*>(parts[part].iov_base) + n;
+                    parts[part].iov_len -= n;
+                }
+            }
+
+            // The index only ever points at complete frames
+            if (::write(index_fd, &end, sizeof(end)) != ssize_t(sizeof(end)))
+            {
+                throw error("Can't append to the frame log index", "");
+            }
+
+            end += total;
+            ++count;
+        }
+
+        size_t FrameLogWriter::frames() const
+        {
+            return count;
+        }
+
+        std::shared_ptr<FrameLogReader> FrameLogReader::open(const std::string& path)
+        {
+
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw error("Can't open the frame log", path);
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(FileHeader))
+            {
+                close(fd);
+                throw std::runtime_error(path + " is not a frame log");
+            }
+
+            void* memory = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (memory == MAP_FAILED)
+            {
+                throw error("Can't map the frame log", path);
+            }
+
+            std::shared_ptr<FrameLogReader> reader(new FrameLogReader());
+            reader->mapping = static_cast<const uint8_t*>(memory);
+            reader->mapping_size = info.st_size;
+
+            if (!valid_header(*reinterpret_cast<const FileHeader*>(reader->mapping)))
+            {
+                throw std::runtime_error(path + " is not a frame log");
+            }
+
+            auto record_at = [&] (uint64_t offset) -> const FrameLogRecord& {
+                return *reinterpret_cast<const FrameLogRecord*>(reader->mapping + offset);
+            };
+            auto valid_at = [&] (uint64_t offset) {
+                return offset % ALIGNMENT == 0 && offset + sizeof(FrameLogRecord) <= reader->mapping_size
+                       && valid_record(record_at(offset), offset, reader->mapping_size);
+            };
+
+            // Use the index when it agrees with the log, otherwise walk the records
+            int index_fd = ::open((path + ".index").c_str(), O_RDONLY);
+            if (index_fd >= 0)
+            {
+                struct stat index_info;
+                if (fstat(index_fd, &index_info) == 0)
+                {
+                    reader->offsets.resize(index_info.st_size / sizeof(uint64_t));
+                    const ssize_t index_bytes = reader->offsets.size() * sizeof(uint64_t);
+                    if (pread(index_fd, reader->offsets.data(), index_bytes, 0) != index_bytes
+                        || !std::all_of(reader->offsets.begin(), reader->offsets.end(), valid_at))
+                    {
+                        reader->offsets.clear();
+                    }
+                }
+                close(index_fd);
+            }
+
+            if (reader->offsets.empty())
+            {
+                for (uint64_t offset = sizeof(FileHeader); valid_at(offset); offset += record_size(record_at(offset).bytes))
+                {
+                    reader->offsets.push_back(offset);
+                }
+            }
+
+            // Frames from different threads may have been appended slightly out of order
+            std::stable_sort(reader->offsets.begin(), reader->offsets.end(), [&] (uint64_t a, uint64_t b) {
+                return record_at(a).timestamp < record_at(b).timestamp;
+            });
+
+            madvise(const_cast<uint8_t*>(reader->mapping), reader->mapping_size, MADV_SEQUENTIAL);
+
+            return reader;
+        }
+
+        FrameLogReader::~FrameLogReader()
+        {
+            if (mapping)
+            {
+                munmap(const_cast<uint8_t*>(mapping), mapping_size);
+            }
+        }
+
+        size_t FrameLogReader::size() const
+        {
+            return offsets.size();
+        }
+
+        const FrameLogRecord& FrameLogReader::record(size_t frame) const
+        {
+            return *reinterpret_cast<const FrameLogRecord*>(mapping + offsets[frame]);
+        }
+
+        const uint8_t* FrameLogReader::data(size_t frame) const
+        {
+            return mapping + offsets[frame] + sizeof(FrameLogRecord);
+        }
+
+        void FrameLogReader::will_need(size_t first, size_t count) const
+        {
+
+            const size_t last = std::min(first + count, offsets.size());
+            if (first >= last)
+            {
+                return;
+            }
+
+            // madvise wants page aligned addresses
+            const size_t page = sysconf(_SC_PAGESIZE);
+            const uint64_t begin = offsets[first] / page * page;
+            const uint64_t finish = offsets[last - 1] + record_size(record(last - 1).bytes);
+            madvise(const_cast<uint8_t*>(mapping) + begin, finish - begin, MADV_WILLNEED);
+        }
+
+    }  // simulation
+}  // utility
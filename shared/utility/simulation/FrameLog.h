@@ -0,0 +1,123 @@
+/*
+ * This file is part of NUbots Codebase.
+ *
+ * The NUbots Codebase is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The NUbots Codebase is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the NUbots Codebase.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright 2016 NUbots <nubots@nubots.net>
+ */
+
+#ifndef UTILITY_SIMULATION_FRAMELOG_H
+#define UTILITY_SIMULATION_FRAMELOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace utility {
+    namespace simulation {
+
+        /// The simulated world when a frame was rendered
+        struct FrameLogPose {
+            float camera_position[3];
+            float camera_pitch;
+            float camera_yaw;
+            float ball_position[3];
+        };
+
+        /**
+         * The header of one frame in a log, followed directly by its pixels. Records are padded to a multiple
+         * of 64 bytes so the pixels of every frame start 32 byte aligned.
+         */
+        struct FrameLogRecord {
+            uint32_t magic;
+            /// A message::input::ImageFormat
+            uint32_t format;
+            uint32_t width;
+            uint32_t height;
+            uint32_t world_id;
+            uint32_t camera_id;
+            /// Nanoseconds since the NUClear clock's epoch
+            int64_t timestamp;
+            /// Number of pixel bytes that follow
+            uint64_t bytes;
+            FrameLogPose pose;
+            uint32_t reserved[6];
+        };
+
+        /**
+         * Appends frames to a log file.
+         *
+         * The log is append only: each frame is written with one writev after the last, and its offset is added
+         * to an index beside it (path + ".index"). Opening an existing log carries on after its last complete
+         * frame, dropping anything a crash left half written, and rebuilds the index.
+         *
+         * Not thread safe, callers appending from several threads must serialise.
+         */
+        class FrameLogWriter {
+        public:
+            /// @throws std::runtime_error if the log can't be opened or isn't a frame log
+            explicit FrameLogWriter(const std::string& path);
+            ~FrameLogWriter();
+
+            FrameLogWriter(const FrameLogWriter&) = delete;
+            FrameLogWriter& operator=(const FrameLogWriter&) = delete;
+
+            /// @brief Appends a frame, record.magic and record.bytes are filled in here
+            /// @throws std::runtime_error if the write fails
+            void append(FrameLogRecord record, const uint8_t* data, size_t bytes);
+
+            size_t frames() const;
+
+        private:
+            int fd;
+            int index_fd;
+            uint64_t end;
+            size_t count;
+        };
+
+        /**
+         * Memory maps a frame log for reading. Frames are ordered by timestamp and their pixels are read straight
+         * from the mapping, which lives as long as the reader.
+         */
+        class FrameLogReader {
+        public:
+            /// @throws std::runtime_error if the log can't be read or isn't a frame log
+            static std::shared_ptr<FrameLogReader> open(const std::string& path);
+
+            ~FrameLogReader();
+
+            FrameLogReader(const FrameLogReader&) = delete;
+            FrameLogReader& operator=(const FrameLogReader&) = delete;
+
+            size_t size() const;
+            const FrameLogRecord& record(size_t frame) const;
+            const uint8_t* data(size_t frame) const;
+
+            /// @brief Asks the kernel to start reading frames [first, first + count) in ahead of use
+            void will_need(size_t first, size_t count) const;
+
+        private:
+            FrameLogReader() = default;
+
+            const uint8_t* mapping = nullptr;
+            size_t mapping_size = 0;
+            std::vector<uint64_t> offsets;
+        };
+
+    }  // simulation
+}  // utility
+
+#endif  // UTILITY_SIMULATION_FRAMELOG_H